@@ -5,11 +5,20 @@
  */
 
 #include "ads1292r_driver.h"
+#include "qrs_detector.h"
+#include "boot.h"
+#include "ptt.h"
 #include "nrf_drv_spi.h"
+#include "nrf_drv_gpiote.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_drv_timer.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
 #include "nrf_gpio.h"
 #include "nrf_delay.h"
 #include "nrf_log.h"
-#include <math.h>
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_ECG
+#include "trace.h"
 
 // ADS1292R Pin Definitions (adjust to your circuit)
 #define ADS1292R_CS_PIN       25
@@ -42,27 +51,137 @@
 #define ADS1292R_CMD_RREG     0x20
 #define ADS1292R_CMD_WREG     0x40
 
+// Capture configuration
+#define ADS1292R_SAMPLE_RATE_HZ   500
+#define ADS1292R_MAX_SAMPLES      2000  // Capture limit (4 s) if beats are missed
+#define ADS1292R_TARGET_RR        3     // Stop once this many RR intervals are measured
+#define ADS1292R_FRAME_SIZE       9     // 3 status bytes + 3 bytes CH1 + 3 bytes CH2
+#define ADS1292R_BLOCK_SAMPLES    50    // 100 ms per DMA block
+#define ADS1292R_CAPTURE_MARGIN_MS 200  // Extra time before the capture is abandoned
+#define ADS1292R_WAKEUP_MS        10    // Standby exit until conversions are valid
+#define ADS1292R_SAMPLE_PERIOD_US (1000000 / ADS1292R_SAMPLE_RATE_HZ)
+
+// ECG history, CH1 of every measured sample in ADS1292R_ECG_FORMAT
+#define ADS1292R_HISTORY_BYTES    3000
+#if ADS1292R_ECG_FORMAT == ADS1292R_ECG_FORMAT_DECIMATED16
+#define ADS1292R_HISTORY_SAMPLE_BYTES 2
+#define ADS1292R_HISTORY_DECIMATION   2     // 1500 samples, 6 s
+#else
+#define ADS1292R_HISTORY_SAMPLE_BYTES 3
+#define ADS1292R_HISTORY_DECIMATION   1     // 1000 samples, 2 s
+#endif
+#define ADS1292R_HISTORY_SAMPLES  (ADS1292R_HISTORY_BYTES / ADS1292R_HISTORY_SAMPLE_BYTES)
+#define ADS1292R_BASELINE_SHIFT   8     // Baseline tracker time constant ~0.5 s
+#define ADS1292R_DECIMATED_SHIFT  2     // 5200 counts/mV, +-6.3 mV in 16 bits
+
 // SPI Instance
 static const nrf_drv_spi_t m_spi = NRF_DRV_SPI_INSTANCE(1);
 static bool m_initialized = false;
+static bool m_spi_enabled = false;      // Released in standby, see ads1292r_power_off()
+static volatile bool m_spi_xfer_done = false;
+
+// DRDY capture resources: TIMER1 counts SPIM END events, PPI links
+// DRDY -> SPIM START and SPIM END -> TIMER COUNT without CPU involvement.
+// DRDY also forks to the PTT capture, timestamping every sample.
+static const nrf_drv_timer_t m_sample_counter = NRF_DRV_TIMER_INSTANCE(1);
+static nrf_ppi_channel_t m_ppi_drdy_start;
+static nrf_ppi_channel_t m_ppi_end_count;
+APP_TIMER_DEF(m_capture_timeout_timer);
+APP_TIMER_DEF(m_wakeup_timer);
+
+// EasyDMA ping-pong buffers. Both halves are contiguous so RX_POSTINC walks
+// from block 0 straight into block 1; the pointer is rewound after block 1.
+static uint8_t m_dma_rx[2][ADS1292R_BLOCK_SAMPLES][ADS1292R_FRAME_SIZE];
+static volatile uint8_t m_blocks_pending = 0;   // Bit n set = block n ready
+static volatile bool m_capture_timed_out = false;
+static uint16_t m_block_overruns = 0;
+static volatile uint32_t m_block_time[2];       // DRDY capture of each block's last sample
+static ptt_clock_t m_clock;                     // Measurement sample index to PTT time
+
+// ECG history ring, kept across captures for pre-event context
+static uint8_t m_history[ADS1292R_HISTORY_SAMPLES * ADS1292R_HISTORY_SAMPLE_BYTES];
+static uint16_t m_history_head = 0;             // Next slot to write
+static uint16_t m_history_count = 0;
+static bool m_history_primed = false;           // Baseline seeded for this capture
+#if ADS1292R_ECG_FORMAT == ADS1292R_ECG_FORMAT_DECIMATED16
+static int32_t m_history_baseline_q4;
+static int32_t m_history_acc;                   // Decimation sum
+static uint8_t m_history_phase;
+#endif
+static uint16_t m_samples_captured = 0;
+
+// Non-blocking measurement state
+static ads1292r_ready_handler_t m_ready_handler = NULL;
+static volatile bool m_ready_pending = false;
+static ads1292r_done_handler_t m_done_handler = NULL;
+static bool m_capture_active = false;
+static bool m_powered = false;          // Between power_on and power_off
+static uint8_t m_next_block = 0;
+static int m_result = -1;
+static uint16_t m_bp_systolic = 120;
+static uint16_t m_bp_diastolic = 80;
+
+// Continuous CH1 streaming, independent of the measurement cycle
+static ads1292r_stream_handler_t m_stream_handler = NULL;
+static bool m_streaming = false;
+
+// Init sequence, advanced by ads1292r_init_step()
+typedef enum {
+    ADS1292R_INIT_START,
+    ADS1292R_INIT_POWER_UP,             // PWDN pulse in progress
+    ADS1292R_INIT_RESET,                // Powering up
+    ADS1292R_INIT_SDATAC,               // Software reset in progress
+    ADS1292R_INIT_CONFIGURE
+} ads1292r_init_state_t;
+
+static ads1292r_init_state_t m_init_state = ADS1292R_INIT_START;
 
-// ECG Data buffers
-static int32_t ecg_ch1_buffer[500];
-static int32_t ecg_ch2_buffer[500];
-static uint16_t buffer_index = 0;
+// Register configuration, written on every init
+static const uint8_t m_config[][2] = {
+    { ADS1292R_REG_CONFIG1, 0x02 },     // HR mode, 500 SPS
+    { ADS1292R_REG_CONFIG2, 0xA0 },     // Test signals off, PDB_LOFF_COMP, PDB_REFBUF
+    { ADS1292R_REG_CH1SET,  0x00 },     // Normal operation, Gain 6, channel enabled
+#if ADS1292R_CH2_ENABLE
+    { ADS1292R_REG_CH2SET,  0x00 },     // Normal operation, Gain 6, channel enabled
+    { ADS1292R_REG_RLDSENS, 0x2C },     // RLD sensing
+#else
+    { ADS1292R_REG_CH2SET,  0x81 },     // Powered down, input shorted
+    { ADS1292R_REG_RLDSENS, 0x23 },     // RLD sensing from CH1, CH2 is off
+#endif
+};
+
+/**
+ * @brief SPI event handler, signals completion of register transfers
+ */
+static void ads1292r_spi_evt_handler(nrf_drv_spi_evt_t const *p_event, void *p_context) {
+    m_spi_xfer_done = true;
+}
+
+/**
+ * @brief Blocking SPI transfer, sleeps until the SPIM END event
+ */
+static void ads1292r_spi_transfer(uint8_t *tx_data, uint8_t tx_len, uint8_t *rx_data, uint8_t rx_len) {
+    m_spi_xfer_done = false;
+    if (nrf_drv_spi_transfer(&m_spi, tx_data, tx_len, rx_data, rx_len) != NRF_SUCCESS) {
+        return;
+    }
+    while (!m_spi_xfer_done) {
+        __WFE();
+    }
+}
 
 /**
  * @brief SPI write/read helper
  */
 static void ads1292r_spi_write(uint8_t *tx_data, uint8_t tx_len) {
     nrf_gpio_pin_clear(ADS1292R_CS_PIN);
-    nrf_drv_spi_transfer(&m_spi, tx_data, tx_len, NULL, 0);
+    ads1292r_spi_transfer(tx_data, tx_len, NULL, 0);
     nrf_gpio_pin_set(ADS1292R_CS_PIN);
 }
 
 static void ads1292r_spi_read(uint8_t *tx_data, uint8_t tx_len, uint8_t *rx_data, uint8_t rx_len) {
     nrf_gpio_pin_clear(ADS1292R_CS_PIN);
-    nrf_drv_spi_transfer(&m_spi, tx_data, tx_len, rx_data, rx_len);
+    ads1292r_spi_transfer(tx_data, tx_len, rx_data, rx_len);
     nrf_gpio_pin_set(ADS1292R_CS_PIN);
 }
 
@@ -70,10 +189,8 @@ static void ads1292r_spi_read(uint8_t *tx_data, uint8_t tx_len, uint8_t *rx_data
  * @brief Send command to ADS1292R
  */
 static void ads1292r_send_command(uint8_t cmd) {
-    nrf_gpio_pin_clear(ADS1292R_CS_PIN);
     uint8_t tx_data = cmd;
-    nrf_drv_spi_transfer(&m_spi, &tx_data, 1, NULL, 0);
-    nrf_gpio_pin_set(ADS1292R_CS_PIN);
+    ads1292r_spi_write(&tx_data, 1);
     nrf_delay_us(10);
 }
 
@@ -106,24 +223,262 @@ static uint8_t ads1292r_read_register(uint8_t reg) {
 }
 
 /**
- * @brief Initialize ADS1292R
+ * @brief Point the SPIM RX EasyDMA list back at the start of block 0
  */
-int ads1292r_init(void) {
+static void ads1292r_dma_rewind(void) {
+    nrf_drv_spi_xfer_desc_t xfer = NRF_DRV_SPI_XFER_TRX(NULL, 0,
+                                                        &m_dma_rx[0][0][0],
+                                                        ADS1292R_FRAME_SIZE);
+    // Transfer is only armed here; DRDY triggers START through PPI
+    nrf_drv_spi_xfer(&m_spi, &xfer,
+                     NRF_DRV_SPI_FLAG_HOLD_XFER |
+                     NRF_DRV_SPI_FLAG_RX_POSTINC |
+                     NRF_DRV_SPI_FLAG_REPEATED_XFER |
+                     NRF_DRV_SPI_FLAG_NO_XFER_EVT_HANDLER);
+}
+
+/**
+ * @brief Sample counter handler, runs once per completed DMA block
+ */
+static void ads1292r_counter_evt_handler(nrf_timer_event_t event_type, void *p_context) {
+    uint8_t block;
+
+    if (event_type == NRF_TIMER_EVENT_COMPARE0) {
+        block = 0;
+    } else if (event_type == NRF_TIMER_EVENT_COMPARE1) {
+        block = 1;
+        // Next DRDY is 2 ms away, plenty of time to rewind the list
+        ads1292r_dma_rewind();
+    } else {
+        return;
+    }
+    m_block_time[block] = ptt_capture_get(PTT_SOURCE_ECG);
+
+    if (m_blocks_pending & (1 << block)) {
+        m_block_overruns++;
+    }
+    m_blocks_pending |= (1 << block);
+}
+
+/**
+ * @brief Capture watchdog, fires if DRDY stops arriving
+ */
+static void ads1292r_capture_timeout_handler(void *p_context) {
+    m_capture_timed_out = true;
+}
+
+/**
+ * @brief Wake-up settling timer, signals that the device is ready
+ */
+static void ads1292r_wakeup_timeout_handler(void *p_context) {
+    m_ready_pending = true;
+}
+
+/**
+ * @brief Set up GPIOTE, PPI and TIMER for DRDY-driven capture
+ */
+static int ads1292r_capture_init(void) {
     ret_code_t err_code;
-    
-    // Configure GPIO pins
-    nrf_gpio_cfg_output(ADS1292R_CS_PIN);
+
+    if (!nrf_drv_gpiote_is_init()) {
+        err_code = nrf_drv_gpiote_init();
+        if (err_code != NRF_SUCCESS) return -1;
+    }
+
+    // DRDY falling edge as a GPIOTE event only, no CPU interrupt
+    nrf_drv_gpiote_in_config_t drdy_config = GPIOTE_CONFIG_IN_SENSE_HITOLO(true);
+    drdy_config.pull = NRF_GPIO_PIN_PULLUP;
+    err_code = nrf_drv_gpiote_in_init(ADS1292R_DRDY_PIN, &drdy_config, NULL);
+    if (err_code != NRF_SUCCESS) return -1;
+
+    // Count SPIM END events; interrupt only at block boundaries
+    nrf_drv_timer_config_t timer_config = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_config.mode = NRF_TIMER_MODE_COUNTER;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_16;
+    err_code = nrf_drv_timer_init(&m_sample_counter, &timer_config, ads1292r_counter_evt_handler);
+    if (err_code != NRF_SUCCESS) return -1;
+
+    nrf_drv_timer_compare(&m_sample_counter, NRF_TIMER_CC_CHANNEL0,
+                          ADS1292R_BLOCK_SAMPLES, true);
+    nrf_drv_timer_extended_compare(&m_sample_counter, NRF_TIMER_CC_CHANNEL1,
+                                   2 * ADS1292R_BLOCK_SAMPLES,
+                                   NRF_TIMER_SHORT_COMPARE1_CLEAR_MASK, true);
+
+    err_code = nrf_drv_ppi_init();
+    if (err_code != NRF_SUCCESS && err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED) return -1;
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_drdy_start);
+    if (err_code != NRF_SUCCESS) return -1;
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_drdy_start,
+                                          nrf_drv_gpiote_in_event_addr_get(ADS1292R_DRDY_PIN),
+                                          nrf_drv_spi_start_task_get(&m_spi));
+    if (err_code != NRF_SUCCESS) return -1;
+    err_code = nrf_drv_ppi_channel_fork_assign(m_ppi_drdy_start,
+                                               ptt_capture_task_addr(PTT_SOURCE_ECG));
+    if (err_code != NRF_SUCCESS) return -1;
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_end_count);
+    if (err_code != NRF_SUCCESS) return -1;
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_end_count,
+                                          nrf_drv_spi_end_event_get(&m_spi),
+                                          nrf_drv_timer_task_address_get(&m_sample_counter,
+                                                                         NRF_TIMER_TASK_COUNT));
+    if (err_code != NRF_SUCCESS) return -1;
+
+    err_code = app_timer_create(&m_capture_timeout_timer,
+                                APP_TIMER_MODE_SINGLE_SHOT,
+                                ads1292r_capture_timeout_handler);
+    if (err_code != NRF_SUCCESS) return -1;
+
+    err_code = app_timer_create(&m_wakeup_timer,
+                                APP_TIMER_MODE_SINGLE_SHOT,
+                                ads1292r_wakeup_timeout_handler);
+    if (err_code != NRF_SUCCESS) return -1;
+
+    return 0;
+}
+
+/**
+ * @brief Arm hardware capture. Device must already be in RDATAC mode.
+ */
+static void ads1292r_capture_start(uint32_t timeout_ms) {
+    m_blocks_pending = 0;
+    m_block_overruns = 0;
+    m_capture_timed_out = false;
+
+    nrf_drv_timer_clear(&m_sample_counter);
+    nrf_drv_timer_enable(&m_sample_counter);
+    ads1292r_dma_rewind();
+
+    // ADS1292R is alone on SPI1, so CS stays low for the whole capture
+    nrf_gpio_pin_clear(ADS1292R_CS_PIN);
+
+    nrf_drv_ppi_channel_enable(m_ppi_end_count);
+    nrf_drv_ppi_channel_enable(m_ppi_drdy_start);
+    nrf_drv_gpiote_in_event_enable(ADS1292R_DRDY_PIN, false);
+
+    // Streaming runs without a watchdog
+    if (timeout_ms > 0) {
+        app_timer_start(m_capture_timeout_timer, APP_TIMER_TICKS(timeout_ms), NULL);
+    }
+}
+
+/**
+ * @brief Disarm hardware capture
+ */
+static void ads1292r_capture_stop(void) {
+    app_timer_stop(m_capture_timeout_timer);
+
+    nrf_drv_gpiote_in_event_disable(ADS1292R_DRDY_PIN);
+    nrf_drv_ppi_channel_disable(m_ppi_drdy_start);
+    nrf_drv_ppi_channel_disable(m_ppi_end_count);
+    nrf_drv_timer_disable(&m_sample_counter);
+
     nrf_gpio_pin_set(ADS1292R_CS_PIN);
+
+    if (m_block_overruns > 0) {
+        TRACE_WARNING("ADS1292R DMA block overruns: %d", m_block_overruns);
+    }
+}
+
+/**
+ * @brief CH1 sample of one RDATAC frame; CH2 is not used
+ */
+static int32_t ads1292r_decode_frame(const uint8_t *data) {
+    // Convert 24-bit two's complement to 32-bit signed
+    return ((int32_t)(data[3] << 24) | (data[4] << 16) | (data[5] << 8)) >> 8;
+}
+
+/**
+ * @brief Append one measured sample to the history ring
+ * @note The decimated layout removes the baseline first, so the 16-bit
+ *       range holds the ECG rather than the electrode offset, and averages
+ *       sample pairs ahead of the decimation
+ */
+static void ads1292r_history_put(int32_t sample) {
+    uint8_t *p = &m_history[m_history_head * ADS1292R_HISTORY_SAMPLE_BYTES];
+    
+#if ADS1292R_ECG_FORMAT == ADS1292R_ECG_FORMAT_DECIMATED16
+    if (!m_history_primed) {
+        m_history_baseline_q4 = sample << 4;
+        m_history_acc = 0;
+        m_history_phase = 0;
+        m_history_primed = true;
+    }
+    m_history_baseline_q4 += ((sample << 4) - m_history_baseline_q4) >> ADS1292R_BASELINE_SHIFT;
+    m_history_acc += sample - (m_history_baseline_q4 >> 4);
+    if (++m_history_phase < ADS1292R_HISTORY_DECIMATION) {
+        return;
+    }
     
-    nrf_gpio_cfg_output(ADS1292R_START_PIN);
-    nrf_gpio_pin_clear(ADS1292R_START_PIN);
-    
-    nrf_gpio_cfg_output(ADS1292R_PWDN_PIN);
-    nrf_gpio_pin_set(ADS1292R_PWDN_PIN); // Power on
-    
-    nrf_gpio_cfg_input(ADS1292R_DRDY_PIN, NRF_GPIO_PIN_PULLUP);
+    int32_t value = (m_history_acc / ADS1292R_HISTORY_DECIMATION) >> ADS1292R_DECIMATED_SHIFT;
+    m_history_acc = 0;
+    m_history_phase = 0;
+    if (value > INT16_MAX) value = INT16_MAX;
+    if (value < INT16_MIN) value = INT16_MIN;
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+#else
+    p[0] = (uint8_t)sample;
+    p[1] = (uint8_t)(sample >> 8);
+    p[2] = (uint8_t)(sample >> 16);
+#endif
+    
+    m_history_head = (m_history_head + 1) % ADS1292R_HISTORY_SAMPLES;
+    if (m_history_count < ADS1292R_HISTORY_SAMPLES) {
+        m_history_count++;
+    }
+}
+
+/**
+ * @brief Capture is complete once enough beats are seen or the limit is hit
+ */
+static bool ads1292r_capture_complete(void) {
+    return (qrs_detector_beat_count() > ADS1292R_TARGET_RR) ||
+           (m_samples_captured >= ADS1292R_MAX_SAMPLES) ||
+           m_capture_timed_out;
+}
+
+/**
+ * @brief Decode a completed DMA block, feed CH1 to the QRS detector while
+ *        measuring and hand the block to the stream
+ */
+static void ads1292r_process_block(uint8_t block) {
+    int32_t ch1[ADS1292R_BLOCK_SAMPLES];
+    qrs_beat_t beat;
+    bool measuring = m_capture_active && !ads1292r_capture_complete();
+
+    if (measuring) {
+        ptt_clock_anchor(&m_clock, m_samples_captured + ADS1292R_BLOCK_SAMPLES - 1, m_block_time[block]);
+    }
+
+    for (uint16_t i = 0; i < ADS1292R_BLOCK_SAMPLES; i++) {
+        ch1[i] = ads1292r_decode_frame(m_dma_rx[block][i]);
+        if (!measuring) {
+            continue;
+        }
+        m_samples_captured++;
+
+        if (qrs_detector_process(ch1[i], &beat)) {
+            TRACE_DEBUG("QRS at sample %d, RR %d", beat.r_peak_sample, beat.rr_interval);
+            ptt_event(PTT_SOURCE_ECG, ptt_clock_time(&m_clock, beat.r_peak_sample));
+        }
+        ads1292r_history_put(ch1[i]);
+    }
+
+    if (m_streaming && m_stream_handler) {
+        m_stream_handler(ch1, ADS1292R_BLOCK_SAMPLES);
+    }
+}
+
+/**
+ * @brief Configure SPIM1 for register access and capture
+ */
+static int ads1292r_spi_enable(void) {
+    if (m_spi_enabled) {
+        return 0;
+    }
     
-    // Initialize SPI
     nrf_drv_spi_config_t spi_config = NRF_DRV_SPI_DEFAULT_CONFIG;
     spi_config.ss_pin   = NRF_DRV_SPI_PIN_NOT_USED;
     spi_config.miso_pin = 3;  // Adjust to your circuit
@@ -131,46 +486,122 @@ int ads1292r_init(void) {
     spi_config.sck_pin  = 5;  // Adjust to your circuit
     spi_config.frequency = NRF_DRV_SPI_FREQ_1M;
     spi_config.mode = NRF_DRV_SPI_MODE_1; // CPOL=0, CPHA=1
+    spi_config.orc = 0x00; // Clock out NOPs while reading RDATAC frames
     
-    err_code = nrf_drv_spi_init(&m_spi, &spi_config, NULL, NULL);
+    ret_code_t err_code = nrf_drv_spi_init(&m_spi, &spi_config, ads1292r_spi_evt_handler, NULL);
     if (err_code != NRF_SUCCESS) {
-        NRF_LOG_ERROR("SPI init failed: %d", err_code);
+        TRACE_ERROR("SPI init failed: %d", err_code);
         return -1;
     }
     
-    // Hardware reset
-    nrf_gpio_pin_clear(ADS1292R_PWDN_PIN);
-    nrf_delay_ms(100);
-    nrf_gpio_pin_set(ADS1292R_PWDN_PIN);
-    nrf_delay_ms(500); // Wait for power-up
-    
-    // Software reset
-    ads1292r_send_command(ADS1292R_CMD_RESET);
-    nrf_delay_ms(100);
-    
-    // Stop data conversion
-    ads1292r_send_command(ADS1292R_CMD_SDATAC);
-    nrf_delay_ms(10);
+    m_spi_enabled = true;
+    return 0;
+}
+
+/**
+ * @brief Release SPIM1 so it draws nothing between measurement cycles
+ */
+static void ads1292r_spi_disable(void) {
+    if (m_spi_enabled) {
+        nrf_drv_spi_uninit(&m_spi);
+        m_spi_enabled = false;
+    }
+}
+
+/**
+ * @brief Advance the init sequence by one step
+ * @return ms to wait before the next step, 0 once initialized, -1 on failure
+ * @note A warm reset leaves the device powered. If it answers with the ID
+ *       it had before, the power-down pulse and software reset (700 ms) are
+ *       skipped; the registers are written and read back either way.
+ */
+int32_t ads1292r_init_step(void) {
+    switch (m_init_state) {
+        case ADS1292R_INIT_START:
+            // Configure GPIO pins
+            nrf_gpio_cfg_output(ADS1292R_CS_PIN);
+            nrf_gpio_pin_set(ADS1292R_CS_PIN);
+            
+            nrf_gpio_cfg_output(ADS1292R_START_PIN);
+            nrf_gpio_pin_clear(ADS1292R_START_PIN);
+            
+            // Driven high before it becomes an output, a low glitch would
+            // power the device down
+            nrf_gpio_pin_set(ADS1292R_PWDN_PIN);
+            nrf_gpio_cfg_output(ADS1292R_PWDN_PIN);
+            
+            nrf_gpio_cfg_input(ADS1292R_DRDY_PIN, NRF_GPIO_PIN_PULLUP);
+            
+            // Initialize SPI
+            if (ads1292r_spi_enable() != 0) {
+                return -1;
+            }
+            
+            if (ads1292r_capture_init() != 0) {
+                NRF_LOG_ERROR("ADS1292R capture init failed");
+                return -1;
+            }
+            
+            qrs_detector_init();
+            
+            if (boot_warm()) {
+                // Out of standby and continuous mode, whichever it was left in
+                ads1292r_send_command(ADS1292R_CMD_WAKEUP);
+                ads1292r_send_command(ADS1292R_CMD_SDATAC);
+                if (boot_sensor_known(BOOT_SENSOR_ADS1292R, ads1292r_read_register(ADS1292R_REG_ID))) {
+                    NRF_LOG_INFO("ADS1292R configured before reset, reset skipped");
+                    m_init_state = ADS1292R_INIT_CONFIGURE;
+                    return ADS1292R_WAKEUP_MS;
+                }
+            }
+            boot_sensor_forget(BOOT_SENSOR_ADS1292R);
+            
+            // Hardware reset
+            nrf_gpio_pin_clear(ADS1292R_PWDN_PIN);
+            m_init_state = ADS1292R_INIT_POWER_UP;
+            return 100;
+            
+        case ADS1292R_INIT_POWER_UP:
+            nrf_gpio_pin_set(ADS1292R_PWDN_PIN);
+            m_init_state = ADS1292R_INIT_RESET;
+            return 500; // Wait for power-up
+            
+        case ADS1292R_INIT_RESET:
+            // Software reset
+            ads1292r_send_command(ADS1292R_CMD_RESET);
+            m_init_state = ADS1292R_INIT_SDATAC;
+            return 100;
+            
+        case ADS1292R_INIT_SDATAC:
+            // Stop data conversion
+            ads1292r_send_command(ADS1292R_CMD_SDATAC);
+            m_init_state = ADS1292R_INIT_CONFIGURE;
+            return 10;
+            
+        case ADS1292R_INIT_CONFIGURE:
+            break;
+    }
+    m_init_state = ADS1292R_INIT_START;
     
     // Read and verify device ID
     uint8_t device_id = ads1292r_read_register(ADS1292R_REG_ID);
     NRF_LOG_INFO("ADS1292R Device ID: 0x%02X", device_id);
     
-    // Configure registers
-    // CONFIG1: HR mode, 500 SPS
-    ads1292r_write_register(ADS1292R_REG_CONFIG1, 0x02);
-    
-    // CONFIG2: Test signals off, PDB_LOFF_COMP, PDB_REFBUF
-    ads1292r_write_register(ADS1292R_REG_CONFIG2, 0xA0);
-    
-    // CH1SET: Normal operation, Gain 6, channel enabled
-    ads1292r_write_register(ADS1292R_REG_CH1SET, 0x00);
-    
-    // CH2SET: Normal operation, Gain 6, channel enabled
-    ads1292r_write_register(ADS1292R_REG_CH2SET, 0x00);
-    
-    // RLD sensing
-    ads1292r_write_register(ADS1292R_REG_RLDSENS, 0x2C);
+    // Configure registers, then read them back before the configuration
+    // is trusted across a reset
+    bool verified = true;
+    for (uint8_t i = 0; i < sizeof(m_config) / sizeof(m_config[0]); i++) {
+        ads1292r_write_register(m_config[i][0], m_config[i][1]);
+    }
+    for (uint8_t i = 0; i < sizeof(m_config) / sizeof(m_config[0]); i++) {
+        verified = verified && (ads1292r_read_register(m_config[i][0]) == m_config[i][1]);
+    }
+    if (verified) {
+        boot_sensor_store(BOOT_SENSOR_ADS1292R, device_id);
+    } else {
+        NRF_LOG_ERROR("ADS1292R configuration readback mismatch");
+        boot_sensor_forget(BOOT_SENSOR_ADS1292R);
+    }
     
     // Start conversion
     nrf_gpio_pin_set(ADS1292R_START_PIN);
@@ -182,106 +613,78 @@ int ads1292r_init(void) {
 }
 
 /**
- * @brief Power on ADS1292R
+ * @brief Initialize ADS1292R (blocking)
  */
-void ads1292r_power_on(void) {
-    if (m_initialized) {
-        nrf_gpio_pin_set(ADS1292R_PWDN_PIN);
-        nrf_delay_ms(100);
-        ads1292r_send_command(ADS1292R_CMD_WAKEUP);
-        nrf_gpio_pin_set(ADS1292R_START_PIN);
-        nrf_delay_ms(10);
+int ads1292r_init(void) {
+    int32_t wait;
+    while ((wait = ads1292r_init_step()) > 0) {
+        nrf_delay_ms(wait);
     }
+    return (int)wait;
 }
 
 /**
- * @brief Power off ADS1292R
+ * @brief Power on ADS1292R (non-blocking)
+ * @param handler Called from ads1292r_process() once conversions are valid
+ * @return 0 if the wake-up was started
  */
-void ads1292r_power_off(void) {
-    if (m_initialized) {
-        nrf_gpio_pin_clear(ADS1292R_START_PIN);
-        ads1292r_send_command(ADS1292R_CMD_STANDBY);
-        nrf_delay_ms(10);
+int ads1292r_power_on(ads1292r_ready_handler_t handler) {
+    if (!m_initialized || ads1292r_spi_enable() != 0) {
+        return -1;
     }
-}
-
-/**
- * @brief Read ECG data from both channels
- */
-static void ads1292r_read_ecg_sample(int32_t *ch1, int32_t *ch2) {
-    uint8_t data[9]; // 3 status bytes + 3 bytes CH1 + 3 bytes CH2
     
-    // Wait for DRDY to go low
-    uint16_t timeout = 1000;
-    while (nrf_gpio_pin_read(ADS1292R_DRDY_PIN) && timeout--) {
-        nrf_delay_us(10);
+    m_ready_handler = handler;
+    m_ready_pending = false;
+    m_powered = true;
+    if (m_streaming) {
+        // Already converting; SPIM is owned by the capture
+        m_ready_pending = true;
+        return 0;
     }
     
-    if (timeout == 0) {
-        *ch1 = 0;
-        *ch2 = 0;
-        return;
-    }
+    // PWDN stays high across standby, so only the standby exit has to settle
+    nrf_gpio_pin_set(ADS1292R_PWDN_PIN);
+    ads1292r_send_command(ADS1292R_CMD_WAKEUP);
+    nrf_gpio_pin_set(ADS1292R_START_PIN);
     
-    // Read data
-    nrf_gpio_pin_clear(ADS1292R_CS_PIN);
-    uint8_t cmd = ADS1292R_CMD_RDATA;
-    nrf_drv_spi_transfer(&m_spi, &cmd, 1, data, 9);
-    nrf_gpio_pin_set(ADS1292R_CS_PIN);
+    if (app_timer_start(m_wakeup_timer, APP_TIMER_TICKS(ADS1292R_WAKEUP_MS), NULL) != NRF_SUCCESS) {
+        return -1;
+    }
     
-    // Convert 24-bit two's complement to 32-bit signed
-    *ch1 = ((int32_t)(data[3] << 24) | (data[4] << 16) | (data[5] << 8)) >> 8;
-    *ch2 = ((int32_t)(data[6] << 24) | (data[7] << 16) | (data[8] << 8)) >> 8;
+    return 0;
 }
 
 /**
- * @brief Calculate heart rate from ECG using R-peak detection
+ * @brief Stop conversions and release SPIM1
  */
-static uint16_t calculate_heart_rate_from_ecg(void) {
-    // Simple R-peak detection algorithm
-    // In production, use more sophisticated methods (Pan-Tompkins, etc.)
-    
-    const uint16_t sampling_rate = 500; // Hz
-    const int32_t threshold = 100000; // Adjust based on signal amplitude
-    
-    uint16_t peak_count = 0;
-    uint16_t last_peak_idx = 0;
-    uint16_t rr_intervals[10];
-    uint16_t rr_count = 0;
-    
-    // Find R-peaks
-    for (uint16_t i = 2; i < buffer_index - 2; i++) {
-        if (ecg_ch1_buffer[i] > threshold &&
-            ecg_ch1_buffer[i] > ecg_ch1_buffer[i-1] &&
-            ecg_ch1_buffer[i] > ecg_ch1_buffer[i+1] &&
-            (i - last_peak_idx) > 100) { // Refractory period
-            
-            if (last_peak_idx > 0 && rr_count < 10) {
-                rr_intervals[rr_count++] = i - last_peak_idx;
-            }
-            last_peak_idx = i;
-            peak_count++;
-        }
+static void ads1292r_standby(void) {
+    nrf_gpio_pin_clear(ADS1292R_START_PIN);
+    if (m_spi_enabled) {
+        ads1292r_send_command(ADS1292R_CMD_STANDBY);
     }
-    
-    // Calculate average RR interval
-    if (rr_count == 0) return 70; // Default
-    
-    uint32_t avg_rr = 0;
-    for (uint16_t i = 0; i < rr_count; i++) {
-        avg_rr += rr_intervals[i];
+    ads1292r_spi_disable();
+}
+
+/**
+ * @brief Power off ADS1292R
+ * @note A running stream keeps the device converting until
+ *       ads1292r_stream_stop()
+ */
+void ads1292r_power_off(void) {
+    if (m_initialized) {
+        app_timer_stop(m_wakeup_timer);
+        m_ready_pending = false;
+        m_powered = false;
+        if (!m_streaming) {
+            ads1292r_standby();
+        }
     }
-    avg_rr /= rr_count;
-    
-    // Convert to BPM
-    uint16_t heart_rate = (60 * sampling_rate) / avg_rr;
-    
-    return heart_rate;
 }
 
 /**
  * @brief Estimate blood pressure from ECG
- * @note This is a simplified estimation. Real BP requires calibration and PPG signals
+ * @note This is a simplified estimation, used when no pulse transit time
+ *       could be measured. See ptt_get_bp().
  */
 static void estimate_blood_pressure(uint16_t heart_rate, uint16_t *systolic, uint16_t *diastolic) {
     // Simplified BP estimation based on heart rate and PTT (Pulse Transit Time)
@@ -295,62 +698,260 @@ static void estimate_blood_pressure(uint16_t heart_rate, uint16_t *systolic, uin
     // MAP (Mean Arterial Pressure) ≈ CO × SVR
     // Where CO = Cardiac Output, SVR = Systemic Vascular Resistance
     
-    float base_systolic = 120.0;
-    float base_diastolic = 80.0;
+    int32_t base_systolic = 120;
+    int32_t base_diastolic = 80;
     
-    // Adjust based on heart rate deviation from normal (70 bpm)
-    float hr_factor = (heart_rate - 70.0) / 70.0;
-    
-    *systolic = (uint16_t)(base_systolic + (hr_factor * 20.0));
-    *diastolic = (uint16_t)(base_diastolic + (hr_factor * 10.0));
+    // Adjust based on heart rate deviation from normal (70 bpm):
+    // +20 mmHg systolic and +10 mmHg diastolic per 100% deviation
+    int32_t hr_delta = (int32_t)heart_rate - 70;
+    int32_t sys = base_systolic + (hr_delta * 20) / 70;
+    int32_t dia = base_diastolic + (hr_delta * 10) / 70;
     
     // Clamp to reasonable ranges
-    if (*systolic < 90) *systolic = 90;
-    if (*systolic > 180) *systolic = 180;
-    if (*diastolic < 60) *diastolic = 60;
-    if (*diastolic > 110) *diastolic = 110;
+    if (sys < 90) sys = 90;
+    if (sys > 180) sys = 180;
+    if (dia < 60) dia = 60;
+    if (dia > 110) dia = 110;
+    
+    *systolic = (uint16_t)sys;
+    *diastolic = (uint16_t)dia;
 }
 
 /**
- * @brief Read ECG and estimate blood pressure
+ * @brief Finish the capture and derive HR/BP from the detected beats
  */
-void ads1292r_read_ecg_and_bp(uint16_t *bp_systolic, uint16_t *bp_diastolic) {
-    if (!m_initialized) {
-        *bp_systolic = 120;
-        *bp_diastolic = 80;
+static void ads1292r_finish_capture(void) {
+    if (m_streaming) {
+        app_timer_stop(m_capture_timeout_timer);
+    } else {
+        ads1292r_capture_stop();
+        
+        // Stop continuous conversion
+        ads1292r_send_command(ADS1292R_CMD_SDATAC);
+    }
+    m_capture_active = false;
+    ptt_release(PTT_SOURCE_ECG);
+    
+    if (m_capture_timed_out) {
+        TRACE_WARNING("ECG capture timed out after %d samples", m_samples_captured);
+    }
+    
+    // Heart rate from detected RR intervals
+    uint16_t hr_from_ecg = qrs_detector_heart_rate();
+    if (hr_from_ecg == 0) {
+        TRACE_WARNING("No QRS complexes detected in %d samples", m_samples_captured);
+        m_result = -1;
         return;
     }
     
-    // Start continuous conversion
-    ads1292r_send_command(ADS1292R_CMD_RDATAC);
-    nrf_delay_ms(10);
+    // Estimate blood pressure
+    estimate_blood_pressure(hr_from_ecg, &m_bp_systolic, &m_bp_diastolic);
+    m_result = 0;
     
-    // Collect ECG samples (2 seconds of data at 500 SPS)
-    buffer_index = 0;
-    for (uint16_t i = 0; i < 500 && i < sizeof(ecg_ch1_buffer)/sizeof(ecg_ch1_buffer[0]); i++) {
-        ads1292r_read_ecg_sample(&ecg_ch1_buffer[i], &ecg_ch2_buffer[i]);
-        buffer_index++;
-        nrf_delay_us(2000); // 500 Hz = 2ms period
+    TRACE_INFO("ECG-derived HR: %d BPM (%d beats, %d ms)", hr_from_ecg,
+               qrs_detector_beat_count(),
+               (m_samples_captured * 1000) / ADS1292R_SAMPLE_RATE_HZ);
+    TRACE_INFO("Estimated BP: %d/%d mmHg", m_bp_systolic, m_bp_diastolic);
+}
+
+/**
+ * @brief Start a non-blocking ECG capture
+ * @param handler Called from ads1292r_process() once the result is ready
+ * @return 0 if the capture was started
+ */
+int ads1292r_start_ecg(ads1292r_done_handler_t handler) {
+    if (!m_initialized || m_capture_active) {
+        return -1;
     }
     
-    // Stop continuous conversion
-    ads1292r_send_command(ADS1292R_CMD_SDATAC);
+    // Collect ECG samples at 500 SPS until enough beats are seen. DRDY drives
+    // the transfers in hardware; the CPU only wakes once per completed block.
+    uint32_t timeout_ms = (ADS1292R_MAX_SAMPLES * 1000) / ADS1292R_SAMPLE_RATE_HZ +
+                          ADS1292R_CAPTURE_MARGIN_MS;
+    m_samples_captured = 0;
+    m_history_primed = false;
+    m_result = -1;
+    m_done_handler = handler;
+    qrs_detector_restart();
+    ptt_clock_reset(&m_clock, ADS1292R_SAMPLE_PERIOD_US);
+    ptt_acquire(PTT_SOURCE_ECG);
+    
+    if (m_streaming) {
+        // Measure on the samples the stream is already capturing
+        m_capture_timed_out = false;
+        app_timer_start(m_capture_timeout_timer, APP_TIMER_TICKS(timeout_ms), NULL);
+    } else {
+        // Start continuous conversion
+        // No settling delay needed: the capture is paced by DRDY
+        ads1292r_send_command(ADS1292R_CMD_RDATAC);
+        m_next_block = 0;
+        ads1292r_capture_start(timeout_ms);
+    }
+    m_capture_active = true;
     
-    // Calculate heart rate from ECG
-    uint16_t hr_from_ecg = calculate_heart_rate_from_ecg();
+    return 0;
+}
+
+/**
+ * @brief Cut a running capture short
+ * @note Ends as on a timeout: the next ads1292r_process() stops the capture
+ *       and reports a result from the beats seen so far
+ */
+void ads1292r_abort(void) {
+    if (m_capture_active) {
+        m_capture_timed_out = true;
+    }
+}
+
+/**
+ * @brief Report readiness and consume completed DMA blocks; call from the main loop on wakeup
+ */
+void ads1292r_process(void) {
+    if (m_ready_pending) {
+        m_ready_pending = false;
+        if (m_ready_handler) {
+            m_ready_handler();
+        }
+    }
     
-    // Estimate blood pressure
-    estimate_blood_pressure(hr_from_ecg, bp_systolic, bp_diastolic);
+    if (!m_capture_active && !m_streaming) {
+        return;
+    }
     
-    NRF_LOG_INFO("ECG-derived HR: %d BPM", hr_from_ecg);
-    NRF_LOG_INFO("Estimated BP: %d/%d mmHg", *bp_systolic, *bp_diastolic);
+    // The stream consumes every block; a measurement alone stops at completion
+    while ((m_blocks_pending & (1 << m_next_block)) &&
+           (m_streaming || !ads1292r_capture_complete())) {
+        ads1292r_process_block(m_next_block);
+        CRITICAL_REGION_ENTER();
+        m_blocks_pending &= ~(1 << m_next_block);
+        CRITICAL_REGION_EXIT();
+        m_next_block ^= 1;
+    }
+    
+    if (m_capture_active && ads1292r_capture_complete()) {
+        ads1292r_finish_capture();
+        if (m_done_handler) {
+            m_done_handler();
+        }
+    }
 }
 
 /**
- * @brief Get raw ECG data for further analysis
+ * @brief Blood pressure from the last completed capture
+ * @return 0 if valid, -1 if no RR interval could be measured
  */
-void ads1292r_get_raw_ecg(int32_t *ch1_buffer, int32_t *ch2_buffer, uint16_t *length) {
-    memcpy(ch1_buffer, ecg_ch1_buffer, buffer_index * sizeof(int32_t));
-    memcpy(ch2_buffer, ecg_ch2_buffer, buffer_index * sizeof(int32_t));
-    *length = buffer_index;
+int ads1292r_get_bp(uint16_t *bp_systolic, uint16_t *bp_diastolic) {
+    *bp_systolic = m_bp_systolic;
+    *bp_diastolic = m_bp_diastolic;
+    return m_result;
+}
+
+/**
+ * @brief Read ECG and estimate blood pressure (blocking)
+ * @return 0 on success, -1 if no RR interval could be measured
+ */
+int ads1292r_read_ecg_and_bp(uint16_t *bp_systolic, uint16_t *bp_diastolic) {
+    if (ads1292r_start_ecg(NULL) != 0) {
+        *bp_systolic = 120;
+        *bp_diastolic = 80;
+        return -1;
+    }
+    
+    while (m_capture_active) {
+        ads1292r_process();
+        if (m_capture_active) {
+            __WFE();
+        }
+    }
+    
+    return ads1292r_get_bp(bp_systolic, bp_diastolic);
+}
+
+/**
+ * @brief View the ECG history in place, oldest sample first
+ * @note Valid until the next ads1292r_process(); call from thread context
+ */
+void ads1292r_get_ecg_view(ads1292r_ecg_view_t *view) {
+    uint16_t oldest = (m_history_head + ADS1292R_HISTORY_SAMPLES - m_history_count) % ADS1292R_HISTORY_SAMPLES;
+    uint16_t first = ADS1292R_HISTORY_SAMPLES - oldest;
+    
+    view->segment[0] = &m_history[oldest * ADS1292R_HISTORY_SAMPLE_BYTES];
+    view->count[0] = (m_history_count < first) ? m_history_count : first;
+    view->segment[1] = m_history;
+    view->count[1] = m_history_count - view->count[0];
+    view->rate_hz = ADS1292R_SAMPLE_RATE_HZ / ADS1292R_HISTORY_DECIMATION;
+    view->format = ADS1292R_ECG_FORMAT;
+}
+
+/**
+ * @brief Sample of a view, 0 being the oldest
+ */
+int32_t ads1292r_ecg_view_sample(ads1292r_ecg_view_t const *view, uint16_t index) {
+    uint8_t seg = (index >= view->count[0]) ? 1 : 0;
+    if (seg) {
+        index -= view->count[0];
+    }
+    if (view->format == ADS1292R_ECG_FORMAT_DECIMATED16) {
+        uint8_t const *p = &view->segment[seg][index * 2];
+        return (int16_t)(p[0] | (p[1] << 8));
+    }
+    uint8_t const *p = &view->segment[seg][index * 3];
+    return ((int32_t)(p[2] << 24) | (p[1] << 16) | (p[0] << 8)) >> 8;
+}
+
+/**
+ * @brief Start continuous CH1 streaming
+ * @param handler Called from ads1292r_process() with every 100 ms block
+ * @return 0 if streaming, -1 if the device is unavailable
+ * @note The device stays converting across ads1292r_power_off(); measurement
+ *       captures run on the streamed samples meanwhile
+ */
+int ads1292r_stream_start(ads1292r_stream_handler_t handler) {
+    if (!m_initialized) {
+        return -1;
+    }
+    
+    m_stream_handler = handler;
+    if (m_streaming) {
+        return 0;
+    }
+    
+    if (!m_capture_active) {
+        if (ads1292r_spi_enable() != 0) {
+            return -1;
+        }
+        if (!m_powered) {
+            // Standby exit settles within the first block
+            nrf_gpio_pin_set(ADS1292R_PWDN_PIN);
+            ads1292r_send_command(ADS1292R_CMD_WAKEUP);
+            nrf_gpio_pin_set(ADS1292R_START_PIN);
+        }
+        ads1292r_send_command(ADS1292R_CMD_RDATAC);
+        m_next_block = 0;
+        ads1292r_capture_start(0);
+    }
+    
+    m_streaming = true;
+    TRACE_INFO("ADS1292R streaming started");
+    return 0;
+}
+
+/**
+ * @brief Stop streaming; the device returns to standby unless it is in use
+ */
+void ads1292r_stream_stop(void) {
+    if (!m_streaming) {
+        return;
+    }
+    
+    m_streaming = false;
+    m_stream_handler = NULL;
+    if (!m_capture_active) {
+        ads1292r_capture_stop();
+        ads1292r_send_command(ADS1292R_CMD_SDATAC);
+        if (!m_powered) {
+            ads1292r_standby();
+        }
+    }
+    TRACE_INFO("ADS1292R streaming stopped");
 }
\ No newline at end of file
@@ -3,10 +3,43 @@
 
 #include <stdint.h>
 
+// ECG history layout, override with -DADS1292R_ECG_FORMAT=<format>
+#define ADS1292R_ECG_FORMAT_PACKED24    0   // Raw CH1 at 500 SPS, 3 bytes per sample
+#define ADS1292R_ECG_FORMAT_DECIMATED16 1   // Baseline removed, 250 SPS, counts / 4 in 2 bytes
+
+#ifndef ADS1292R_ECG_FORMAT
+#define ADS1292R_ECG_FORMAT     ADS1292R_ECG_FORMAT_PACKED24
+#endif
+
+// CH2 is not used by the firmware; -DADS1292R_CH2_ENABLE=1 keeps it converting
+#ifndef ADS1292R_CH2_ENABLE
+#define ADS1292R_CH2_ENABLE     0
+#endif
+
+// Read-only view of the ECG history ring, oldest sample first
+typedef struct {
+    uint8_t const *segment[2];  // The second is empty unless the ring wrapped
+    uint16_t       count[2];    // Samples in each segment
+    uint16_t       rate_hz;
+    uint8_t        format;      // ADS1292R_ECG_FORMAT_*
+} ads1292r_ecg_view_t;
+
+typedef void (*ads1292r_ready_handler_t)(void);
+typedef void (*ads1292r_done_handler_t)(void);
+typedef void (*ads1292r_stream_handler_t)(int32_t const *samples, uint16_t count);
+
 int ads1292r_init(void);
-void ads1292r_power_on(void);
+int32_t ads1292r_init_step(void);
+int ads1292r_power_on(ads1292r_ready_handler_t handler);
 void ads1292r_power_off(void);
-void ads1292r_read_ecg_and_bp(uint16_t *bp_systolic, uint16_t *bp_diastolic);
-void ads1292r_get_raw_ecg(int32_t *ch1_buffer, int32_t *ch2_buffer, uint16_t *length);
+int ads1292r_start_ecg(ads1292r_done_handler_t handler);
+void ads1292r_abort(void);
+void ads1292r_process(void);
+int ads1292r_get_bp(uint16_t *bp_systolic, uint16_t *bp_diastolic);
+int ads1292r_read_ecg_and_bp(uint16_t *bp_systolic, uint16_t *bp_diastolic);
+void ads1292r_get_ecg_view(ads1292r_ecg_view_t *view);
+int32_t ads1292r_ecg_view_sample(ads1292r_ecg_view_t const *view, uint16_t index);
+int ads1292r_stream_start(ads1292r_stream_handler_t handler);
+void ads1292r_stream_stop(void);
 
 #endif
\ No newline at end of file
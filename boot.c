@@ -0,0 +1,197 @@
+/**
+ * @file boot.c
+ * @brief Reset classification, retained sensor state and overlapped init
+ * @description A watchdog, lockup, soft or pin reset only resets the MCU:
+ *              the sensors stay powered and keep their registers. A
+ *              power-on or brownout reset (RESETREAS reads 0) may have taken
+ *              them down too. The device ID of each sensor whose
+ *              configuration was validated is kept in a record that the
+ *              startup code leaves alone, so after a warm reset a driver
+ *              whose sensor still answers with the same ID skips its reset
+ *              sequence. The linker script must not zero the section:
+ *
+ *                  .noinit (NOLOAD) : { KEEP(*(.noinit)) } > RAM
+ *
+ *              Driver init is split into boot_step_t steps; boot_run()
+ *              interleaves them so that the reset waits on the TWI bus and
+ *              both SPI buses overlap instead of adding up.
+ *
+ *              boot_init() reads POWER directly, so it runs before the
+ *              SoftDevice is enabled.
+ */
+
+#include "boot.h"
+#include "nrf.h"
+#include "nrf_delay.h"
+#include "crc16.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_BOOT
+#include "trace.h"
+#include <stddef.h>
+#include <string.h>
+
+#define BOOT_RETAINED_MAGIC     0x424F4F54      // "BOOT"
+#define BOOT_WARM_RESETS        (POWER_RESETREAS_RESETPIN_Msk | POWER_RESETREAS_DOG_Msk | \
+                                 POWER_RESETREAS_SREQ_Msk | POWER_RESETREAS_LOCKUP_Msk)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t device_id[BOOT_SENSOR_COUNT];
+    uint8_t  valid;                     // One bit per boot_sensor_t
+    uint8_t  warm_resets;               // In a row, without a completed cycle in between
+    uint16_t crc;                       // Over everything above
+} boot_retained_t;
+
+static boot_retained_t m_retained __attribute__((section(".noinit")));
+static uint32_t m_reset_reason = 0;
+static bool m_warm = false;
+
+static uint16_t boot_retained_crc(void) {
+    return crc16_compute((uint8_t const *)&m_retained, offsetof(boot_retained_t, crc), NULL);
+}
+
+static void boot_retained_seal(void) {
+    m_retained.crc = boot_retained_crc();
+}
+
+/**
+ * @brief Classify the reset and validate the retained record
+ * @note A warm reset loop falls back to a full init after BOOT_WARM_LIMIT
+ *       resets, in case a sensor left in a bad state is what trips the
+ *       watchdog. boot_cycle_done() ends the loop once the firmware has
+ *       completed a monitoring cycle.
+ */
+void boot_init(void) {
+    m_reset_reason = NRF_POWER->RESETREAS;
+    NRF_POWER->RESETREAS = m_reset_reason;      // Write 1 to clear
+    
+    bool intact = (m_retained.magic == BOOT_RETAINED_MAGIC) && (m_retained.crc == boot_retained_crc());
+    m_warm = intact && (m_reset_reason & BOOT_WARM_RESETS) != 0 &&
+             m_retained.warm_resets < BOOT_WARM_LIMIT;
+    
+    if (m_warm) {
+        m_retained.warm_resets++;
+    } else {
+        memset(&m_retained, 0, sizeof(m_retained));
+        m_retained.magic = BOOT_RETAINED_MAGIC;
+    }
+    boot_retained_seal();
+    
+    TRACE_INFO("%s boot, reset reason 0x%x, %d warm resets", m_warm ? "Warm" : "Cold",
+               m_reset_reason, m_retained.warm_resets);
+}
+
+/**
+ * @brief Sensors kept their configuration through the last reset
+ */
+bool boot_warm(void) {
+    return m_warm;
+}
+
+/**
+ * @brief RESETREAS as read by boot_init()
+ */
+uint32_t boot_reset_reason(void) {
+    return m_reset_reason;
+}
+
+/**
+ * @brief Sensor was validated before a warm reset and still has the same ID
+ */
+bool boot_sensor_known(boot_sensor_t sensor, uint16_t device_id) {
+    return m_warm && sensor < BOOT_SENSOR_COUNT &&
+           (m_retained.valid & (1 << sensor)) != 0 &&
+           m_retained.device_id[sensor] == device_id;
+}
+
+/**
+ * @brief Record a sensor whose configuration was written and read back
+ */
+void boot_sensor_store(boot_sensor_t sensor, uint16_t device_id) {
+    if (sensor >= BOOT_SENSOR_COUNT) {
+        return;
+    }
+    m_retained.device_id[sensor] = device_id;
+    m_retained.valid |= (uint8_t)(1 << sensor);
+    boot_retained_seal();
+}
+
+/**
+ * @brief Require a full init of a sensor after the next reset
+ */
+void boot_sensor_forget(boot_sensor_t sensor) {
+    if (sensor >= BOOT_SENSOR_COUNT) {
+        return;
+    }
+    m_retained.valid &= (uint8_t)~(1 << sensor);
+    boot_retained_seal();
+}
+
+/**
+ * @brief A monitoring cycle completed since the reset
+ * @note Clears the warm reset count, so an occasional reset long after
+ *       the last one is not taken for a reset loop
+ */
+void boot_cycle_done(void) {
+    if (m_retained.warm_resets != 0) {
+        m_retained.warm_resets = 0;
+        boot_retained_seal();
+    }
+}
+
+/**
+ * @brief Run driver init steps side by side until all have finished
+ * @param steps Step function of each driver
+ * @param results 0 or -1 per driver
+ * @param count Number of drivers, at most BOOT_MAX_STEPS
+ * @param serial_ms Total of all waits, the time the drivers would take one
+ *        after another (may be NULL)
+ * @return Time spent waiting (ms)
+ * @note Step execution time is not counted against the waits, so every
+ *       wait lasts at least as long as its driver asked for.
+ */
+uint32_t boot_run(boot_step_t const *steps, int32_t *results, uint8_t count, uint32_t *serial_ms) {
+    uint32_t due[BOOT_MAX_STEPS];
+    uint8_t running = 0;
+    uint32_t now = 0;
+    uint32_t serial = 0;
+    
+    if (count > BOOT_MAX_STEPS) {
+        count = BOOT_MAX_STEPS;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        due[i] = 0;
+        running |= (uint8_t)(1 << i);
+    }
+    
+    while (running) {
+        uint32_t next = UINT32_MAX;
+        for (uint8_t i = 0; i < count; i++) {
+            if (!(running & (1 << i))) {
+                continue;
+            }
+            if (due[i] <= now) {
+                int32_t wait = steps[i]();
+                if (wait <= 0) {
+                    results[i] = wait;
+                    running &= (uint8_t)~(1 << i);
+                    continue;
+                }
+                due[i] = now + (uint32_t)wait;
+                serial += (uint32_t)wait;
+            }
+            if (due[i] < next) {
+                next = due[i];
+            }
+        }
+        
+        if (running && next > now) {
+            nrf_delay_ms(next - now);
+            now = next;
+        }
+    }
+    
+    if (serial_ms != NULL) {
+        *serial_ms = serial;
+    }
+    return now;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sensors whose reset sequence is skipped after a warm reset
+typedef enum {
+    BOOT_SENSOR_MAX30102,
+    BOOT_SENSOR_ADS1292R,
+    BOOT_SENSOR_ICM42688,
+    BOOT_SENSOR_COUNT
+} boot_sensor_t;
+
+// One step of a driver init: ms to wait before the next step, 0 once the
+// driver is initialized, -1 on failure
+typedef int32_t (*boot_step_t)(void);
+
+#define BOOT_MAX_STEPS          BOOT_SENSOR_COUNT
+#define BOOT_WARM_LIMIT         3       // Warm resets in a row before a full init; any completed cycle ends the run
+
+void boot_init(void);
+bool boot_warm(void);
+uint32_t boot_reset_reason(void);
+bool boot_sensor_known(boot_sensor_t sensor, uint16_t device_id);
+void boot_sensor_store(boot_sensor_t sensor, uint16_t device_id);
+void boot_sensor_forget(boot_sensor_t sensor);
+void boot_cycle_done(void);
+uint32_t boot_run(boot_step_t const *steps, int32_t *results, uint8_t count, uint32_t *serial_ms);
+
+#endif
\ No newline at end of file
@@ -1,48 +1,585 @@
 /**
  * @file communication.c
  * @brief Communication module for LoRa/BLE gateway transmission
+ * @description Frames are copied into a fixed pool and sent in the
+ *              background, emergency class first. The main loop only
+ *              queues and returns; communication_process() advances the
+ *              queue on radio and backoff timer events.
+ *
+ *              transport.c picks the links for each attempt: routine frames
+ *              go out on one, emergency frames on all of them, and the
+ *              first ACK stops the rest. Every attempt that ran to an ACK
+ *              or a timeout is reported back so the choice follows the
+ *              links as the miner moves.
+ *
+ *              Alerts have a slot of their own, go ahead of everything,
+ *              including emergency frames already on air, and are timed
+ *              from the event behind them to the moment they are on air.
  */
 
 #include "communication.h"
-#include "nrf_log.h"
-#include "nrf_delay.h"
+#include "transport.h"
+#include "app_timer.h"
+#include "nrf_drv_clock.h"
+#include "profiler.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_COMM
+#include "trace.h"
+#include <string.h>
+
+#define COMM_RETRY_BASE_MS      500   // Backoff doubles after every failed attempt
+#define COMM_MAX_ATTEMPTS       4
+#define COMM_TX_SLOTS           (COMM_TX_QUEUE_SIZE + 1)
+#define COMM_ALERT_SLOT         COMM_TX_QUEUE_SIZE  // Only ever used by alerts
+
+typedef enum {
+    COMM_PRIO_EMERGENCY,
+    COMM_PRIO_ROUTINE,
+    COMM_PRIO_COUNT
+} comm_priority_t;
+
+typedef enum {
+    COMM_STATE_IDLE,
+    COMM_STATE_ON_AIR,
+    COMM_STATE_BACKOFF
+} comm_state_t;
+
+typedef struct {
+    uint8_t  data[COMM_MAX_FRAME_SIZE];
+    uint16_t length;
+    communication_tx_handler_t handler;
+    void     *p_context;
+    uint8_t  attempts;
+    bool     in_use;
+    bool     alert;
+    uint32_t event_ticks;               // Alerts: RTC ticks of the event behind them
+    uint8_t  links;                     // TRANSPORT_LINK_MASK() bits the frame may use
+} comm_frame_t;
+
+// FIFO of frame pool indices, one per priority class
+typedef struct {
+    uint8_t idx[COMM_TX_SLOTS];
+    uint8_t head;
+    uint8_t count;
+} comm_fifo_t;
 
 static bool m_comm_initialized = false;
 
+static comm_frame_t m_frames[COMM_TX_SLOTS];
+static comm_alert_stats_t m_alert_stats;
+static comm_fifo_t m_fifo[COMM_PRIO_COUNT];
+
+APP_TIMER_DEF(m_comm_timer);
+static volatile bool m_timer_expired = false;
+static comm_state_t m_state = COMM_STATE_IDLE;
+static uint8_t m_active;                // Frame on air (COMM_STATE_ON_AIR)
+static comm_priority_t m_active_prio;
+static bool m_radio_on = false;         // Profiled while any link is on air
+static bool m_hfclk_on = false;         // BLE needs the crystal, the LoRa radio has its own
+
+// One attempt per link, all for the active frame
+typedef struct {
+    uint32_t start_ticks;
+    bool     ack_expected;              // Simulated back-end: ACK when the timer fires
+} comm_link_attempt_t;
+
+static char const * const m_link_names[TRANSPORT_LINK_COUNT] = { "BLE", "LoRa" };
+
+APP_TIMER_DEF(m_ble_timer);
+APP_TIMER_DEF(m_lora_timer);
+static app_timer_id_t m_link_timer[TRANSPORT_LINK_COUNT];
+static volatile bool m_link_expired[TRANSPORT_LINK_COUNT];
+static comm_link_attempt_t m_link_attempt[TRANSPORT_LINK_COUNT];
+static uint8_t m_links_on_air;          // TRANSPORT_LINK_MASK() bits
+
+/**
+ * @brief Airtime or backoff elapsed
+ */
+static void comm_timer_handler(void *p_context) {
+    m_timer_expired = true;
+}
+
+/**
+ * @brief ACK or ACK timeout on one link
+ */
+static void comm_link_timer_handler(void *p_context) {
+    m_link_expired[(uintptr_t)p_context] = true;
+}
+
+static void comm_fifo_push_back(comm_priority_t prio, uint8_t idx) {
+    comm_fifo_t *q = &m_fifo[prio];
+    q->idx[(q->head + q->count) % COMM_TX_SLOTS] = idx;
+    q->count++;
+}
+
+static void comm_fifo_push_front(comm_priority_t prio, uint8_t idx) {
+    comm_fifo_t *q = &m_fifo[prio];
+    q->head = (q->head + COMM_TX_SLOTS - 1) % COMM_TX_SLOTS;
+    q->idx[q->head] = idx;
+    q->count++;
+}
+
+static uint8_t comm_fifo_pop_front(comm_priority_t prio) {
+    comm_fifo_t *q = &m_fifo[prio];
+    uint8_t idx = q->idx[q->head];
+    q->head = (q->head + 1) % COMM_TX_SLOTS;
+    q->count--;
+    return idx;
+}
+
+static uint8_t comm_fifo_pop_back(comm_priority_t prio) {
+    comm_fifo_t *q = &m_fifo[prio];
+    q->count--;
+    return q->idx[(q->head + q->count) % COMM_TX_SLOTS];
+}
+
+/**
+ * @brief Release a frame and report the outcome to its owner
+ */
+static void comm_frame_complete(uint8_t idx, bool success) {
+    comm_frame_t *frame = &m_frames[idx];
+    communication_tx_handler_t handler = frame->handler;
+    void *p_context = frame->p_context;
+
+    frame->in_use = false;
+    frame->alert = false;
+    if (handler) {
+        handler(success, p_context);
+    }
+}
+
+/**
+ * @brief Put a frame on one link
+ * @note Until the radio back-ends land the gateway is simulated: it ACKs
+ *       at the end of the airtime if that is within the ACK timeout. A
+ *       real back-end arms the timer with the timeout alone and reports an
+ *       earlier ACK through comm_link_done().
+ */
+static bool comm_link_start(transport_link_t link, comm_frame_t const *frame) {
+    comm_link_attempt_t *attempt = &m_link_attempt[link];
+    uint32_t airtime_ms = (transport_airtime_us(link, frame->length) + 999) / 1000;
+    uint32_t timeout_ms = transport_ack_timeout_ms(link, frame->length);
+
+    attempt->ack_expected = (airtime_ms <= timeout_ms);
+    attempt->start_ticks = app_timer_cnt_get();
+    m_link_expired[link] = false;
+
+    uint32_t wait_ms = attempt->ack_expected ? airtime_ms : timeout_ms;
+    return app_timer_start(m_link_timer[link], APP_TIMER_TICKS(wait_ms),
+                           (void *)(uintptr_t)link) == NRF_SUCCESS;
+}
+
+/**
+ * @brief Stop the links still on air without reporting them
+ */
+static void comm_links_cancel(void) {
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        if (m_links_on_air & TRANSPORT_LINK_MASK(i)) {
+            app_timer_stop(m_link_timer[i]);
+            m_link_expired[i] = false;
+        }
+    }
+    m_links_on_air = 0;
+}
+
+/**
+ * @brief Hand a frame to the links transport.c picks for it
+ * @return true if it went out on at least one
+ */
+static bool comm_radio_start(comm_frame_t const *frame, comm_priority_t prio) {
+    uint8_t links = transport_select(frame->length, prio == COMM_PRIO_EMERGENCY) & frame->links;
+
+    // A frame kept off the selected link still tries its own; the attempt
+    // is reported like any other, so it probes the link as well
+    if (links == 0) {
+        links = frame->links;
+    }
+
+    if (prio == COMM_PRIO_EMERGENCY) {
+        TRACE_ERROR("!!! EMERGENCY TRANSMISSION !!!");
+    } else {
+        TRACE_INFO("Standard data transmission");
+    }
+
+    m_links_on_air = 0;
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        if (!(links & TRANSPORT_LINK_MASK(i))) {
+            continue;
+        }
+        if (comm_link_start((transport_link_t)i, frame)) {
+            m_links_on_air |= TRANSPORT_LINK_MASK(i);
+            TRACE_INFO("Transmitting %d bytes over %s", frame->length, m_link_names[i]);
+        } else {
+            TRACE_WARNING("%s busy", m_link_names[i]);
+        }
+    }
+    TRACE_HEXDUMP_INFO(frame->data, frame->length);
+
+    return m_links_on_air != 0;
+}
+
+/**
+ * @brief Put the active frame back for a retry, or give up on it
+ */
+static void comm_tx_failed(void) {
+    comm_frame_t *frame = &m_frames[m_active];
+
+    if (frame->attempts >= COMM_MAX_ATTEMPTS) {
+        TRACE_ERROR("Transmission failed after %d attempts", frame->attempts);
+        m_state = COMM_STATE_IDLE;
+        comm_frame_complete(m_active, false);
+        return;
+    }
+
+    uint32_t backoff_ms = COMM_RETRY_BASE_MS << (frame->attempts - 1);
+    TRACE_WARNING("Transmission failed, retry in %d ms", backoff_ms);
+
+    comm_fifo_push_front(m_active_prio, m_active);
+    m_state = COMM_STATE_BACKOFF;
+    if (app_timer_start(m_comm_timer, APP_TIMER_TICKS(backoff_ms), NULL) != NRF_SUCCESS) {
+        m_state = COMM_STATE_IDLE;
+    }
+}
+
+/**
+ * @brief Hold HFXO only while a frame is on air, not across backoff
+ */
+static void comm_radio_power_update(void) {
+    bool on_air = (m_state == COMM_STATE_ON_AIR);
+    bool hfclk = on_air && (m_links_on_air & TRANSPORT_LINK_MASK(TRANSPORT_LINK_BLE));
+
+    if (hfclk && !m_hfclk_on) {
+        nrf_drv_clock_hfclk_request(NULL);
+        m_hfclk_on = true;
+    } else if (!hfclk && m_hfclk_on) {
+        nrf_drv_clock_hfclk_release();
+        m_hfclk_on = false;
+    }
+
+    if (on_air && !m_radio_on) {
+        profiler_begin(PROFILER_OP_RADIO);
+        m_radio_on = true;
+    } else if (!on_air && m_radio_on) {
+        profiler_end(PROFILER_OP_RADIO);
+        m_radio_on = false;
+    }
+}
+
+/**
+ * @brief One link got its ACK or gave up waiting for it
+ * @param rssi_dbm RSSI of the ACK or TRANSPORT_SIGNAL_UNKNOWN
+ * @param snr_db SNR of the ACK or TRANSPORT_SIGNAL_UNKNOWN
+ */
+static void comm_link_done(transport_link_t link, bool acked, int8_t rssi_dbm, int8_t snr_db) {
+    if (m_state != COMM_STATE_ON_AIR || !(m_links_on_air & TRANSPORT_LINK_MASK(link))) {
+        return;                         // Cancelled
+    }
+    m_links_on_air &= ~TRANSPORT_LINK_MASK(link);
+
+    uint32_t ticks = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_link_attempt[link].start_ticks);
+    transport_report(link, acked, (uint32_t)((uint64_t)ticks * 1000 / APP_TIMER_CLOCK_FREQ),
+                     rssi_dbm, snr_db);
+
+    if (acked) {
+        TRACE_INFO("Transmission successful over %s", m_link_names[link]);
+        comm_links_cancel();
+        m_state = COMM_STATE_IDLE;
+        comm_frame_complete(m_active, true);
+    } else if (m_links_on_air == 0) {
+        comm_tx_failed();
+    } else {
+        TRACE_WARNING("No ACK over %s", m_link_names[link]);
+    }
+}
+
+/**
+ * @brief Time an alert from its event to its first attempt on air
+ */
+static void comm_alert_on_air(comm_frame_t const *frame) {
+    uint32_t ticks = app_timer_cnt_diff_compute(app_timer_cnt_get(), frame->event_ticks);
+    uint32_t latency_ms = (uint32_t)((uint64_t)ticks * 1000 / APP_TIMER_CLOCK_FREQ);
+
+    m_alert_stats.count++;
+    m_alert_stats.last_ms = latency_ms;
+    if (latency_ms > m_alert_stats.max_ms) {
+        m_alert_stats.max_ms = latency_ms;
+    }
+    if (latency_ms > COMM_ALERT_DEADLINE_MS) {
+        m_alert_stats.missed++;
+        TRACE_ERROR("Alert on air %d ms after the event, deadline %d ms", latency_ms, COMM_ALERT_DEADLINE_MS);
+    } else {
+        TRACE_INFO("Alert on air %d ms after the event", latency_ms);
+    }
+}
+
+/**
+ * @brief Start the next queued frame, emergency class first
+ */
+static void comm_dispatch(void) {
+    while (m_state == COMM_STATE_IDLE) {
+        comm_priority_t prio;
+
+        if (m_fifo[COMM_PRIO_EMERGENCY].count > 0) {
+            prio = COMM_PRIO_EMERGENCY;
+        } else if (m_fifo[COMM_PRIO_ROUTINE].count > 0) {
+            prio = COMM_PRIO_ROUTINE;
+        } else {
+            break;
+        }
+
+        m_active = comm_fifo_pop_front(prio);
+        m_active_prio = prio;
+        m_frames[m_active].attempts++;
+
+        if (comm_radio_start(&m_frames[m_active], prio)) {
+            m_state = COMM_STATE_ON_AIR;
+            if (m_frames[m_active].alert && m_frames[m_active].attempts == 1) {
+                comm_alert_on_air(&m_frames[m_active]);
+            }
+        } else {
+            comm_tx_failed();
+        }
+    }
+
+    comm_radio_power_update();
+}
+
 /**
  * @brief Initialize communication module
  */
 void communication_init(void) {
     // Initialize BLE for local communication
     // Initialize LoRa interface for underground-to-surface
-    
-    NRF_LOG_INFO("Communication module initialized");
+
+    memset(m_frames, 0, sizeof(m_frames));
+    memset(m_fifo, 0, sizeof(m_fifo));
+    memset(&m_alert_stats, 0, sizeof(m_alert_stats));
+    m_state = COMM_STATE_IDLE;
+    m_links_on_air = 0;
+    transport_init();
+
+    m_link_timer[TRANSPORT_LINK_BLE] = m_ble_timer;
+    m_link_timer[TRANSPORT_LINK_LORA] = m_lora_timer;
+    if (app_timer_create(&m_comm_timer, APP_TIMER_MODE_SINGLE_SHOT,
+                         comm_timer_handler) != NRF_SUCCESS) {
+        TRACE_ERROR("Communication timer create failed");
+        return;
+    }
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        if (app_timer_create(&m_link_timer[i], APP_TIMER_MODE_SINGLE_SHOT,
+                             comm_link_timer_handler) != NRF_SUCCESS) {
+            TRACE_ERROR("%s timer create failed", m_link_names[i]);
+            return;
+        }
+    }
+
+    TRACE_INFO("Communication module initialized");
     m_comm_initialized = true;
 }
 
 /**
- * @brief Send data packet
+ * @brief Find a free slot outside the alert slot
+ * @param is_emergency May displace the newest routine frame if none is free
+ * @return Slot index, or -1 if the queue is full
+ */
+static int8_t comm_frame_alloc(bool is_emergency) {
+    for (uint8_t i = 0; i < COMM_TX_QUEUE_SIZE; i++) {
+        if (!m_frames[i].in_use) {
+            return (int8_t)i;
+        }
+    }
+
+    if (is_emergency && m_fifo[COMM_PRIO_ROUTINE].count > 0) {
+        // Make room by dropping the newest routine frame
+        uint8_t idx = comm_fifo_pop_back(COMM_PRIO_ROUTINE);
+        TRACE_WARNING("TX queue full, routine frame dropped for emergency");
+        comm_frame_complete(idx, false);
+        return (int8_t)idx;
+    }
+
+    TRACE_ERROR("TX queue full");
+    return -1;
+}
+
+static void comm_frame_fill(uint8_t idx, uint8_t const *data, uint16_t length,
+                            communication_tx_handler_t handler, void *p_context) {
+    comm_frame_t *frame = &m_frames[idx];
+
+    memcpy(frame->data, data, length);
+    frame->length = length;
+    frame->handler = handler;
+    frame->p_context = p_context;
+    frame->attempts = 0;
+    frame->alert = false;
+    frame->links = TRANSPORT_ALL_LINKS;
+    frame->in_use = true;
+}
+
+/**
+ * @brief Take the radio back from the frame on air or in backoff
+ * @note The interrupted frame goes first in its class once the new one is
+ *       out; an attempt cut short does not count as a failed one
+ */
+static void comm_preempt(void) {
+    app_timer_stop(m_comm_timer);
+    m_timer_expired = false;
+    comm_links_cancel();
+    if (m_state == COMM_STATE_ON_AIR) {
+        m_frames[m_active].attempts--;
+        comm_fifo_push_front(m_active_prio, m_active);
+    }
+    m_state = COMM_STATE_IDLE;
+}
+
+/**
+ * @brief Queue a frame for background transmission
+ * @param data Frame bytes, copied before returning
+ * @param length Frame length, at most COMM_MAX_FRAME_SIZE
+ * @param is_emergency Emergency frames go ahead of routine ones and may
+ *                     displace the newest routine frame if the queue is full
+ * @param handler Called once the frame was sent or dropped, normally from
+ *                communication_process(); may be NULL
+ * @return 0 if queued, -1 if not initialized, too long or no slot free
+ */
+int communication_send(uint8_t const *data, uint16_t length, bool is_emergency,
+                       communication_tx_handler_t handler, void *p_context) {
+    if (!m_comm_initialized) {
+        TRACE_ERROR("Communication not initialized");
+        return -1;
+    }
+    if (length == 0 || length > COMM_MAX_FRAME_SIZE) {
+        return -1;
+    }
+
+    int8_t idx = comm_frame_alloc(is_emergency);
+    if (idx < 0) {
+        return -1;
+    }
+    comm_frame_fill(idx, data, length, handler, p_context);
+
+    comm_priority_t prio = is_emergency ? COMM_PRIO_EMERGENCY : COMM_PRIO_ROUTINE;
+    comm_fifo_push_back(prio, idx);
+
+    if (is_emergency && m_state != COMM_STATE_IDLE && m_active_prio == COMM_PRIO_ROUTINE) {
+        comm_preempt();
+    }
+
+    comm_dispatch();
+    return 0;
+}
+
+/**
+ * @brief Queue a routine frame that may only go out on some links
+ * @param links TRANSPORT_LINK_MASK() bits, e.g. BLE only for bulk data
+ *              that would hold LoRa for seconds per frame
+ * @return 0 if queued, -1 if not initialized, too long, no link given or
+ *         no slot free
+ */
+int communication_send_on(uint8_t const *data, uint16_t length, uint8_t links,
+                          communication_tx_handler_t handler, void *p_context) {
+    links &= TRANSPORT_ALL_LINKS;
+    if (!m_comm_initialized || length == 0 || length > COMM_MAX_FRAME_SIZE || links == 0) {
+        return -1;
+    }
+
+    int8_t idx = comm_frame_alloc(false);
+    if (idx < 0) {
+        return -1;
+    }
+    comm_frame_fill(idx, data, length, handler, p_context);
+    m_frames[idx].links = links;
+    comm_fifo_push_back(COMM_PRIO_ROUTINE, idx);
+
+    comm_dispatch();
+    return 0;
+}
+
+/**
+ * @brief Put an alert on air ahead of everything else
+ * @param event_ticks RTC ticks of the event the alert reports; the time
+ *                    from it to the first attempt on air is checked
+ *                    against COMM_ALERT_DEADLINE_MS
+ * @note Uses the reserved slot, so a queue full of emergency frames cannot
+ *       hold it back; a second alert while the first is in flight takes a
+ *       regular slot. Only another alert on air is left to finish.
+ * @return 0 if queued, -1 if not initialized, too long or no slot free
+ */
+int communication_send_alert(uint8_t const *data, uint16_t length, uint32_t event_ticks,
+                             communication_tx_handler_t handler, void *p_context) {
+    if (!m_comm_initialized || length == 0 || length > COMM_MAX_FRAME_SIZE) {
+        return -1;
+    }
+
+    int8_t idx = m_frames[COMM_ALERT_SLOT].in_use ? comm_frame_alloc(true) : COMM_ALERT_SLOT;
+    if (idx < 0) {
+        return -1;
+    }
+    comm_frame_fill(idx, data, length, handler, p_context);
+    m_frames[idx].alert = true;
+    m_frames[idx].event_ticks = event_ticks;
+
+    if (m_state != COMM_STATE_IDLE &&
+        !(m_state == COMM_STATE_ON_AIR && m_frames[m_active].alert)) {
+        comm_preempt();
+    }
+    comm_fifo_push_front(COMM_PRIO_EMERGENCY, idx);
+
+    comm_dispatch();
+    return 0;
+}
+
+/**
+ * @brief Send data packet without a completion callback
  * @param data Pointer to data buffer
  * @param length Data length
  * @param is_emergency Emergency flag for priority transmission
  */
 void communication_send_data(uint8_t *data, uint16_t length, bool is_emergency) {
-    if (!m_comm_initialized) {
-        NRF_LOG_ERROR("Communication not initialized");
-        return;
+    if (communication_send(data, length, is_emergency, NULL, NULL) != 0) {
+        TRACE_ERROR("Frame not queued (%d bytes)", length);
     }
-    
-    if (is_emergency) {
-        NRF_LOG_ERROR("!!! EMERGENCY TRANSMISSION !!!");
-        // Use both BLE (nearby) and LoRa (surface) with high priority
-    } else {
-        NRF_LOG_INFO("Standard data transmission");
-    }
-    
-    // Simulate transmission
-    NRF_LOG_INFO("Transmitting %d bytes...", length);
-    nrf_delay_ms(100); // Simulate transmission time
-    
-    NRF_LOG_HEXDUMP_INFO(data, length);
-    NRF_LOG_INFO("Transmission successful");
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Advance the TX queue on timer events; call from the main loop
+ */
+void communication_process(void) {
+    bool event = false;
+
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        if (!m_link_expired[i]) {
+            continue;
+        }
+        m_link_expired[i] = false;
+        event = true;
+        comm_link_done((transport_link_t)i, m_link_attempt[i].ack_expected,
+                       TRANSPORT_SIGNAL_UNKNOWN, TRANSPORT_SIGNAL_UNKNOWN);
+    }
+
+    if (m_timer_expired) {
+        m_timer_expired = false;
+        event = true;
+        if (m_state == COMM_STATE_BACKOFF) {
+            m_state = COMM_STATE_IDLE;
+        }
+    }
+
+    if (event) {
+        comm_dispatch();
+    }
+}
+
+/**
+ * @brief Event-to-air latency of the alerts sent since init
+ */
+void communication_get_alert_stats(comm_alert_stats_t *stats) {
+    *stats = m_alert_stats;
+}
+
+/**
+ * @brief Frames are queued or on air
+ */
+bool communication_busy(void) {
+    return (m_state != COMM_STATE_IDLE) ||
+           (m_fifo[COMM_PRIO_EMERGENCY].count > 0) ||
+           (m_fifo[COMM_PRIO_ROUTINE].count > 0);
+}
@@ -4,7 +4,32 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define COMM_MAX_FRAME_SIZE     192     // Fits a full telemetry frame
+#define COMM_TX_QUEUE_SIZE      4       // Frames waiting or on air, alerts aside
+
+#ifndef COMM_ALERT_DEADLINE_MS
+#define COMM_ALERT_DEADLINE_MS  50      // Event to alert frame on air
+#endif
+
+typedef void (*communication_tx_handler_t)(bool success, void *p_context);
+
+typedef struct {
+    uint16_t count;             // Alerts put on air
+    uint16_t missed;            // Later than COMM_ALERT_DEADLINE_MS
+    uint32_t last_ms;           // Event to first attempt on air
+    uint32_t max_ms;
+} comm_alert_stats_t;
+
 void communication_init(void);
+int communication_send(uint8_t const *data, uint16_t length, bool is_emergency,
+                       communication_tx_handler_t handler, void *p_context);
+int communication_send_on(uint8_t const *data, uint16_t length, uint8_t links,
+                          communication_tx_handler_t handler, void *p_context);
+int communication_send_alert(uint8_t const *data, uint16_t length, uint32_t event_ticks,
+                             communication_tx_handler_t handler, void *p_context);
 void communication_send_data(uint8_t *data, uint16_t length, bool is_emergency);
+void communication_process(void);
+void communication_get_alert_stats(comm_alert_stats_t *stats);
+bool communication_busy(void);
 
 #endif
\ No newline at end of file
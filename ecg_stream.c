@@ -0,0 +1,282 @@
+/**
+ * @file ecg_stream.c
+ * @brief Losslessly compressed raw ECG streaming
+ * @description CH1 samples from the ADS1292R are predicted from the two
+ *              before them (second-order delta) and the residuals are Rice
+ *              coded into chunks that fit the link MTU:
+ *
+ *   Offset Size  Field
+ *   0      1     Sync (0x5E)
+ *   1      1     Version
+ *   2      4     Device ID (FICR DEVICEID[0], little-endian)
+ *   6      2     Chunk sequence number (little-endian)
+ *   8      4     Stream index of sample 0 (little-endian); a gap means
+ *                chunks were dropped
+ *   12     1     Sample count N
+ *   13     1     Rice parameter k
+ *   14     3     Sample 0, 24-bit two's complement (little-endian)
+ *   17     3     Sample 1, zero if N = 1
+ *   20     ...   Bitstream, LSB first: per sample 2..N-1 the zigzagged
+ *                residual x[n] - 2x[n-1] + x[n-2] as q = u >> k ones, a
+ *                zero and the k low bits; q >= 24 is sent as 24 ones and
+ *                the 27-bit code
+ *   end    2     CRC16-CCITT over all preceding bytes (little-endian)
+ *
+ *              Every chunk restarts the predictor, so a lost chunk costs
+ *              only its own samples. At 500 SPS the host bench measures
+ *              13.8 bits per sample at rest and 15.3 during exertion, about
+ *              7 kbit/s against 12 kbit/s raw.
+ *
+ *              Chunks go out on BLE only: at that rate LoRa would be on air
+ *              for longer than the stream lasts and hold back the vitals
+ *              and alerts behind it. Out of BLE range the chunks are
+ *              dropped and the telemetry carries on over LoRa.
+ */
+
+#include "ecg_stream.h"
+#include "ads1292r_driver.h"
+#include "communication.h"
+#include "transport.h"
+#include "crc16.h"
+#include "nrf.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_STREAM
+#include "trace.h"
+#include <string.h>
+
+#define ECG_STREAM_ESCAPE_Q         24
+#define ECG_STREAM_ESCAPE_BITS      27      // Second-order residual of 24-bit samples
+#define ECG_STREAM_MAX_K            (ECG_STREAM_ESCAPE_BITS - 1)
+#define ECG_STREAM_STATS_WINDOW     64      // Residuals before the statistics halve
+
+static bool m_active = false;
+static uint16_t m_mtu;
+static uint32_t m_device_id;
+
+// Chunk under construction
+static uint8_t m_frame[COMM_MAX_FRAME_SIZE];
+static uint32_t m_bit_pos;              // Bitstream position after the header
+static uint8_t m_count;
+static uint8_t m_k;
+static int32_t m_prev[2];               // x[n-1], x[n-2]
+static uint16_t m_chunk_seq;
+static uint32_t m_first_index;          // Stream index of the chunk's sample 0
+static uint32_t m_sample_index;         // Samples seen since the stream started
+static uint32_t m_dropped;
+
+// Running mean of the residual codes, picks k for the next chunk
+static uint32_t m_code_sum;
+static uint32_t m_code_count;
+
+/**
+ * @brief Append the low `bits` bits of value to the bitstream, LSB first
+ */
+static void ecg_stream_bits_put(uint32_t value, uint8_t bits) {
+    uint8_t *p_bits = &m_frame[ECG_STREAM_HEADER_SIZE];
+
+    for (uint8_t i = 0; i < bits; i++) {
+        if ((m_bit_pos & 7) == 0) {
+            p_bits[m_bit_pos >> 3] = 0;
+        }
+        if (value & (1UL << i)) {
+            p_bits[m_bit_pos >> 3] |= (uint8_t)(1 << (m_bit_pos & 7));
+        }
+        m_bit_pos++;
+    }
+}
+
+static void ecg_stream_put24(uint8_t *p, int32_t sample) {
+    p[0] = sample & 0xFF;
+    p[1] = (sample >> 8) & 0xFF;
+    p[2] = (sample >> 16) & 0xFF;
+}
+
+/**
+ * @brief Smallest k with count * 2^k >= sum of codes
+ */
+static uint8_t ecg_stream_rice_k(void) {
+    uint8_t k = 0;
+    while (k < ECG_STREAM_MAX_K && ((uint64_t)m_code_count << k) < m_code_sum) {
+        k++;
+    }
+    return k;
+}
+
+/**
+ * @brief Coded length of a residual in bits
+ */
+static uint32_t ecg_stream_code_bits(uint32_t code) {
+    uint32_t q = code >> m_k;
+    return (q < ECG_STREAM_ESCAPE_Q) ? q + 1 + m_k : ECG_STREAM_ESCAPE_Q + ECG_STREAM_ESCAPE_BITS;
+}
+
+static void ecg_stream_put_code(uint32_t code) {
+    uint32_t q = code >> m_k;
+
+    if (q >= ECG_STREAM_ESCAPE_Q) {
+        ecg_stream_bits_put((1UL << ECG_STREAM_ESCAPE_Q) - 1, ECG_STREAM_ESCAPE_Q);
+        ecg_stream_bits_put(code, ECG_STREAM_ESCAPE_BITS);
+        return;
+    }
+    ecg_stream_bits_put((1UL << q) - 1, (uint8_t)(q + 1));
+    ecg_stream_bits_put(code, m_k);
+}
+
+/**
+ * @brief Open a chunk with its first sample
+ */
+static void ecg_stream_chunk_begin(int32_t sample) {
+    m_count = 1;
+    m_first_index = m_sample_index;
+    m_bit_pos = 0;
+    m_k = ecg_stream_rice_k();
+    m_prev[0] = sample;
+    ecg_stream_put24(&m_frame[14], sample);
+    ecg_stream_put24(&m_frame[17], 0);
+}
+
+/**
+ * @brief Complete the header and CRC and queue the chunk
+ */
+static void ecg_stream_chunk_send(void) {
+    uint32_t first_index = m_first_index;
+    uint16_t pos = ECG_STREAM_HEADER_SIZE + (uint16_t)((m_bit_pos + 7) >> 3);
+
+    m_frame[0] = ECG_STREAM_SYNC;
+    m_frame[1] = ECG_STREAM_VERSION;
+    m_frame[2] = m_device_id & 0xFF;
+    m_frame[3] = (m_device_id >> 8) & 0xFF;
+    m_frame[4] = (m_device_id >> 16) & 0xFF;
+    m_frame[5] = (m_device_id >> 24) & 0xFF;
+    m_frame[6] = m_chunk_seq & 0xFF;
+    m_frame[7] = (m_chunk_seq >> 8) & 0xFF;
+    m_frame[8] = first_index & 0xFF;
+    m_frame[9] = (first_index >> 8) & 0xFF;
+    m_frame[10] = (first_index >> 16) & 0xFF;
+    m_frame[11] = (first_index >> 24) & 0xFF;
+    m_frame[12] = m_count;
+    m_frame[13] = m_k;
+
+    uint16_t crc = crc16_compute(m_frame, pos, NULL);
+    m_frame[pos++] = crc & 0xFF;
+    m_frame[pos++] = (crc >> 8) & 0xFF;
+
+    // Routine class: alerts and the vitals backlog go first, and a full
+    // queue drops the chunk rather than holding up the stream
+    if (communication_send_on(m_frame, pos, TRANSPORT_LINK_MASK(TRANSPORT_LINK_BLE), NULL, NULL) != 0) {
+        m_dropped++;
+        TRACE_WARNING("ECG chunk %d dropped (%d total)", m_chunk_seq, m_dropped);
+    }
+    m_chunk_seq++;
+    m_count = 0;
+}
+
+/**
+ * @brief Add one sample to the open chunk, sending it once full
+ */
+static void ecg_stream_put_sample(int32_t sample) {
+    if (m_count == 0) {
+        ecg_stream_chunk_begin(sample);
+        return;
+    }
+    if (m_count == 1) {
+        ecg_stream_put24(&m_frame[17], sample);
+        m_prev[1] = m_prev[0];
+        m_prev[0] = sample;
+        m_count++;
+        return;
+    }
+
+    int32_t residual = sample - 2 * m_prev[0] + m_prev[1];
+    uint32_t code = ((uint32_t)residual << 1) ^ (uint32_t)(residual >> 31);
+    uint32_t capacity = (uint32_t)(m_mtu - ECG_STREAM_HEADER_SIZE - 2) * 8;
+
+    if (m_bit_pos + ecg_stream_code_bits(code) > capacity) {
+        // Sample opens the next chunk
+        ecg_stream_chunk_send();
+        ecg_stream_chunk_begin(sample);
+        return;
+    }
+
+    ecg_stream_put_code(code);
+    m_prev[1] = m_prev[0];
+    m_prev[0] = sample;
+    m_count++;
+
+    m_code_sum += code;
+    if (++m_code_count >= ECG_STREAM_STATS_WINDOW) {
+        m_code_sum >>= 1;
+        m_code_count >>= 1;
+    }
+
+    if (m_count >= ECG_STREAM_MAX_SAMPLES) {
+        ecg_stream_chunk_send();
+    }
+}
+
+/**
+ * @brief ADS1292R block handler, delivered from ads1292r_process()
+ */
+static void ecg_stream_samples(int32_t const *samples, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        ecg_stream_put_sample(samples[i]);
+        m_sample_index++;
+    }
+}
+
+/**
+ * @brief Start streaming CH1 to the gateway
+ * @param mtu Largest frame BLE carries, capped at COMM_MAX_FRAME_SIZE
+ * @return 0 if streaming, -1 if the MTU is too small or the ADS1292R is
+ *         unavailable
+ */
+int ecg_stream_start(uint16_t mtu) {
+    if (m_active) {
+        return 0;
+    }
+    if (mtu < ECG_STREAM_MIN_MTU) {
+        return -1;
+    }
+
+    m_mtu = (mtu > COMM_MAX_FRAME_SIZE) ? COMM_MAX_FRAME_SIZE : mtu;
+    m_device_id = NRF_FICR->DEVICEID[0];
+    m_count = 0;
+    m_chunk_seq = 0;
+    m_sample_index = 0;
+    m_dropped = 0;
+    m_code_sum = 0;
+    m_code_count = 0;
+
+    if (ads1292r_stream_start(ecg_stream_samples) != 0) {
+        TRACE_ERROR("ECG stream unavailable");
+        return -1;
+    }
+
+    m_active = true;
+    TRACE_INFO("ECG stream started, %d byte chunks", m_mtu);
+    return 0;
+}
+
+/**
+ * @brief Stop streaming; the partial chunk is sent first
+ */
+void ecg_stream_stop(void) {
+    if (!m_active) {
+        return;
+    }
+
+    ads1292r_stream_stop();
+    if (m_count > 0) {
+        ecg_stream_chunk_send();
+    }
+
+    m_active = false;
+    TRACE_INFO("ECG stream stopped after %d samples, %d chunks dropped",
+               m_sample_index, m_dropped);
+}
+
+/**
+ * @brief Stream is running
+ */
+bool ecg_stream_active(void) {
+    return m_active;
+}
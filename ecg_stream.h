@@ -0,0 +1,17 @@
+#ifndef ECG_STREAM_H
+#define ECG_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ECG_STREAM_SYNC             0x5E
+#define ECG_STREAM_VERSION          1
+#define ECG_STREAM_HEADER_SIZE      20
+#define ECG_STREAM_MIN_MTU          32
+#define ECG_STREAM_MAX_SAMPLES      250     // 0.5 s per chunk at most
+
+int ecg_stream_start(uint16_t mtu);
+void ecg_stream_stop(void);
+bool ecg_stream_active(void);
+
+#endif
\ No newline at end of file
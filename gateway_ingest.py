@@ -0,0 +1,796 @@
+"""
+Miner Health Monitoring System - Gateway ingest service
+Decodes telemetry and ECG stream frames from many wearables in bulk
+
+Usage:
+    python gateway_ingest.py
+    python gateway_ingest.py --devices 2000 --minutes 60 --batch 512
+
+Frames from the radio are queued and decoded a batch at a time. Headers,
+CRCs, record 0, the delta bitstreams of batched telemetry frames and the
+Rice coded ECG chunks of every frame in the batch are parsed with numpy
+array operations rather than one Python loop per frame. Per-miner state is
+split over shards, each with its own lock, and every miner keeps a bounded
+history of readings and ECG samples.
+
+Telemetry whose record 0 carries the EMERGENCY status skips the queue: it is
+decoded on the submitting thread and reported through on_emergency before
+submit() returns, so its latency does not depend on the routine load.
+
+Run directly, the module feeds itself synthetic traffic from the requested
+number of wearables, checks that everything sent was decoded and reports
+throughput and latency.
+"""
+
+import argparse
+import binascii
+import random
+import struct
+import sys
+import threading
+import time
+from collections import deque
+
+import numpy as np
+
+# Telemetry frame, see telemetry.c
+TELEMETRY_SYNC = 0xA5
+TELEMETRY_VERSION = 3
+TELEMETRY_BATCH_RECORDS = 8
+TELEMETRY_HEADER_SIZE = 10
+TELEMETRY_STATUS_HRV = 0x40
+TELEMETRY_STATUS_STATS = 0x80
+TELEMETRY_STATUS_MASK = 0x3F
+TELEMETRY_FIELDS = 9
+TELEMETRY_WIDTH_BITS = 5
+TELEMETRY_TS_MASK = 0x00FFFFFF
+TELEMETRY_TS_SHIFT = 12
+RECORD_SIZE = 17
+RECORD_FORMAT = '<I4h5B'
+HRV_SIZE = 6
+STATS_SIZE = 28
+RECORD0_END = TELEMETRY_HEADER_SIZE + RECORD_SIZE
+WIDTHS_BITS = TELEMETRY_FIELDS * TELEMETRY_WIDTH_BITS
+RECORD_FLAGS_BITS = 8
+RECORD_PREFIX_BITS = 2 + RECORD_FLAGS_BITS      # Status and flags ahead of the fields
+
+# Record flags, see vitals.h; the high nibble marks fields carried from an
+# earlier cycle because their sensor was not sampled
+VITAL_FLAG_STALE_SHIFT = 4
+STALE_BITS = {'ppg': 1 << 0, 'ecg': 1 << 1, 'temp': 1 << 2, 'accel': 1 << 3}
+SENSOR_FIELDS = {'ppg': ('spo2', 'heart_rate'), 'ecg': ('bp_systolic', 'bp_diastolic'),
+                 'temp': ('temp_raw',), 'accel': ('accel_raw',)}
+
+# ECG stream chunk, see ecg_stream.c
+ECG_STREAM_SYNC = 0x5E
+ECG_STREAM_VERSION = 1
+ECG_STREAM_HEADER_SIZE = 20
+ECG_STREAM_MAX_SAMPLES = 250
+ECG_STREAM_ESCAPE_Q = 24
+ECG_STREAM_ESCAPE_BITS = 27
+
+COMM_MAX_FRAME_SIZE = 192
+HEALTH_EMERGENCY = 3
+PROFILER_OPS = ('sleep', 'warmup', 'ecg', 'ppg', 'temp', 'imu',
+                'analyze', 'encode', 'flash', 'radio', 'log')
+
+HEADER_DTYPE = np.dtype([('sync', 'u1'), ('version', 'u1'), ('device', '<u4'),
+                         ('sequence', '<u2'), ('count', 'u1'), ('status', 'u1')])
+RECORD_DTYPE = np.dtype([('timestamp', '<u4'), ('temp_raw', '<i2'), ('accel_raw', '<i2', (3,)),
+                         ('spo2', 'u1'), ('heart_rate', 'u1'), ('bp_systolic', 'u1'),
+                         ('bp_diastolic', 'u1'), ('flags', 'u1')])
+HRV_DTYPE = np.dtype([('beats', 'u1'), ('sdnn_ms', 'u1'), ('rmssd_ms', 'u1'), ('pnn50_pct', 'u1'),
+                      ('ectopic', 'u1'), ('af_score', 'u1')])
+STATS_DTYPE = np.dtype([('period_ms', '<u4'), ('cpu_duty', '<u2'),
+                        ('op_duty', '<u2', (len(PROFILER_OPS),))])
+ECG_HEADER_DTYPE = np.dtype([('sync', 'u1'), ('version', 'u1'), ('device', '<u4'),
+                             ('sequence', '<u2'), ('first_index', '<u4'), ('count', 'u1'),
+                             ('k', 'u1'), ('sample0', 'u1', (3,)), ('sample1', 'u1', (3,))])
+
+# One decoded reading as the gateway stores it
+READING_DTYPE = np.dtype([('device', '<u4'), ('sequence', '<u2'), ('status', 'u1'),
+                          ('flags', 'u1'), ('stale', 'u1'), ('timestamp', '<u4'), ('temp_raw', '<i2'),
+                          ('accel_raw', '<i2', (3,)), ('spo2', 'u1'), ('heart_rate', 'u1'),
+                          ('bp_systolic', 'u1'), ('bp_diastolic', 'u1'), ('received', '<f8')])
+
+assert HEADER_DTYPE.itemsize == TELEMETRY_HEADER_SIZE
+assert RECORD_DTYPE.itemsize == RECORD_SIZE == struct.calcsize(RECORD_FORMAT)
+assert HRV_DTYPE.itemsize == HRV_SIZE
+assert STATS_DTYPE.itemsize == STATS_SIZE
+assert ECG_HEADER_DTYPE.itemsize == ECG_STREAM_HEADER_SIZE
+
+
+# ---------------------------------------------------------------------------
+# Bulk decoding
+# ---------------------------------------------------------------------------
+
+def crc_ok(frames):
+    """CRC16-CCITT check per frame; crc_hqx with 0xFFFF is the SDK crc16_compute()"""
+    return np.fromiter((len(f) >= 2 and
+                        binascii.crc_hqx(memoryview(f)[:-2], 0xFFFF) == (f[-2] | (f[-1] << 8))
+                        for f in frames), bool, len(frames))
+
+
+def pack_frames(frames, min_width):
+    """Frames as one zero-padded (n, width) byte matrix and their lengths"""
+    lengths = np.fromiter((len(f) for f in frames), np.int64, len(frames))
+    buf = np.zeros((len(frames), max(int(lengths.max()), min_width)), np.uint8)
+    flat = np.frombuffer(b''.join(frames), np.uint8)
+    rows = np.repeat(np.arange(len(frames)), lengths)
+    cols = np.arange(len(flat)) - np.repeat(np.cumsum(lengths) - lengths, lengths)
+    buf[rows, cols] = flat
+    return buf, lengths
+
+
+def unpack_bits(buf, start):
+    """LSB-first bits of every row from byte `start`, with zero padding past the end"""
+    bits = np.unpackbits(buf[:, start:], axis=1, bitorder='little')
+    return np.pad(bits, ((0, 0), (0, 64)))
+
+
+def take_bits(bits, rows, pos, width, max_width):
+    """Unsigned LSB-first fields of `width` bits at bit `pos` of each row
+
+    rows, pos and width broadcast together; fields are at most max_width
+    bits and reads past the padding return zeros.
+    """
+    j = np.arange(max_width)
+    idx = np.minimum(pos[..., None] + j, bits.shape[1] - 1)
+    b = bits[rows[..., None], idx].astype(np.int64)
+    return ((b * (j < np.asarray(width)[..., None])) << j).sum(axis=-1)
+
+
+def unzigzag(code):
+    return (code >> 1) ^ -(code & 1)
+
+
+def signed24(b):
+    v = b[:, 0].astype(np.int64) | (b[:, 1].astype(np.int64) << 8) | (b[:, 2].astype(np.int64) << 16)
+    return v - ((v & 0x800000) << 1)
+
+
+def decode_telemetry(frames, received):
+    """Decode a batch of telemetry frames
+
+    @return (readings, hrv_devices, hrv, stats_devices, stats, rejected):
+            valid readings in frame order as READING_DTYPE, the HRV and
+            stats records with the device each came from, and the number
+            of frames that failed a check
+    """
+    n = len(frames)
+    buf, lengths = pack_frames(frames, RECORD0_END)
+    hdr = np.ascontiguousarray(buf[:, :TELEMETRY_HEADER_SIZE]).view(HEADER_DTYPE)[:, 0]
+    rec0 = np.ascontiguousarray(buf[:, TELEMETRY_HEADER_SIZE:RECORD0_END]).view(RECORD_DTYPE)[:, 0]
+    count = hdr['count'].astype(np.int64)
+    has_hrv = (hdr['status'] & TELEMETRY_STATUS_HRV) != 0
+    has_stats = (hdr['status'] & TELEMETRY_STATUS_STATS) != 0
+
+    ok = (crc_ok(frames) & (hdr['sync'] == TELEMETRY_SYNC) & (hdr['version'] == TELEMETRY_VERSION) &
+          (count >= 1) & (count <= TELEMETRY_BATCH_RECORDS))
+
+    # Field widths, then per record k >= 1 status, flags and fields at a
+    # fixed stride: every bit position follows from the nine widths
+    bits = unpack_bits(buf, RECORD0_END)
+    rows = np.arange(n)[:, None]
+    widths = take_bits(bits, rows, np.broadcast_to(np.arange(TELEMETRY_FIELDS) * TELEMETRY_WIDTH_BITS,
+                                                   (n, TELEMETRY_FIELDS)),
+                       TELEMETRY_WIDTH_BITS, TELEMETRY_WIDTH_BITS)
+    widths = np.where((count > 1)[:, None], widths, 0)
+    stride = RECORD_PREFIX_BITS + widths.sum(axis=1)
+
+    stream_bits = np.where(count > 1, WIDTHS_BITS + (count - 1) * stride, 0)
+    ok &= lengths == RECORD0_END + (stream_bits + 7) // 8 + has_hrv * HRV_SIZE + has_stats * STATS_SIZE + 2
+
+    k = np.arange(1, TELEMETRY_BATCH_RECORDS)
+    base = WIDTHS_BITS + (k[None, :] - 1) * stride[:, None]
+    status = take_bits(bits, rows, base, 2, 2)
+    flags = take_bits(bits, rows, base + 2, RECORD_FLAGS_BITS, RECORD_FLAGS_BITS)
+    offsets = RECORD_PREFIX_BITS + np.concatenate(
+        [np.zeros((n, 1), np.int64), np.cumsum(widths, axis=1)[:, :-1]], axis=1)
+    codes = take_bits(bits, rows[:, :, None], base[:, :, None] + offsets[:, None, :],
+                      widths[:, None, :], 31)
+
+    out = np.zeros((n, TELEMETRY_BATCH_RECORDS), READING_DTYPE)
+    out['device'] = hdr['device'][:, None]
+    out['sequence'] = (hdr['sequence'][:, None].astype(np.int64) + np.arange(TELEMETRY_BATCH_RECORDS)) & 0xFFFF
+    out['received'] = np.asarray(received)[:, None]
+    out['status'][:, 0] = hdr['status'] & TELEMETRY_STATUS_MASK
+    out['status'][:, 1:] = status
+    out['flags'][:, 0] = rec0['flags']
+    out['flags'][:, 1:] = flags
+    out['stale'] = out['flags'] >> VITAL_FLAG_STALE_SHIFT
+    out['timestamp'][:, 0] = rec0['timestamp']
+    out['timestamp'][:, 1:] = ((rec0['timestamp'][:, None].astype(np.int64) +
+                                (codes[..., 0] << TELEMETRY_TS_SHIFT)) & TELEMETRY_TS_MASK)
+    out['temp_raw'][:, 0] = rec0['temp_raw']
+    out['temp_raw'][:, 1:] = rec0['temp_raw'][:, None] + unzigzag(codes[..., 1])
+    out['accel_raw'][:, 0] = rec0['accel_raw']
+    out['accel_raw'][:, 1:] = rec0['accel_raw'][:, None, :] + unzigzag(codes[..., 2:5])
+    for f, name in enumerate(('spo2', 'heart_rate', 'bp_systolic', 'bp_diastolic'), start=5):
+        out[name][:, 0] = rec0[name]
+        out[name][:, 1:] = rec0[name][:, None] + unzigzag(codes[..., f])
+
+    valid = ok[:, None] & (np.arange(TELEMETRY_BATCH_RECORDS)[None, :] < count[:, None])
+
+    stats_rows = np.flatnonzero(ok & has_stats)
+    stats_at = (lengths[stats_rows] - 2 - STATS_SIZE)[:, None] + np.arange(STATS_SIZE)
+    stats = np.ascontiguousarray(buf[stats_rows[:, None], stats_at]).view(STATS_DTYPE)[:, 0]
+
+    # The HRV record sits ahead of the stats record
+    hrv_rows = np.flatnonzero(ok & has_hrv)
+    hrv_at = (lengths[hrv_rows] - 2 - has_stats[hrv_rows] * STATS_SIZE - HRV_SIZE)[:, None] + np.arange(HRV_SIZE)
+    hrv = np.ascontiguousarray(buf[hrv_rows[:, None], hrv_at]).view(HRV_DTYPE)[:, 0]
+
+    return (out[valid], hdr['device'][hrv_rows], hrv, hdr['device'][stats_rows], stats,
+            int(n - ok.sum()))
+
+
+def decode_ecg(frames):
+    """Decode a batch of ECG stream chunks
+
+    The Rice codes are read one symbol position at a time for all chunks at
+    once, then the second-order prediction is undone with two cumulative sums.
+
+    @return (ok, headers, samples): samples[i, :headers['count'][i]] are the
+            samples of chunk i where ok[i] is set
+    """
+    n = len(frames)
+    buf, lengths = pack_frames(frames, ECG_STREAM_HEADER_SIZE)
+    hdr = np.ascontiguousarray(buf[:, :ECG_STREAM_HEADER_SIZE]).view(ECG_HEADER_DTYPE)[:, 0]
+    count = hdr['count'].astype(np.int64)
+    k = hdr['k'].astype(np.int64)
+
+    ok = (crc_ok(frames) & (lengths >= ECG_STREAM_HEADER_SIZE + 2) & (hdr['sync'] == ECG_STREAM_SYNC) &
+          (hdr['version'] == ECG_STREAM_VERSION) & (count >= 1) & (k < ECG_STREAM_ESCAPE_BITS))
+
+    bits = unpack_bits(buf, ECG_STREAM_HEADER_SIZE)
+    width = bits.shape[1]
+    col = np.arange(width)
+    # Length of the run of ones starting at every bit; the padding ends all runs
+    next_zero = np.minimum.accumulate(np.where(bits == 0, col, width)[:, ::-1], axis=1)[:, ::-1]
+    run = next_zero - col
+
+    steps = max(int(count.max()) - 2, 0)
+    residual = np.zeros((n, steps), np.int64)
+    rows = np.arange(n)
+    pos = np.zeros(n, np.int64)
+    end = np.zeros(n, np.int64)
+    for i in range(steps):
+        q = np.minimum(run[rows, np.minimum(pos, width - 1)], ECG_STREAM_ESCAPE_Q)
+        escape = q == ECG_STREAM_ESCAPE_Q
+        start = np.where(escape, pos + q, pos + q + 1)
+        length = np.where(escape, ECG_STREAM_ESCAPE_BITS, k)
+        payload = take_bits(bits, rows, start, length, ECG_STREAM_ESCAPE_BITS)
+        residual[:, i] = unzigzag(np.where(escape, payload, (q << k) | payload))
+        pos = start + length
+        end = np.where(i < count - 2, pos, end)
+    ok &= end <= (lengths - ECG_STREAM_HEADER_SIZE - 2) * 8
+
+    x0 = signed24(hdr['sample0'])
+    x1 = signed24(hdr['sample1'])
+    samples = np.empty((n, steps + 2), np.int64)
+    samples[:, 0] = x0
+    samples[:, 1] = x1
+    samples[:, 2:] = x1[:, None] + np.cumsum((x1 - x0)[:, None] + np.cumsum(residual, axis=1), axis=1)
+    return ok, hdr, samples
+
+
+def is_emergency_frame(frame):
+    """Telemetry whose record 0 was taken in EMERGENCY, read from the raw header"""
+    return (len(frame) > TELEMETRY_HEADER_SIZE and frame[0] == TELEMETRY_SYNC and
+            (frame[9] & TELEMETRY_STATUS_MASK) == HEALTH_EMERGENCY)
+
+
+# ---------------------------------------------------------------------------
+# Per-miner state
+# ---------------------------------------------------------------------------
+
+class MinerHistory:
+    """Bounded state of one wearable: newest readings, ECG samples, link stats"""
+
+    def __init__(self, device_id, capacity, ecg_capacity):
+        self.device_id = device_id
+        self.readings = np.zeros(capacity, READING_DTYPE)
+        self.head = 0
+        self.count = 0
+        self.ecg = np.zeros(ecg_capacity, np.int32)
+        self.ecg_head = 0
+        self.ecg_count = 0
+        self.ecg_next = None            # Stream index expected next
+        self.ecg_lost = 0               # Samples in chunks that never arrived
+        self.stats = None               # Latest profiler stats record
+        self.hrv = None                 # Latest HRV features record
+        self.duplicates = 0
+        self.last_seen = 0.0
+
+    def add_readings(self, new):
+        """Store readings not seen before; alerts come again with the backlog"""
+        _, first = np.unique(new['sequence'], return_index=True)
+        fresh = new[np.sort(first)]
+        if self.count:
+            held = self.readings['sequence'][:self.count]
+            fresh = fresh[~np.isin(fresh['sequence'], held)]
+        self.duplicates += len(new) - len(fresh)
+
+        capacity = len(self.readings)
+        stored = fresh[-capacity:]
+        self.readings[(self.head + np.arange(len(stored))) % capacity] = stored
+        self.head = (self.head + len(stored)) % capacity
+        self.count = min(self.count + len(stored), capacity)
+        if len(new):
+            self.last_seen = max(self.last_seen, float(new['received'].max()))
+        return fresh
+
+    def add_ecg(self, first_index, samples):
+        """Append one chunk; gaps in the stream index count as lost samples"""
+        if self.ecg_next is not None and first_index != 0:
+            gap = (first_index - self.ecg_next) & 0xFFFFFFFF
+            if gap >= 1 << 31:
+                return 0                # Repeat of a chunk already stored
+            self.ecg_lost += gap
+        self.ecg_next = (first_index + len(samples)) & 0xFFFFFFFF
+
+        capacity = len(self.ecg)
+        stored = samples[-capacity:]
+        self.ecg[(self.ecg_head + np.arange(len(stored))) % capacity] = stored
+        self.ecg_head = (self.ecg_head + len(stored)) % capacity
+        self.ecg_count = min(self.ecg_count + len(stored), capacity)
+        return len(samples)
+
+    def history(self):
+        """Readings in sequence order, oldest first (a copy)"""
+        held = self.readings[:self.count] if self.count < len(self.readings) else \
+            np.roll(self.readings, -self.head)
+        if not len(held):
+            return held
+        rel = ((held['sequence'].astype(np.int64) - int(held['sequence'][0]) + 0x8000) & 0xFFFF) - 0x8000
+        return held[np.argsort(rel, kind='stable')]
+
+    def measured(self, sensor):
+        """Readings in sequence order whose `sensor` fields were measured in
+        their own cycle; statistics over those fields should use these, a
+        stale reading only repeats the one before it"""
+        held = self.history()
+        return held[(held['stale'] & STALE_BITS[sensor]) == 0]
+
+    def ecg_samples(self):
+        """ECG samples in stream order, oldest first (a copy)"""
+        if self.ecg_count < len(self.ecg):
+            return self.ecg[:self.ecg_count].copy()
+        return np.roll(self.ecg, -self.ecg_head)
+
+
+class Shard:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.miners = {}
+
+
+# ---------------------------------------------------------------------------
+# Ingest service
+# ---------------------------------------------------------------------------
+
+class GatewayIngest:
+    """Frame sink for one gateway, serving any number of wearables
+
+    submit() may be called from any thread. Routine frames are decoded in
+    batches of batch_size, or after max_delay seconds by the worker thread
+    once start() was called; without the worker, flush() decodes the queue
+    and a full queue is flushed by the submitting thread.
+    """
+
+    def __init__(self, shards=16, batch_size=256, max_delay=0.05, history=1024,
+                 ecg_history=30000, on_emergency=None):
+        self.shards = [Shard() for _ in range(shards)]
+        self.batch_size = batch_size
+        self.max_delay = max_delay
+        self.history_size = history
+        self.ecg_history_size = ecg_history
+        self.on_emergency = on_emergency
+
+        self._queue = deque()
+        self._cond = threading.Condition()
+        self._thread = None
+        self._running = False
+
+        self._stats_lock = threading.Lock()
+        self.counters = {'frames': 0, 'rejected': 0, 'readings': 0, 'duplicates': 0,
+                         'emergencies': 0, 'ecg_chunks': 0, 'ecg_samples': 0, 'batches': 0}
+        self.counters.update(('measured_' + sensor, 0) for sensor in STALE_BITS)
+        self.emergency_latency = deque(maxlen=4096)     # Seconds, submit to on_emergency
+        self.batch_latency = deque(maxlen=4096)         # Seconds, oldest frame queued to stored
+
+    def _count(self, **values):
+        with self._stats_lock:
+            for name, value in values.items():
+                self.counters[name] += value
+
+    def submit(self, frame, received=None, emergency=None):
+        """Hand over one frame as received from the radio
+
+        @param received Gateway receive time, time.time() if omitted
+        @param emergency Link-layer priority if known, otherwise taken from
+                         the frame's record 0 status
+        """
+        queued = time.perf_counter()
+        received = time.time() if received is None else received
+        if emergency is None:
+            emergency = is_emergency_frame(frame)
+
+        if emergency:
+            self._ingest([frame], [received])
+            with self._stats_lock:
+                self.emergency_latency.append(time.perf_counter() - queued)
+            return
+
+        with self._cond:
+            self._queue.append((frame, received, queued))
+            full = len(self._queue) >= self.batch_size
+            if full:
+                self._cond.notify()
+        if full and self._thread is None:
+            self.flush()
+
+    def flush(self):
+        """Decode everything queued; returns the number of frames taken"""
+        with self._cond:
+            batch = list(self._queue)
+            self._queue.clear()
+        if not batch:
+            return 0
+        frames, received, queued = zip(*batch)
+        self._ingest(frames, received)
+        with self._stats_lock:
+            self.batch_latency.append(time.perf_counter() - min(queued))
+            self.counters['batches'] += 1
+        return len(batch)
+
+    def start(self):
+        """Decode in a background thread"""
+        self._running = True
+        self._thread = threading.Thread(target=self._run, name='gateway-ingest', daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        """Stop the worker after the queue has drained"""
+        with self._cond:
+            self._running = False
+            self._cond.notify()
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+        self.flush()
+
+    def _run(self):
+        while True:
+            with self._cond:
+                self._cond.wait_for(lambda: not self._running or len(self._queue) >= self.batch_size,
+                                    timeout=self.max_delay)
+                if not self._running:
+                    return
+            self.flush()
+
+    def _miner(self, shard, device):
+        miner = shard.miners.get(device)
+        if miner is None:
+            miner = MinerHistory(device, self.history_size, self.ecg_history_size)
+            shard.miners[device] = miner
+        return miner
+
+    def _by_shard(self, devices):
+        """Group the unique devices of a sorted batch: shard -> [(device, start, end)]"""
+        unique, starts = np.unique(devices, return_index=True)
+        ends = np.append(starts[1:], len(devices))
+        groups = {}
+        for device, start, end in zip(unique.tolist(), starts.tolist(), ends.tolist()):
+            groups.setdefault(device % len(self.shards), []).append((device, start, end))
+        return groups
+
+    def _ingest(self, frames, received):
+        tele = [i for i, f in enumerate(frames) if f[:1] == b'\xa5']     # TELEMETRY_SYNC
+        ecg = [i for i, f in enumerate(frames) if f[:1] == b'\x5e']      # ECG_STREAM_SYNC
+        rejected = len(frames) - len(tele) - len(ecg)
+        alerts = []
+        stored = 0
+        duplicates = 0
+        ecg_samples = 0
+        measured = dict.fromkeys(STALE_BITS, 0)
+
+        if tele:
+            readings, hrv_devices, hrv, stats_devices, stats, bad = decode_telemetry(
+                [frames[i] for i in tele], np.asarray(received, np.float64)[tele])
+            rejected += bad
+            readings = readings[np.argsort(readings['device'], kind='stable')]
+            latest_stats = dict(zip(stats_devices.tolist(), stats))
+            latest_hrv = dict(zip(hrv_devices.tolist(), hrv))
+
+            for shard_idx, group in self._by_shard(readings['device']).items():
+                shard = self.shards[shard_idx]
+                with shard.lock:
+                    for device, start, end in group:
+                        miner = self._miner(shard, device)
+                        fresh = miner.add_readings(readings[start:end])
+                        stored += len(fresh)
+                        for sensor, bit in STALE_BITS.items():
+                            measured[sensor] += int(((fresh['stale'] & bit) == 0).sum())
+                        duplicates += end - start - len(fresh)
+                        if device in latest_stats:
+                            miner.stats = latest_stats[device]
+                        if device in latest_hrv:
+                            miner.hrv = latest_hrv[device]
+                        emergency = fresh[fresh['status'] == HEALTH_EMERGENCY]
+                        if len(emergency):
+                            alerts.append((device, emergency))
+
+        if ecg:
+            ok, hdr, samples = decode_ecg([frames[i] for i in ecg])
+            rejected += int(len(ecg) - ok.sum())
+            good = np.flatnonzero(ok)
+            good = good[np.argsort(hdr['device'][good], kind='stable')]
+            for shard_idx, group in self._by_shard(hdr['device'][good]).items():
+                shard = self.shards[shard_idx]
+                with shard.lock:
+                    for device, start, end in group:
+                        miner = self._miner(shard, device)
+                        for i in good[start:end]:
+                            ecg_samples += miner.add_ecg(int(hdr['first_index'][i]),
+                                                         samples[i, :hdr['count'][i]])
+
+        self._count(frames=len(frames), rejected=rejected, readings=stored, duplicates=duplicates,
+                    emergencies=len(alerts), ecg_chunks=len(ecg), ecg_samples=ecg_samples,
+                    **{'measured_' + sensor: n for sensor, n in measured.items()})
+
+        # Outside the shard locks, the handler may call back into the service
+        if self.on_emergency:
+            for device, emergency in alerts:
+                self.on_emergency(device, emergency)
+
+    def miner(self, device_id):
+        """State of one wearable, or None if it was never heard"""
+        shard = self.shards[device_id % len(self.shards)]
+        with shard.lock:
+            return shard.miners.get(device_id)
+
+    def devices(self):
+        ids = []
+        for shard in self.shards:
+            with shard.lock:
+                ids.extend(shard.miners)
+        return sorted(ids)
+
+
+# ---------------------------------------------------------------------------
+# Reference encoders and synthetic traffic
+# ---------------------------------------------------------------------------
+
+class BitWriter:
+    def __init__(self):
+        self.value = 0
+        self.bits = 0
+
+    def put(self, value, bits):
+        self.value |= (value & ((1 << bits) - 1)) << self.bits
+        self.bits += bits
+
+    def tobytes(self):
+        return self.value.to_bytes((self.bits + 7) // 8, 'little')
+
+
+def zigzag(delta):
+    return ((delta << 1) ^ (delta >> 31)) & 0xFFFFFFFF
+
+
+def crc_append(frame):
+    crc = binascii.crc_hqx(frame, 0xFFFF)
+    return frame + struct.pack('<H', crc)
+
+
+def encode_telemetry(device_id, sequence, records, statuses, stats=None, hrv=None):
+    """A frame as telemetry_encode() builds it
+
+    records are (timestamp, temp_raw, accel x, y, z, spo2, heart_rate,
+    systolic, diastolic, flags) tuples; stats is (period_ms, cpu_duty,
+    op_duty...) or None; hrv is (beats, sdnn_ms, rmssd_ms, pnn50_pct,
+    ectopic, af_score) or None.
+    """
+    flags = (TELEMETRY_STATUS_HRV if hrv else 0) | (TELEMETRY_STATUS_STATS if stats else 0)
+    frame = struct.pack('<BBIHBB', TELEMETRY_SYNC, TELEMETRY_VERSION, device_id, sequence & 0xFFFF,
+                        len(records), statuses[0] | flags)
+    frame += struct.pack(RECORD_FORMAT, *records[0])
+
+    if len(records) > 1:
+        r0 = records[0]
+        codes = [[((r[0] - r0[0]) & TELEMETRY_TS_MASK) >> TELEMETRY_TS_SHIFT] +
+                 [zigzag(r[f] - r0[f]) for f in range(1, TELEMETRY_FIELDS)] for r in records[1:]]
+        widths = [max(c[f].bit_length() for c in codes) for f in range(TELEMETRY_FIELDS)]
+        w = BitWriter()
+        for width in widths:
+            w.put(width, TELEMETRY_WIDTH_BITS)
+        for record, status, code in zip(records[1:], statuses[1:], codes):
+            w.put(status, 2)
+            w.put(record[9], RECORD_FLAGS_BITS)
+            for value, width in zip(code, widths):
+                w.put(value, width)
+        frame += w.tobytes()
+
+    if hrv:
+        frame += struct.pack('<6B', *hrv)
+    if stats:
+        frame += struct.pack('<IH%dH' % len(PROFILER_OPS), *stats)
+    return crc_append(frame)
+
+
+def encode_ecg(device_id, samples, mtu=COMM_MAX_FRAME_SIZE):
+    """Chunks as ecg_stream.c sends them, k taken from the previous chunk"""
+    capacity = (mtu - ECG_STREAM_HEADER_SIZE - 2) * 8
+    frames = []
+    first = 0
+    k = 0
+    sequence = 0
+    while first < len(samples):
+        w = BitWriter()
+        code_sum = 0
+        n = min(2, len(samples) - first)
+        while first + n < len(samples) and n < ECG_STREAM_MAX_SAMPLES:
+            r = samples[first + n] - 2 * samples[first + n - 1] + samples[first + n - 2]
+            code = zigzag(r)
+            q = code >> k
+            bits = q + 1 + k if q < ECG_STREAM_ESCAPE_Q else ECG_STREAM_ESCAPE_Q + ECG_STREAM_ESCAPE_BITS
+            if w.bits + bits > capacity:
+                break
+            if q < ECG_STREAM_ESCAPE_Q:
+                w.put((1 << q) - 1, q + 1)
+                w.put(code, k)
+            else:
+                w.put((1 << ECG_STREAM_ESCAPE_Q) - 1, ECG_STREAM_ESCAPE_Q)
+                w.put(code, ECG_STREAM_ESCAPE_BITS)
+            code_sum += code
+            n += 1
+
+        s1 = samples[first + 1] if n > 1 else 0
+        frame = struct.pack('<BBIHIBB', ECG_STREAM_SYNC, ECG_STREAM_VERSION, device_id, sequence & 0xFFFF,
+                            first, n, k)
+        frame += (samples[first] & 0xFFFFFF).to_bytes(3, 'little') + (s1 & 0xFFFFFF).to_bytes(3, 'little')
+        frames.append(crc_append(frame + w.tobytes()))
+
+        if n > 2:
+            k = 0
+            while k < ECG_STREAM_ESCAPE_BITS - 1 and ((n - 2) << k) < code_sum:
+                k += 1
+        first += n
+        sequence += 1
+    return frames
+
+
+def synthetic_traffic(devices, minutes, seed=1, p_emergency=0.002, ecg_seconds=30):
+    """(receive time, frame) pairs from `devices` wearables, in arrival order
+
+    Every wearable measures every 35 s and uploads full batches of eight with
+    an HRV and a stats record. As in main.c at normal status, the ECG is
+    sampled every 140 s and the temperature every 5 min; the readings in
+    between repeat the last value and are flagged stale. An EMERGENCY
+    reading also goes out at once as a single record alert, followed by
+    ecg_seconds of raw ECG chunks. Returns the traffic and the expected
+    per-device totals (readings, ECG samples, readings with a measured
+    temperature).
+    """
+    rng = random.Random(seed)
+    traffic = []
+    expected = {}
+    interval = 35.0
+    for d in range(devices):
+        device_id = 0x10000000 + d * 7919
+        phase = rng.uniform(0, interval)
+        batch, statuses = [], []
+        readings = 0
+        ecg_total = 0
+        temp_measured = 0
+        temp = bp = None
+        seq = rng.randrange(0x10000)
+        first_seq = seq
+        t = phase
+        while t < minutes * 60:
+            status = HEALTH_EMERGENCY if rng.random() < p_emergency else rng.choice((0, 0, 0, 0, 1))
+            stale = 0
+            if readings % 9 == 0:
+                temp = 4710 + rng.randint(-40, 40)
+                temp_measured += 1
+            else:
+                stale |= STALE_BITS['temp']
+            if readings % 4 == 0:
+                bp = (rng.randint(110, 135), rng.randint(70, 88))
+            else:
+                stale |= STALE_BITS['ecg']
+            record = (int(t * 32768) & TELEMETRY_TS_MASK, temp,
+                      rng.randint(-300, 300), rng.randint(-300, 300), 2048 + rng.randint(-200, 200),
+                      rng.randint(94, 99), rng.randint(60, 110)) + bp + \
+                     (0x0C | (stale << VITAL_FLAG_STALE_SHIFT),)
+            if not batch:
+                first_seq = seq
+            batch.append(record)
+            statuses.append(status)
+            readings += 1
+
+            if status == HEALTH_EMERGENCY:
+                traffic.append((t + 0.05, encode_telemetry(device_id, seq, [record], [status])))
+                hr = record[6] / 60.0
+                ecg = [int(4000 * np.sin(2 * np.pi * hr * n / 500.0) ** 15 + rng.randint(-30, 30))
+                       for n in range(int(ecg_seconds * 500))]
+                for i, chunk in enumerate(encode_ecg(device_id, ecg)):
+                    traffic.append((t + 0.5 * (i + 1), chunk))
+                ecg_total += len(ecg)
+
+            if len(batch) == TELEMETRY_BATCH_RECORDS:
+                stats = (280000, rng.randint(100, 900)) + tuple(rng.randint(0, 2000) for _ in PROFILER_OPS)
+                hrv = (rng.randint(6, 30), rng.randint(20, 80), rng.randint(15, 70), rng.randint(0, 40),
+                       rng.randint(0, 2), rng.randint(0, 60))
+                traffic.append((t + 0.2, encode_telemetry(device_id, first_seq, batch, statuses, stats, hrv)))
+                batch, statuses = [], []
+            seq = (seq + 1) & 0xFFFF
+            t += interval
+
+        if batch:
+            traffic.append((t, encode_telemetry(device_id, first_seq, batch, statuses)))
+        expected[device_id] = (readings, ecg_total, temp_measured)
+
+    traffic.sort(key=lambda item: item[0])
+    return traffic, expected
+
+
+def percentile_us(values, p):
+    return float(np.percentile(np.asarray(values), p)) * 1e6 if values else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Gateway ingest service benchmark on synthetic traffic')
+    parser.add_argument('--devices', type=int, default=1000)
+    parser.add_argument('--minutes', type=float, default=60)
+    parser.add_argument('--batch', type=int, default=256, help='frames per decode batch')
+    parser.add_argument('--shards', type=int, default=16)
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    print('Generating traffic from %d wearables over %g minutes...' % (args.devices, args.minutes))
+    traffic, expected = synthetic_traffic(args.devices, args.minutes, seed=args.seed)
+    alerts = []
+    service = GatewayIngest(shards=args.shards, batch_size=args.batch,
+                            on_emergency=lambda device, readings: alerts.append(device))
+
+    start = time.perf_counter()
+    for received, frame in traffic:
+        service.submit(frame, received=received)
+    service.flush()
+    elapsed = time.perf_counter() - start
+
+    failures = 0
+    for device_id, (readings, ecg_samples, temp_measured) in expected.items():
+        miner = service.miner(device_id)
+        got = (miner.count, miner.ecg_count) if miner else (0, 0)
+        ecg_samples = min(ecg_samples, service.ecg_history_size)
+        if got != (readings, ecg_samples):
+            failures += 1
+            print('device 0x%08x: %d readings / %d ECG samples, expected %d / %d' %
+                  ((device_id,) + got + (readings, ecg_samples)))
+        elif readings <= service.history_size and len(miner.measured('temp')) != temp_measured:
+            failures += 1
+            print('device 0x%08x: %d measured temperatures, expected %d' %
+                  (device_id, len(miner.measured('temp')), temp_measured))
+
+    c = service.counters
+    print('%d frames in %.3f s: %.0f frames/s, %.0f readings/s' %
+          (c['frames'], elapsed, c['frames'] / elapsed, c['readings'] / elapsed))
+    print('readings %d (+%d repeats dropped), ECG %d samples in %d chunks, %d rejected' %
+          (c['readings'], c['duplicates'], c['ecg_samples'], c['ecg_chunks'], c['rejected']))
+    print('measured: SpO2/HR %d, BP %d, temperature %d, accel %d of %d readings' %
+          (c['measured_ppg'], c['measured_ecg'], c['measured_temp'], c['measured_accel'], c['readings']))
+    print('emergency fast path: %d alerts, latency p50 %.0f us p99 %.0f us' %
+          (c['emergencies'], percentile_us(service.emergency_latency, 50),
+           percentile_us(service.emergency_latency, 99)))
+    print('routine batches: %d, latency p50 %.0f us p99 %.0f us' %
+          (c['batches'], percentile_us(service.batch_latency, 50), percentile_us(service.batch_latency, 99)))
+    print('devices: %d, %d mismatched' % (len(service.devices()), failures))
+    return 1 if failures or c['rejected'] else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,86 @@
+/**
+ * @file health.c
+ * @brief Health status from a set of vital signs
+ * @description Threshold checks in sensor units, kept free of hardware
+ *              dependencies so the host benchmark can run them
+ */
+
+#include "health.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_HEALTH
+#include "trace.h"
+
+/**
+ * @brief Analyze health status based on vital signs
+ * @param vitals Pointer to vital signs structure
+ * @return Health status
+ */
+health_status_t health_analyze(vital_signs_t const *vitals) {
+    health_status_t status = HEALTH_NORMAL;
+    uint8_t warning_flags = 0;
+    uint8_t critical_flags = 0;
+    
+    // Check SpO2 and Heart Rate (only meaningful with a detected pulse)
+    if (!vitals->ppg_valid) {
+        TRACE_WARNING("WARNING: No valid PPG, SpO2/HR not assessed");
+    } else {
+        if (vitals->spo2 < SPO2_MIN_CRITICAL) {
+            critical_flags++;
+            TRACE_ERROR("CRITICAL: SpO2 too low: %d%%", vitals->spo2);
+        } else if (vitals->spo2 < SPO2_MIN_NORMAL) {
+            warning_flags++;
+            TRACE_WARNING("WARNING: SpO2 below normal: %d%%", vitals->spo2);
+        }
+        
+        if (vitals->heart_rate < HEART_RATE_CRITICAL_MIN || 
+            vitals->heart_rate > HEART_RATE_CRITICAL_MAX) {
+            critical_flags++;
+            TRACE_ERROR("CRITICAL: Heart rate abnormal: %d BPM", vitals->heart_rate);
+        } else if (vitals->heart_rate < HEART_RATE_MIN || 
+                   vitals->heart_rate > HEART_RATE_MAX) {
+            warning_flags++;
+            TRACE_WARNING("WARNING: Heart rate outside normal range: %d BPM", vitals->heart_rate);
+        }
+    }
+    
+    // Check Temperature
+    if (vitals->temp_raw < TEMP_CRITICAL_MIN || 
+        vitals->temp_raw > TEMP_CRITICAL_MAX) {
+        critical_flags++;
+        TRACE_ERROR("CRITICAL: Temperature abnormal: %d (1/128 C)", vitals->temp_raw);
+    } else if (vitals->temp_raw < TEMP_MIN_NORMAL || 
+               vitals->temp_raw > TEMP_MAX_NORMAL) {
+        warning_flags++;
+        TRACE_WARNING("WARNING: Temperature outside normal range");
+    }
+    
+    // Check Blood Pressure (only meaningful when QRS detection succeeded)
+    if (!vitals->ecg_valid) {
+        TRACE_WARNING("WARNING: No valid ECG, BP not assessed");
+    } else if (vitals->bp_systolic > BP_SYSTOLIC_MAX || 
+               vitals->bp_systolic < BP_SYSTOLIC_MIN) {
+        warning_flags++;
+        TRACE_WARNING("WARNING: Systolic BP abnormal: %d mmHg", vitals->bp_systolic);
+    }
+    
+    // Check for fall
+    if (vitals->fall_detected) {
+        if (vitals->no_movement) {
+            critical_flags++;
+            TRACE_ERROR("EMERGENCY: Fall detected with no movement!");
+        } else {
+            warning_flags++;
+            TRACE_WARNING("WARNING: Fall detected!");
+        }
+    }
+    
+    // Determine overall status
+    if (critical_flags > 0 || vitals->fall_detected) {
+        status = HEALTH_EMERGENCY;
+    } else if (warning_flags >= 2) {
+        status = HEALTH_CRITICAL;
+    } else if (warning_flags > 0) {
+        status = HEALTH_WARNING;
+    }
+    
+    return status;
+}
\ No newline at end of file
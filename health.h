@@ -0,0 +1,34 @@
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <stdint.h>
+#include "vitals.h"
+#include "tmp117_driver.h"
+
+// Health Thresholds
+#define SPO2_MIN_NORMAL          92      // Below 92% is concerning
+#define SPO2_MIN_CRITICAL        85      // Below 85% is critical
+#define HEART_RATE_MIN           45      // BPM
+#define HEART_RATE_MAX           120     // BPM (for underground work)
+#define HEART_RATE_CRITICAL_MIN  40
+#define HEART_RATE_CRITICAL_MAX  150
+#define TEMP_MIN_NORMAL          TMP117_RAW_FROM_CDEG(3550)  // 35.5 Celsius
+#define TEMP_MAX_NORMAL          TMP117_RAW_FROM_CDEG(3850)  // 38.5 Celsius
+#define TEMP_CRITICAL_MIN        TMP117_RAW_FROM_CDEG(3500)
+#define TEMP_CRITICAL_MAX        TMP117_RAW_FROM_CDEG(4000)
+#define BP_SYSTOLIC_MAX          160     // mmHg
+#define BP_SYSTOLIC_MIN          90
+#define BP_DIASTOLIC_MAX         100
+#define BP_DIASTOLIC_MIN         60
+
+// Health Status
+typedef enum {
+    HEALTH_NORMAL,
+    HEALTH_WARNING,
+    HEALTH_CRITICAL,
+    HEALTH_EMERGENCY
+} health_status_t;
+
+health_status_t health_analyze(vital_signs_t const *vitals);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,1546 @@
+/**
+ * @file bench.c
+ * @brief Host replay benchmark for the signal-processing paths
+ * @description Replays ECG and accelerometer recordings through the real
+ *              drivers on top of the HAL shim and reports per-sample cost
+ *              and detection accuracy:
+ *
+ *   boot    ADS1292R and ICM-42688 init interleaved by boot_run() after a
+ *           power-on reset: time waited against the drivers one by one
+ *   ecg     QRS detector over the whole recording: sensitivity and positive
+ *           predictivity against the beat annotations (+-75 ms)
+ *   cycle   ADS1292R measurement captures every 10 s through DRDY, PPI and
+ *           EasyDMA: heart rate error against the annotated RR intervals,
+ *           and the ECG history view against the captured samples
+ *   stream  Raw ECG stream: bits per sample, decoded back and compared
+ *   fall    ICM-42688 fall monitor fed at 100 Hz through the FIFO model:
+ *           detections against the recording label
+ *   health  health_analyze() against a table of expected outcomes
+ *   hrv     Synthetic RR series (sinus, isolated ectopic beats, atrial
+ *           fibrillation): SDNN and RMSSD against a floating-point
+ *           reference, ectopic count, AF score
+ *   ptt     R peaks and pulse feet on sensor clocks off their data sheet
+ *           rate, anchored as the drivers anchor them: PTT error, and the
+ *           blood pressure for a shorter PTT after calibration
+ *   trend   Simulated hours of readings with one-off anomalies, judged
+ *           reading by reading and through the trend engine: readings per
+ *           hour, time at an escalated interval, desaturation detection
+ *   link    Routine and emergency frames while a BLE relay comes in and out
+ *           of range and LoRa SNR changes: delivery and charge per frame
+ *           against sending on both radios every time, LoRa SF reached,
+ *           time to the first alarm ACK
+ *   telem   A full telemetry batch encoded into every buffer size below its
+ *           frame: each frame is whole and the batch is emptied
+ *
+ *              Recordings are text files, one sample per line, '#' starts a
+ *              comment. ECG at 500 SPS in ADS1292R counts, an optional second
+ *              column 1 marking an annotated R peak. Accelerometer at 100 Hz,
+ *              x,y,z in ICM-42688 counts (2048/g), labelled by a "# fall=1"
+ *              or "# fall=0" line. host/convert_recording.py writes both
+ *              from MIT-BIH and SisFall. Without recordings the bench
+ *              generates synthetic ones.
+ *
+ *              Cost is host wall time spent in driver code, not on-target
+ *              cycles; compare runs on the same machine.
+ *
+ *              Exit status is 1 if a health case or stream round trip fails,
+ *              an HRV rhythm is misjudged, the PTT is off by more than a PPG
+ *              sample, the trend engine detects the desaturation later than
+ *              the reading-by-reading rules, link selection delivers
+ *              less or costs more than both radios, or a telemetry frame
+ *              encoded into a small buffer is broken.
+ *
+ * Usage:
+ *     host_bench [--ecg rec.csv]... [--fall rec.csv]... [--verbose]
+ */
+
+#include "host_hal.h"
+#include "sensor_models.h"
+#include "ads1292r_driver.h"
+#include "icm42688_driver.h"
+#include "qrs_detector.h"
+#include "health.h"
+#include "trend.h"
+#include "boot.h"
+#include "ptt.h"
+#include "hrv.h"
+#include "transport.h"
+#include "ecg_stream.h"
+#include "communication.h"
+#include "telemetry.h"
+#include "crc16.h"
+#include "app_timer.h"
+#include "nrf.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_ECG_FS                500
+#define BENCH_IMU_FS                100
+#define BENCH_ECG_COUNTS_PER_MV     20800   // Gain 6, 2.42 V reference
+#define BENCH_BEAT_TOLERANCE        (75 * BENCH_ECG_FS / 1000)
+#define BENCH_ECG_WARMUP            (2 * BENCH_ECG_FS)  // Detector settles and learns
+#define BENCH_CYCLE_PERIOD          (10 * BENCH_ECG_FS)
+#define BENCH_CAPTURE_SAMPLES       2000    // ADS1292R capture limit, 4 s
+#define BENCH_BLOCK_SAMPLES         50      // ADS1292R DMA block
+#define BENCH_HEALTH_ROUNDS         100000
+#define BENCH_MAX_RECORDINGS        32
+#define BENCH_NAME_SIZE             64
+
+typedef struct {
+    char     name[BENCH_NAME_SIZE];
+    int32_t  *samples;
+    uint8_t  *beat;                     // 1 at annotated R peaks
+    uint32_t count;
+} ecg_recording_t;
+
+typedef struct {
+    char     name[BENCH_NAME_SIZE];
+    int16_t  (*accel)[3];
+    uint32_t count;
+    bool     fall;
+} fall_recording_t;
+
+static ecg_recording_t m_ecg[BENCH_MAX_RECORDINGS];
+static uint8_t m_ecg_count = 0;
+static fall_recording_t m_falls[BENCH_MAX_RECORDINGS];
+static uint8_t m_fall_count = 0;
+static int m_failures = 0;
+static bool m_verbose = false;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------
+ * Recordings
+ * ------------------------------------------------------------------------ */
+
+static void bench_name_from_path(char *name, char const *path) {
+    char const *base = strrchr(path, '/');
+    snprintf(name, BENCH_NAME_SIZE, "%s", base ? base + 1 : path);
+}
+
+static ecg_recording_t *bench_ecg_new(char const *name, uint32_t capacity) {
+    if (m_ecg_count >= BENCH_MAX_RECORDINGS) {
+        return NULL;
+    }
+    ecg_recording_t *rec = &m_ecg[m_ecg_count++];
+    snprintf(rec->name, BENCH_NAME_SIZE, "%s", name);
+    rec->samples = calloc(capacity, sizeof(int32_t));
+    rec->beat = calloc(capacity, 1);
+    rec->count = 0;
+    return rec;
+}
+
+static fall_recording_t *bench_fall_new(char const *name, uint32_t capacity, bool fall) {
+    if (m_fall_count >= BENCH_MAX_RECORDINGS) {
+        return NULL;
+    }
+    fall_recording_t *rec = &m_falls[m_fall_count++];
+    snprintf(rec->name, BENCH_NAME_SIZE, "%s", name);
+    rec->accel = calloc(capacity, sizeof(rec->accel[0]));
+    rec->count = 0;
+    rec->fall = fall;
+    return rec;
+}
+
+static int bench_load_ecg(char const *path) {
+    FILE *f = fopen(path, "r");
+    char line[128];
+    uint32_t capacity = 1 << 16;
+    char name[BENCH_NAME_SIZE];
+
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    bench_name_from_path(name, path);
+    ecg_recording_t *rec = bench_ecg_new(name, capacity);
+    if (!rec) {
+        fclose(f);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        long counts;
+        int beat = 0;
+        if (line[0] == '#' || sscanf(line, "%ld , %d", &counts, &beat) < 1) {
+            continue;
+        }
+        if (rec->count >= capacity) {
+            capacity *= 2;
+            rec->samples = realloc(rec->samples, capacity * sizeof(int32_t));
+            rec->beat = realloc(rec->beat, capacity);
+        }
+        rec->samples[rec->count] = (int32_t)counts;
+        rec->beat[rec->count] = (beat != 0);
+        rec->count++;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int bench_load_fall(char const *path) {
+    FILE *f = fopen(path, "r");
+    char line[128];
+    uint32_t capacity = 1 << 14;
+    char name[BENCH_NAME_SIZE];
+    int label = -1;
+
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    bench_name_from_path(name, path);
+    fall_recording_t *rec = bench_fall_new(name, capacity, false);
+    if (!rec) {
+        fclose(f);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        int x, y, z;
+        if (line[0] == '#') {
+            sscanf(line, "# fall=%d", &label);
+            continue;
+        }
+        if (sscanf(line, "%d , %d , %d", &x, &y, &z) != 3) {
+            continue;
+        }
+        if (rec->count >= capacity) {
+            capacity *= 2;
+            rec->accel = realloc(rec->accel, capacity * sizeof(rec->accel[0]));
+        }
+        rec->accel[rec->count][0] = (int16_t)x;
+        rec->accel[rec->count][1] = (int16_t)y;
+        rec->accel[rec->count][2] = (int16_t)z;
+        rec->count++;
+    }
+    fclose(f);
+
+    if (label < 0) {
+        fprintf(stderr, "%s: no '# fall=' label\n", path);
+        m_fall_count--;
+        return -1;
+    }
+    rec->fall = (label != 0);
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Synthetic recordings
+ * ------------------------------------------------------------------------ */
+
+static uint32_t m_rng = 0x12345678;
+
+static double bench_uniform(void) {
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    return (m_rng + 0.5) / 4294967296.0;
+}
+
+static double bench_gauss(void) {
+    return sqrt(-2.0 * log(bench_uniform())) * cos(2.0 * M_PI * bench_uniform());
+}
+
+/**
+ * @brief PQRST complex in mV at time t (s) from the R peak
+ */
+static double bench_pqrst(double t, double scale) {
+    static const struct { double at, amp, width; } waves[] = {
+        { -0.20,  0.15, 0.025 },    // P
+        { -0.03, -0.10, 0.008 },    // Q
+        {  0.00,  1.20, 0.010 },    // R
+        {  0.03, -0.25, 0.010 },    // S
+        {  0.30,  0.30, 0.050 },    // T
+    };
+    double v = 0;
+    for (size_t i = 0; i < sizeof(waves) / sizeof(waves[0]); i++) {
+        double at = waves[i].at * (i == 4 ? scale : 1.0);   // QT shortens with HR
+        double d = (t - at) / waves[i].width;
+        v += waves[i].amp * exp(-0.5 * d * d);
+    }
+    return v;
+}
+
+static void bench_synth_ecg(char const *name, double seconds, double mean_hr,
+                            double noise_mv, double artefact_mv) {
+    uint32_t count = (uint32_t)(seconds * BENCH_ECG_FS);
+    ecg_recording_t *rec = bench_ecg_new(name, count);
+    double beats[512];
+    uint16_t beat_count = 0;
+
+    // Beat times with respiratory sinus arrhythmia and jitter
+    for (double t = 0.4; t < seconds && beat_count < 512; ) {
+        beats[beat_count++] = t;
+        double rr = (60.0 / mean_hr) * (1.0 + 0.05 * sin(2.0 * M_PI * 0.25 * t)) + 0.01 * bench_gauss();
+        t += rr;
+    }
+
+    double qt_scale = sqrt(60.0 / mean_hr);
+    uint16_t b = 0;
+    for (uint32_t n = 0; n < count; n++) {
+        double t = (double)n / BENCH_ECG_FS;
+        while (b + 1 < beat_count && beats[b + 1] - 0.5 < t && beats[b] + 0.6 < t) {
+            b++;
+        }
+
+        double mv = 0;
+        for (uint16_t k = b; k < beat_count && beats[k] - 0.5 < t; k++) {
+            mv += bench_pqrst(t - beats[k], qt_scale);
+        }
+        mv += 0.30 * sin(2.0 * M_PI * 0.3 * t);             // Baseline wander
+        mv += 0.02 * sin(2.0 * M_PI * 50.0 * t);            // Mains
+        mv += noise_mv * bench_gauss();
+        if (artefact_mv > 0 && fmod(t, 7.0) < 0.4) {
+            mv += artefact_mv * sin(2.0 * M_PI * 6.0 * t);  // Motion burst
+        }
+        rec->samples[n] = (int32_t)lround(mv * BENCH_ECG_COUNTS_PER_MV);
+    }
+
+    for (uint16_t k = 0; k < beat_count; k++) {
+        uint32_t n = (uint32_t)lround(beats[k] * BENCH_ECG_FS);
+        if (n < count) {
+            rec->beat[n] = 1;
+        }
+    }
+    rec->count = count;
+}
+
+typedef enum {
+    MOTION_STAND,
+    MOTION_WALK,
+    MOTION_LIE,
+    MOTION_SIT,
+    MOTION_FREEFALL,
+    MOTION_IMPACT,
+} motion_t;
+
+typedef struct {
+    motion_t motion;
+    double   seconds;
+    double   level_g;                   // Freefall residual or impact peak
+} motion_step_t;
+
+static void bench_synth_fall(char const *name, bool fall, motion_step_t const *steps, uint8_t step_count) {
+    uint32_t capacity = 0;
+    for (uint8_t i = 0; i < step_count; i++) {
+        capacity += (uint32_t)(steps[i].seconds * BENCH_IMU_FS) + 1;
+    }
+    fall_recording_t *rec = bench_fall_new(name, capacity, fall);
+
+    for (uint8_t i = 0; i < step_count; i++) {
+        uint32_t n_step = (uint32_t)(steps[i].seconds * BENCH_IMU_FS);
+        for (uint32_t n = 0; n < n_step; n++) {
+            double t = (double)rec->count / BENCH_IMU_FS;
+            double phase = (double)n / (n_step > 1 ? n_step - 1 : 1);
+            double g[3];
+
+            switch (steps[i].motion) {
+                case MOTION_WALK:
+                    g[0] = 0.15 * sin(2.0 * M_PI * 0.9 * t);
+                    g[1] = 0.05 * sin(2.0 * M_PI * 1.8 * t + 1.0);
+                    g[2] = 1.0 + 0.30 * sin(2.0 * M_PI * 1.8 * t);
+                    break;
+                case MOTION_LIE:
+                    g[0] = 1.0; g[1] = 0.05; g[2] = 0.1;
+                    break;
+                case MOTION_SIT:
+                    g[0] = 0.3; g[1] = 0.0; g[2] = 0.95;
+                    break;
+                case MOTION_FREEFALL:
+                    g[0] = 0.0; g[1] = 0.0; g[2] = steps[i].level_g;
+                    break;
+                case MOTION_IMPACT:
+                    // Half-sine spike across the step
+                    g[0] = 0.4 * steps[i].level_g * sin(M_PI * phase);
+                    g[1] = 0.1 * steps[i].level_g * sin(M_PI * phase);
+                    g[2] = 1.0 + (steps[i].level_g - 1.0) * sin(M_PI * phase);
+                    break;
+                case MOTION_STAND:
+                default:
+                    g[0] = 0.0; g[1] = 0.0; g[2] = 1.0;
+                    break;
+            }
+            for (uint8_t axis = 0; axis < 3; axis++) {
+                double counts = (g[axis] + 0.01 * bench_gauss()) * ICM42688_LSB_PER_G;
+                rec->accel[rec->count][axis] = (int16_t)fmax(-32767, fmin(32767, counts));
+            }
+            rec->count++;
+        }
+    }
+}
+
+static void bench_synthesize(void) {
+    bench_synth_ecg("synthetic-rest", 120.0, 68.0, 0.02, 0.0);
+    bench_synth_ecg("synthetic-exertion", 120.0, 135.0, 0.05, 0.4);
+
+    static const motion_step_t fall_still[] = {
+        { MOTION_WALK, 4.0, 0 }, { MOTION_FREEFALL, 0.35, 0.15 }, { MOTION_IMPACT, 0.06, 6.0 },
+        { MOTION_LIE, 35.0, 0 },
+    };
+    static const motion_step_t fall_recover[] = {
+        { MOTION_WALK, 4.0, 0 }, { MOTION_FREEFALL, 0.30, 0.2 }, { MOTION_IMPACT, 0.05, 5.0 },
+        { MOTION_LIE, 6.0, 0 }, { MOTION_WALK, 10.0, 0 },
+    };
+    static const motion_step_t walk[] = {
+        { MOTION_STAND, 2.0, 0 }, { MOTION_WALK, 40.0, 0 },
+    };
+    static const motion_step_t sit_down[] = {
+        { MOTION_WALK, 4.0, 0 }, { MOTION_FREEFALL, 0.15, 0.6 }, { MOTION_IMPACT, 0.10, 2.5 },
+        { MOTION_SIT, 10.0, 0 },
+    };
+    static const motion_step_t jump[] = {
+        { MOTION_STAND, 2.0, 0 }, { MOTION_FREEFALL, 0.20, 0.05 }, { MOTION_IMPACT, 0.08, 3.2 },
+        { MOTION_WALK, 6.0, 0 },
+    };
+    static const motion_step_t stumble[] = {
+        { MOTION_WALK, 4.0, 0 }, { MOTION_FREEFALL, 0.06, 0.3 }, { MOTION_IMPACT, 0.05, 3.0 },
+        { MOTION_WALK, 6.0, 0 },
+    };
+
+    bench_synth_fall("synthetic-fall-still", true, fall_still, 4);
+    bench_synth_fall("synthetic-fall-recover", true, fall_recover, 5);
+    bench_synth_fall("synthetic-walk", false, walk, 2);
+    bench_synth_fall("synthetic-sit-down", false, sit_down, 4);
+    bench_synth_fall("synthetic-jump", false, jump, 4);
+    bench_synth_fall("synthetic-stumble", false, stumble, 4);
+}
+
+/* ---------------------------------------------------------------------------
+ * Boot: overlapped driver init after a power-on reset
+ * ------------------------------------------------------------------------ */
+
+static int bench_boot(void) {
+    static const boot_step_t steps[] = { ads1292r_init_step, icm42688_init_step };
+    int32_t results[2];
+    uint32_t serial_ms;
+
+    host_power.RESETREAS = 0;
+    boot_init();
+    uint32_t waited_ms = boot_run(steps, results, 2, &serial_ms);
+
+    bool ok = (results[0] == 0 && results[1] == 0);
+    printf("boot    %-28s %8u ms waited  %5u ms one after another  %s\n", "power-on reset",
+           waited_ms, serial_ms, ok ? "ok" : "FAILED");
+    return ok ? 0 : -1;
+}
+
+/* ---------------------------------------------------------------------------
+ * ECG: QRS detector accuracy
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    uint32_t tp;
+    uint32_t fn;
+    uint32_t fp;
+} beat_score_t;
+
+/**
+ * @brief Match detections to annotations after the warm-up, greedily in time
+ */
+static beat_score_t bench_score_beats(ecg_recording_t const *rec, uint32_t const *detected, uint32_t count) {
+    beat_score_t score = { 0, 0, 0 };
+    uint32_t d = 0;
+
+    for (uint32_t n = BENCH_ECG_WARMUP; n < rec->count; n++) {
+        if (!rec->beat[n]) {
+            continue;
+        }
+        while (d < count && detected[d] + BENCH_BEAT_TOLERANCE < n) {
+            if (detected[d] >= BENCH_ECG_WARMUP) {
+                score.fp++;
+            }
+            d++;
+        }
+        if (d < count && detected[d] <= n + BENCH_BEAT_TOLERANCE) {
+            score.tp++;
+            d++;
+        } else if (n + BENCH_BEAT_TOLERANCE < rec->count) {
+            score.fn++;
+        }
+    }
+    for (; d < count; d++) {
+        if (detected[d] >= BENCH_ECG_WARMUP) {
+            score.fp++;
+        }
+    }
+    return score;
+}
+
+static void bench_ecg_detector(ecg_recording_t const *rec) {
+    uint32_t *detected = malloc(rec->count / 40 * sizeof(uint32_t) + 16);
+    uint32_t max_detected = rec->count / 40 + 4;    // 750 BPM
+    uint32_t count = 0;
+    qrs_beat_t beat;
+
+    qrs_detector_init();
+    uint64_t start = bench_now_ns();
+    for (uint32_t n = 0; n < rec->count; n++) {
+        if (qrs_detector_process(rec->samples[n], &beat) && count < max_detected) {
+            detected[count++] = beat.r_peak_sample;
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    beat_score_t s = bench_score_beats(rec, detected, count);
+    double se = (s.tp + s.fn) ? 100.0 * s.tp / (s.tp + s.fn) : 0.0;
+    double ppv = (s.tp + s.fp) ? 100.0 * s.tp / (s.tp + s.fp) : 0.0;
+    printf("ecg     %-28s %8u samples %5u beats  Se %6.2f%%  +P %6.2f%%  %7.1f ns/sample\n",
+           rec->name, rec->count, s.tp + s.fn, se, ppv, (double)elapsed / rec->count);
+    free(detected);
+}
+
+/* ---------------------------------------------------------------------------
+ * ECG: measurement cycles through the ADS1292R driver
+ * ------------------------------------------------------------------------ */
+
+static bool m_ads_ready;
+static bool m_ads_done;
+
+static void bench_ads_ready(void) {
+    m_ads_ready = true;
+}
+
+static void bench_ads_done(void) {
+    m_ads_done = true;
+}
+
+/**
+ * @brief Heart rate from the annotated RR intervals in [from, to)
+ */
+static double bench_reference_hr(ecg_recording_t const *rec, uint32_t from, uint32_t to) {
+    int32_t first = -1, last = -1;
+    uint32_t beats = 0;
+
+    for (uint32_t n = from; n < to && n < rec->count; n++) {
+        if (rec->beat[n]) {
+            if (first < 0) {
+                first = (int32_t)n;
+            }
+            last = (int32_t)n;
+            beats++;
+        }
+    }
+    if (beats < 2) {
+        return 0;
+    }
+    return 60.0 * BENCH_ECG_FS * (beats - 1) / (last - first);
+}
+
+/**
+ * @brief Deliver one sample; the DMA block completes inside the model
+ */
+static uint64_t bench_ads_feed(ecg_recording_t const *rec, uint32_t n) {
+    int32_t sample = rec->samples[n % rec->count];
+    ads1292r_model_convert(sample, 0);
+    host_time_advance_us(1000000 / BENCH_ECG_FS);
+
+    if ((n + 1) % BENCH_BLOCK_SAMPLES != 0) {
+        return 0;
+    }
+    uint64_t start = bench_now_ns();
+    ads1292r_process();
+    return bench_now_ns() - start;
+}
+
+/**
+ * @brief The history view ends with the samples just captured, unaltered
+ *        in the packed layout
+ * @return 0 if it does
+ */
+static int bench_ecg_history_check(ecg_recording_t const *rec, uint32_t captured) {
+    ads1292r_ecg_view_t view;
+    ads1292r_get_ecg_view(&view);
+    uint32_t total = view.count[0] + view.count[1];
+    if (total == 0) {
+        return -1;
+    }
+    if (view.format != ADS1292R_ECG_FORMAT_PACKED24) {
+        return 0;
+    }
+    uint32_t check = (total < captured) ? total : captured;
+    for (uint32_t i = 0; i < check; i++) {
+        int32_t expected = rec->samples[(captured - check + i) % rec->count];
+        if (ads1292r_ecg_view_sample(&view, (uint16_t)(total - check + i)) != expected) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void bench_ecg_cycles(ecg_recording_t const *rec) {
+    uint32_t cycles = 0, valid = 0, history_errors = 0;
+    uint64_t busy_ns = 0;
+    uint32_t measured_samples = 0;
+    double abs_error = 0, max_error = 0;
+
+    for (uint32_t base = BENCH_ECG_WARMUP; base + BENCH_CAPTURE_SAMPLES < rec->count;
+         base += BENCH_CYCLE_PERIOD) {
+        uint32_t n = base;
+
+        m_ads_ready = false;
+        m_ads_done = false;
+        if (ads1292r_power_on(bench_ads_ready) != 0) {
+            break;
+        }
+        while (!m_ads_ready) {
+            host_time_advance_us(1000000 / BENCH_ECG_FS);
+            ads1292r_process();
+        }
+        if (ads1292r_start_ecg(bench_ads_done) != 0) {
+            ads1292r_power_off();
+            break;
+        }
+        // Capture starts at the next block boundary of the trace
+        while (!m_ads_done && n < rec->count) {
+            busy_ns += bench_ads_feed(rec, n - base);
+            n++;
+        }
+        ads1292r_power_off();
+        if (!m_ads_done) {
+            break;
+        }
+
+        uint32_t captured = n - base;
+        uint16_t systolic, diastolic;
+        if (bench_ecg_history_check(rec, captured) != 0) {
+            history_errors++;
+        }
+        cycles++;
+        measured_samples += captured;
+        if (ads1292r_get_bp(&systolic, &diastolic) != 0) {
+            continue;
+        }
+
+        double reference = bench_reference_hr(rec, base, n);
+        double error = fabs(qrs_detector_heart_rate() - reference);
+        if (reference > 0) {
+            valid++;
+            abs_error += error;
+            if (error > max_error) {
+                max_error = error;
+            }
+        }
+    }
+
+    printf("cycle   %-28s %8u cycles  %5u valid  HR MAE %5.1f BPM  max %5.1f  %7.1f ns/sample\n",
+           rec->name, cycles, valid, valid ? abs_error / valid : 0.0, max_error,
+           measured_samples ? (double)busy_ns / measured_samples : 0.0);
+    if (history_errors > 0) {
+        printf("cycle   %-28s %8u of %u histories differ from the capture\n", rec->name,
+               history_errors, cycles);
+        m_failures++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * ECG: compressed stream round trip
+ * ------------------------------------------------------------------------ */
+
+static int32_t const *m_stream_reference;
+static uint32_t m_stream_reference_count;
+static uint32_t m_stream_bytes;
+static uint32_t m_stream_chunks;
+static uint32_t m_stream_decoded;
+static uint32_t m_stream_errors;
+
+typedef struct {
+    uint8_t const *p_buf;
+    uint32_t size_bits;
+    uint32_t bit_pos;
+} bit_reader_t;
+
+static uint32_t bench_bits_get(bit_reader_t *r, uint8_t bits) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bits && r->bit_pos < r->size_bits; i++, r->bit_pos++) {
+        if (r->p_buf[r->bit_pos >> 3] & (1 << (r->bit_pos & 7))) {
+            value |= (1UL << i);
+        }
+    }
+    return value;
+}
+
+static int32_t bench_get24(uint8_t const *p) {
+    return ((int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24)) >> 8;
+}
+
+/**
+ * @brief Decode one chunk and compare it with the samples that were fed
+ */
+static void bench_stream_check(uint8_t const *data, uint16_t length) {
+    if (length < ECG_STREAM_HEADER_SIZE + 2 || data[0] != ECG_STREAM_SYNC ||
+        data[1] != ECG_STREAM_VERSION ||
+        crc16_compute(data, length - 2, NULL) != (data[length - 2] | (data[length - 1] << 8))) {
+        m_stream_errors++;
+        return;
+    }
+
+    uint32_t first = data[8] | (data[9] << 8) | (data[10] << 16) | ((uint32_t)data[11] << 24);
+    uint8_t count = data[12];
+    uint8_t k = data[13];
+    int32_t x[2] = { bench_get24(&data[14]), bench_get24(&data[17]) };
+    bit_reader_t r = { &data[ECG_STREAM_HEADER_SIZE], (uint32_t)(length - ECG_STREAM_HEADER_SIZE - 2) * 8, 0 };
+
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t sample;
+        if (i < 2) {
+            sample = x[i];
+        } else {
+            uint32_t q = 0;
+            while (q < 24 && bench_bits_get(&r, 1)) {
+                q++;
+            }
+            uint32_t code = (q == 24) ? bench_bits_get(&r, 27) : (q << k) | bench_bits_get(&r, k);
+            int32_t residual = (int32_t)(code >> 1) ^ -(int32_t)(code & 1);
+            sample = residual + 2 * x[1] - x[0];
+            x[0] = x[1];
+            x[1] = sample;
+        }
+        uint32_t index = first + i;
+        if (index >= m_stream_reference_count || m_stream_reference[index] != sample) {
+            m_stream_errors++;
+            return;
+        }
+    }
+    m_stream_decoded += count;
+}
+
+/**
+ * @brief Radio stand-in for ecg_stream.c; every frame is accepted, a chunk
+ *        allowed on LoRa counts as an error
+ */
+int communication_send_on(uint8_t const *data, uint16_t length, uint8_t links,
+                          communication_tx_handler_t handler, void *p_context) {
+    if (links != TRANSPORT_LINK_MASK(TRANSPORT_LINK_BLE)) {
+        m_stream_errors++;
+    }
+    m_stream_bytes += length;
+    m_stream_chunks++;
+    bench_stream_check(data, length);
+    if (handler) {
+        handler(true, p_context);
+    }
+    return 0;
+}
+
+static void bench_ecg_stream(ecg_recording_t const *rec) {
+    // Whole blocks only; the stream is fed 50 samples at a time
+    uint32_t count = rec->count - rec->count % BENCH_BLOCK_SAMPLES;
+    uint64_t busy_ns = 0;
+
+    m_stream_reference = rec->samples;
+    m_stream_reference_count = count;
+    m_stream_bytes = 0;
+    m_stream_chunks = 0;
+    m_stream_decoded = 0;
+    m_stream_errors = 0;
+
+    if (ecg_stream_start(TRANSPORT_BLE_PACKET_BYTES) != 0) {
+        printf("stream  %-28s failed to start\n", rec->name);
+        m_failures++;
+        return;
+    }
+    for (uint32_t n = 0; n < count; n++) {
+        busy_ns += bench_ads_feed(rec, n);
+    }
+    ecg_stream_stop();
+
+    bool lossless = (m_stream_errors == 0) && (m_stream_decoded == count);
+    printf("stream  %-28s %8u chunks  %5.2f bits/sample  %s  %7.1f ns/sample\n",
+           rec->name, m_stream_chunks, 8.0 * m_stream_bytes / count,
+           lossless ? "lossless" : "MISMATCH", (double)busy_ns / count);
+    if (!lossless) {
+        m_failures++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Fall detection
+ * ------------------------------------------------------------------------ */
+
+static uint32_t m_fall_events;
+static uint32_t m_still_events;
+static uint32_t m_recovered_events;
+
+static void bench_fall_evt(icm42688_evt_t evt, uint32_t impact_mag_sq) {
+    (void)impact_mag_sq;
+    switch (evt) {
+        case ICM42688_EVT_FALL:         m_fall_events++;      break;
+        case ICM42688_EVT_NO_MOVEMENT:  m_still_events++;     break;
+        case ICM42688_EVT_RECOVERED:    m_recovered_events++; break;
+    }
+}
+
+typedef struct {
+    uint32_t tp;
+    uint32_t fn;
+    uint32_t fp;
+    uint32_t tn;
+    uint64_t busy_ns;
+    uint64_t samples;
+} fall_score_t;
+
+static void bench_fall(fall_recording_t const *rec, fall_score_t *score) {
+    m_fall_events = 0;
+    m_still_events = 0;
+    m_recovered_events = 0;
+
+    if (icm42688_fall_monitor_start(bench_fall_evt) != 0) {
+        printf("fall    %-28s monitor failed to start\n", rec->name);
+        m_failures++;
+        return;
+    }
+
+    uint64_t busy_ns = 0;
+    for (uint32_t n = 0; n < rec->count; n++) {
+        icm42688_model_sample(rec->accel[n][0], rec->accel[n][1], rec->accel[n][2]);
+        host_time_advance_us(1000000 / BENCH_IMU_FS);
+
+        uint64_t start = bench_now_ns();
+        icm42688_process();
+        busy_ns += bench_now_ns() - start;
+    }
+    icm42688_fall_monitor_stop();
+
+    bool detected = (m_fall_events > 0);
+    if (rec->fall) {
+        detected ? score->tp++ : score->fn++;
+    } else {
+        detected ? score->fp++ : score->tn++;
+    }
+    score->busy_ns += busy_ns;
+    score->samples += rec->count;
+
+    printf("fall    %-28s %8u samples  label %-7s falls %u still %u recovered %u  %s  %7.1f ns/sample\n",
+           rec->name, rec->count, rec->fall ? "fall" : "no-fall", m_fall_events, m_still_events,
+           m_recovered_events, (detected == rec->fall) ? "ok" : "MISS",
+           (double)busy_ns / rec->count);
+}
+
+/* ---------------------------------------------------------------------------
+ * Health classification
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    char const      *name;
+    vital_signs_t   vitals;
+    health_status_t expected;
+} health_case_t;
+
+#define BENCH_TEMP(cdeg)    TMP117_RAW_FROM_CDEG(cdeg)
+#define BENCH_NORMAL_VITALS .spo2 = 97, .heart_rate = 72, .bp_systolic = 120, .bp_diastolic = 80, \
+                            .temp_raw = BENCH_TEMP(3680), .ppg_valid = true, .ecg_valid = true
+
+static const health_case_t m_health_cases[] = {
+    { "normal",              { BENCH_NORMAL_VITALS },                                   HEALTH_NORMAL },
+    { "spo2 low",            { BENCH_NORMAL_VITALS, .spo2 = 90 },                       HEALTH_WARNING },
+    { "spo2 critical",       { BENCH_NORMAL_VITALS, .spo2 = 80 },                       HEALTH_EMERGENCY },
+    { "spo2 without pulse",  { BENCH_NORMAL_VITALS, .spo2 = 80, .ppg_valid = false },   HEALTH_NORMAL },
+    { "hr high",             { BENCH_NORMAL_VITALS, .heart_rate = 130 },                HEALTH_WARNING },
+    { "hr critical",         { BENCH_NORMAL_VITALS, .heart_rate = 160 },                HEALTH_EMERGENCY },
+    { "hr low critical",     { BENCH_NORMAL_VITALS, .heart_rate = 35 },                 HEALTH_EMERGENCY },
+    { "temp high",           { BENCH_NORMAL_VITALS, .temp_raw = BENCH_TEMP(3900) },     HEALTH_WARNING },
+    { "temp critical",       { BENCH_NORMAL_VITALS, .temp_raw = BENCH_TEMP(4050) },     HEALTH_EMERGENCY },
+    { "hypothermia",         { BENCH_NORMAL_VITALS, .temp_raw = BENCH_TEMP(3400) },     HEALTH_EMERGENCY },
+    { "bp high",             { BENCH_NORMAL_VITALS, .bp_systolic = 170 },               HEALTH_WARNING },
+    { "bp without ecg",      { BENCH_NORMAL_VITALS, .bp_systolic = 170, .ecg_valid = false }, HEALTH_NORMAL },
+    { "two warnings",        { BENCH_NORMAL_VITALS, .spo2 = 90, .heart_rate = 130 },    HEALTH_CRITICAL },
+    { "fall",                { BENCH_NORMAL_VITALS, .fall_detected = true },            HEALTH_EMERGENCY },
+    { "fall, no movement",   { BENCH_NORMAL_VITALS, .fall_detected = true, .no_movement = true }, HEALTH_EMERGENCY },
+};
+
+#define BENCH_HEALTH_CASES  (sizeof(m_health_cases) / sizeof(m_health_cases[0]))
+
+static void bench_health(void) {
+    uint32_t passed = 0;
+    volatile health_status_t sink;
+
+    for (uint32_t i = 0; i < BENCH_HEALTH_CASES; i++) {
+        health_status_t status = health_analyze(&m_health_cases[i].vitals);
+        if (status == m_health_cases[i].expected) {
+            passed++;
+        } else {
+            printf("health  %-28s expected %d got %d\n", m_health_cases[i].name,
+                   m_health_cases[i].expected, status);
+            m_failures++;
+        }
+    }
+
+    // Time the decisions, not the log formatting
+    host_log_enable(false);
+    uint64_t start = bench_now_ns();
+    for (uint32_t round = 0; round < BENCH_HEALTH_ROUNDS; round++) {
+        for (uint32_t i = 0; i < BENCH_HEALTH_CASES; i++) {
+            sink = health_analyze(&m_health_cases[i].vitals);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    host_log_enable(m_verbose);
+    (void)sink;
+
+    printf("health  %-28s %8u/%u cases pass  %7.1f ns/call\n", "table", passed,
+           (unsigned)BENCH_HEALTH_CASES, (double)elapsed / (BENCH_HEALTH_ROUNDS * BENCH_HEALTH_CASES));
+}
+
+/* ---------------------------------------------------------------------------
+ * HRV: features of synthetic rhythms
+ * ------------------------------------------------------------------------ */
+
+#define BENCH_HRV_CAPTURES      40
+#define BENCH_HRV_CAPTURE_RR    8       // QRS_MAX_RR
+#define BENCH_HRV_ROUNDS        2000
+#define BENCH_HRV_TOLERANCE_MS  2.0
+
+typedef enum {
+    BENCH_RHYTHM_SINUS,                 // Respiratory variation and jitter
+    BENCH_RHYTHM_ECTOPIC,               // Sinus with a premature beat every 10th
+    BENCH_RHYTHM_AF
+} bench_rhythm_t;
+
+typedef struct {
+    char const    *name;
+    bench_rhythm_t rhythm;
+    int16_t        ectopic;             // Expected ectopic intervals, -1 for any
+    bool           af;                  // Expected to score as AF
+} hrv_case_t;
+
+static const hrv_case_t m_hrv_cases[] = {
+    { "sinus",          BENCH_RHYTHM_SINUS,   0,  false },
+    { "ectopic beats",  BENCH_RHYTHM_ECTOPIC, 64, false },
+    { "af",             BENCH_RHYTHM_AF,      -1, true  },
+};
+
+#define BENCH_HRV_AF_THRESHOLD  128     // Half the successive intervals irregular
+
+static uint16_t bench_hrv_rr(bench_rhythm_t rhythm, uint32_t beat, double *t_s) {
+    double base = 850.0 + 40.0 * sin(2 * M_PI * *t_s / 4.0) + 10.0 * bench_gauss();
+    double rr = base;
+    if (rhythm == BENCH_RHYTHM_ECTOPIC && beat % 10 == 8) {
+        rr = 0.6 * base;                // Premature beat
+    } else if (rhythm == BENCH_RHYTHM_ECTOPIC && beat % 10 == 9) {
+        rr = 1.4 * base;                // Compensatory pause
+    } else if (rhythm == BENCH_RHYTHM_AF) {
+        rr = 400.0 + 600.0 * bench_uniform();
+    }
+    *t_s += rr / 1000.0;
+    return (uint16_t)lround(rr);
+}
+
+static void bench_hrv(void) {
+    static uint16_t rr[BENCH_HRV_CAPTURES][BENCH_HRV_CAPTURE_RR];
+
+    for (uint8_t c = 0; c < sizeof(m_hrv_cases) / sizeof(m_hrv_cases[0]); c++) {
+        hrv_case_t const *hc = &m_hrv_cases[c];
+        double t_s = 0, sum = 0, sum_sq = 0, diff_sq = 0;
+        uint32_t beat = 0, nn = 0, diffs = 0;
+
+        for (uint32_t k = 0; k < BENCH_HRV_CAPTURES; k++) {
+            for (uint32_t i = 0; i < BENCH_HRV_CAPTURE_RR; i++, beat++) {
+                rr[k][i] = bench_hrv_rr(hc->rhythm, beat, &t_s);
+            }
+        }
+
+        // Floating-point reference over the sinus intervals, as hrv.c splits them
+        for (uint32_t k = 0; k < BENCH_HRV_CAPTURES; k++) {
+            for (uint32_t i = 0, b = k * BENCH_HRV_CAPTURE_RR; i < BENCH_HRV_CAPTURE_RR; i++, b++) {
+                bool normal = (hc->rhythm != BENCH_RHYTHM_ECTOPIC || b % 10 < 8);
+                if (normal) {
+                    nn++;
+                    sum += rr[k][i];
+                    sum_sq += (double)rr[k][i] * rr[k][i];
+                }
+                bool prev_normal = (hc->rhythm != BENCH_RHYTHM_ECTOPIC || (b - 1) % 10 < 8);
+                if (i > 0 && normal && prev_normal) {
+                    double d = (double)rr[k][i] - rr[k][i - 1];
+                    diffs++;
+                    diff_sq += d * d;
+                }
+            }
+        }
+        double sdnn = sqrt((sum_sq - sum * sum / nn) / (nn - 1));
+        double rmssd = diffs ? sqrt(diff_sq / diffs) : 0;
+
+        hrv_features_t f = { 0 };
+        hrv_init();
+        uint64_t start = bench_now_ns();
+        for (uint32_t round = 0; round < BENCH_HRV_ROUNDS; round++) {
+            for (uint32_t k = 0; k < BENCH_HRV_CAPTURES; k++) {
+                hrv_add_capture(rr[k], BENCH_HRV_CAPTURE_RR);
+            }
+            hrv_snapshot(&f);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        bool ok = (hc->ectopic < 0 || f.ectopic == hc->ectopic) &&
+                  ((f.af_score >= BENCH_HRV_AF_THRESHOLD) == hc->af);
+        if (hc->rhythm != BENCH_RHYTHM_AF) {
+            ok = ok && fabs(f.sdnn_ms - sdnn) <= BENCH_HRV_TOLERANCE_MS &&
+                 fabs(f.rmssd_ms - rmssd) <= BENCH_HRV_TOLERANCE_MS;
+        }
+        // The reference only knows which intervals are sinus for the sinus rhythms
+        char sdnn_ref[8] = "  -  ", rmssd_ref[8] = "  -  ";
+        if (hc->rhythm != BENCH_RHYTHM_AF) {
+            snprintf(sdnn_ref, sizeof(sdnn_ref), "%5.1f", sdnn);
+            snprintf(rmssd_ref, sizeof(rmssd_ref), "%5.1f", rmssd);
+        }
+        printf("hrv     %-28s %8u beats  SDNN %3u (%s) RMSSD %3u (%s) pNN50 %3u%%  ectopic %3u  AF %3u  %s  %5.1f ns/beat\n",
+               hc->name, f.beats, f.sdnn_ms, sdnn_ref, f.rmssd_ms, rmssd_ref, f.pnn50_pct, f.ectopic, f.af_score,
+               ok ? "ok" : "FAILED",
+               (double)elapsed / ((double)BENCH_HRV_ROUNDS * BENCH_HRV_CAPTURES * BENCH_HRV_CAPTURE_RR));
+        if (!ok) {
+            m_failures++;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * PTT: R peak to pulse foot pairing on drifting sensor clocks
+ * ------------------------------------------------------------------------ */
+
+#define BENCH_PTT_WINDOWS       50
+#define BENCH_PTT_WINDOW_US     4000000.0
+#define BENCH_PTT_ECG_PERIOD_US 2020.0      // 1% slow against the data sheet
+#define BENCH_PTT_PPG_PERIOD_US 9800.0      // 2% fast
+#define BENCH_PTT_US            250000.0
+#define BENCH_PTT_JITTER_US     3000.0
+#define BENCH_PTT_STEP_US       20000.0     // Shortening after calibration
+#define BENCH_PTT_MAX_ERROR_US  5000.0      // Half a PPG sample
+
+typedef struct {
+    ptt_clock_t clock;
+    double      start_us;               // Time of sample 0
+    double      period_us;
+    uint32_t    every;                  // Samples per anchor: DMA block or FIFO threshold
+    uint32_t    next;
+} bench_ptt_sensor_t;
+
+static void bench_ptt_sensor(bench_ptt_sensor_t *s, uint32_t nominal_us, double period_us, uint32_t every) {
+    ptt_clock_reset(&s->clock, nominal_us);
+    s->start_us = 1000.0 * bench_uniform();
+    s->period_us = period_us;
+    s->every = every;
+    s->next = every - 1;
+}
+
+/**
+ * @brief Event at true time t on the sensor's sample grid, after the
+ *        anchors the driver would have taken by then
+ */
+static void bench_ptt_event(bench_ptt_sensor_t *s, ptt_source_t source, double t_us) {
+    while (s->start_us + s->next * s->period_us <= t_us) {
+        ptt_clock_anchor(&s->clock, s->next, (uint32_t)(s->start_us + s->next * s->period_us));
+        s->next += s->every;
+    }
+    uint32_t index = (uint32_t)lround((t_us - s->start_us) / s->period_us);
+    ptt_event(source, ptt_clock_time(&s->clock, index));
+}
+
+/**
+ * @brief One measurement window of beats at the given PTT
+ * @return Measured PTT (us), -1 if too few beats paired
+ */
+static double bench_ptt_window(double ptt_us) {
+    bench_ptt_sensor_t ecg, ppg;
+    uint32_t measured;
+
+    ptt_restart();
+    bench_ptt_sensor(&ecg, 2000, BENCH_PTT_ECG_PERIOD_US, 50);
+    bench_ptt_sensor(&ppg, 10000, BENCH_PTT_PPG_PERIOD_US, 30);
+
+    for (double t = 200000.0 + 100000.0 * bench_uniform();
+         t + ptt_us < BENCH_PTT_WINDOW_US; t += 800000.0 + 40000.0 * bench_gauss()) {
+        bench_ptt_event(&ecg, PTT_SOURCE_ECG, t);
+        bench_ptt_event(&ppg, PTT_SOURCE_PPG, t + ptt_us + BENCH_PTT_JITTER_US * bench_gauss());
+    }
+    return (ptt_measure(&measured) == 0) ? (double)measured : -1.0;
+}
+
+static void bench_ptt(void) {
+    uint32_t valid = 0;
+    double abs_sum = 0, abs_max = 0;
+
+    for (uint32_t i = 0; i < BENCH_PTT_WINDOWS; i++) {
+        double measured = bench_ptt_window(BENCH_PTT_US);
+        if (measured < 0) {
+            continue;
+        }
+        valid++;
+        abs_sum += fabs(measured - BENCH_PTT_US);
+        abs_max = fmax(abs_max, fabs(measured - BENCH_PTT_US));
+    }
+    double mae = valid ? abs_sum / valid : 0;
+    bool ok = (valid == BENCH_PTT_WINDOWS && mae <= BENCH_PTT_MAX_ERROR_US);
+    printf("ptt     %-28s %8u windows %4u valid  PTT MAE %5.1f ms  max %5.1f  %s\n", "drifting clocks",
+           BENCH_PTT_WINDOWS, valid, mae / 1000, abs_max / 1000, ok ? "ok" : "FAILED");
+
+    // Calibrate at 120/80, then the transit shortens
+    uint16_t sys = 0, dia = 0;
+    bench_ptt_window(BENCH_PTT_US);
+    int calibrated = ptt_calibrate(120, 80);
+    bench_ptt_window(BENCH_PTT_US - BENCH_PTT_STEP_US);
+    bool rises = (calibrated == 0 && ptt_get_bp(&sys, &dia) == 0 && sys > 120 && dia > 80);
+    printf("ptt     %-28s %8.0f ms shorter  BP 120/80 -> %u/%u mmHg  %s\n", "after calibration",
+           BENCH_PTT_STEP_US / 1000, sys, dia, rises ? "ok" : "FAILED");
+
+    if (!ok || !rises) {
+        m_failures++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Trend engine: escalations on noisy readings
+ * ------------------------------------------------------------------------ */
+
+#define BENCH_TREND_HOURS       4
+#define BENCH_DESAT_ONSET_MS    (20UL * 60 * 1000)
+#define BENCH_DESAT_RATE        1.0     // SpO2 points per minute
+#define BENCH_DESAT_FLOOR       80.0
+
+typedef struct {
+    uint32_t readings;
+    uint32_t escalated_ms;              // Time spent below the normal interval
+    int32_t  detect_ms;                 // Desaturation below 85% to EMERGENCY, -1 if missed
+} trend_run_t;
+
+/**
+ * @brief Readings as the simulation produces them, optionally with a real
+ *        desaturation from BENCH_DESAT_ONSET_MS on
+ * @note The noise depends on the time of the reading only, so runs that
+ *       sample at different intervals still see the same signal
+ */
+static void bench_trend_vitals(uint32_t t_ms, bool desat, vital_signs_t *v) {
+    m_rng = 0x12345678u ^ (t_ms * 2654435761u);
+    double spo2 = 95 + 5 * bench_uniform();
+
+    memset(v, 0, sizeof(*v));
+    if (desat && t_ms > BENCH_DESAT_ONSET_MS) {
+        double drop = BENCH_DESAT_RATE * (t_ms - BENCH_DESAT_ONSET_MS) / 60000.0;
+        spo2 = fmax(97.0 - drop, BENCH_DESAT_FLOOR) + bench_gauss();
+    }
+    v->heart_rate = 70 + (uint16_t)(20 * bench_uniform());
+    v->bp_systolic = 110 + (uint16_t)(20 * bench_uniform());
+    v->bp_diastolic = 75;
+    v->temp_raw = BENCH_TEMP(3620 + (int)(100 * bench_uniform()));
+    v->ppg_valid = true;
+    v->ecg_valid = true;
+
+    // One-off anomalies of the simulation, plus the odd motion artefact
+    double anomaly = bench_uniform();
+    if (anomaly < 1.0 / 8) {
+        spo2 = 87 + 5 * bench_uniform();
+    }
+    if (bench_uniform() < 1.0 / 12) {
+        v->heart_rate = 122 + (uint16_t)(13 * bench_uniform());
+    }
+    if (anomaly > 1.0 - 1.0 / 53) {
+        spo2 = 80;
+    }
+    v->spo2 = (uint8_t)fmin(fmax(spo2, 0), 100);
+    v->timestamp = APP_TIMER_TICKS(t_ms) & 0x00FFFFFF;
+}
+
+/**
+ * @brief Monitoring interval the state machine in main.c picks for a status
+ */
+static uint32_t bench_trend_interval(health_status_t status, uint8_t *anomalies, uint32_t interval) {
+    switch (status) {
+        case HEALTH_NORMAL:
+            *anomalies = 0;
+            return 35000;
+        case HEALTH_WARNING:
+            return (++*anomalies >= 2) ? 10000 : interval;
+        case HEALTH_CRITICAL:
+            return 10000;
+        default:
+            return 5000;
+    }
+}
+
+static void bench_trend_run(bool use_trend, bool desat, trend_run_t *run) {
+    uint32_t interval = 35000;
+    uint8_t anomalies = 0;
+    int64_t severe_at = -1;
+    vital_signs_t v;
+
+    memset(run, 0, sizeof(*run));
+    run->detect_ms = -1;
+    trend_init();
+
+    for (uint32_t t = 0; t < BENCH_TREND_HOURS * 3600000UL; t += interval) {
+        run->readings++;
+        bench_trend_vitals(t, desat, &v);
+        health_status_t status = use_trend ? trend_update(&v) : health_analyze(&v);
+
+        if (desat && severe_at < 0 &&
+            97.0 - BENCH_DESAT_RATE * ((double)t - BENCH_DESAT_ONSET_MS) / 60000.0 < SPO2_MIN_CRITICAL) {
+            severe_at = t;
+        }
+        if (severe_at >= 0 && run->detect_ms < 0 && status == HEALTH_EMERGENCY) {
+            run->detect_ms = (int32_t)(t - severe_at);
+        }
+
+        interval = bench_trend_interval(status, &anomalies, interval);
+        if (interval < 35000) {
+            run->escalated_ms += interval;
+        }
+    }
+}
+
+static void bench_trend(void) {
+    static const struct { char const *name; bool desat; } scenarios[] = {
+        { "noisy readings", false },
+        { "desaturation", true },
+    };
+
+    host_log_enable(false);
+    for (uint8_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        trend_run_t instant, trend;
+        bench_trend_run(false, scenarios[i].desat, &instant);
+        bench_trend_run(true, scenarios[i].desat, &trend);
+
+        printf("trend   %-28s readings/h %5.1f -> %5.1f  escalated %4.1f%% -> %4.1f%%",
+               scenarios[i].name, (double)instant.readings / BENCH_TREND_HOURS,
+               (double)trend.readings / BENCH_TREND_HOURS,
+               100.0 * instant.escalated_ms / (BENCH_TREND_HOURS * 3600000.0),
+               100.0 * trend.escalated_ms / (BENCH_TREND_HOURS * 3600000.0));
+        if (scenarios[i].desat) {
+            printf("  detected after %d s -> %d s", instant.detect_ms / 1000, trend.detect_ms / 1000);
+            if (trend.detect_ms < 0 || trend.detect_ms > instant.detect_ms) {
+                printf("  SLOWER");
+                m_failures++;
+            }
+        }
+        printf("\n");
+    }
+    host_log_enable(m_verbose);
+}
+
+/* ---------------------------------------------------------------------------
+ * Link: BLE and LoRa selection as the miner leaves a BLE relay behind
+ * ------------------------------------------------------------------------ */
+
+#define BENCH_LINK_FRAMES       400     // Per phase, every 10th an emergency
+#define BENCH_LINK_BYTES        120
+#define BENCH_LINK_ATTEMPTS     4       // COMM_MAX_ATTEMPTS
+#define BENCH_LINK_BLE_ACK_MS   15.0    // Connection event to the relay and back
+#define BENCH_LINK_LORA_ACK_MS  200.0   // Gateway turnaround
+#define BENCH_LINK_MIN_DELIVERY 0.02    // May deliver this much less than both links always
+
+typedef struct {
+    char const *name;
+    double      ble_ack;                // Chance a BLE attempt is ACKed
+    int8_t      ble_rssi_dbm;
+    double      lora_snr_db;            // At the gateway
+} link_phase_t;
+
+static const link_phase_t m_link_phases[] = {
+    { "relay in range",     0.98, -65,   8.0 },
+    { "relay at the edge",  0.60, -84,  -2.0 },
+    { "relay out of range", 0.00, -100, -12.0 },
+    { "back in range",      0.98, -65,   8.0 },
+};
+
+typedef struct {
+    uint32_t frames;
+    uint32_t delivered;
+    double   charge_uc;
+    uint32_t on_link[TRANSPORT_LINK_COUNT];     // Attempts
+    uint32_t alarms;
+    uint32_t alarms_acked;
+    double   alarm_ms;                          // Sum of first ACK times
+} link_run_t;
+
+/**
+ * @brief Chance a LoRa frame is ACKed with this much SNR over the SF floor
+ */
+static double bench_link_lora_p(double margin_db) {
+    if (margin_db >= 2.0) {
+        return 0.98;
+    }
+    if (margin_db >= 0.0) {
+        return 0.7;
+    }
+    return (margin_db >= -2.0) ? 0.3 : 0.02;
+}
+
+/**
+ * @brief One attempt on a link: ACK, its time after the start and the charge
+ */
+static bool bench_link_try(transport_link_t link, link_phase_t const *ph, double *ack_ms,
+                           double *charge_uc, int8_t *rssi_dbm, int8_t *snr_db) {
+    double airtime_ms = transport_airtime_us(link, BENCH_LINK_BYTES) / 1000.0;
+
+    *rssi_dbm = TRANSPORT_SIGNAL_UNKNOWN;
+    *snr_db = TRANSPORT_SIGNAL_UNKNOWN;
+    if (link == TRANSPORT_LINK_BLE) {
+        *ack_ms = airtime_ms + BENCH_LINK_BLE_ACK_MS;
+        *charge_uc = airtime_ms * TRANSPORT_BLE_TX_MA;
+        *rssi_dbm = (int8_t)lround(ph->ble_rssi_dbm + 2.0 * bench_gauss());
+        return bench_uniform() < ph->ble_ack;
+    }
+
+    static const double floor_db[] = { -7.5, -10.0, -12.5, -15.0, -17.5, -20.0 };
+    double snr = ph->lora_snr_db + 1.5 * bench_gauss();
+    *ack_ms = 2.0 * airtime_ms + BENCH_LINK_LORA_ACK_MS;
+    *charge_uc = airtime_ms * TRANSPORT_LORA_TX_MA;
+    *snr_db = (int8_t)lround(snr);
+    return bench_uniform() < bench_link_lora_p(snr - floor_db[transport_lora_sf() - TRANSPORT_LORA_SF_MIN]);
+}
+
+/**
+ * @brief Send one frame as communication.c does: retries, and for an
+ *        emergency every link at once until the first ACK
+ * @param adaptive Links from transport_select(), else both links every time
+ */
+static void bench_link_frame(link_phase_t const *ph, bool emergency, bool adaptive, link_run_t *run) {
+    run->frames++;
+    for (uint8_t attempt = 0; attempt < BENCH_LINK_ATTEMPTS; attempt++) {
+        uint8_t links = adaptive ? transport_select(BENCH_LINK_BYTES, emergency) : TRANSPORT_ALL_LINKS;
+        double ack_ms[TRANSPORT_LINK_COUNT], charge_uc[TRANSPORT_LINK_COUNT];
+        bool acked[TRANSPORT_LINK_COUNT];
+        int8_t rssi[TRANSPORT_LINK_COUNT], snr[TRANSPORT_LINK_COUNT];
+        double first_ms = INFINITY;
+
+        for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+            acked[i] = false;
+            if (links & TRANSPORT_LINK_MASK(i)) {
+                acked[i] = bench_link_try((transport_link_t)i, ph, &ack_ms[i], &charge_uc[i], &rssi[i], &snr[i]);
+                run->on_link[i]++;
+                if (acked[i] && ack_ms[i] < first_ms) {
+                    first_ms = ack_ms[i];
+                }
+            }
+        }
+
+        // Links still on air at the first ACK are stopped there and not reported
+        for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+            if (!(links & TRANSPORT_LINK_MASK(i))) {
+                continue;
+            }
+            bool cancelled = adaptive && links != TRANSPORT_LINK_MASK(i) && ack_ms[i] > first_ms;
+            double airtime_ms = transport_airtime_us((transport_link_t)i, BENCH_LINK_BYTES) / 1000.0;
+            run->charge_uc += cancelled ? charge_uc[i] * fmin(1.0, first_ms / airtime_ms) : charge_uc[i];
+            if (adaptive && !cancelled) {
+                transport_report((transport_link_t)i, acked[i], (uint32_t)lround(ack_ms[i]), rssi[i], snr[i]);
+            }
+        }
+
+        if (isfinite(first_ms)) {
+            run->delivered++;
+            if (emergency && attempt == 0) {
+                run->alarms_acked++;
+                run->alarm_ms += first_ms;
+            }
+            break;
+        }
+    }
+    if (emergency) {
+        run->alarms++;
+    }
+}
+
+static void bench_link(void) {
+    transport_init();
+
+    for (uint8_t p = 0; p < sizeof(m_link_phases) / sizeof(m_link_phases[0]); p++) {
+        link_phase_t const *ph = &m_link_phases[p];
+        link_run_t adaptive = { 0 }, both = { 0 };
+
+        for (uint32_t n = 0; n < BENCH_LINK_FRAMES; n++) {
+            bench_link_frame(ph, n % 10 == 9, true, &adaptive);
+        }
+        // Same SF, no state kept: what sending on both radios every time costs
+        for (uint32_t n = 0; n < BENCH_LINK_FRAMES; n++) {
+            bench_link_frame(ph, n % 10 == 9, false, &both);
+        }
+
+        double delivered = (double)adaptive.delivered / adaptive.frames;
+        double both_delivered = (double)both.delivered / both.frames;
+        uint32_t tries = adaptive.on_link[TRANSPORT_LINK_BLE] + adaptive.on_link[TRANSPORT_LINK_LORA];
+        bool ok = delivered >= both_delivered - BENCH_LINK_MIN_DELIVERY && adaptive.charge_uc < both.charge_uc;
+
+        printf("link    %-28s %8u frames  delivered %5.1f%% (both links %5.1f%%)  %7.1f uC/frame (%7.1f)"
+               "  BLE %3.0f%%  SF%u  alarm ACK %4.0f ms  %s\n",
+               ph->name, adaptive.frames, 100.0 * delivered, 100.0 * both_delivered,
+               adaptive.charge_uc / adaptive.frames, both.charge_uc / both.frames,
+               tries ? 100.0 * adaptive.on_link[TRANSPORT_LINK_BLE] / tries : 0.0, transport_lora_sf(),
+               adaptive.alarms_acked ? adaptive.alarm_ms / adaptive.alarms_acked : 0.0, ok ? "ok" : "FAILED");
+        if (!ok) {
+            m_failures++;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Telemetry: batch frames encoded into buffers too small for them
+ * ------------------------------------------------------------------------ */
+
+#define BENCH_TELEMETRY_READINGS    TELEMETRY_BATCH_RECORDS
+
+/**
+ * @brief Fill the batch with readings far enough apart to need wide deltas
+ */
+static void bench_telemetry_batch(vital_signs_t *first) {
+    telemetry_init();
+    for (uint8_t i = 0; i < BENCH_TELEMETRY_READINGS; i++) {
+        vital_signs_t v;
+
+        memset(&v, 0, sizeof(v));
+        v.timestamp = APP_TIMER_TICKS(35000UL * i);
+        v.spo2 = (uint8_t)(98 - 3 * i);
+        v.heart_rate = (uint16_t)(70 + 9 * i);
+        v.bp_systolic = (uint16_t)(118 + 5 * i);
+        v.bp_diastolic = (uint16_t)(76 + 3 * i);
+        v.temp_raw = BENCH_TEMP(3680 + 25 * i);
+        v.accel_raw[0] = (int16_t)(400 * i - 1500);
+        v.accel_raw[1] = (int16_t)(-300 * i);
+        v.accel_raw[2] = 2048;
+        v.ppg_valid = true;
+        v.ecg_valid = (i & 1) != 0;
+        v.stale = (i % 4 == 3) ? 0 : VITAL_STALE_TEMP | ((i & 1) ? 0 : VITAL_STALE_ECG);
+        telemetry_add(&v, (uint8_t)(i % 3));
+        if (i == 0) {
+            *first = v;
+        }
+    }
+
+    hrv_features_t hrv = { 60, 30, 35, 12, 1, 20 };
+    profiler_stats_t stats;
+    memset(&stats, 0x5A, sizeof(stats));
+    telemetry_attach_hrv(&hrv);
+    telemetry_attach_stats(&stats);
+}
+
+/**
+ * @brief A frame is whole: fits its buffer, CRC good, header count and
+ *        record 0 as encoded, staleness included
+ */
+static bool bench_telemetry_valid(uint8_t const *frame, uint16_t len, uint16_t size,
+                                  uint8_t records, vital_signs_t const *first) {
+    vital_record_t r0;
+    vital_signs_t v0;
+
+    if (len < TELEMETRY_ALERT_SIZE || len > size || records < 1 || frame[8] != records ||
+        crc16_compute(frame, len - 2, NULL) != (frame[len - 2] | (frame[len - 1] << 8))) {
+        return false;
+    }
+    memcpy(&r0, &frame[TELEMETRY_HEADER_SIZE], sizeof(r0));
+    vitals_unpack(&r0, &v0);
+    return v0.stale == first->stale && v0.spo2 == first->spo2 && v0.timestamp == first->timestamp;
+}
+
+static void bench_telemetry(void) {
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    vital_signs_t first;
+    uint8_t records;
+
+    bench_telemetry_batch(&first);
+    uint16_t full = telemetry_encode(frame, sizeof(frame), 0, &records);
+    bool ok = bench_telemetry_valid(frame, full, sizeof(frame), records, &first) &&
+              records == BENCH_TELEMETRY_READINGS && (frame[9] & TELEMETRY_STATUS_STATS);
+    printf("telem   %-28s %8u records  %3u bytes  %s\n", "full buffer", records, full,
+           ok ? "ok" : "FAIL");
+    if (!ok) {
+        m_failures++;
+    }
+
+    // Every size down to a single-record frame keeps a valid prefix, and
+    // always empties the batch so the caller cannot retry it forever
+    uint16_t sizes_ok = 0, sizes = 0;
+    uint8_t fewest = BENCH_TELEMETRY_READINGS;
+    for (uint16_t size = full - 1; size >= TELEMETRY_ALERT_SIZE; size--) {
+        bench_telemetry_batch(&first);
+        uint16_t len = telemetry_encode(frame, size, 0, &records);
+        sizes++;
+        if (bench_telemetry_valid(frame, len, size, records, &first) && telemetry_count() == 0) {
+            sizes_ok++;
+        }
+        if (records < fewest) {
+            fewest = records;
+        }
+    }
+    bench_telemetry_batch(&first);
+    bool too_small = telemetry_encode(frame, TELEMETRY_ALERT_SIZE - 1, 0, &records) == 0 &&
+                     records == 0 && telemetry_count() == 0;
+
+    ok = (sizes_ok == sizes) && too_small;
+    printf("telem   %-28s %8u/%u sizes whole  down to %u records  %s\n", "undersized buffers",
+           sizes_ok, sizes, fewest, ok ? "ok" : "FAIL");
+    if (!ok) {
+        m_failures++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Main
+ * ------------------------------------------------------------------------ */
+
+static void bench_usage(void) {
+    fprintf(stderr, "usage: host_bench [--ecg rec.csv]... [--fall rec.csv]... [--verbose]\n");
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ecg") == 0 && i + 1 < argc) {
+            if (bench_load_ecg(argv[++i]) != 0) {
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--fall") == 0 && i + 1 < argc) {
+            if (bench_load_fall(argv[++i]) != 0) {
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            m_verbose = true;
+            host_log_enable(true);
+        } else {
+            bench_usage();
+            return 2;
+        }
+    }
+    if (m_ecg_count == 0 && m_fall_count == 0) {
+        bench_synthesize();
+    }
+
+    ads1292r_model_attach();
+    icm42688_model_attach();
+    if (bench_boot() != 0) {
+        fprintf(stderr, "driver init failed against the device models\n");
+        return 2;
+    }
+
+    for (uint8_t i = 0; i < m_ecg_count; i++) {
+        bench_ecg_detector(&m_ecg[i]);
+    }
+    for (uint8_t i = 0; i < m_ecg_count; i++) {
+        bench_ecg_cycles(&m_ecg[i]);
+    }
+    for (uint8_t i = 0; i < m_ecg_count; i++) {
+        bench_ecg_stream(&m_ecg[i]);
+    }
+
+    fall_score_t fall = { 0 };
+    for (uint8_t i = 0; i < m_fall_count; i++) {
+        bench_fall(&m_falls[i], &fall);
+    }
+    if (m_fall_count > 0) {
+        printf("fall    %-28s %8u falls %u/%u detected  %u/%u false alarms  %7.1f ns/sample\n",
+               "total", fall.tp + fall.fn, fall.tp, fall.tp + fall.fn, fall.fp, fall.fp + fall.tn,
+               fall.samples ? (double)fall.busy_ns / fall.samples : 0.0);
+    }
+
+    bench_health();
+    bench_hrv();
+    bench_ptt();
+    bench_trend();
+    bench_link();
+    bench_telemetry();
+
+    return m_failures ? 1 : 0;
+}
\ No newline at end of file
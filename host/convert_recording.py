@@ -0,0 +1,152 @@
+"""
+Miner Health Monitoring System - Recording converter for the host benchmark
+Writes ECG and fall recordings in the text format host_bench replays
+
+Usage:
+    python convert_recording.py mitbih mitdb/100 -o 100.csv
+    python convert_recording.py sisfall SisFall/SA01/F01_SA01_R01.txt -o F01_SA01_R01.csv
+
+mitbih reads a WFDB record (.hea, format 212 .dat, .atr annotations), takes
+the first signal, resamples it to 500 SPS and scales it to ADS1292R counts.
+Beat annotations become a second column of 1 at the R peak.
+
+sisfall reads a SisFall trial, takes the ADXL345 channels (+-16 g, 13 bit),
+averages 200 Hz down to 100 Hz and scales them to ICM-42688 counts. The
+label comes from the file name: F* trials are falls, D* trials are not.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+ECG_FS = 500
+ECG_COUNTS_PER_MV = 20800       # ADS1292R at gain 6, 2.42 V reference
+IMU_COUNTS_PER_G = 2048         # ICM-42688 at +-16 g
+SISFALL_FS = 200
+SISFALL_ADXL345_LSB_PER_G = 256
+
+# WFDB annotation codes that mark a beat
+BEAT_CODES = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 25, 34, 35, 38, 41}
+ANN_SKIP, ANN_NUM, ANN_SUB, ANN_CHN, ANN_AUX = 59, 60, 61, 62, 63
+
+
+def read_header(record):
+    with open(record + '.hea') as f:
+        lines = [l.split() for l in f if l.strip() and not l.startswith('#')]
+    fields = lines[0]
+    nsig, fs = int(fields[1]), float(fields[2].split('/')[0])
+    signals = []
+    for sig in lines[1:1 + nsig]:
+        if sig[1] != '212':
+            raise ValueError('%s: only format 212 is supported, not %s' % (record, sig[1]))
+        gain_field = sig[2].split('/')[0]
+        gain = float(gain_field.split('(')[0]) or 200.0
+        baseline = int(gain_field.split('(')[1].rstrip(')')) if '(' in gain_field else int(sig[4])
+        signals.append({'file': sig[0], 'gain': gain, 'baseline': baseline})
+    return nsig, fs, signals
+
+
+def read_format212(path, nsig, channel):
+    with open(path, 'rb') as f:
+        data = f.read()
+    values = []
+    for i in range(0, len(data) - 2, 3):
+        b0, b1, b2 = data[i], data[i + 1], data[i + 2]
+        for v in (b0 | ((b1 & 0x0F) << 8), b2 | ((b1 & 0xF0) << 4)):
+            values.append(v - 4096 if v & 0x800 else v)
+    return values[channel::nsig]
+
+
+def read_annotations(path):
+    """Sample positions of beat annotations in an MIT-format .atr file"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    beats = []
+    sample = 0
+    pos = 0
+    while pos + 2 <= len(data):
+        word, = struct.unpack_from('<H', data, pos)
+        pos += 2
+        code, interval = word >> 10, word & 0x3FF
+        if code == 0 and interval == 0:
+            break
+        if code == ANN_SKIP:
+            high, low = struct.unpack_from('<HH', data, pos)
+            pos += 4
+            skip = (high << 16) | low
+            sample += skip - (1 << 32) if skip & 0x80000000 else skip
+        elif code == ANN_AUX:
+            pos += (interval + 1) & ~1
+        elif code in (ANN_NUM, ANN_SUB, ANN_CHN):
+            pass
+        else:
+            sample += interval
+            if code in BEAT_CODES:
+                beats.append(sample)
+    return beats
+
+
+def convert_mitbih(record, out):
+    nsig, fs, signals = read_header(record)
+    sig = signals[0]
+    raw = read_format212(os.path.join(os.path.dirname(record), sig['file']), nsig, 0)
+    mv = [(v - sig['baseline']) / sig['gain'] for v in raw]
+
+    count = int(len(mv) * ECG_FS / fs)
+    beats = set()
+    for s in read_annotations(record + '.atr'):
+        beats.add(int(round(s * ECG_FS / fs)))
+
+    out.write('# %s, %d Hz resampled to %d SPS, ADS1292R counts\n' % (record, fs, ECG_FS))
+    for n in range(count):
+        t = n * fs / ECG_FS
+        i = int(t)
+        frac = t - i
+        v = mv[i] if i + 1 >= len(mv) else mv[i] * (1 - frac) + mv[i + 1] * frac
+        counts = int(round(v * ECG_COUNTS_PER_MV))
+        out.write('%d,1\n' % counts if n in beats else '%d\n' % counts)
+
+
+def convert_sisfall(path, out):
+    name = os.path.basename(path)
+    fall = name.upper().startswith('F')
+    rows = []
+    with open(path) as f:
+        for line in f:
+            fields = line.strip().rstrip(';').split(',')
+            if len(fields) < 3:
+                continue
+            try:
+                rows.append([int(v) for v in fields[:3]])
+            except ValueError:
+                continue
+
+    out.write('# %s, ADXL345 %d Hz averaged to 100 Hz, ICM-42688 counts\n' % (name, SISFALL_FS))
+    out.write('# fall=%d\n' % (1 if fall else 0))
+    scale = IMU_COUNTS_PER_G / SISFALL_ADXL345_LSB_PER_G
+    for i in range(0, len(rows) - 1, 2):
+        out.write('%d,%d,%d\n' % tuple(int(round((rows[i][a] + rows[i + 1][a]) / 2 * scale)) for a in range(3)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert public datasets into host_bench recordings')
+    parser.add_argument('format', choices=['mitbih', 'sisfall'])
+    parser.add_argument('source', help='WFDB record path without extension, or SisFall trial file')
+    parser.add_argument('-o', '--output', help='output file, standard output if omitted')
+    args = parser.parse_args()
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    try:
+        if args.format == 'mitbih':
+            convert_mitbih(args.source, out)
+        else:
+            convert_sisfall(args.source, out)
+    finally:
+        if args.output:
+            out.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
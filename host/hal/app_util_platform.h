@@ -0,0 +1,10 @@
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include "sdk_common.h"
+
+// Host build: handlers run synchronously, nothing can preempt a region
+#define CRITICAL_REGION_ENTER()         {
+#define CRITICAL_REGION_EXIT()          }
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef CRC16_H__
+#define CRC16_H__
+
+#include <stdint.h>
+
+uint16_t crc16_compute(uint8_t const *p_data, uint32_t size, uint16_t const *p_crc);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef NRF_H
+#define NRF_H
+
+// Host build: device registers the application code reads
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t DEVICEID[2];
+} NRF_FICR_Type;
+
+typedef struct {
+    volatile uint32_t RESETREAS;
+} NRF_POWER_Type;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern NRF_FICR_Type host_ficr;
+extern NRF_POWER_Type host_power;
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+extern uint32_t SystemCoreClock;
+
+#define NRF_FICR                        (&host_ficr)
+#define NRF_POWER                       (&host_power)
+#define DWT                             (&host_dwt)
+#define CoreDebug                       (&host_core_debug)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+#define POWER_RESETREAS_RESETPIN_Msk    (1UL << 0)
+#define POWER_RESETREAS_DOG_Msk         (1UL << 1)
+#define POWER_RESETREAS_SREQ_Msk        (1UL << 2)
+#define POWER_RESETREAS_LOCKUP_Msk      (1UL << 3)
+
+#endif
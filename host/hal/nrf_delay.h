@@ -0,0 +1,10 @@
+#ifndef NRF_DELAY_H
+#define NRF_DELAY_H
+
+#include "sdk_common.h"
+
+// Host build: delays advance the virtual clock and fire expired app_timers
+void nrf_delay_ms(uint32_t ms_time);
+void nrf_delay_us(uint32_t us_time);
+
+#endif
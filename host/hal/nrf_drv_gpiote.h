@@ -0,0 +1,42 @@
+#ifndef NRF_DRV_GPIOTE_H__
+#define NRF_DRV_GPIOTE_H__
+
+#include "sdk_common.h"
+#include "nrf_gpio.h"
+
+typedef uint32_t nrf_drv_gpiote_pin_t;
+
+typedef enum {
+    NRF_GPIOTE_POLARITY_LOTOHI = 1,
+    NRF_GPIOTE_POLARITY_HITOLO,
+    NRF_GPIOTE_POLARITY_TOGGLE
+} nrf_gpiote_polarity_t;
+
+typedef struct {
+    nrf_gpiote_polarity_t sense;
+    nrf_gpio_pin_pull_t   pull;
+    bool                  is_watcher;
+    bool                  hi_accuracy;
+    bool                  skip_gpio_setup;
+} nrf_drv_gpiote_in_config_t;
+
+#define GPIOTE_CONFIG_IN_SENSE_LOTOHI(hi_accu)  \
+    { NRF_GPIOTE_POLARITY_LOTOHI, NRF_GPIO_PIN_NOPULL, false, hi_accu, false }
+#define GPIOTE_CONFIG_IN_SENSE_HITOLO(hi_accu)  \
+    { NRF_GPIOTE_POLARITY_HITOLO, NRF_GPIO_PIN_NOPULL, false, hi_accu, false }
+#define GPIOTE_CONFIG_IN_SENSE_TOGGLE(hi_accu)  \
+    { NRF_GPIOTE_POLARITY_TOGGLE, NRF_GPIO_PIN_NOPULL, false, hi_accu, false }
+
+typedef void (*nrf_drv_gpiote_evt_handler_t)(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+
+ret_code_t nrf_drv_gpiote_init(void);
+bool nrf_drv_gpiote_is_init(void);
+ret_code_t nrf_drv_gpiote_in_init(nrf_drv_gpiote_pin_t pin, nrf_drv_gpiote_in_config_t const *p_config,
+                                  nrf_drv_gpiote_evt_handler_t evt_handler);
+void nrf_drv_gpiote_in_uninit(nrf_drv_gpiote_pin_t pin);
+void nrf_drv_gpiote_in_event_enable(nrf_drv_gpiote_pin_t pin, bool int_enable);
+void nrf_drv_gpiote_in_event_disable(nrf_drv_gpiote_pin_t pin);
+uint32_t nrf_drv_gpiote_in_event_addr_get(nrf_drv_gpiote_pin_t pin);
+bool nrf_drv_gpiote_in_is_set(nrf_drv_gpiote_pin_t pin);
+
+#endif
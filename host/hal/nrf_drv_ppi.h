@@ -0,0 +1,18 @@
+#ifndef NRF_DRV_PPI_H__
+#define NRF_DRV_PPI_H__
+
+#include "sdk_common.h"
+
+#define HOST_PPI_CHANNELS       20
+
+typedef uint8_t nrf_ppi_channel_t;
+
+ret_code_t nrf_drv_ppi_init(void);
+ret_code_t nrf_drv_ppi_channel_alloc(nrf_ppi_channel_t *p_channel);
+ret_code_t nrf_drv_ppi_channel_free(nrf_ppi_channel_t channel);
+ret_code_t nrf_drv_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep);
+ret_code_t nrf_drv_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep);
+ret_code_t nrf_drv_ppi_channel_enable(nrf_ppi_channel_t channel);
+ret_code_t nrf_drv_ppi_channel_disable(nrf_ppi_channel_t channel);
+
+#endif
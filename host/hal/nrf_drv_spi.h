@@ -0,0 +1,104 @@
+#ifndef NRF_DRV_SPI_H__
+#define NRF_DRV_SPI_H__
+
+#include "sdk_common.h"
+
+// Host build: transfers go to the device model attached to the instance,
+// see host_spi_attach()
+
+#define HOST_SPI_INSTANCES              3
+
+typedef struct {
+    uint8_t inst_idx;
+} nrf_drv_spi_t;
+
+#define NRF_DRV_SPI_INSTANCE(id)        { .inst_idx = (id) }
+#define NRF_DRV_SPI_PIN_NOT_USED        0xFF
+
+typedef enum {
+    NRF_DRV_SPI_FREQ_125K,
+    NRF_DRV_SPI_FREQ_250K,
+    NRF_DRV_SPI_FREQ_500K,
+    NRF_DRV_SPI_FREQ_1M,
+    NRF_DRV_SPI_FREQ_2M,
+    NRF_DRV_SPI_FREQ_4M,
+    NRF_DRV_SPI_FREQ_8M
+} nrf_drv_spi_frequency_t;
+
+typedef enum {
+    NRF_DRV_SPI_MODE_0,
+    NRF_DRV_SPI_MODE_1,
+    NRF_DRV_SPI_MODE_2,
+    NRF_DRV_SPI_MODE_3
+} nrf_drv_spi_mode_t;
+
+typedef enum {
+    NRF_DRV_SPI_BIT_ORDER_MSB_FIRST,
+    NRF_DRV_SPI_BIT_ORDER_LSB_FIRST
+} nrf_drv_spi_bit_order_t;
+
+typedef struct {
+    uint8_t sck_pin;
+    uint8_t mosi_pin;
+    uint8_t miso_pin;
+    uint8_t ss_pin;
+    uint8_t irq_priority;
+    uint8_t orc;
+    nrf_drv_spi_frequency_t frequency;
+    nrf_drv_spi_mode_t      mode;
+    nrf_drv_spi_bit_order_t bit_order;
+} nrf_drv_spi_config_t;
+
+#define NRF_DRV_SPI_DEFAULT_CONFIG                          \
+{                                                           \
+    .sck_pin      = NRF_DRV_SPI_PIN_NOT_USED,               \
+    .mosi_pin     = NRF_DRV_SPI_PIN_NOT_USED,               \
+    .miso_pin     = NRF_DRV_SPI_PIN_NOT_USED,               \
+    .ss_pin       = NRF_DRV_SPI_PIN_NOT_USED,               \
+    .irq_priority = APP_IRQ_PRIORITY_LOWEST,                \
+    .orc          = 0xFF,                                   \
+    .frequency    = NRF_DRV_SPI_FREQ_4M,                    \
+    .mode         = NRF_DRV_SPI_MODE_0,                     \
+    .bit_order    = NRF_DRV_SPI_BIT_ORDER_MSB_FIRST,        \
+}
+
+typedef enum {
+    NRF_DRV_SPI_EVENT_DONE
+} nrf_drv_spi_evt_type_t;
+
+typedef struct {
+    uint8_t const *p_tx_buffer;
+    uint8_t       tx_length;
+    uint8_t       *p_rx_buffer;
+    uint8_t       rx_length;
+} nrf_drv_spi_xfer_desc_t;
+
+#define NRF_DRV_SPI_XFER_TRX(p_tx_buf, tx_length_, p_rx_buf, rx_length_) \
+    { .p_tx_buffer = (uint8_t const *)(p_tx_buf), .tx_length = (tx_length_), \
+      .p_rx_buffer = (p_rx_buf), .rx_length = (rx_length_) }
+
+#define NRF_DRV_SPI_FLAG_TX_POSTINC             (1UL << 0)
+#define NRF_DRV_SPI_FLAG_RX_POSTINC             (1UL << 1)
+#define NRF_DRV_SPI_FLAG_NO_XFER_EVT_HANDLER    (1UL << 2)
+#define NRF_DRV_SPI_FLAG_HOLD_XFER              (1UL << 3)
+#define NRF_DRV_SPI_FLAG_REPEATED_XFER          (1UL << 4)
+
+typedef struct {
+    nrf_drv_spi_evt_type_t  type;
+    nrf_drv_spi_xfer_desc_t xfer_desc;
+} nrf_drv_spi_evt_t;
+
+typedef void (*nrf_drv_spi_evt_handler_t)(nrf_drv_spi_evt_t const *p_event, void *p_context);
+
+ret_code_t nrf_drv_spi_init(nrf_drv_spi_t const *p_instance, nrf_drv_spi_config_t const *p_config,
+                            nrf_drv_spi_evt_handler_t handler, void *p_context);
+void nrf_drv_spi_uninit(nrf_drv_spi_t const *p_instance);
+ret_code_t nrf_drv_spi_transfer(nrf_drv_spi_t const *p_instance, uint8_t const *p_tx_buffer,
+                                uint8_t tx_buffer_length, uint8_t *p_rx_buffer, uint8_t rx_buffer_length);
+ret_code_t nrf_drv_spi_xfer(nrf_drv_spi_t const *p_instance, nrf_drv_spi_xfer_desc_t const *p_xfer_desc,
+                            uint32_t flags);
+uint32_t nrf_drv_spi_start_task_get(nrf_drv_spi_t const *p_instance);
+uint32_t nrf_drv_spi_end_event_get(nrf_drv_spi_t const *p_instance);
+void nrf_drv_spi_abort(nrf_drv_spi_t const *p_instance);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef NRF_DRV_TWI_H__
+#define NRF_DRV_TWI_H__
+
+#include "sdk_common.h"
+
+typedef struct {
+    uint8_t inst_idx;
+} nrf_drv_twi_t;
+
+#define NRF_DRV_TWI_INSTANCE(id)        { .inst_idx = (id) }
+
+typedef enum {
+    NRF_DRV_TWI_FREQ_100K,
+    NRF_DRV_TWI_FREQ_250K,
+    NRF_DRV_TWI_FREQ_400K
+} nrf_drv_twi_frequency_t;
+
+typedef struct {
+    uint32_t                scl;
+    uint32_t                sda;
+    nrf_drv_twi_frequency_t frequency;
+    uint8_t                 interrupt_priority;
+    bool                    clear_bus_init;
+    bool                    hold_bus_uninit;
+} nrf_drv_twi_config_t;
+
+void nrf_drv_twi_enable(nrf_drv_twi_t const *p_instance);
+void nrf_drv_twi_disable(nrf_drv_twi_t const *p_instance);
+
+#endif
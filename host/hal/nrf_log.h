@@ -0,0 +1,18 @@
+#ifndef NRF_LOG_H
+#define NRF_LOG_H
+
+#include "sdk_common.h"
+
+// Host build: printed only when the bench runs with --verbose
+void host_log(char level, char const *fmt, ...) __attribute__((format(printf, 2, 3)));
+void host_log_hexdump(void const *p_data, uint32_t length);
+
+#define NRF_LOG_ERROR(...)              host_log('E', __VA_ARGS__)
+#define NRF_LOG_WARNING(...)            host_log('W', __VA_ARGS__)
+#define NRF_LOG_INFO(...)               host_log('I', __VA_ARGS__)
+#define NRF_LOG_DEBUG(...)              host_log('D', __VA_ARGS__)
+#define NRF_LOG_HEXDUMP_INFO(p_data, len)   host_log_hexdump(p_data, len)
+#define NRF_LOG_FLUSH()                 do { } while (0)
+#define NRF_LOG_PROCESS()               false
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+// Host build: just enough of the nRF5 SDK common definitions for the drivers
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint32_t ret_code_t;
+
+#define NRF_SUCCESS                             0
+#define NRF_ERROR_INTERNAL                      3
+#define NRF_ERROR_NO_MEM                        4
+#define NRF_ERROR_NOT_FOUND                     5
+#define NRF_ERROR_INVALID_PARAM                 7
+#define NRF_ERROR_INVALID_STATE                 8
+#define NRF_ERROR_INVALID_LENGTH                9
+#define NRF_ERROR_TIMEOUT                       13
+#define NRF_ERROR_NULL                          14
+#define NRF_ERROR_BUSY                          17
+#define NRF_ERROR_MODULE_ALREADY_INITIALIZED    0x85
+#define NRF_ERROR_DRV_TWI_ERR_ANACK             0x8602
+
+#define APP_IRQ_PRIORITY_HIGH                   2
+#define APP_IRQ_PRIORITY_LOW                    6
+#define APP_IRQ_PRIORITY_LOWEST                 7
+
+#define APP_ERROR_CHECK(err_code)               (void)(err_code)
+#define UNUSED_PARAMETER(x)                     (void)(x)
+
+// Events are delivered synchronously on the host, so waiting never sleeps
+#define __WFE()                                 do { } while (0)
+#define __SEV()                                 do { } while (0)
+#define __WFI()                                 do { } while (0)
+
+#endif
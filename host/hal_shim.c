@@ -0,0 +1,743 @@
+/**
+ * @file hal_shim.c
+ * @brief Host implementation of the nRF5 SDK calls used by the drivers
+ * @description Time is virtual: app_timer runs on a 32768 Hz counter that
+ *              only moves through host_time_advance() and nrf_delay_*().
+ *              Peripherals are modelled at the event level. GPIOTE edges
+ *              from host_gpio_drive() fire PPI channels, which start armed
+ *              SPIM transfers and count TIMER events, so DRDY-driven EasyDMA
+ *              capture runs the same way it does on the device.
+ *
+ *              Every handler runs synchronously in the caller's context.
+ */
+
+#include "host_hal.h"
+#include "app_timer.h"
+#include "nrf.h"
+#include "nrf_delay.h"
+#include "nrf_drv_gpiote.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_drv_spi.h"
+#include "nrf_drv_timer.h"
+#include "nrf_gpio.h"
+#include "nrf_log.h"
+#include "crc16.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#define HOST_GPIO_PINS          48
+#define HOST_APP_TIMERS         32
+
+// PPI endpoint encoding: peripheral in the high byte, index below
+#define HOST_EP_GPIOTE_IN       0x1000
+#define HOST_EP_SPI_START       0x2000
+#define HOST_EP_SPI_END         0x2100
+#define HOST_EP_TIMER_TASK      0x3000
+#define HOST_EP_TIMER_EVENT     0x3100
+#define HOST_EP_KIND(ep)        ((ep) & 0xFF00)
+#define HOST_EP_INDEX(ep)       ((ep) & 0x00FF)
+
+NRF_FICR_Type host_ficr = { .DEVICEID = { 0x484F5354, 0 } };   // "HOST"
+NRF_POWER_Type host_power;                                      // Power-on reset
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+uint32_t SystemCoreClock = 64000000;
+
+static bool m_log_enabled = false;
+
+// Virtual clock
+static uint64_t m_now_ticks = 0;
+static uint32_t m_us_residue = 0;       // Microseconds not yet worth a tick
+static app_timer_t *m_timers[HOST_APP_TIMERS];
+static uint8_t m_timer_count = 0;
+
+// GPIO and GPIOTE
+typedef struct {
+    bool level;
+    bool in_configured;
+    bool event_enabled;
+    bool int_enabled;
+    nrf_gpiote_polarity_t sense;
+    nrf_drv_gpiote_evt_handler_t handler;
+} host_pin_t;
+
+static host_pin_t m_pins[HOST_GPIO_PINS];
+static bool m_gpiote_initialized = false;
+
+// PPI
+typedef struct {
+    uint32_t eep;
+    uint32_t tep;
+    uint32_t fork_tep;
+    bool     allocated;
+    bool     enabled;
+} host_ppi_channel_t;
+
+static host_ppi_channel_t m_ppi[HOST_PPI_CHANNELS];
+
+// SPIM
+typedef struct {
+    host_spi_device_t device;
+    nrf_drv_spi_evt_handler_t handler;
+    void     *p_context;
+    bool     initialized;
+    nrf_drv_spi_xfer_desc_t armed;      // Held transfer, started from PPI
+    uint32_t armed_flags;
+    bool     is_armed;
+} host_spi_t;
+
+static host_spi_t m_spi[HOST_SPI_INSTANCES];
+
+// TIMER
+typedef struct {
+    nrf_timer_event_handler_t handler;
+    void     *p_context;
+    uint32_t cc[4];
+    uint8_t  int_mask;
+    uint8_t  shorts;
+    uint32_t counter;
+    uint32_t width_mask;
+    bool     running;
+} host_timer_t;
+
+static host_timer_t m_timer[HOST_TIMER_INSTANCES];
+
+// TWI
+static host_twi_device_t m_twi_device = NULL;
+
+static void host_ppi_event(uint32_t eep);
+
+/**
+ * @brief Print driver logs, off unless the bench runs verbose
+ */
+void host_log_enable(bool enable) {
+    m_log_enabled = enable;
+}
+
+void host_log(char level, char const *fmt, ...) {
+    if (!m_log_enabled) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    printf("[%10.3f] %c ", (double)m_now_ticks / APP_TIMER_CLOCK_FREQ, level);
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+}
+
+void host_log_hexdump(void const *p_data, uint32_t length) {
+    if (!m_log_enabled) {
+        return;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        printf("%02x%c", ((uint8_t const *)p_data)[i], ((i & 15) == 15 || i + 1 == length) ? '\n' : ' ');
+    }
+}
+
+/**
+ * @brief CRC16-CCITT, same algorithm as the SDK crc16 library
+ */
+uint16_t crc16_compute(uint8_t const *p_data, uint32_t size, uint16_t const *p_crc) {
+    uint16_t crc = (p_crc == NULL) ? 0xFFFF : *p_crc;
+
+    for (uint32_t i = 0; i < size; i++) {
+        crc = (uint8_t)(crc >> 8) | (crc << 8);
+        crc ^= p_data[i];
+        crc ^= (uint8_t)(crc & 0xFF) >> 4;
+        crc ^= (crc << 8) << 4;
+        crc ^= ((crc & 0xFF) << 4) << 1;
+    }
+    return crc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Virtual time and app_timer
+ * ------------------------------------------------------------------------ */
+
+uint64_t host_time_ticks(void) {
+    return m_now_ticks;
+}
+
+/**
+ * @brief Move the clock forward, firing every timer that expires on the way
+ *        in deadline order
+ */
+void host_time_advance(uint32_t ticks) {
+    uint64_t target = m_now_ticks + ticks;
+
+    for (;;) {
+        app_timer_t *next = NULL;
+        for (uint8_t i = 0; i < m_timer_count; i++) {
+            app_timer_t *t = m_timers[i];
+            if (t->active && t->deadline <= target && (!next || t->deadline < next->deadline)) {
+                next = t;
+            }
+        }
+        if (!next) {
+            break;
+        }
+
+        m_now_ticks = next->deadline;
+        if (next->mode == APP_TIMER_MODE_REPEATED) {
+            next->deadline += next->period;
+        } else {
+            next->active = false;
+        }
+        next->handler(next->p_context);
+    }
+
+    m_now_ticks = target;
+}
+
+void host_time_advance_us(uint32_t us) {
+    uint64_t total = (uint64_t)us + m_us_residue;
+    uint64_t ticks = total * APP_TIMER_CLOCK_FREQ / 1000000;
+    m_us_residue = (uint32_t)(total - ticks * 1000000 / APP_TIMER_CLOCK_FREQ);
+    host_time_advance((uint32_t)ticks);
+}
+
+void nrf_delay_ms(uint32_t ms_time) {
+    host_time_advance(APP_TIMER_TICKS(ms_time));
+}
+
+void nrf_delay_us(uint32_t us_time) {
+    host_time_advance_us(us_time);
+}
+
+ret_code_t app_timer_init(void) {
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_create(app_timer_id_t const *p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler) {
+    app_timer_t *t = *p_timer_id;
+
+    if (timeout_handler == NULL) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    bool known = false;
+    for (uint8_t i = 0; i < m_timer_count; i++) {
+        known |= (m_timers[i] == t);
+    }
+    if (!known) {
+        if (m_timer_count >= HOST_APP_TIMERS) {
+            return NRF_ERROR_NO_MEM;
+        }
+        m_timers[m_timer_count++] = t;
+    }
+
+    t->handler = timeout_handler;
+    t->mode = mode;
+    t->active = false;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void *p_context) {
+    if (timer_id->handler == NULL) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (timeout_ticks < 5 || timeout_ticks > APP_TIMER_MAX_CNT_VAL) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    timer_id->deadline = m_now_ticks + timeout_ticks;
+    timer_id->period = timeout_ticks;
+    timer_id->p_context = p_context;
+    timer_id->active = true;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id) {
+    timer_id->active = false;
+    return NRF_SUCCESS;
+}
+
+uint32_t app_timer_cnt_get(void) {
+    return (uint32_t)m_now_ticks & APP_TIMER_MAX_CNT_VAL;
+}
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from) {
+    return (ticks_to - ticks_from) & APP_TIMER_MAX_CNT_VAL;
+}
+
+/* ---------------------------------------------------------------------------
+ * GPIO and GPIOTE
+ * ------------------------------------------------------------------------ */
+
+void nrf_gpio_cfg_output(uint32_t pin_number) {
+    (void)pin_number;
+}
+
+void nrf_gpio_cfg_input(uint32_t pin_number, nrf_gpio_pin_pull_t pull_config) {
+    if (pin_number < HOST_GPIO_PINS) {
+        m_pins[pin_number].level = (pull_config == NRF_GPIO_PIN_PULLUP);
+    }
+}
+
+void nrf_gpio_cfg_default(uint32_t pin_number) {
+    (void)pin_number;
+}
+
+void nrf_gpio_pin_set(uint32_t pin_number) {
+    if (pin_number < HOST_GPIO_PINS) {
+        m_pins[pin_number].level = true;
+    }
+}
+
+void nrf_gpio_pin_clear(uint32_t pin_number) {
+    if (pin_number < HOST_GPIO_PINS) {
+        m_pins[pin_number].level = false;
+    }
+}
+
+uint32_t nrf_gpio_pin_read(uint32_t pin_number) {
+    return (pin_number < HOST_GPIO_PINS) ? m_pins[pin_number].level : 0;
+}
+
+bool host_gpio_level(uint32_t pin) {
+    return nrf_gpio_pin_read(pin);
+}
+
+/**
+ * @brief Drive an input from a device model; a sensed edge fires the
+ *        GPIOTE event (and its PPI channels) and the pin handler
+ */
+void host_gpio_drive(uint32_t pin, bool level) {
+    if (pin >= HOST_GPIO_PINS || m_pins[pin].level == level) {
+        return;
+    }
+
+    host_pin_t *p = &m_pins[pin];
+    nrf_gpiote_polarity_t edge = level ? NRF_GPIOTE_POLARITY_LOTOHI : NRF_GPIOTE_POLARITY_HITOLO;
+    p->level = level;
+
+    if (!p->in_configured || !p->event_enabled ||
+        (p->sense != edge && p->sense != NRF_GPIOTE_POLARITY_TOGGLE)) {
+        return;
+    }
+
+    host_ppi_event(HOST_EP_GPIOTE_IN | pin);
+    if (p->int_enabled && p->handler) {
+        p->handler(pin, p->sense);
+    }
+}
+
+ret_code_t nrf_drv_gpiote_init(void) {
+    if (m_gpiote_initialized) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_gpiote_initialized = true;
+    return NRF_SUCCESS;
+}
+
+bool nrf_drv_gpiote_is_init(void) {
+    return m_gpiote_initialized;
+}
+
+ret_code_t nrf_drv_gpiote_in_init(nrf_drv_gpiote_pin_t pin, nrf_drv_gpiote_in_config_t const *p_config,
+                                  nrf_drv_gpiote_evt_handler_t evt_handler) {
+    if (pin >= HOST_GPIO_PINS) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (m_pins[pin].in_configured) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_pins[pin].in_configured = true;
+    m_pins[pin].sense = p_config->sense;
+    m_pins[pin].handler = evt_handler;
+    m_pins[pin].event_enabled = false;
+    if (!p_config->skip_gpio_setup) {
+        nrf_gpio_cfg_input(pin, p_config->pull);
+    }
+    return NRF_SUCCESS;
+}
+
+void nrf_drv_gpiote_in_uninit(nrf_drv_gpiote_pin_t pin) {
+    if (pin < HOST_GPIO_PINS) {
+        m_pins[pin].in_configured = false;
+        m_pins[pin].event_enabled = false;
+        m_pins[pin].handler = NULL;
+    }
+}
+
+void nrf_drv_gpiote_in_event_enable(nrf_drv_gpiote_pin_t pin, bool int_enable) {
+    if (pin < HOST_GPIO_PINS) {
+        m_pins[pin].event_enabled = true;
+        m_pins[pin].int_enabled = int_enable;
+    }
+}
+
+void nrf_drv_gpiote_in_event_disable(nrf_drv_gpiote_pin_t pin) {
+    if (pin < HOST_GPIO_PINS) {
+        m_pins[pin].event_enabled = false;
+        m_pins[pin].int_enabled = false;
+    }
+}
+
+uint32_t nrf_drv_gpiote_in_event_addr_get(nrf_drv_gpiote_pin_t pin) {
+    return HOST_EP_GPIOTE_IN | pin;
+}
+
+bool nrf_drv_gpiote_in_is_set(nrf_drv_gpiote_pin_t pin) {
+    return nrf_gpio_pin_read(pin);
+}
+
+/* ---------------------------------------------------------------------------
+ * TIMER
+ * ------------------------------------------------------------------------ */
+
+static host_timer_t *host_timer(nrf_drv_timer_t const *p_instance) {
+    return &m_timer[p_instance->instance_id % HOST_TIMER_INSTANCES];
+}
+
+/**
+ * @brief One COUNT task: compare events, their interrupts and shortcuts
+ */
+static void host_timer_count(uint8_t id) {
+    host_timer_t *t = &m_timer[id];
+
+    if (!t->running) {
+        return;
+    }
+    t->counter = (t->counter + 1) & t->width_mask;
+
+    for (uint8_t ch = 0; ch < 4; ch++) {
+        if (t->counter != t->cc[ch]) {
+            continue;
+        }
+        if (t->shorts & (1 << ch)) {
+            t->counter = 0;
+        }
+        host_ppi_event(HOST_EP_TIMER_EVENT | (id << 4) | ch);
+        if ((t->int_mask & (1 << ch)) && t->handler) {
+            t->handler((nrf_timer_event_t)ch, t->p_context);
+        }
+    }
+}
+
+static void host_timer_task(uint8_t id, nrf_timer_task_t task) {
+    host_timer_t *t = &m_timer[id];
+
+    switch (task) {
+        case NRF_TIMER_TASK_START:  t->running = true;  break;
+        case NRF_TIMER_TASK_STOP:   t->running = false; break;
+        case NRF_TIMER_TASK_COUNT:  host_timer_count(id); break;
+        case NRF_TIMER_TASK_CLEAR:  t->counter = 0;     break;
+        default:
+            t->cc[task - NRF_TIMER_TASK_CAPTURE0] = t->counter;
+            break;
+    }
+}
+
+ret_code_t nrf_drv_timer_init(nrf_drv_timer_t const *p_instance, nrf_drv_timer_config_t const *p_config,
+                              nrf_timer_event_handler_t timer_event_handler) {
+    static const uint32_t width_masks[] = { 0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF };
+    host_timer_t *t = host_timer(p_instance);
+
+    if (timer_event_handler == NULL) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    memset(t, 0, sizeof(*t));
+    t->handler = timer_event_handler;
+    t->p_context = p_config->p_context;
+    t->width_mask = width_masks[p_config->bit_width];
+    return NRF_SUCCESS;
+}
+
+void nrf_drv_timer_uninit(nrf_drv_timer_t const *p_instance) {
+    memset(host_timer(p_instance), 0, sizeof(host_timer_t));
+}
+
+void nrf_drv_timer_enable(nrf_drv_timer_t const *p_instance) {
+    host_timer(p_instance)->running = true;
+}
+
+void nrf_drv_timer_disable(nrf_drv_timer_t const *p_instance) {
+    host_timer(p_instance)->running = false;
+}
+
+void nrf_drv_timer_clear(nrf_drv_timer_t const *p_instance) {
+    host_timer(p_instance)->counter = 0;
+}
+
+void nrf_drv_timer_compare(nrf_drv_timer_t const *p_instance, nrf_timer_cc_channel_t cc_channel,
+                           uint32_t cc_value, bool enable_int) {
+    host_timer_t *t = host_timer(p_instance);
+    t->cc[cc_channel] = cc_value;
+    if (enable_int) {
+        t->int_mask |= (1 << cc_channel);
+    } else {
+        t->int_mask &= ~(1 << cc_channel);
+    }
+}
+
+void nrf_drv_timer_extended_compare(nrf_drv_timer_t const *p_instance, nrf_timer_cc_channel_t cc_channel,
+                                    uint32_t cc_value, nrf_timer_short_mask_t timer_short_mask,
+                                    bool enable_int) {
+    host_timer(p_instance)->shorts |= timer_short_mask;
+    nrf_drv_timer_compare(p_instance, cc_channel, cc_value, enable_int);
+}
+
+uint32_t nrf_drv_timer_task_address_get(nrf_drv_timer_t const *p_instance, nrf_timer_task_t timer_task) {
+    return HOST_EP_TIMER_TASK | (p_instance->instance_id << 4) | timer_task;
+}
+
+uint32_t nrf_drv_timer_capture_task_address_get(nrf_drv_timer_t const *p_instance, uint32_t channel) {
+    return nrf_drv_timer_task_address_get(p_instance, (nrf_timer_task_t)(NRF_TIMER_TASK_CAPTURE0 + channel));
+}
+
+uint32_t nrf_drv_timer_event_address_get(nrf_drv_timer_t const *p_instance, nrf_timer_event_t timer_event) {
+    return HOST_EP_TIMER_EVENT | (p_instance->instance_id << 4) | timer_event;
+}
+
+uint32_t nrf_drv_timer_capture_get(nrf_drv_timer_t const *p_instance, nrf_timer_cc_channel_t cc_channel) {
+    return host_timer(p_instance)->cc[cc_channel];
+}
+
+uint32_t nrf_drv_timer_capture(nrf_drv_timer_t const *p_instance, nrf_timer_cc_channel_t cc_channel) {
+    host_timer_t *t = host_timer(p_instance);
+    t->cc[cc_channel] = t->counter;
+    return t->counter;
+}
+
+/* ---------------------------------------------------------------------------
+ * SPIM
+ * ------------------------------------------------------------------------ */
+
+void host_spi_attach(uint8_t instance, host_spi_device_t device) {
+    if (instance < HOST_SPI_INSTANCES) {
+        m_spi[instance].device = device;
+    }
+}
+
+/**
+ * @brief Run the held transfer as if SPIM START had been triggered
+ */
+static void host_spi_start(uint8_t instance) {
+    host_spi_t *s = &m_spi[instance];
+
+    if (!s->initialized || !s->is_armed) {
+        return;
+    }
+    if (s->device) {
+        s->device(s->armed.p_tx_buffer, s->armed.tx_length, s->armed.p_rx_buffer, s->armed.rx_length);
+    }
+    nrf_drv_spi_xfer_desc_t done = s->armed;
+    if (s->armed_flags & NRF_DRV_SPI_FLAG_TX_POSTINC) {
+        s->armed.p_tx_buffer += s->armed.tx_length;
+    }
+    if (s->armed_flags & NRF_DRV_SPI_FLAG_RX_POSTINC) {
+        s->armed.p_rx_buffer += s->armed.rx_length;
+    }
+    if (!(s->armed_flags & NRF_DRV_SPI_FLAG_REPEATED_XFER)) {
+        s->is_armed = false;
+    }
+
+    host_ppi_event(HOST_EP_SPI_END | instance);
+    if (!(s->armed_flags & NRF_DRV_SPI_FLAG_NO_XFER_EVT_HANDLER) && s->handler) {
+        nrf_drv_spi_evt_t evt = { .type = NRF_DRV_SPI_EVENT_DONE, .xfer_desc = done };
+        s->handler(&evt, s->p_context);
+    }
+}
+
+ret_code_t nrf_drv_spi_init(nrf_drv_spi_t const *p_instance, nrf_drv_spi_config_t const *p_config,
+                            nrf_drv_spi_evt_handler_t handler, void *p_context) {
+    host_spi_t *s = &m_spi[p_instance->inst_idx % HOST_SPI_INSTANCES];
+
+    (void)p_config;
+    if (s->initialized) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    s->initialized = true;
+    s->handler = handler;
+    s->p_context = p_context;
+    s->is_armed = false;
+    return NRF_SUCCESS;
+}
+
+void nrf_drv_spi_uninit(nrf_drv_spi_t const *p_instance) {
+    host_spi_t *s = &m_spi[p_instance->inst_idx % HOST_SPI_INSTANCES];
+    s->initialized = false;
+    s->is_armed = false;
+}
+
+ret_code_t nrf_drv_spi_transfer(nrf_drv_spi_t const *p_instance, uint8_t const *p_tx_buffer,
+                                uint8_t tx_buffer_length, uint8_t *p_rx_buffer, uint8_t rx_buffer_length) {
+    nrf_drv_spi_xfer_desc_t xfer = NRF_DRV_SPI_XFER_TRX(p_tx_buffer, tx_buffer_length,
+                                                        p_rx_buffer, rx_buffer_length);
+    return nrf_drv_spi_xfer(p_instance, &xfer, 0);
+}
+
+ret_code_t nrf_drv_spi_xfer(nrf_drv_spi_t const *p_instance, nrf_drv_spi_xfer_desc_t const *p_xfer_desc,
+                            uint32_t flags) {
+    uint8_t instance = p_instance->inst_idx % HOST_SPI_INSTANCES;
+    host_spi_t *s = &m_spi[instance];
+
+    if (!s->initialized) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    s->armed = *p_xfer_desc;
+    s->armed_flags = flags;
+    s->is_armed = true;
+    if (!(flags & NRF_DRV_SPI_FLAG_HOLD_XFER)) {
+        host_spi_start(instance);
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t nrf_drv_spi_start_task_get(nrf_drv_spi_t const *p_instance) {
+    return HOST_EP_SPI_START | p_instance->inst_idx;
+}
+
+uint32_t nrf_drv_spi_end_event_get(nrf_drv_spi_t const *p_instance) {
+    return HOST_EP_SPI_END | p_instance->inst_idx;
+}
+
+void nrf_drv_spi_abort(nrf_drv_spi_t const *p_instance) {
+    m_spi[p_instance->inst_idx % HOST_SPI_INSTANCES].is_armed = false;
+}
+
+/* ---------------------------------------------------------------------------
+ * PPI
+ * ------------------------------------------------------------------------ */
+
+static void host_ppi_task(uint32_t tep) {
+    uint8_t index = HOST_EP_INDEX(tep);
+
+    switch (HOST_EP_KIND(tep)) {
+        case HOST_EP_SPI_START:
+            host_spi_start(index % HOST_SPI_INSTANCES);
+            break;
+        case HOST_EP_TIMER_TASK:
+            host_timer_task((index >> 4) % HOST_TIMER_INSTANCES, (nrf_timer_task_t)(index & 0x0F));
+            break;
+        default:
+            break;
+    }
+}
+
+static void host_ppi_event(uint32_t eep) {
+    for (uint8_t ch = 0; ch < HOST_PPI_CHANNELS; ch++) {
+        if (!m_ppi[ch].enabled || m_ppi[ch].eep != eep) {
+            continue;
+        }
+        host_ppi_task(m_ppi[ch].tep);
+        if (m_ppi[ch].fork_tep) {
+            host_ppi_task(m_ppi[ch].fork_tep);
+        }
+    }
+}
+
+ret_code_t nrf_drv_ppi_init(void) {
+    static bool initialized = false;
+    if (initialized) {
+        return NRF_ERROR_MODULE_ALREADY_INITIALIZED;
+    }
+    initialized = true;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_ppi_channel_alloc(nrf_ppi_channel_t *p_channel) {
+    for (uint8_t ch = 0; ch < HOST_PPI_CHANNELS; ch++) {
+        if (!m_ppi[ch].allocated) {
+            memset(&m_ppi[ch], 0, sizeof(m_ppi[ch]));
+            m_ppi[ch].allocated = true;
+            *p_channel = ch;
+            return NRF_SUCCESS;
+        }
+    }
+    return NRF_ERROR_NO_MEM;
+}
+
+ret_code_t nrf_drv_ppi_channel_free(nrf_ppi_channel_t channel) {
+    if (channel >= HOST_PPI_CHANNELS || !m_ppi[channel].allocated) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi[channel].allocated = false;
+    m_ppi[channel].enabled = false;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep) {
+    if (channel >= HOST_PPI_CHANNELS || !m_ppi[channel].allocated) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi[channel].eep = eep;
+    m_ppi[channel].tep = tep;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep) {
+    if (channel >= HOST_PPI_CHANNELS || !m_ppi[channel].allocated) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi[channel].fork_tep = fork_tep;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_ppi_channel_enable(nrf_ppi_channel_t channel) {
+    if (channel >= HOST_PPI_CHANNELS || !m_ppi[channel].allocated) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi[channel].enabled = true;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_ppi_channel_disable(nrf_ppi_channel_t channel) {
+    if (channel >= HOST_PPI_CHANNELS || !m_ppi[channel].allocated) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi[channel].enabled = false;
+    return NRF_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------
+ * TWI manager
+ * ------------------------------------------------------------------------ */
+
+void host_twi_attach(host_twi_device_t device) {
+    m_twi_device = device;
+}
+
+static ret_code_t host_twi_run(nrf_twi_mngr_transfer_t const *p_transfers, uint8_t count) {
+    return m_twi_device ? m_twi_device(p_transfers, count) : NRF_ERROR_DRV_TWI_ERR_ANACK;
+}
+
+ret_code_t nrf_twi_mngr_init(nrf_twi_mngr_t const *p_nrf_twi_mngr, nrf_drv_twi_config_t const *p_default_twi_config) {
+    (void)p_nrf_twi_mngr;
+    (void)p_default_twi_config;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_twi_mngr_schedule(nrf_twi_mngr_t const *p_nrf_twi_mngr,
+                                 nrf_twi_mngr_transaction_t const *p_transaction) {
+    (void)p_nrf_twi_mngr;
+    ret_code_t result = host_twi_run(p_transaction->p_transfers, p_transaction->number_of_transfers);
+    if (p_transaction->callback) {
+        p_transaction->callback(result, p_transaction->p_user_data);
+    }
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_twi_mngr_perform(nrf_twi_mngr_t const *p_nrf_twi_mngr, nrf_drv_twi_config_t const *p_config,
+                                nrf_twi_mngr_transfer_t const *p_transfers, uint8_t number_of_transfers,
+                                void (*user_function)(void)) {
+    (void)p_nrf_twi_mngr;
+    (void)p_config;
+    (void)user_function;
+    return host_twi_run(p_transfers, number_of_transfers);
+}
+
+bool nrf_twi_mngr_is_idle(nrf_twi_mngr_t const *p_nrf_twi_mngr) {
+    (void)p_nrf_twi_mngr;
+    return true;
+}
+
+void nrf_drv_twi_enable(nrf_drv_twi_t const *p_instance) {
+    (void)p_instance;
+}
+
+void nrf_drv_twi_disable(nrf_drv_twi_t const *p_instance) {
+    (void)p_instance;
+}
\ No newline at end of file
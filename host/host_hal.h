@@ -0,0 +1,31 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_common.h"
+#include "nrf_twi_mngr.h"
+
+// Bench side of the host HAL shim: virtual time, device models and pins
+
+// SPI device model; called for every transfer on its instance, including
+// the PPI-triggered EasyDMA transfers armed with nrf_drv_spi_xfer()
+typedef void (*host_spi_device_t)(uint8_t const *p_tx, uint8_t tx_length,
+                                  uint8_t *p_rx, uint8_t rx_length);
+
+// TWI device model; runs one transaction, returns the result for its callback
+typedef ret_code_t (*host_twi_device_t)(nrf_twi_mngr_transfer_t const *p_transfers, uint8_t count);
+
+void host_log_enable(bool enable);
+
+uint64_t host_time_ticks(void);
+void host_time_advance(uint32_t ticks);
+void host_time_advance_us(uint32_t us);
+
+void host_spi_attach(uint8_t instance, host_spi_device_t device);
+void host_twi_attach(host_twi_device_t device);
+
+void host_gpio_drive(uint32_t pin, bool level);
+bool host_gpio_level(uint32_t pin);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,355 @@
+"""
+Miner Health Monitoring System - Power benchmark report
+Pairs the benchmark firmware's per-cycle records with a Power Profiler capture
+
+Usage:
+    python power_report.py bench.rtt --release v1.4
+    python power_report.py bench.rtt --capture ppk.csv --release v1.4 --json v1.4.json
+    python power_report.py bench.rtt --capture ppk.csv --release v1.5 --baseline v1.4.json
+
+bench.rtt is RTT up channel 1 of the benchmark firmware (make bench), as
+written by JLinkRTTLogger: one power_bench_record_t per monitoring cycle with
+the RTC ticks and DWT cycles spent in every profiler phase.
+
+The capture is a CSV export of the Power Profiler Kit II: a timestamp column,
+a current column and either a D0-D7 column or separate D0..D7 columns. The
+firmware toggles the marker pin at every wake tick, so capture and records
+are cut at the same boundaries. Without a digital channel the capture is cut
+by the record lengths, starting --offset-ms into the capture at the first
+wake tick. Either way the capture has to be running before the device
+is reset.
+
+The report gives mean current, charge and awake time per cycle, overall and
+by health status, and the runtime a battery of --battery-mah gives at the
+measured mean current against a --shift-hours shift.
+"""
+
+import argparse
+import csv
+import json
+import re
+import struct
+import sys
+
+POWER_BENCH_MAGIC = 0x31425750
+RECORD_HEADER = struct.Struct('<IHBBBBBBII')
+PHASE = struct.Struct('<II')
+RTC_FREQ_HZ = 32768
+
+# Phase order of profiler.h: operations, then main.c system states
+OP_NAMES = ['sleep', 'warmup', 'ecg', 'ppg', 'temp', 'imu',
+            'analyze', 'encode', 'flash', 'radio', 'log']
+STATE_NAMES = ['sleep', 'waking', 'monitoring', 'extended', 'emergency', 'transmitting']
+STATE_SLEEP = 0
+STATUS_NAMES = ['normal', 'warning', 'critical', 'emergency']
+
+# Metrics compared against a baseline report, lower is better for all
+COMPARED = [('mean_ma', 'mean current', 'mA'),
+            ('charge_uah_per_cycle', 'charge per cycle', 'uAh'),
+            ('awake_ms_per_cycle', 'awake per cycle', 'ms'),
+            ('cpu_ms_per_cycle', 'CPU per cycle', 'ms')]
+
+FLOAT_VALUE = re.compile(r'^\s*-?\d+(\.\d*)?([eE][-+]?\d+)?\s*$')
+
+
+def read_records(path):
+    """Records in file order; the stream is resynchronised on the magic"""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    records = []
+    pos = 0
+    magic = struct.pack('<I', POWER_BENCH_MAGIC)
+    while True:
+        pos = data.find(magic, pos)
+        if pos < 0 or pos + RECORD_HEADER.size > len(data):
+            break
+        (_, cycle, status, sensors, op_count, phase_count, flags, _,
+         core_hz, wall_ticks) = RECORD_HEADER.unpack_from(data, pos)
+        end = pos + RECORD_HEADER.size + phase_count * PHASE.size
+        if end > len(data) or op_count > phase_count or core_hz == 0:
+            pos += 1
+            continue
+
+        phases = [PHASE.unpack_from(data, pos + RECORD_HEADER.size + i * PHASE.size)
+                  for i in range(phase_count)]
+        records.append({
+            'cycle': cycle, 'status': status, 'sensors': sensors, 'flags': flags,
+            'core_hz': core_hz, 'wall_ticks': wall_ticks,
+            'ops': phases[:op_count], 'states': phases[op_count:],
+        })
+        pos = end
+    return records
+
+
+def phase_name(names, index):
+    return names[index] if index < len(names) else 'phase%d' % index
+
+
+def column_scale(name, units):
+    """Scale from the unit in a column header such as Current(uA)"""
+    match = re.search(r'\((\w+)\)', name)
+    unit = match.group(1).lower() if match else ''
+    if unit not in units:
+        raise ValueError('unknown unit in column %r' % name)
+    return units[unit]
+
+
+def capture_columns(header, channel):
+    time_col = current_col = digital_col = None
+    digital_bit = None
+    for i, name in enumerate(header):
+        key = name.strip().lower()
+        if key.startswith('timestamp') or key.startswith('time'):
+            time_col = i
+        elif key.startswith('current'):
+            current_col = i
+        elif key.startswith('d0-d7'):
+            digital_col, digital_bit = i, channel
+        elif key == 'd%d' % channel:
+            digital_col, digital_bit = i, None
+    if time_col is None or current_col is None:
+        raise ValueError('capture needs a timestamp and a current column')
+    return time_col, current_col, digital_col, digital_bit
+
+
+def read_capture(path, records, channel, offset_ms):
+    """Charge and length of every cycle in the capture
+
+    Streams the CSV once; PPK2 exports of a full benchmark run are too large
+    to hold in memory.
+    """
+    segments = []
+    with open(path, newline='') as f:
+        reader = csv.reader(f)
+        header = next(reader)
+        time_col, current_col, digital_col, digital_bit = capture_columns(header, channel)
+        time_scale = column_scale(header[time_col], {'ms': 1.0, 'us': 1e-3, 's': 1e3})
+        current_scale = column_scale(header[current_col], {'ua': 1e-3, 'ma': 1.0, 'na': 1e-6, 'a': 1e3})
+
+        # Boundaries from the records when there is no marker
+        bounds = None
+        if digital_col is None:
+            bounds = [offset_ms]
+            for r in records:
+                bounds.append(bounds[-1] + r['wall_ticks'] * 1000.0 / RTC_FREQ_HZ)
+
+        marker = None
+        next_bound = 0
+        start_ms = None
+        charge = 0.0            # mA*ms
+        prev_t = prev_i = None
+        for row in reader:
+            if len(row) <= max(time_col, current_col) or not FLOAT_VALUE.match(row[current_col]):
+                continue
+            t = float(row[time_col]) * time_scale
+            i = float(row[current_col]) * current_scale
+
+            if prev_t is not None and start_ms is not None:
+                charge += prev_i * (t - prev_t)
+            prev_t, prev_i = t, i
+
+            if digital_col is not None:
+                field = row[digital_col].strip()
+                level = field[digital_bit] if digital_bit is not None else field
+                if marker is None:
+                    marker = level
+                    continue
+                edge = level != marker
+                marker = level
+            else:
+                edge = next_bound < len(bounds) and t >= bounds[next_bound]
+                if edge:
+                    next_bound += 1
+
+            if not edge:
+                continue
+            if start_ms is not None:
+                segments.append({'ms': t - start_ms, 'charge': charge})
+                if len(segments) >= len(records):
+                    break
+            start_ms = t
+            charge = 0.0
+    return segments
+
+
+def percentile(values, pct):
+    ordered = sorted(values)
+    if not ordered:
+        return 0.0
+    k = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[k]
+
+
+def cycle_metrics(record, segment):
+    wall_ms = record['wall_ticks'] * 1000.0 / RTC_FREQ_HZ
+    sleep_ticks = record['states'][STATE_SLEEP][0] if record['states'] else 0
+    cpu_cycles = sum(c for _, c in record['states'])
+    m = {
+        'cycle': record['cycle'],
+        'status': record['status'],
+        'wall_ms': wall_ms,
+        'awake_ms': max(0.0, (record['wall_ticks'] - sleep_ticks) * 1000.0 / RTC_FREQ_HZ),
+        'cpu_ms': cpu_cycles * 1000.0 / record['core_hz'],
+    }
+    if segment is not None:
+        m['capture_ms'] = segment['ms']
+        m['charge_uah'] = segment['charge'] / 3600.0      # mA*ms to uAh
+        m['mean_ma'] = segment['charge'] / segment['ms'] if segment['ms'] > 0 else 0.0
+    return m
+
+
+def summarize(cycles):
+    n = len(cycles)
+    total_ms = sum(c['wall_ms'] for c in cycles)
+    s = {
+        'cycles': n,
+        'cycle_ms': total_ms / n,
+        'awake_ms_per_cycle': sum(c['awake_ms'] for c in cycles) / n,
+        'awake_ms_p95': percentile([c['awake_ms'] for c in cycles], 95),
+        'cpu_ms_per_cycle': sum(c['cpu_ms'] for c in cycles) / n,
+    }
+    if all('charge_uah' in c for c in cycles):
+        capture_ms = sum(c['capture_ms'] for c in cycles)
+        charge = sum(c['charge_uah'] for c in cycles)
+        s['charge_uah_per_cycle'] = charge / n
+        s['mean_ma'] = charge * 3600.0 / capture_ms if capture_ms > 0 else 0.0
+        s['max_cycle_ma'] = max(c['mean_ma'] for c in cycles)
+    return s
+
+
+def phase_means(records):
+    """Mean time per cycle in every operation and state (ms)"""
+    out = {}
+    n = len(records)
+    for key, names in (('ops', OP_NAMES), ('states', STATE_NAMES)):
+        for r in records:
+            for i, (ticks, cycles) in enumerate(r[key]):
+                name = '%s.%s' % (key[:-1], phase_name(names, i))
+                entry = out.setdefault(name, {'ms': 0.0, 'cpu_ms': 0.0})
+                entry['ms'] += ticks * 1000.0 / RTC_FREQ_HZ / n
+                entry['cpu_ms'] += cycles * 1000.0 / r['core_hz'] / n
+    return {k: v for k, v in out.items() if v['ms'] > 0 or v['cpu_ms'] > 0}
+
+
+def build_report(records, segments, args):
+    if segments is not None and len(segments) < len(records):
+        print('warning: capture covers %d of %d cycles, report limited to those'
+              % (len(segments), len(records)), file=sys.stderr)
+        records = records[:len(segments)]
+
+    cycles = [cycle_metrics(r, segments[i] if segments is not None else None)
+              for i, r in enumerate(records)]
+    expected = list(range(records[0]['cycle'], records[-1]['cycle'] + 1))
+    seen = set(r['cycle'] for r in records)
+
+    report = {
+        'release': args.release,
+        'battery_mah': args.battery_mah,
+        'shift_hours': args.shift_hours,
+        'missing_cycles': [c for c in expected if c not in seen],
+        'complete': bool(records[-1]['flags'] & 1),
+        'summary': summarize(cycles),
+        'by_status': {},
+        'phases': phase_means(records),
+    }
+    for status in sorted(set(c['status'] for c in cycles)):
+        name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+        report['by_status'][name] = summarize([c for c in cycles if c['status'] == status])
+
+    summary = report['summary']
+    if 'mean_ma' in summary and summary['mean_ma'] > 0:
+        summary['runtime_hours'] = args.battery_mah / summary['mean_ma']
+        summary['shifts'] = summary['runtime_hours'] / args.shift_hours
+
+    if segments is not None:
+        drift = [abs(c['capture_ms'] - c['wall_ms']) / c['wall_ms'] for c in cycles if c['wall_ms'] > 0]
+        summary['max_boundary_drift_pct'] = 100.0 * max(drift) if drift else 0.0
+    return report
+
+
+def print_report(report, baseline, out):
+    s = report['summary']
+    out.write('Power benchmark report: %s\n' % report['release'])
+    out.write('  cycles            %d%s\n' % (s['cycles'], '' if report['complete'] else ' (run incomplete)'))
+    if report['missing_cycles']:
+        out.write('  missing records   %s\n' % ', '.join(str(c) for c in report['missing_cycles']))
+    out.write('  cycle length      %.1f ms\n' % s['cycle_ms'])
+    out.write('  awake per cycle   %.1f ms (p95 %.1f ms)\n' % (s['awake_ms_per_cycle'], s['awake_ms_p95']))
+    out.write('  CPU per cycle     %.2f ms\n' % s['cpu_ms_per_cycle'])
+    if 'mean_ma' in s:
+        out.write('  mean current      %.3f mA (worst cycle %.3f mA)\n' % (s['mean_ma'], s['max_cycle_ma']))
+        out.write('  charge per cycle  %.2f uAh\n' % s['charge_uah_per_cycle'])
+        out.write('  runtime           %.1f h on %d mAh, %.2f shifts of %g h\n'
+                  % (s['runtime_hours'], report['battery_mah'], s['shifts'], report['shift_hours']))
+        if s['max_boundary_drift_pct'] > 2.0:
+            out.write('  warning: capture and record boundaries differ by up to %.1f%%\n'
+                      % s['max_boundary_drift_pct'])
+    else:
+        out.write('  no capture, current and runtime not reported\n')
+
+    out.write('\nBy health status:\n')
+    for name, st in report['by_status'].items():
+        line = '  %-10s %4d cycles  %8.1f ms  awake %7.1f ms  CPU %6.2f ms' % (
+            name, st['cycles'], st['cycle_ms'], st['awake_ms_per_cycle'], st['cpu_ms_per_cycle'])
+        if 'mean_ma' in st:
+            line += '  %.3f mA  %.2f uAh' % (st['mean_ma'], st['charge_uah_per_cycle'])
+        out.write(line + '\n')
+
+    out.write('\nPer cycle (mean):\n')
+    for name, ph in sorted(report['phases'].items()):
+        out.write('  %-20s %9.2f ms  CPU %8.3f ms\n' % (name, ph['ms'], ph['cpu_ms']))
+
+    if baseline is not None:
+        out.write('\nAgainst %s:\n' % baseline.get('release', 'baseline'))
+        for key, label, unit in COMPARED:
+            new, old = s.get(key), baseline['summary'].get(key)
+            if new is None or old is None:
+                continue
+            change = 100.0 * (new - old) / old if old else 0.0
+            out.write('  %-18s %10.3f -> %10.3f %-3s %+6.1f%%\n' % (label, old, new, unit, change))
+        new, old = s.get('runtime_hours'), baseline['summary'].get('runtime_hours')
+        if new is not None and old is not None:
+            out.write('  %-18s %10.1f -> %10.1f h   %+6.1f%%\n'
+                      % ('runtime', old, new, 100.0 * (new - old) / old if old else 0.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Per-release power report from the benchmark firmware')
+    parser.add_argument('rtt', help='RTT channel 1 log of the benchmark firmware')
+    parser.add_argument('--capture', help='Power Profiler CSV export of the same run')
+    parser.add_argument('--marker-channel', type=int, default=0, help='digital input on the marker pin')
+    parser.add_argument('--offset-ms', type=float, default=0.0,
+                        help='first wake tick in the capture, when it has no digital channel')
+    parser.add_argument('--release', default='unnamed', help='label of the firmware under test')
+    parser.add_argument('--battery-mah', type=float, default=1000.0)
+    parser.add_argument('--shift-hours', type=float, default=12.0)
+    parser.add_argument('--json', help='write the report as JSON, for later --baseline runs')
+    parser.add_argument('--baseline', help='JSON report of an earlier release to compare against')
+    args = parser.parse_args()
+
+    records = read_records(args.rtt)
+    if not records:
+        print('%s: no benchmark records' % args.rtt, file=sys.stderr)
+        return 1
+
+    segments = read_capture(args.capture, records, args.marker_channel, args.offset_ms) if args.capture else None
+    if segments is not None and not segments:
+        print('%s: no cycle boundaries found' % args.capture, file=sys.stderr)
+        return 1
+
+    baseline = None
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    report = build_report(records, segments, args)
+    print_report(report, baseline, sys.stdout)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
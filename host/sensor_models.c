@@ -0,0 +1,327 @@
+/**
+ * @file sensor_models.c
+ * @brief ADS1292R and ICM-42688 models for the host benchmark
+ * @description Each model answers register transfers on its SPI instance
+ *              and drives its interrupt pin, so the drivers run unmodified.
+ *              Samples come from the bench one conversion (ADS1292R, 500 SPS)
+ *              or one ODR tick (ICM-42688, 100 Hz) at a time.
+ */
+
+#include "sensor_models.h"
+#include "host_hal.h"
+#include <string.h>
+
+// Wiring and instances as in the drivers
+#define ADS1292R_SPI_INSTANCE   1
+#define ADS1292R_DRDY_PIN       24
+#define ADS1292R_START_PIN      23
+#define ICM42688_SPI_INSTANCE   2
+#define ICM42688_INT1_PIN       21
+
+// ADS1292R
+#define ADS1292R_ID             0x73
+#define ADS1292R_REGS           12
+#define ADS1292R_CMD_WAKEUP     0x02
+#define ADS1292R_CMD_STANDBY    0x04
+#define ADS1292R_CMD_RESET      0x06
+#define ADS1292R_CMD_RDATAC     0x10
+#define ADS1292R_CMD_SDATAC     0x11
+#define ADS1292R_CMD_RREG       0x20
+#define ADS1292R_CMD_WREG       0x40
+#define ADS1292R_FRAME_SIZE     9
+#define ADS1292R_STATUS_SYNC    0xC0
+
+// ICM-42688 bank 0 unless noted
+#define ICM_REG_DEVICE_CONFIG   0x11
+#define ICM_REG_FIFO_CONFIG     0x16
+#define ICM_REG_ACCEL_DATA_X1   0x1F
+#define ICM_REG_INT_STATUS      0x2D
+#define ICM_REG_FIFO_COUNTH     0x2E
+#define ICM_REG_FIFO_COUNTL     0x2F
+#define ICM_REG_FIFO_DATA       0x30
+#define ICM_REG_INT_STATUS2     0x37
+#define ICM_REG_PWR_MGMT0       0x4E
+#define ICM_REG_SMD_CONFIG      0x57
+#define ICM_REG_FIFO_CONFIG1    0x5F
+#define ICM_REG_FIFO_CONFIG2    0x60
+#define ICM_REG_FIFO_CONFIG3    0x61
+#define ICM_REG_INT_SOURCE0     0x65
+#define ICM_REG_INT_SOURCE1     0x66
+#define ICM_REG_WHO_AM_I        0x75
+#define ICM_REG_BANK_SEL        0x76
+#define ICM_REG_WOM_X_THR       0x4A    // Bank 4
+
+#define ICM_WHO_AM_I            0x47
+#define ICM_FIFO_SIZE           2048
+#define ICM_PACKET_SIZE         8
+#define ICM_FIFO_MODE_MASK      0xC0
+#define ICM_FIFO_MODE_STREAM    0x40
+#define ICM_FIFO_ACCEL_EN       0x01
+#define ICM_INT_FIFO_THS        0x04
+#define ICM_INT_STATUS_FIFO_FULL 0x02
+#define ICM_INT_STATUS_FIFO_THS 0x04
+#define ICM_INT_STATUS2_WOM_XYZ 0x07
+#define ICM_SMD_MODE_MASK       0x03
+#define ICM_SMD_MODE_WOM        0x01
+#define ICM_WOM_COUNTS_PER_LSB  8       // 1/256 g threshold LSB at 2048 counts/g
+#define ICM_HEADER_ACCEL        0x40
+#define ICM_ACCEL_MODE_MASK     0x03
+
+/* ---------------------------------------------------------------------------
+ * ADS1292R: register access in SDATAC, 9-byte frames per DRDY in RDATAC
+ * ------------------------------------------------------------------------ */
+
+static uint8_t m_ads_regs[ADS1292R_REGS];
+static bool m_ads_standby = false;
+static bool m_ads_rdatac = false;
+static uint8_t m_ads_frame[ADS1292R_FRAME_SIZE];
+
+static void ads1292r_model_put24(uint8_t *p, int32_t value) {
+    p[0] = (value >> 16) & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = value & 0xFF;
+}
+
+static void ads1292r_model_xfer(uint8_t const *p_tx, uint8_t tx_length, uint8_t *p_rx, uint8_t rx_length) {
+    if (tx_length == 0) {
+        // Frame read clocked out by the DRDY-triggered EasyDMA transfer
+        if (p_rx) {
+            memcpy(p_rx, m_ads_frame, rx_length < ADS1292R_FRAME_SIZE ? rx_length : ADS1292R_FRAME_SIZE);
+        }
+        return;
+    }
+
+    uint8_t opcode = p_tx[0];
+    if ((opcode & 0xE0) == ADS1292R_CMD_RREG && tx_length >= 3 && p_rx && rx_length >= 3) {
+        uint8_t reg = opcode & 0x1F;
+        p_rx[2] = (reg < ADS1292R_REGS) ? m_ads_regs[reg] : 0;
+    } else if ((opcode & 0xE0) == ADS1292R_CMD_WREG && tx_length >= 3) {
+        uint8_t reg = opcode & 0x1F;
+        if (reg > 0 && reg < ADS1292R_REGS) {
+            m_ads_regs[reg] = p_tx[2];
+        }
+    } else {
+        switch (opcode) {
+            case ADS1292R_CMD_WAKEUP:  m_ads_standby = false; break;
+            case ADS1292R_CMD_STANDBY: m_ads_standby = true;  break;
+            case ADS1292R_CMD_RESET:   memset(&m_ads_regs[1], 0, ADS1292R_REGS - 1); break;
+            case ADS1292R_CMD_RDATAC:  m_ads_rdatac = true;   break;
+            case ADS1292R_CMD_SDATAC:  m_ads_rdatac = false;  break;
+            default: break;
+        }
+    }
+}
+
+void ads1292r_model_attach(void) {
+    memset(m_ads_regs, 0, sizeof(m_ads_regs));
+    m_ads_regs[0] = ADS1292R_ID;
+    m_ads_standby = false;
+    m_ads_rdatac = false;
+    host_spi_attach(ADS1292R_SPI_INSTANCE, ads1292r_model_xfer);
+    host_gpio_drive(ADS1292R_DRDY_PIN, true);
+}
+
+/**
+ * @brief One conversion; pulses DRDY if the device is converting
+ */
+void ads1292r_model_convert(int32_t ch1, int32_t ch2) {
+    if (m_ads_standby || !host_gpio_level(ADS1292R_START_PIN)) {
+        return;
+    }
+
+    m_ads_frame[0] = ADS1292R_STATUS_SYNC;
+    m_ads_frame[1] = 0;
+    m_ads_frame[2] = 0;
+    ads1292r_model_put24(&m_ads_frame[3], ch1);
+    ads1292r_model_put24(&m_ads_frame[6], ch2);
+
+    // DRDY stays low until the frame is read; in RDATAC the read follows
+    // immediately through PPI
+    host_gpio_drive(ADS1292R_DRDY_PIN, false);
+    host_gpio_drive(ADS1292R_DRDY_PIN, true);
+}
+
+/* ---------------------------------------------------------------------------
+ * ICM-42688: accel data registers, 2 KB FIFO, watermark and WoM on INT1
+ * ------------------------------------------------------------------------ */
+
+static uint8_t m_icm_regs[2][128];      // Banks 0 and 4
+static uint8_t m_icm_bank = 0;
+static uint8_t m_icm_addr = 0;          // Latched across split transfers
+static uint8_t m_icm_fifo[ICM_FIFO_SIZE];
+static uint16_t m_icm_fifo_head = 0;
+static uint16_t m_icm_fifo_count = 0;
+static uint8_t m_icm_int_status = 0;
+static uint8_t m_icm_int_status2 = 0;
+static int16_t m_icm_prev[3];
+
+static uint8_t *icm42688_model_reg(uint8_t reg) {
+    return &m_icm_regs[m_icm_bank == 4 ? 1 : 0][reg & 0x7F];
+}
+
+static void icm42688_model_fifo_clear(void) {
+    m_icm_fifo_head = 0;
+    m_icm_fifo_count = 0;
+}
+
+static uint8_t icm42688_model_fifo_pop(void) {
+    if (m_icm_fifo_count == 0) {
+        return 0xFF;
+    }
+    uint8_t byte = m_icm_fifo[m_icm_fifo_head];
+    m_icm_fifo_head = (m_icm_fifo_head + 1) % ICM_FIFO_SIZE;
+    m_icm_fifo_count--;
+    return byte;
+}
+
+static void icm42688_model_update_int1(void) {
+    host_gpio_drive(ICM42688_INT1_PIN, (m_icm_int_status & ICM_INT_STATUS_FIFO_THS) ||
+                                      (m_icm_int_status2 & ICM_INT_STATUS2_WOM_XYZ));
+}
+
+static uint8_t icm42688_model_read(uint8_t reg) {
+    uint8_t value;
+
+    if (m_icm_bank != 0) {
+        return *icm42688_model_reg(reg);
+    }
+    switch (reg) {
+        case ICM_REG_WHO_AM_I:
+            return ICM_WHO_AM_I;
+        case ICM_REG_FIFO_COUNTH:
+            return m_icm_fifo_count >> 8;
+        case ICM_REG_FIFO_COUNTL:
+            return m_icm_fifo_count & 0xFF;
+        case ICM_REG_FIFO_DATA:
+            return icm42688_model_fifo_pop();
+        case ICM_REG_INT_STATUS:
+            // Latched sources clear on read
+            value = m_icm_int_status;
+            m_icm_int_status = 0;
+            icm42688_model_update_int1();
+            return value;
+        case ICM_REG_INT_STATUS2:
+            value = m_icm_int_status2;
+            m_icm_int_status2 = 0;
+            icm42688_model_update_int1();
+            return value;
+        default:
+            return *icm42688_model_reg(reg);
+    }
+}
+
+static void icm42688_model_write(uint8_t reg, uint8_t value) {
+    if (reg == ICM_REG_BANK_SEL) {
+        m_icm_bank = value & 0x07;
+        return;
+    }
+    if (m_icm_bank == 0 && reg == ICM_REG_DEVICE_CONFIG && (value & 0x01)) {
+        memset(m_icm_regs, 0, sizeof(m_icm_regs));
+        icm42688_model_fifo_clear();
+        return;
+    }
+    if (m_icm_bank == 0 && reg == ICM_REG_FIFO_CONFIG && (value & ICM_FIFO_MODE_MASK) == 0) {
+        icm42688_model_fifo_clear();    // Bypass mode empties the FIFO
+    }
+    *icm42688_model_reg(reg) = value;
+}
+
+static void icm42688_model_xfer(uint8_t const *p_tx, uint8_t tx_length, uint8_t *p_rx, uint8_t rx_length) {
+    uint8_t rx_pos = 0;
+
+    if (tx_length > 0) {
+        m_icm_addr = p_tx[0];
+        if (!(m_icm_addr & 0x80)) {
+            for (uint8_t i = 1; i < tx_length; i++) {
+                icm42688_model_write((m_icm_addr + i - 1) & 0x7F, p_tx[i]);
+            }
+            return;
+        }
+        // Byte clocked in while the address goes out
+        if (p_rx && rx_length > 0) {
+            p_rx[rx_pos++] = 0;
+        }
+    }
+
+    if (!(m_icm_addr & 0x80) || !p_rx) {
+        return;
+    }
+    uint8_t reg = m_icm_addr & 0x7F;
+    for (; rx_pos < rx_length; rx_pos++) {
+        p_rx[rx_pos] = icm42688_model_read(reg);
+        if (reg != ICM_REG_FIFO_DATA) {
+            reg++;
+        }
+    }
+    m_icm_addr = 0x80 | reg;
+}
+
+void icm42688_model_attach(void) {
+    memset(m_icm_regs, 0, sizeof(m_icm_regs));
+    m_icm_bank = 0;
+    m_icm_int_status = 0;
+    m_icm_int_status2 = 0;
+    memset(m_icm_prev, 0, sizeof(m_icm_prev));
+    icm42688_model_fifo_clear();
+    host_spi_attach(ICM42688_SPI_INSTANCE, icm42688_model_xfer);
+    host_gpio_drive(ICM42688_INT1_PIN, false);
+}
+
+static void icm42688_model_put16(uint8_t *p, int16_t value) {
+    p[0] = ((uint16_t)value >> 8) & 0xFF;
+    p[1] = value & 0xFF;
+}
+
+/**
+ * @brief One accelerometer ODR tick
+ */
+void icm42688_model_sample(int16_t x, int16_t y, int16_t z) {
+    uint8_t *bank0 = m_icm_regs[0];
+    int16_t sample[3] = { x, y, z };
+
+    if ((bank0[ICM_REG_PWR_MGMT0] & ICM_ACCEL_MODE_MASK) == 0) {
+        return;
+    }
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        icm42688_model_put16(&bank0[ICM_REG_ACCEL_DATA_X1 + 2 * axis], sample[axis]);
+    }
+
+    if ((bank0[ICM_REG_FIFO_CONFIG] & ICM_FIFO_MODE_MASK) == ICM_FIFO_MODE_STREAM &&
+        (bank0[ICM_REG_FIFO_CONFIG1] & ICM_FIFO_ACCEL_EN)) {
+        uint8_t packet[ICM_PACKET_SIZE] = { ICM_HEADER_ACCEL };
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            icm42688_model_put16(&packet[1 + 2 * axis], sample[axis]);
+        }
+        if (m_icm_fifo_count + ICM_PACKET_SIZE > ICM_FIFO_SIZE) {
+            // Stream mode drops the oldest packet
+            for (uint8_t i = 0; i < ICM_PACKET_SIZE; i++) {
+                icm42688_model_fifo_pop();
+            }
+            m_icm_int_status |= ICM_INT_STATUS_FIFO_FULL;
+        }
+        for (uint8_t i = 0; i < ICM_PACKET_SIZE; i++) {
+            m_icm_fifo[(m_icm_fifo_head + m_icm_fifo_count) % ICM_FIFO_SIZE] = packet[i];
+            m_icm_fifo_count++;
+        }
+
+        uint16_t watermark = bank0[ICM_REG_FIFO_CONFIG2] | ((bank0[ICM_REG_FIFO_CONFIG3] & 0x0F) << 8);
+        if ((bank0[ICM_REG_INT_SOURCE0] & ICM_INT_FIFO_THS) && watermark > 0 &&
+            m_icm_fifo_count >= watermark) {
+            m_icm_int_status |= ICM_INT_STATUS_FIFO_THS;
+        }
+    }
+
+    if ((bank0[ICM_REG_SMD_CONFIG] & ICM_SMD_MODE_MASK) == ICM_SMD_MODE_WOM) {
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            int32_t delta = (int32_t)sample[axis] - m_icm_prev[axis];
+            int32_t threshold = m_icm_regs[1][ICM_REG_WOM_X_THR + axis] * ICM_WOM_COUNTS_PER_LSB;
+            if ((delta > threshold || -delta > threshold) && (bank0[ICM_REG_INT_SOURCE1] & (1 << axis))) {
+                m_icm_int_status2 |= (1 << axis);
+            }
+        }
+    }
+    memcpy(m_icm_prev, sample, sizeof(m_icm_prev));
+
+    icm42688_model_update_int1();
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef SENSOR_MODELS_H
+#define SENSOR_MODELS_H
+
+#include <stdint.h>
+
+// Register-level device models behind the host HAL shim
+
+void ads1292r_model_attach(void);
+void ads1292r_model_convert(int32_t ch1, int32_t ch2);
+
+void icm42688_model_attach(void);
+void icm42688_model_sample(int16_t x, int16_t y, int16_t z);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+/**
+ * @file hrv.c
+ * @brief Heart rate variability and rhythm features from RR intervals
+ * @description Each ECG capture hands over its RR intervals. An interval
+ *              more than 20% off the capture median is counted as ectopic
+ *              and left out of the normal-to-normal (NN) statistics: SDNN,
+ *              RMSSD and pNN50. Successive differences are only taken
+ *              within a capture, never across the gap between two.
+ *
+ *              The AF score is the share of successive intervals, ectopic
+ *              ones included, that differ by more than 1/8 of the median.
+ *              Sinus rhythm stays low; an isolated ectopic beat adds two
+ *              irregular differences; atrial fibrillation is irregular
+ *              throughout and scores high in every window.
+ *
+ *              Sums accumulate beat by beat in integers until
+ *              hrv_snapshot() turns them into features and starts a new
+ *              window.
+ */
+
+#include "hrv.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_HRV
+#include "trace.h"
+#include <string.h>
+
+#define HRV_ECTOPIC_DIV         5       // Ectopic beyond median / 5 (20%)
+#define HRV_IRREGULAR_DIV       8       // Irregular beyond median / 8 (12.5%)
+#define HRV_NN50_MS             50
+
+// Window accumulators, cleared by hrv_snapshot()
+static uint16_t m_beats;
+static uint16_t m_ectopic;
+static uint16_t m_nn_count;
+static uint32_t m_nn_sum;
+static uint64_t m_nn_sum_sq;
+static uint16_t m_diff_count;           // Successive NN differences
+static uint64_t m_diff_sum_sq;
+static uint16_t m_nn50;
+static uint16_t m_succ_count;           // Successive differences, ectopic included
+static uint16_t m_irregular;
+
+static uint8_t hrv_saturate(uint32_t value) {
+    return (value > UINT8_MAX) ? UINT8_MAX : (uint8_t)value;
+}
+
+/**
+ * @brief Integer square root, rounded down
+ */
+static uint32_t hrv_isqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/**
+ * @brief Median of a capture's intervals, a handful at most
+ */
+static uint16_t hrv_median(uint16_t const *rr_ms, uint8_t count) {
+    uint16_t sorted[HRV_MAX_CAPTURE_RR];
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > rr_ms[i]) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = rr_ms[i];
+    }
+    return (count & 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+}
+
+/**
+ * @brief Start an empty window
+ */
+void hrv_init(void) {
+    m_beats = 0;
+    m_ectopic = 0;
+    m_nn_count = 0;
+    m_nn_sum = 0;
+    m_nn_sum_sq = 0;
+    m_diff_count = 0;
+    m_diff_sum_sq = 0;
+    m_nn50 = 0;
+    m_succ_count = 0;
+    m_irregular = 0;
+}
+
+/**
+ * @brief Add the RR intervals of one capture, in order
+ * @param rr_ms Intervals in ms; out-of-range ones break the succession
+ */
+void hrv_add_capture(uint16_t const *rr_ms, uint8_t count) {
+    uint16_t valid[HRV_MAX_CAPTURE_RR];
+    uint8_t valid_count = 0;
+
+    if (count > HRV_MAX_CAPTURE_RR) {
+        count = HRV_MAX_CAPTURE_RR;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (rr_ms[i] >= HRV_MIN_RR_MS && rr_ms[i] <= HRV_MAX_RR_MS) {
+            valid[valid_count++] = rr_ms[i];
+        }
+    }
+    if (valid_count == 0) {
+        return;
+    }
+    uint16_t median = hrv_median(valid, valid_count);
+
+    uint16_t prev = 0;                  // Previous interval of the capture, 0 if none
+    bool prev_normal = false;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t rr = rr_ms[i];
+        if (rr < HRV_MIN_RR_MS || rr > HRV_MAX_RR_MS) {
+            prev = 0;
+            continue;
+        }
+
+        uint16_t off = (rr > median) ? rr - median : median - rr;
+        bool normal = (off * HRV_ECTOPIC_DIV <= median);
+        m_beats++;
+        if (normal) {
+            m_nn_count++;
+            m_nn_sum += rr;
+            m_nn_sum_sq += (uint32_t)rr * rr;
+        } else {
+            m_ectopic++;
+        }
+
+        if (prev != 0) {
+            uint16_t diff = (rr > prev) ? rr - prev : prev - rr;
+            m_succ_count++;
+            if (diff * HRV_IRREGULAR_DIV > median) {
+                m_irregular++;
+            }
+            if (normal && prev_normal) {
+                m_diff_count++;
+                m_diff_sum_sq += (uint32_t)diff * diff;
+                if (diff > HRV_NN50_MS) {
+                    m_nn50++;
+                }
+            }
+        }
+        prev = rr;
+        prev_normal = normal;
+    }
+}
+
+/**
+ * @brief Features of the window so far, then start a new one
+ * @return false if no interval was seen; features is left alone
+ */
+bool hrv_snapshot(hrv_features_t *features) {
+    if (m_beats == 0) {
+        return false;
+    }
+
+    memset(features, 0, sizeof(*features));
+    features->beats = hrv_saturate(m_beats);
+    features->ectopic = hrv_saturate(m_ectopic);
+
+    // Sample variance without a second pass: (n * sum(x^2) - sum(x)^2) / (n * (n - 1))
+    if (m_nn_count >= 2) {
+        uint64_t n = m_nn_count;
+        uint64_t spread = n * m_nn_sum_sq - (uint64_t)m_nn_sum * m_nn_sum;
+        features->sdnn_ms = hrv_saturate(hrv_isqrt(spread / (n * (n - 1))));
+    }
+    if (m_diff_count > 0) {
+        features->rmssd_ms = hrv_saturate(hrv_isqrt(m_diff_sum_sq / m_diff_count));
+        features->pnn50_pct = (uint8_t)((100UL * m_nn50) / m_diff_count);
+    }
+    if (m_succ_count > 0) {
+        features->af_score = (uint8_t)((255UL * m_irregular) / m_succ_count);
+    }
+
+    TRACE_DEBUG("HRV: %d beats SDNN %d RMSSD %d pNN50 %d%% ectopic %d AF %d", features->beats,
+                features->sdnn_ms, features->rmssd_ms, features->pnn50_pct, features->ectopic,
+                features->af_score);
+    hrv_init();
+    return true;
+}
\ No newline at end of file
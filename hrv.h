@@ -0,0 +1,25 @@
+#ifndef HRV_H
+#define HRV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HRV_MIN_RR_MS           300     // 200 BPM, shorter is a false detection
+#define HRV_MAX_RR_MS           2000    // 30 BPM, longer is a missed beat
+#define HRV_MAX_CAPTURE_RR      16
+
+// Features since the last snapshot, as sent in the telemetry frame (6 bytes)
+typedef struct __attribute__((packed)) {
+    uint8_t beats;              // RR intervals seen, saturated at 255
+    uint8_t sdnn_ms;            // SD of normal RR intervals, saturated at 255
+    uint8_t rmssd_ms;           // RMS of successive normal RR differences, saturated
+    uint8_t pnn50_pct;          // Successive normal differences over 50 ms (%)
+    uint8_t ectopic;            // Intervals over 20% off their capture median
+    uint8_t af_score;           // Share of irregular successive intervals, 255 = all
+} hrv_features_t;
+
+void hrv_init(void);
+void hrv_add_capture(uint16_t const *rr_ms, uint8_t count);
+bool hrv_snapshot(hrv_features_t *features);
+
+#endif
\ No newline at end of file
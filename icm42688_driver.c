@@ -5,11 +5,14 @@
  */
 
 #include "icm42688_driver.h"
+#include "boot.h"
 #include "nrf_drv_spi.h"
+#include "nrf_drv_gpiote.h"
 #include "nrf_gpio.h"
+#include "app_timer.h"
 #include "nrf_delay.h"
 #include "nrf_log.h"
-#include <math.h>
+#include <string.h>
 
 // ICM-42688 Pin Definitions
 #define ICM42688_CS_PIN       20
@@ -19,6 +22,17 @@
 #define ICM42688_REG_DEVICE_CONFIG      0x11
 #define ICM42688_REG_DRIVE_CONFIG       0x13
 #define ICM42688_REG_INT_CONFIG         0x14
+#define ICM42688_REG_FIFO_CONFIG        0x16
+#define ICM42688_REG_INT_STATUS         0x2D
+#define ICM42688_REG_FIFO_COUNTH        0x2E
+#define ICM42688_REG_FIFO_DATA          0x30
+#define ICM42688_REG_INT_STATUS2        0x37
+#define ICM42688_REG_SMD_CONFIG         0x57
+#define ICM42688_REG_FIFO_CONFIG1       0x5F
+#define ICM42688_REG_FIFO_CONFIG2       0x60
+#define ICM42688_REG_FIFO_CONFIG3       0x61
+#define ICM42688_REG_INT_SOURCE1        0x66
+#define ICM42688_REG_BANK_SEL           0x76
 #define ICM42688_REG_PWR_MGMT0          0x4E
 #define ICM42688_REG_GYRO_CONFIG0       0x4F
 #define ICM42688_REG_ACCEL_CONFIG0      0x50
@@ -41,6 +55,11 @@
 #define ICM42688_REG_ACCEL_DATA_Z0      0x24
 #define ICM42688_REG_GYRO_DATA_X1       0x25
 
+// Register Bank 4
+#define ICM42688_REG_ACCEL_WOM_X_THR    0x4A
+#define ICM42688_REG_ACCEL_WOM_Y_THR    0x4B
+#define ICM42688_REG_ACCEL_WOM_Z_THR    0x4C
+
 // WHO_AM_I value
 #define ICM42688_WHO_AM_I_VALUE         0x47
 
@@ -49,6 +68,41 @@
 #define ICM42688_PWR_MGMT0_IDLE         (1 << 4)
 #define ICM42688_PWR_MGMT0_GYRO_MODE_LN (3 << 2)
 #define ICM42688_PWR_MGMT0_ACCEL_MODE_LN (3 << 0)
+#define ICM42688_PWR_MGMT0_ACCEL_MODE_LP (2 << 0)
+
+// Output data rates (ACCEL_CONFIG0 / GYRO_CONFIG0 low nibble)
+#define ICM42688_ODR_100HZ              0x08
+
+// Interrupt and FIFO configuration bits
+#define ICM42688_INT1_ACTIVE_HIGH_PP_LATCHED 0x07  // INT_CONFIG INT1 fields
+#define ICM42688_FIFO_MODE_STREAM       (1 << 6)
+#define ICM42688_FIFO_ACCEL_EN          (1 << 0)
+#define ICM42688_FIFO_WM_GT_TH          (1 << 5)
+#define ICM42688_INT_FIFO_THS_INT1_EN   (1 << 2)
+#define ICM42688_INT_WOM_XYZ_INT1_EN    0x07
+#define ICM42688_SMD_WOM_MODE_PREVIOUS  (1 << 2)
+#define ICM42688_SMD_MODE_WOM           0x01
+#define ICM42688_INT_STATUS_FIFO_FULL   (1 << 1)
+#define ICM42688_FIFO_HEADER_MSG        (1 << 7)
+#define ICM42688_FIFO_HEADER_ACCEL      (1 << 6)
+
+#define ICM42688_FIFO_PACKET_SIZE       8     // Header + accel XYZ + temp
+#define ICM42688_FIFO_SIZE_BYTES        2048
+#define ICM42688_FIFO_CHUNK_PACKETS     31    // Keeps each SPI read under 255 bytes
+
+// Fall analysis (100 Hz LP accel, thresholds in counts^2 via ICM42688_G2)
+#define ICM42688_WOM_THRESHOLD          200   // ~0.78 g sample-to-sample change
+#define FALL_FREEFALL_MAG_SQ            ICM42688_G2(50)   // < 0.5 g
+#define FALL_IMPACT_MAG_SQ              ICM42688_G2(350)  // > 3.5 g
+#define FALL_STILL_LOW_SQ               ICM42688_G2(85)   // Still: within 0.85..1.15 g
+#define FALL_STILL_HIGH_SQ              ICM42688_G2(115)
+#define FALL_FREEFALL_SAMPLES           10    // 100 ms
+#define FALL_IMPACT_WINDOW_SAMPLES      50    // Impact within 500 ms of freefall
+#define FALL_STILL_WM_PACKETS           100   // Watermark every 1 s during observation
+#define FALL_STILL_SECONDS              30    // Stillness required after impact
+#define FALL_STILL_MAX_MOVING           5     // Moving samples tolerated per second
+
+#define ICM42688_ACCEL_STARTUP_MS       20    // Accel off to first valid LN sample
 
 // Accelerometer full-scale ranges
 #define ICM42688_ACCEL_FS_2G            0
@@ -63,6 +117,48 @@ static const nrf_drv_spi_t m_spi = NRF_DRV_SPI_INSTANCE(2);
 static bool m_initialized = false;
 static float accel_scale = 1.0 / ICM42688_ACCEL_SENSITIVITY_16G;
 
+// Always-on fall monitor
+static icm42688_evt_handler_t m_evt_handler = NULL;
+static bool m_monitor_active = false;
+static volatile bool m_int1_pending = false;
+static volatile uint32_t m_int1_ticks = 0;     // RTC ticks of the last INT1
+static uint8_t m_fifo_chunk[ICM42688_FIFO_CHUNK_PACKETS * ICM42688_FIFO_PACKET_SIZE];
+
+typedef struct {
+    uint16_t freefall_run;      // Consecutive samples below freefall threshold
+    uint16_t since_freefall;    // Samples since a qualifying freefall ended
+    bool     freefall_seen;
+    bool     fall_detected;     // Latched until read by icm42688_get_fall_status()
+    bool     observing;         // Post-fall stillness observation running
+    bool     no_movement;
+    uint32_t peak_mag_sq;
+    uint16_t second_samples;    // Samples in current one-second bucket
+    uint16_t second_moving;     // Moving samples in current bucket
+    uint8_t  still_seconds;     // Consecutive still seconds since impact
+} fall_state_t;
+
+static fall_state_t m_fall;
+
+// Non-blocking accelerometer snapshot
+static icm42688_done_handler_t m_done_handler = NULL;
+static bool m_read_done = false;
+
+// Init sequence, advanced by icm42688_init_step()
+typedef enum {
+    ICM42688_INIT_START,
+    ICM42688_INIT_WHO_AM_I,             // Powering up
+    ICM42688_INIT_POWER_MODE,           // Soft reset in progress
+    ICM42688_INIT_CONFIGURE             // Sensors starting in LN mode
+} icm42688_init_state_t;
+
+static icm42688_init_state_t m_init_state = ICM42688_INIT_START;
+
+// Wake-up readiness
+APP_TIMER_DEF(m_startup_timer);
+static icm42688_ready_handler_t m_ready_handler = NULL;
+static volatile bool m_ready_pending = false;
+static int16_t m_accel_raw[3] = {0, 0, ICM42688_LSB_PER_G};
+
 /**
  * @brief Write register
  */
@@ -107,64 +203,114 @@ static void icm42688_read_registers(uint8_t reg, uint8_t *buffer, uint8_t length
 }
 
 /**
- * @brief Initialize ICM-42688
+ * @brief Accelerometer start-up timer, signals that accel data is valid
  */
-int icm42688_init(void) {
+static void icm42688_startup_timeout_handler(void *p_context) {
+    m_ready_pending = true;
+}
+
+/**
+ * @brief Advance the init sequence by one step
+ * @return ms to wait before the next step, 0 once initialized, -1 on failure
+ * @note After a warm reset the device is still powered and configured. If
+ *       it answers with the WHO_AM_I it had before, the power-up wait and
+ *       soft reset (200 ms) are skipped.
+ */
+int32_t icm42688_init_step(void) {
     ret_code_t err_code;
+    uint8_t who_am_i;
     
-    // Configure CS pin
-    nrf_gpio_cfg_output(ICM42688_CS_PIN);
-    nrf_gpio_pin_set(ICM42688_CS_PIN);
-    
-    // Configure INT1 pin
-    nrf_gpio_cfg_input(ICM42688_INT1_PIN, NRF_GPIO_PIN_PULLUP);
-    
-    // Initialize SPI
-    nrf_drv_spi_config_t spi_config = NRF_DRV_SPI_DEFAULT_CONFIG;
-    spi_config.ss_pin   = NRF_DRV_SPI_PIN_NOT_USED;
-    spi_config.miso_pin = 8;   // Adjust to your circuit
-    spi_config.mosi_pin = 9;   // Adjust to your circuit
-    spi_config.sck_pin  = 10;  // Adjust to your circuit
-    spi_config.frequency = NRF_DRV_SPI_FREQ_8M;
-    spi_config.mode = NRF_DRV_SPI_MODE_0; // CPOL=0, CPHA=0
-    
-    err_code = nrf_drv_spi_init(&m_spi, &spi_config, NULL, NULL);
-    if (err_code != NRF_SUCCESS) {
-        NRF_LOG_ERROR("ICM42688 SPI init failed: %d", err_code);
-        return -1;
+    switch (m_init_state) {
+        case ICM42688_INIT_START:
+            // Configure CS pin
+            nrf_gpio_cfg_output(ICM42688_CS_PIN);
+            nrf_gpio_pin_set(ICM42688_CS_PIN);
+            
+            // INT1 is driven push-pull active-high once configured, see
+            // icm42688_fall_monitor_start()
+            nrf_gpio_cfg_input(ICM42688_INT1_PIN, NRF_GPIO_PIN_PULLDOWN);
+            
+            // Initialize SPI
+            nrf_drv_spi_config_t spi_config = NRF_DRV_SPI_DEFAULT_CONFIG;
+            spi_config.ss_pin   = NRF_DRV_SPI_PIN_NOT_USED;
+            spi_config.miso_pin = 8;   // Adjust to your circuit
+            spi_config.mosi_pin = 9;   // Adjust to your circuit
+            spi_config.sck_pin  = 10;  // Adjust to your circuit
+            spi_config.frequency = NRF_DRV_SPI_FREQ_8M;
+            spi_config.mode = NRF_DRV_SPI_MODE_0; // CPOL=0, CPHA=0
+            
+            err_code = nrf_drv_spi_init(&m_spi, &spi_config, NULL, NULL);
+            if (err_code != NRF_SUCCESS) {
+                NRF_LOG_ERROR("ICM42688 SPI init failed: %d", err_code);
+                return -1;
+            }
+            
+            if (boot_warm()) {
+                // The bank in use when the MCU reset is still selected
+                icm42688_write_register(ICM42688_REG_BANK_SEL, 0);
+                if (boot_sensor_known(BOOT_SENSOR_ICM42688, icm42688_read_register(ICM42688_REG_WHO_AM_I))) {
+                    NRF_LOG_INFO("ICM-42688 configured before reset, reset skipped");
+                    m_init_state = ICM42688_INIT_POWER_MODE;
+                    return 1;   // Next step right away
+                }
+            }
+            boot_sensor_forget(BOOT_SENSOR_ICM42688);
+            m_init_state = ICM42688_INIT_WHO_AM_I;
+            return 100; // Power-up time
+            
+        case ICM42688_INIT_WHO_AM_I:
+            // Read WHO_AM_I
+            who_am_i = icm42688_read_register(ICM42688_REG_WHO_AM_I);
+            NRF_LOG_INFO("ICM-42688 WHO_AM_I: 0x%02X", who_am_i);
+            
+            if (who_am_i != ICM42688_WHO_AM_I_VALUE) {
+                NRF_LOG_ERROR("ICM-42688 WHO_AM_I mismatch");
+                m_init_state = ICM42688_INIT_START;
+                return -1;
+            }
+            
+            // Soft reset
+            icm42688_write_register(ICM42688_REG_DEVICE_CONFIG, 0x01);
+            m_init_state = ICM42688_INIT_POWER_MODE;
+            return 100;
+            
+        case ICM42688_INIT_POWER_MODE:
+            // Configure power management: Accelerometer and Gyro in Low Noise mode
+            icm42688_write_register(ICM42688_REG_PWR_MGMT0, 
+                                    ICM42688_PWR_MGMT0_ACCEL_MODE_LN | 
+                                    ICM42688_PWR_MGMT0_GYRO_MODE_LN);
+            m_init_state = ICM42688_INIT_CONFIGURE;
+            return 50;
+            
+        case ICM42688_INIT_CONFIGURE:
+            break;
     }
-    
-    nrf_delay_ms(100); // Power-up time
-    
-    // Read WHO_AM_I
-    uint8_t who_am_i = icm42688_read_register(ICM42688_REG_WHO_AM_I);
-    NRF_LOG_INFO("ICM-42688 WHO_AM_I: 0x%02X", who_am_i);
-    
-    if (who_am_i != ICM42688_WHO_AM_I_VALUE) {
-        NRF_LOG_ERROR("ICM-42688 WHO_AM_I mismatch");
-        return -1;
-    }
-    
-    // Soft reset
-    icm42688_write_register(ICM42688_REG_DEVICE_CONFIG, 0x01);
-    nrf_delay_ms(100);
-    
-    // Configure power management: Accelerometer and Gyro in Low Noise mode
-    icm42688_write_register(ICM42688_REG_PWR_MGMT0, 
-                            ICM42688_PWR_MGMT0_ACCEL_MODE_LN | 
-                            ICM42688_PWR_MGMT0_GYRO_MODE_LN);
-    nrf_delay_ms(50);
+    m_init_state = ICM42688_INIT_START;
     
     // Configure accelerometer: ±16g, 100Hz ODR
     icm42688_write_register(ICM42688_REG_ACCEL_CONFIG0, 
-                            (ICM42688_ACCEL_FS_16G << 5) | 0x05); // 100Hz
+                            (ICM42688_ACCEL_FS_16G << 5) | ICM42688_ODR_100HZ);
     
     // Configure gyro: ±2000 dps, 100Hz ODR
-    icm42688_write_register(ICM42688_REG_GYRO_CONFIG0, (3 << 5) | 0x05);
+    icm42688_write_register(ICM42688_REG_GYRO_CONFIG0, (3 << 5) | ICM42688_ODR_100HZ);
     
     // Set accel scale based on ±16g
     accel_scale = 16.0 / 32768.0;
     
+    err_code = app_timer_create(&m_startup_timer, APP_TIMER_MODE_SINGLE_SHOT,
+                                icm42688_startup_timeout_handler);
+    if (err_code != NRF_SUCCESS) {
+        return -1;
+    }
+    
+    // The fall monitor configures the rest, this much is known to be in place
+    if (icm42688_read_register(ICM42688_REG_ACCEL_CONFIG0) ==
+        ((ICM42688_ACCEL_FS_16G << 5) | ICM42688_ODR_100HZ)) {
+        boot_sensor_store(BOOT_SENSOR_ICM42688, ICM42688_WHO_AM_I_VALUE);
+    } else {
+        boot_sensor_forget(BOOT_SENSOR_ICM42688);
+    }
+    
     m_initialized = true;
     NRF_LOG_INFO("ICM-42688 initialized successfully");
     
@@ -172,15 +318,43 @@ int icm42688_init(void) {
 }
 
 /**
- * @brief Wake up ICM-42688
+ * @brief Initialize ICM-42688 (blocking)
  */
-void icm42688_wakeup(void) {
-    if (m_initialized) {
-        icm42688_write_register(ICM42688_REG_PWR_MGMT0, 
-                                ICM42688_PWR_MGMT0_ACCEL_MODE_LN | 
-                                ICM42688_PWR_MGMT0_GYRO_MODE_LN);
-        nrf_delay_ms(50);
+int icm42688_init(void) {
+    int32_t wait;
+    while ((wait = icm42688_init_step()) > 0) {
+        nrf_delay_ms(wait);
+    }
+    return (int)wait;
+}
+
+/**
+ * @brief Wake up ICM-42688 (non-blocking)
+ * @param handler Called from icm42688_process() once accel data is valid
+ * @return 0 if the wake-up was started
+ * @note The FIFO keeps streaming at the same ODR, so the fall monitor is
+ *       unaffected by the switch to low-noise mode.
+ */
+int icm42688_wakeup(icm42688_ready_handler_t handler) {
+    if (!m_initialized) {
+        return -1;
+    }
+    
+    icm42688_write_register(ICM42688_REG_PWR_MGMT0, 
+                            ICM42688_PWR_MGMT0_ACCEL_MODE_LN | 
+                            ICM42688_PWR_MGMT0_GYRO_MODE_LN);
+    
+    m_ready_handler = handler;
+    m_ready_pending = false;
+    if (m_monitor_active) {
+        // Accelerometer was already running in LP mode
+        m_ready_pending = true;
+    } else if (app_timer_start(m_startup_timer, APP_TIMER_TICKS(ICM42688_ACCEL_STARTUP_MS),
+                               NULL) != NRF_SUCCESS) {
+        return -1;
     }
+    
+    return 0;
 }
 
 /**
@@ -188,6 +362,14 @@ void icm42688_wakeup(void) {
  */
 void icm42688_sleep(void) {
     if (m_initialized) {
+        app_timer_stop(m_startup_timer);
+        m_ready_pending = false;
+    }
+    
+    if (m_initialized && m_monitor_active) {
+        // Keep the LP accelerometer running for the fall monitor
+        icm42688_write_register(ICM42688_REG_PWR_MGMT0, ICM42688_PWR_MGMT0_ACCEL_MODE_LP);
+    } else if (m_initialized) {
         icm42688_write_register(ICM42688_REG_PWR_MGMT0, 0x00); // All sensors off
     }
 }
@@ -244,37 +426,303 @@ void icm42688_read_gyro(float *gyro_x, float *gyro_y, float *gyro_z) {
 }
 
 /**
- * @brief Detect fall using accelerometer data
- * @return true if fall detected, false otherwise
+ * @brief Select register bank
  */
-bool icm42688_detect_fall(void) {
-    float ax, ay, az;
-    icm42688_read_accel(&ax, &ay, &az);
-    
-    // Calculate acceleration magnitude
-    float magnitude = sqrtf(ax*ax + ay*ay + az*az);
-    
-    // Free fall detection: magnitude < 0.5g for >100ms
-    // Impact detection: magnitude > 3.5g
-    
-    static uint8_t freefall_count = 0;
-    static bool in_freefall = false;
-    
-    if (magnitude < 0.5) {
-        freefall_count++;
-        if (freefall_count > 10) { // 100ms at 100Hz
-            in_freefall = true;
+static void icm42688_select_bank(uint8_t bank) {
+    icm42688_write_register(ICM42688_REG_BANK_SEL, bank);
+}
+
+/**
+ * @brief INT1 handler: WoM or FIFO watermark. Work is deferred to
+ *        icm42688_process() in thread context.
+ */
+static void icm42688_int1_handler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action) {
+    m_int1_ticks = app_timer_cnt_get();
+    m_int1_pending = true;
+}
+
+/**
+ * @brief Enable or disable one-second FIFO watermark interrupts
+ */
+static void icm42688_set_watermark_int(bool enable) {
+    icm42688_write_register(ICM42688_REG_INT_SOURCE0,
+                            enable ? ICM42688_INT_FIFO_THS_INT1_EN : 0x00);
+}
+
+/**
+ * @brief Run fall analysis on one accelerometer sample
+ */
+static void fall_process_sample(int16_t x, int16_t y, int16_t z) {
+    uint32_t mag_sq = (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z);
+
+    if (m_fall.observing) {
+        // Post-fall: count still seconds, a moving second ends observation
+        if (mag_sq < FALL_STILL_LOW_SQ || mag_sq > FALL_STILL_HIGH_SQ) {
+            m_fall.second_moving++;
         }
-    } else if (magnitude > 3.5 && in_freefall) {
-        // Impact after freefall = FALL DETECTED
-        NRF_LOG_WARNING("FALL DETECTED! Impact: %.2f g", magnitude);
-        freefall_count = 0;
-        in_freefall = false;
-        return true;
-    } else {
-        freefall_count = 0;
-        in_freefall = false;
+        if (++m_fall.second_samples >= FALL_STILL_WM_PACKETS) {
+            bool still = (m_fall.second_moving <= FALL_STILL_MAX_MOVING);
+            m_fall.second_samples = 0;
+            m_fall.second_moving = 0;
+
+            if (!still) {
+                m_fall.observing = false;
+                icm42688_set_watermark_int(false);
+                if (m_evt_handler) m_evt_handler(ICM42688_EVT_RECOVERED, m_fall.peak_mag_sq);
+            } else if (++m_fall.still_seconds >= FALL_STILL_SECONDS) {
+                m_fall.observing = false;
+                m_fall.no_movement = true;
+                icm42688_set_watermark_int(false);
+                if (m_evt_handler) m_evt_handler(ICM42688_EVT_NO_MOVEMENT, m_fall.peak_mag_sq);
+            }
+        }
+        return;
     }
-    
-    return false;
+
+    // Freefall: magnitude near zero for at least 100 ms
+    if (mag_sq < FALL_FREEFALL_MAG_SQ) {
+        if (++m_fall.freefall_run >= FALL_FREEFALL_SAMPLES) {
+            m_fall.freefall_seen = true;
+            m_fall.since_freefall = 0;
+        }
+        return;
+    }
+    m_fall.freefall_run = 0;
+
+    if (!m_fall.freefall_seen) {
+        return;
+    }
+
+    // Impact must follow the freefall closely
+    if (mag_sq > FALL_IMPACT_MAG_SQ) {
+        m_fall.freefall_seen = false;
+        m_fall.fall_detected = true;
+        m_fall.no_movement = false;
+        m_fall.peak_mag_sq = mag_sq;
+
+        m_fall.observing = true;
+        m_fall.second_samples = 0;
+        m_fall.second_moving = 0;
+        m_fall.still_seconds = 0;
+        icm42688_set_watermark_int(true);
+
+        if (m_evt_handler) m_evt_handler(ICM42688_EVT_FALL, mag_sq);
+    } else if (++m_fall.since_freefall > FALL_IMPACT_WINDOW_SAMPLES) {
+        m_fall.freefall_seen = false;
+    }
+}
+
+/**
+ * @brief Burst-read the FIFO in chunks and analyze every buffered sample
+ */
+static void icm42688_drain_fifo(void) {
+    uint8_t count_buf[2];
+    uint8_t int_status = icm42688_read_register(ICM42688_REG_INT_STATUS);
+
+    icm42688_read_registers(ICM42688_REG_FIFO_COUNTH, count_buf, 2);
+    uint16_t bytes = (count_buf[0] << 8) | count_buf[1];
+
+    // A full FIFO has dropped samples since the last read; the buffered
+    // window is not contiguous with earlier analysis state
+    if ((int_status & ICM42688_INT_STATUS_FIFO_FULL) || bytes >= ICM42688_FIFO_SIZE_BYTES) {
+        m_fall.freefall_run = 0;
+        m_fall.freefall_seen = false;
+    }
+
+    uint16_t packets = bytes / ICM42688_FIFO_PACKET_SIZE;
+    while (packets > 0) {
+        uint8_t chunk = (packets > ICM42688_FIFO_CHUNK_PACKETS) ? ICM42688_FIFO_CHUNK_PACKETS : packets;
+        icm42688_read_registers(ICM42688_REG_FIFO_DATA, m_fifo_chunk,
+                                chunk * ICM42688_FIFO_PACKET_SIZE);
+
+        for (uint8_t i = 0; i < chunk; i++) {
+            uint8_t *p = &m_fifo_chunk[i * ICM42688_FIFO_PACKET_SIZE];
+            if ((p[0] & ICM42688_FIFO_HEADER_MSG) || !(p[0] & ICM42688_FIFO_HEADER_ACCEL)) {
+                continue;
+            }
+            int16_t x = (int16_t)((p[1] << 8) | p[2]);
+            int16_t y = (int16_t)((p[3] << 8) | p[4]);
+            int16_t z = (int16_t)((p[5] << 8) | p[6]);
+            if (x == INT16_MIN) {
+                continue; // Invalid sample marker
+            }
+            fall_process_sample(x, y, z);
+        }
+        packets -= chunk;
+    }
+}
+
+/**
+ * @brief Arm always-on fall detection
+ * @description Accelerometer runs in LP mode at 100 Hz streaming into the
+ *              2 KB FIFO (~2.5 s history). Wake-on-motion on INT1 wakes the
+ *              MCU, which then analyzes the buffered window for freefall
+ *              followed by impact.
+ */
+int icm42688_fall_monitor_start(icm42688_evt_handler_t handler) {
+    ret_code_t err_code;
+
+    if (!m_initialized) {
+        return -1;
+    }
+
+    m_evt_handler = handler;
+    memset(&m_fall, 0, sizeof(m_fall));
+
+    // Accel only, LP mode, 100 Hz
+    icm42688_write_register(ICM42688_REG_PWR_MGMT0, ICM42688_PWR_MGMT0_ACCEL_MODE_LP);
+    icm42688_write_register(ICM42688_REG_ACCEL_CONFIG0,
+                            (ICM42688_ACCEL_FS_16G << 5) | ICM42688_ODR_100HZ);
+    nrf_delay_ms(1);
+
+    // FIFO: stream mode, accel packets, watermark at one second of data
+    icm42688_write_register(ICM42688_REG_FIFO_CONFIG1,
+                            ICM42688_FIFO_ACCEL_EN | ICM42688_FIFO_WM_GT_TH);
+    icm42688_write_register(ICM42688_REG_FIFO_CONFIG2,
+                            (FALL_STILL_WM_PACKETS * ICM42688_FIFO_PACKET_SIZE) & 0xFF);
+    icm42688_write_register(ICM42688_REG_FIFO_CONFIG3,
+                            (FALL_STILL_WM_PACKETS * ICM42688_FIFO_PACKET_SIZE) >> 8);
+    icm42688_write_register(ICM42688_REG_FIFO_CONFIG, ICM42688_FIFO_MODE_STREAM);
+
+    // Wake-on-motion thresholds
+    icm42688_select_bank(4);
+    icm42688_write_register(ICM42688_REG_ACCEL_WOM_X_THR, ICM42688_WOM_THRESHOLD);
+    icm42688_write_register(ICM42688_REG_ACCEL_WOM_Y_THR, ICM42688_WOM_THRESHOLD);
+    icm42688_write_register(ICM42688_REG_ACCEL_WOM_Z_THR, ICM42688_WOM_THRESHOLD);
+    icm42688_select_bank(0);
+    nrf_delay_ms(1);
+
+    // INT1: push-pull, active high, latched; WoM routed, watermark off
+    icm42688_write_register(ICM42688_REG_INT_CONFIG, ICM42688_INT1_ACTIVE_HIGH_PP_LATCHED);
+    icm42688_write_register(ICM42688_REG_INT_CONFIG1, 0x00); // INT_ASYNC_RESET cleared
+    icm42688_write_register(ICM42688_REG_INT_SOURCE1, ICM42688_INT_WOM_XYZ_INT1_EN);
+    icm42688_set_watermark_int(false);
+    icm42688_write_register(ICM42688_REG_SMD_CONFIG,
+                            ICM42688_SMD_WOM_MODE_PREVIOUS | ICM42688_SMD_MODE_WOM);
+
+    if (!nrf_drv_gpiote_is_init()) {
+        err_code = nrf_drv_gpiote_init();
+        if (err_code != NRF_SUCCESS) return -1;
+    }
+    nrf_drv_gpiote_in_config_t int_config = GPIOTE_CONFIG_IN_SENSE_LOTOHI(false);
+    err_code = nrf_drv_gpiote_in_init(ICM42688_INT1_PIN, &int_config, icm42688_int1_handler);
+    if (err_code != NRF_SUCCESS) return -1;
+    nrf_drv_gpiote_in_event_enable(ICM42688_INT1_PIN, true);
+
+    m_monitor_active = true;
+    NRF_LOG_INFO("ICM-42688 fall monitor armed");
+
+    return 0;
+}
+
+/**
+ * @brief Disarm always-on fall detection
+ */
+void icm42688_fall_monitor_stop(void) {
+    if (!m_monitor_active) {
+        return;
+    }
+
+    nrf_drv_gpiote_in_event_disable(ICM42688_INT1_PIN);
+    nrf_drv_gpiote_in_uninit(ICM42688_INT1_PIN);
+
+    icm42688_write_register(ICM42688_REG_SMD_CONFIG, 0x00);
+    icm42688_write_register(ICM42688_REG_INT_SOURCE1, 0x00);
+    icm42688_set_watermark_int(false);
+    icm42688_write_register(ICM42688_REG_FIFO_CONFIG, 0x00); // Bypass
+
+    m_monitor_active = false;
+}
+
+/**
+ * @brief Start an accelerometer snapshot
+ * @param handler Called from icm42688_process() once the result is ready
+ * @return 0 if the read was started
+ * @note Data registers update continuously, so the read itself is immediate;
+ *       completion is still reported through icm42688_process() so callers
+ *       treat every sensor alike.
+ */
+int icm42688_start_read(icm42688_done_handler_t handler) {
+    if (!m_initialized) {
+        return -1;
+    }
+
+    uint8_t data[6];
+    icm42688_read_registers(ICM42688_REG_ACCEL_DATA_X1, data, 6);
+    m_accel_raw[0] = (int16_t)((data[0] << 8) | data[1]);
+    m_accel_raw[1] = (int16_t)((data[2] << 8) | data[3]);
+    m_accel_raw[2] = (int16_t)((data[4] << 8) | data[5]);
+    m_done_handler = handler;
+    m_read_done = true;
+
+    return 0;
+}
+
+/**
+ * @brief Accelerometer values from the last snapshot
+ */
+void icm42688_get_accel(float *accel_x, float *accel_y, float *accel_z) {
+    *accel_x = m_accel_raw[0] * accel_scale;
+    *accel_y = m_accel_raw[1] * accel_scale;
+    *accel_z = m_accel_raw[2] * accel_scale;
+}
+
+/**
+ * @brief Raw accelerometer counts from the last snapshot (ICM42688_LSB_PER_G)
+ */
+void icm42688_get_accel_raw(int16_t accel_raw[3]) {
+    accel_raw[0] = m_accel_raw[0];
+    accel_raw[1] = m_accel_raw[1];
+    accel_raw[2] = m_accel_raw[2];
+}
+
+/**
+ * @brief Service readiness, pending INT1 events and snapshot completion;
+ *        call from the main loop
+ */
+void icm42688_process(void) {
+    if (m_ready_pending) {
+        m_ready_pending = false;
+        if (m_ready_handler) {
+            m_ready_handler();
+        }
+    }
+
+    if (m_monitor_active && m_int1_pending) {
+        m_int1_pending = false;
+
+        // Reading the status registers clears the latched INT1 sources
+        (void)icm42688_read_register(ICM42688_REG_INT_STATUS2);
+        icm42688_drain_fifo();
+    }
+
+    if (m_read_done) {
+        m_read_done = false;
+        if (m_done_handler) {
+            m_done_handler();
+        }
+    }
+}
+
+/**
+ * @brief Read and clear the latched fall status
+ */
+void icm42688_get_fall_status(bool *fall_detected, bool *no_movement) {
+    *fall_detected = m_fall.fall_detected;
+    *no_movement = m_fall.no_movement;
+
+    // Keep reporting the fall while stillness is still being observed
+    if (!m_fall.observing) {
+        m_fall.fall_detected = false;
+        m_fall.no_movement = false;
+    }
+}
+
+/**
+ * @brief RTC ticks of the interrupt that delivered the last event
+ * @note Start of the fall-to-uplink latency; the event itself is raised
+ *       later from icm42688_process() in thread context
+ */
+uint32_t icm42688_event_ticks(void) {
+    return m_int1_ticks;
 }
\ No newline at end of file
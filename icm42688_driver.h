@@ -4,11 +4,35 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Accelerometer scale at the configured +-16 g full scale, and a squared
+// magnitude threshold in counts^2 from hundredths of g
+#define ICM42688_LSB_PER_G          2048
+#define ICM42688_G2(g_x100)         ((uint32_t)((g_x100) * ICM42688_LSB_PER_G / 100) * \
+                                     (uint32_t)((g_x100) * ICM42688_LSB_PER_G / 100))
+
+typedef enum {
+    ICM42688_EVT_FALL,          // Freefall followed by impact
+    ICM42688_EVT_NO_MOVEMENT,   // Wearer stayed still after the fall
+    ICM42688_EVT_RECOVERED      // Movement resumed after the fall
+} icm42688_evt_t;
+
+typedef void (*icm42688_evt_handler_t)(icm42688_evt_t evt, uint32_t impact_mag_sq);
+typedef void (*icm42688_ready_handler_t)(void);
+typedef void (*icm42688_done_handler_t)(void);
+
 int icm42688_init(void);
-void icm42688_wakeup(void);
+int32_t icm42688_init_step(void);
+int icm42688_wakeup(icm42688_ready_handler_t handler);
 void icm42688_sleep(void);
 void icm42688_read_accel(float *accel_x, float *accel_y, float *accel_z);
 void icm42688_read_gyro(float *gyro_x, float *gyro_y, float *gyro_z);
-bool icm42688_detect_fall(void);
+int icm42688_start_read(icm42688_done_handler_t handler);
+void icm42688_get_accel(float *accel_x, float *accel_y, float *accel_z);
+void icm42688_get_accel_raw(int16_t accel_raw[3]);
+void icm42688_process(void);
+int icm42688_fall_monitor_start(icm42688_evt_handler_t handler);
+void icm42688_fall_monitor_stop(void);
+void icm42688_get_fall_status(bool *fall_detected, bool *no_movement);
+uint32_t icm42688_event_ticks(void);
 
 #endif
\ No newline at end of file
@@ -19,6 +19,7 @@
 #include "nrf_drv_rtc.h"
 #include "nrf_drv_clock.h"
 #include "app_timer.h"
+#include "app_scheduler.h"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
@@ -29,33 +30,46 @@
 #include "tmp117_driver.h"
 #include "icm42688_driver.h"
 #include "communication.h"
+#include "transport.h"
+#include "vitals.h"
+#include "health.h"
+#include "trend.h"
+#include "telemetry.h"
+#include "vitals_log.h"
+#include "twi_bus.h"
+#include "profiler.h"
+#include "ecg_stream.h"
+#include "boot.h"
+#include "ptt.h"
+#include "hrv.h"
+#include "qrs_detector.h"
+#include "power_bench.h"
+
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_MAIN
+#include "trace.h"
 
 // Configuration Constants
 #define NORMAL_MONITORING_INTERVAL_MS    35000  // 35 seconds
 #define EXTENDED_MONITORING_INTERVAL_MS  10000  // 10 seconds for anomalies
 #define EMERGENCY_MONITORING_INTERVAL_MS 5000   // 5 seconds for critical
-#define SENSOR_WARMUP_TIME_MS            2000   // Sensor stabilization time
-
-// Health Thresholds
-#define SPO2_MIN_NORMAL          92      // Below 92% is concerning
-#define SPO2_MIN_CRITICAL        85      // Below 85% is critical
-#define HEART_RATE_MIN           45      // BPM
-#define HEART_RATE_MAX           120     // BPM (for underground work)
-#define HEART_RATE_CRITICAL_MIN  40
-#define HEART_RATE_CRITICAL_MAX  150
-#define TEMP_MIN_NORMAL          35.5    // Celsius
-#define TEMP_MAX_NORMAL          38.5    // Celsius
-#define TEMP_CRITICAL_MIN        35.0
-#define TEMP_CRITICAL_MAX        40.0
-#define BP_SYSTOLIC_MAX          160     // mmHg
-#define BP_SYSTOLIC_MIN          90
-#define BP_DIASTOLIC_MAX         100
-#define BP_DIASTOLIC_MIN         60
-
-// Fall Detection Thresholds
-#define FALL_ACCEL_THRESHOLD     2.5     // g-force
-#define FALL_IMPACT_THRESHOLD    3.5     // g-force
-#define NO_MOVEMENT_TIME_MS      30000   // 30 seconds no movement after fall
+
+// TMP117 alert limits; the benchmark firmware runs at room temperature and
+// wakes on its tick only
+#if POWER_BENCH_CYCLES > 0
+#define TEMP_ALERT_MAX                   INT16_MAX
+#define TEMP_ALERT_MIN                   INT16_MIN
+#else
+#define TEMP_ALERT_MAX                   TEMP_CRITICAL_MAX
+#define TEMP_ALERT_MIN                   TEMP_CRITICAL_MIN
+#endif
+
+// Event queue: the largest event is a main_evt_t; interrupts post at most
+// one wake tick at a time, the rest is posted from thread context
+#define SCHED_MAX_EVENT_DATA_SIZE   sizeof(main_evt_t)
+#define SCHED_QUEUE_SIZE            8
+
+// Fall detection thresholds live in icm42688_driver.c, which runs the
+// always-on freefall/impact/stillness analysis on the IMU FIFO
 
 // System States
 typedef enum {
@@ -67,28 +81,14 @@ typedef enum {
     STATE_TRANSMITTING
 } system_state_t;
 
-// Health Status
+// State machine events, posted to app_scheduler
 typedef enum {
-    HEALTH_NORMAL,
-    HEALTH_WARNING,
-    HEALTH_CRITICAL,
-    HEALTH_EMERGENCY
-} health_status_t;
+    MAIN_EVT_WAKE,          // Monitoring tick, fall or temperature alert
+    MAIN_EVT_ACQ_DONE,      // Every sensor has reported its acquisition
+    MAIN_EVT_EMERGENCY      // Critical reading, send what is pending now
+} main_evt_t;
 
-// Vital Signs Structure
-typedef struct {
-    uint8_t  spo2;              // Blood oxygen saturation (%)
-    uint16_t heart_rate;        // Beats per minute
-    uint16_t bp_systolic;       // Blood pressure systolic (mmHg)
-    uint16_t bp_diastolic;      // Blood pressure diastolic (mmHg)
-    float    temperature;       // Body temperature (Celsius)
-    float    accel_x;           // Accelerometer X-axis (g)
-    float    accel_y;           // Accelerometer Y-axis (g)
-    float    accel_z;           // Accelerometer Z-axis (g)
-    bool     fall_detected;     // Fall detection flag
-    bool     no_movement;       // No movement detected flag
-    uint32_t timestamp;         // Measurement timestamp
-} vital_signs_t;
+// Vital signs are kept in raw sensor units, see vitals.h
 
 // System Context
 typedef struct {
@@ -101,6 +101,25 @@ typedef struct {
     uint32_t         last_measurement_time;
 } system_context_t;
 
+// Acquisition scheduler: one bit per sensor that is warming up or measuring
+#define ACQ_MAX30102    (1 << 0)
+#define ACQ_ADS1292R    (1 << 1)
+#define ACQ_TMP117      (1 << 2)
+#define ACQ_ICM42688    (1 << 3)
+#define ACQ_SENSOR_COUNT    4
+#define ACQ_ALL         ((1 << ACQ_SENSOR_COUNT) - 1)
+
+// Sampling period of each sensor by health status, 0 samples every cycle.
+// A sensor skipped on a tick keeps its last reading, marked stale. Periods
+// stay below the 512 s wrap of the RTC counter they are measured against.
+static const uint32_t m_acq_period_ms[ACQ_SENSOR_COUNT][HEALTH_EMERGENCY + 1] = {
+    //               NORMAL   WARNING  CRITICAL EMERGENCY
+    /* MAX30102 */ { 0,       0,       0,       0 },
+    /* ADS1292R */ { 140000,  0,       0,       0 },
+    /* TMP117   */ { 300000,  60000,   0,       0 },
+    /* ICM42688 */ { 0,       0,       0,       0 },
+};
+
 // Global system context
 static system_context_t g_system_ctx = {
     .current_state = STATE_SLEEP,
@@ -113,19 +132,68 @@ static system_context_t g_system_ctx = {
 
 // Timer instance
 APP_TIMER_DEF(m_monitoring_timer);
+static uint32_t m_timer_interval = 0;       // Interval the timer is armed with
+
+// Sleep residency over the current cycle (RTC ticks)
+static uint32_t m_cycle_start = 0;
+static uint32_t m_sleep_ticks = 0;
+static bool m_peripherals_down = false;
+
+// Sensors still warming up or acquiring (ACQ_* bits)
+static uint8_t m_acq_pending = 0;
+static uint8_t m_warmup_pending = 0;        // Not yet reported ready
+
+// Sensors woken this cycle, and when each was last sampled (RTC ticks)
+static uint8_t m_acq_awake = 0;
+static uint8_t m_acq_sampled = 0;           // Sampled at least once
+static uint8_t m_acq_forced = 0;            // Due on the next tick regardless
+static uint32_t m_acq_last[ACQ_SENSOR_COUNT];
+
+// A fall cut the cycle short: sensors still warming up are dropped unsampled
+// and a fresh cycle follows at once
+static bool m_acq_cut = false;
+static uint8_t m_acq_dropped = 0;           // Woken but never sampled
+
+// Alert frame encoded ahead of the event, only stamped and queued when it comes
+static uint8_t m_alert_frame[TELEMETRY_ALERT_SIZE];
+
+// An event handler left driver work with no interrupt behind it, so the
+// drivers are polled again before the core idles
+static bool m_rerun = false;
+
+// A backlog frame is queued; its last sequence number is the TX context
+static bool m_upload_in_flight = false;
+
+// The flash log failed: readings are batched in RAM and sent from there,
+// numbered on from the last sequence number the log handed out
+static bool m_log_down = false;
+static uint32_t m_ram_seq = 0;
 
 // Function Prototypes
 static void system_init(void);
 static void sensors_init(void);
-static void sensors_power_on(void);
-static void sensors_power_off(void);
+static void sensors_power_on(uint8_t sensors);
+static void sensors_power_off(uint8_t sensors);
+static void sensors_process(void);
 static void measure_vitals(vital_signs_t *vitals);
-static health_status_t analyze_health(vital_signs_t *vitals);
 static void handle_health_status(health_status_t status);
-static void enter_sleep_mode(uint32_t duration_ms);
+static void main_event_post(main_evt_t evt);
+static void main_event_handler(void *p_event_data, uint16_t event_size);
+static void idle_wait(void);
+static void monitoring_interval_set(uint32_t interval_ms);
+static void sleep_report(void);
 static void monitoring_timer_handler(void *p_context);
 static void transmit_data(vital_signs_t *vitals, health_status_t status);
+static void emergency_prepare(void);
+static void emergency_alert(uint32_t event_ticks);
+static void queue_vitals(vital_signs_t *vitals, health_status_t status);
+static void upload_backlog(bool is_emergency);
+static bool reading_store(vital_signs_t *vitals, health_status_t status, uint32_t *p_seq);
+static void ram_batch_add(vital_signs_t *vitals, health_status_t status);
+static void ram_batch_send(bool is_emergency);
 static void log_vitals(vital_signs_t *vitals);
+static void fall_event_handler(icm42688_evt_t evt, uint32_t impact_mag_sq);
+static void temp_alert_handler(bool high, int16_t temp_raw);
 
 /**
  * @brief Main application entry point
@@ -134,76 +202,36 @@ int main(void) {
     // Initialize system
     system_init();
     
-    NRF_LOG_INFO("===========================================");
-    NRF_LOG_INFO("Miner Health Monitoring System Started");
-    NRF_LOG_INFO("Monitoring Interval: %d seconds", NORMAL_MONITORING_INTERVAL_MS / 1000);
-    NRF_LOG_INFO("===========================================");
+    TRACE_INFO("===========================================");
+    TRACE_INFO("Miner Health Monitoring System Started");
+    TRACE_INFO("Monitoring Interval: %d seconds", NORMAL_MONITORING_INTERVAL_MS / 1000);
+    TRACE_INFO("===========================================");
     
-    // Start monitoring timer
-    ret_code_t err_code = app_timer_start(m_monitoring_timer, 
-                                          APP_TIMER_TICKS(g_system_ctx.monitoring_interval), 
-                                          NULL);
-    APP_ERROR_CHECK(err_code);
+    // Start monitoring timer; the first reading is taken right away rather
+    // than one interval after reset
+    monitoring_interval_set(g_system_ctx.monitoring_interval);
+    m_cycle_start = app_timer_cnt_get();
+    main_event_post(MAIN_EVT_WAKE);
     
-    // Main loop
+    // Main loop: drivers turn their interrupts into handler calls, handlers
+    // post state machine events, and the core idles once nothing is left
     while (true) {
-        switch (g_system_ctx.current_state) {
-            case STATE_SLEEP:
-                // Enter low-power sleep mode
-                NRF_LOG_INFO("Entering sleep mode...");
-                NRF_LOG_FLUSH();
-                enter_sleep_mode(g_system_ctx.monitoring_interval);
-                break;
-                
-            case STATE_WAKING:
-                // Wake up sensors
-                NRF_LOG_INFO("Waking up sensors...");
-                sensors_power_on();
-                nrf_delay_ms(SENSOR_WARMUP_TIME_MS);
-                g_system_ctx.current_state = STATE_MONITORING;
-                break;
-                
-            case STATE_MONITORING:
-            case STATE_EXTENDED_MONITORING:
-                // Measure vitals
-                NRF_LOG_INFO("Measuring vitals...");
-                measure_vitals(&g_system_ctx.vitals);
-                log_vitals(&g_system_ctx.vitals);
-                
-                // Analyze health
-                g_system_ctx.health_status = analyze_health(&g_system_ctx.vitals);
-                handle_health_status(g_system_ctx.health_status);
-                
-                // Power off sensors
-                sensors_power_off();
-                
-                // Return to sleep if not emergency
-                if (g_system_ctx.current_state != STATE_EMERGENCY) {
-                    g_system_ctx.current_state = STATE_SLEEP;
-                }
-                break;
-                
-            case STATE_EMERGENCY:
-                // Handle emergency
-                NRF_LOG_WARNING("EMERGENCY STATE - Critical health issue detected!");
-                transmit_data(&g_system_ctx.vitals, g_system_ctx.health_status);
-                
-                // Continue monitoring at high frequency
-                nrf_delay_ms(EMERGENCY_MONITORING_INTERVAL_MS);
-                g_system_ctx.current_state = STATE_MONITORING;
-                break;
-                
-            case STATE_TRANSMITTING:
-                // Data transmission handled separately
-                g_system_ctx.current_state = STATE_SLEEP;
-                break;
-        }
+        // Service sensor events first so fall alerts are never delayed
+        sensors_process();
+        communication_process();
         
-        // Process logs
-        NRF_LOG_FLUSH();
+        app_sched_execute();
+        profiler_state(g_system_ctx.current_state);
         
-        // Power management
-        nrf_pwr_mgmt_run();
+        profiler_begin(PROFILER_OP_LOG);
+        TRACE_FLUSH();
+        profiler_end(PROFILER_OP_LOG);
+        
+        if (m_rerun) {
+            m_rerun = false;
+            continue;
+        }
+        idle_wait();
     }
 }
 
@@ -223,9 +251,16 @@ static void system_init(void) {
     APP_ERROR_CHECK(err_code);
     nrf_drv_clock_lfclk_request(NULL);
     
+    // Initialize the event queue before anything can post to it
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+    
     // Initialize app timer
     err_code = app_timer_init();
     APP_ERROR_CHECK(err_code);
+    profiler_init();
+#if POWER_BENCH_CYCLES > 0
+    power_bench_init();
+#endif
     
     // Create monitoring timer
     err_code = app_timer_create(&m_monitoring_timer, 
@@ -237,183 +272,312 @@ static void system_init(void) {
     err_code = nrf_pwr_mgmt_init();
     APP_ERROR_CHECK(err_code);
     
+    // Sensors skip their reset sequences after a warm reset
+    boot_init();
+    
+    // Shared time base of the ECG and PPG edges, set up before the drivers
+    if (ptt_init() != 0) {
+        TRACE_ERROR("PTT timer unavailable, BP falls back to heart rate");
+    }
+    
     // Initialize sensors
     sensors_init();
     
     // Initialize communication
     communication_init();
+    telemetry_init();
+    emergency_prepare();
+    trend_init();
+    hrv_init();
+    
+    // Readings not yet uploaded before a reset are picked up from flash
+    if (vitals_log_init() != 0) {
+        TRACE_ERROR("Vitals log unavailable, readings are not retained");
+        m_log_down = true;
+    }
 }
 
 /**
  * @brief Initialize all sensors
  */
 static void sensors_init(void) {
-    NRF_LOG_INFO("Initializing sensors...");
+    TRACE_INFO("Initializing sensors...");
     
-    // Initialize MAX30102 (SpO2 & Heart Rate)
-    if (max30102_init() == 0) {
-        NRF_LOG_INFO("MAX30102 initialized successfully");
-    } else {
-        NRF_LOG_ERROR("MAX30102 initialization failed");
-    }
+    // MAX30102 (SpO2 & Heart Rate), ADS1292R (ECG & BP) and ICM-42688
+    // (Fall Detection) sit on separate buses, so their reset waits overlap
+    static const boot_step_t steps[BOOT_SENSOR_COUNT] = {
+        [BOOT_SENSOR_MAX30102] = max30102_init_step,
+        [BOOT_SENSOR_ADS1292R] = ads1292r_init_step,
+        [BOOT_SENSOR_ICM42688] = icm42688_init_step,
+    };
+    static const char * const names[BOOT_SENSOR_COUNT] = { "MAX30102", "ADS1292R", "ICM-42688" };
+    int32_t results[BOOT_SENSOR_COUNT];
+    uint32_t serial_ms;
+    uint32_t boot_ms = boot_run(steps, results, BOOT_SENSOR_COUNT, &serial_ms);
     
-    // Initialize ADS1292R (ECG & BP)
-    if (ads1292r_init() == 0) {
-        NRF_LOG_INFO("ADS1292R initialized successfully");
-    } else {
-        NRF_LOG_ERROR("ADS1292R initialization failed");
+    for (uint8_t i = 0; i < BOOT_SENSOR_COUNT; i++) {
+        if (results[i] == 0) {
+            TRACE_INFO("%s initialized successfully", names[i]);
+        } else {
+            TRACE_ERROR("%s initialization failed", names[i]);
+        }
     }
+    TRACE_INFO("Sensor init waited %d ms (%d ms one after another)", boot_ms, serial_ms);
     
-    // Initialize TMP117 (Temperature)
+    // Initialize TMP117 (Temperature), no waits of its own
     if (tmp117_init() == 0) {
-        NRF_LOG_INFO("TMP117 initialized successfully");
-    } else {
-        NRF_LOG_ERROR("TMP117 initialization failed");
-    }
-    
-    // Initialize ICM-42688 (Fall Detection)
-    if (icm42688_init() == 0) {
-        NRF_LOG_INFO("ICM-42688 initialized successfully");
+        TRACE_INFO("TMP117 initialized successfully");
+        
+        // Critical limits are watched by the sensor between cycles
+        if (tmp117_set_alert_limits(TEMP_ALERT_MAX, TEMP_ALERT_MIN, temp_alert_handler) != 0) {
+            TRACE_ERROR("TMP117 alert limits not set");
+        }
     } else {
-        NRF_LOG_ERROR("ICM-42688 initialization failed");
+        TRACE_ERROR("TMP117 initialization failed");
     }
     
     // Put sensors in low-power mode initially
-    sensors_power_off();
+    sensors_power_off(ACQ_ALL);
+    
+    // Continuous fall coverage between measurement cycles
+    if (icm42688_fall_monitor_start(fall_event_handler) != 0) {
+        TRACE_ERROR("ICM-42688 fall monitor unavailable");
+    }
 }
 
 /**
- * @brief Power on all sensors
+ * @brief Power off sensors to save energy
+ * @param sensors ACQ_* bits of the sensors to power off
  */
-static void sensors_power_on(void) {
-    max30102_power_on();
-    ads1292r_power_on();
-    tmp117_wakeup();
-    icm42688_wakeup();
+static void sensors_power_off(uint8_t sensors) {
+    if (sensors & ACQ_MAX30102) max30102_power_off();
+    if (sensors & ACQ_ADS1292R) ads1292r_power_off();
+    if (sensors & ACQ_TMP117)   tmp117_sleep();
+    if (sensors & ACQ_ICM42688) icm42688_sleep();
 }
 
 /**
- * @brief Power off all sensors to save energy
+ * @brief Acquisition completion handlers, called from sensors_process()
  */
-static void sensors_power_off(void) {
-    max30102_power_off();
-    ads1292r_power_off();
-    tmp117_sleep();
-    icm42688_sleep();
+static void acq_done(uint8_t sensor, profiler_op_t op) {
+    m_acq_pending &= ~sensor;
+    profiler_end(op);
+    if (m_acq_pending == 0) {
+        main_event_post(MAIN_EVT_ACQ_DONE);
+    }
 }
 
+static void acq_max30102_done(void) { acq_done(ACQ_MAX30102, PROFILER_OP_PPG); }
+static void acq_ads1292r_done(void) { acq_done(ACQ_ADS1292R, PROFILER_OP_ECG); }
+static void acq_tmp117_done(void)   { acq_done(ACQ_TMP117, PROFILER_OP_TEMP); }
+static void acq_icm42688_done(void) { acq_done(ACQ_ICM42688, PROFILER_OP_IMU); }
+
 /**
- * @brief Measure all vital signs
- * @param vitals Pointer to vital signs structure
+ * @brief Warm-up ends once the last sensor reports ready
  */
-static void measure_vitals(vital_signs_t *vitals) {
-    // Clear previous data
-    memset(vitals, 0, sizeof(vital_signs_t));
-    
-    // Timestamp
-    vitals->timestamp = app_timer_cnt_get();
-    
-    // Measure SpO2 and Heart Rate (MAX30102)
-    max30102_read_data(&vitals->spo2, &vitals->heart_rate);
-    
-    // Measure ECG and estimate Blood Pressure (ADS1292R)
-    ads1292r_read_ecg_and_bp(&vitals->bp_systolic, &vitals->bp_diastolic);
+static void acq_ready(uint8_t sensor) {
+    m_warmup_pending &= ~sensor;
+    if (m_warmup_pending == 0) {
+        profiler_end(PROFILER_OP_WARMUP);
+        g_system_ctx.current_state = STATE_MONITORING;
+    }
     
-    // Measure Temperature (TMP117)
-    vitals->temperature = tmp117_read_temperature();
+    // Some acquisitions complete synchronously and only leave a flag
+    m_rerun = true;
+}
+
+/**
+ * @brief Sensor readiness handlers, start the acquisition right away
+ * @note After a fall the PPG and ECG are dropped rather than started, so
+ *       the cycle is not held up by a full window
+ */
+static void acq_max30102_ready(void) {
+    acq_ready(ACQ_MAX30102);
+    if (m_acq_cut) {
+        m_acq_dropped |= ACQ_MAX30102;
+        acq_max30102_done();
+    } else if (max30102_start_read(acq_max30102_done) != 0) {
+        acq_max30102_done();
+    }
+}
+
+static void acq_ads1292r_ready(void) {
+    acq_ready(ACQ_ADS1292R);
+    if (m_acq_cut) {
+        m_acq_dropped |= ACQ_ADS1292R;
+        acq_ads1292r_done();
+    } else if (ads1292r_start_ecg(acq_ads1292r_done) != 0) {
+        acq_ads1292r_done();
+    }
+}
+
+static void acq_tmp117_ready(void) {
+    acq_ready(ACQ_TMP117);
+    if (tmp117_start_read(acq_tmp117_done) != 0) acq_tmp117_done();
+}
+
+static void acq_icm42688_ready(void) {
+    acq_ready(ACQ_ICM42688);
+    if (icm42688_start_read(acq_icm42688_done) != 0) acq_icm42688_done();
+}
+
+/**
+ * @brief Sensors due for sampling on this tick
+ * @return ACQ_* bits
+ * @note Periods come from the health status of the previous cycle. A tick
+ *       landing within half an interval of the period counts as due, so a
+ *       300 s period is met by the ninth 35 s tick rather than the tenth.
+ */
+static uint8_t sensors_due(void) {
+    uint8_t due = m_acq_forced | (uint8_t)(ACQ_ALL & ~m_acq_sampled);
+    uint32_t slack_ms = g_system_ctx.monitoring_interval / 2;
     
-    // Measure Acceleration and detect falls (ICM-42688)
-    icm42688_read_accel(&vitals->accel_x, &vitals->accel_y, &vitals->accel_z);
+    for (uint8_t i = 0; i < ACQ_SENSOR_COUNT; i++) {
+        uint32_t period_ms = m_acq_period_ms[i][g_system_ctx.health_status];
+        uint32_t elapsed_ms = (uint32_t)((uint64_t)app_timer_cnt_diff_compute(m_cycle_start, m_acq_last[i])
+                                         * 1000 / APP_TIMER_CLOCK_FREQ);
+        if (period_ms == 0 || elapsed_ms + slack_ms >= period_ms) {
+            due |= (uint8_t)(1 << i);
+        }
+    }
     
-    // Fall detection logic
-    float accel_magnitude = sqrt(vitals->accel_x * vitals->accel_x + 
-                                  vitals->accel_y * vitals->accel_y + 
-                                  vitals->accel_z * vitals->accel_z);
+    m_acq_forced = 0;
+    return due;
+}
+
+/**
+ * @brief Power on sensors (non-blocking)
+ * @param sensors ACQ_* bits of the sensors to sample this cycle
+ * @note Each driver signals readiness from its own data-ready, status or
+ *       timer event, and its acquisition is started from that handler.
+ */
+static void sensors_power_on(uint8_t sensors) {
+    m_acq_pending = 0;
+    m_acq_awake = sensors;
+    m_acq_dropped = 0;
+    for (uint8_t i = 0; i < ACQ_SENSOR_COUNT; i++) {
+        if (sensors & (1 << i)) {
+            m_acq_last[i] = m_cycle_start;
+        }
+    }
+    m_acq_sampled |= sensors;
+    ptt_restart();
     
-    if (accel_magnitude > FALL_IMPACT_THRESHOLD) {
-        vitals->fall_detected = true;
-        NRF_LOG_WARNING("FALL DETECTED! Magnitude: %d.%02d g", 
-                        (int)accel_magnitude, 
-                        (int)(accel_magnitude * 100) % 100);
+    profiler_begin(PROFILER_OP_WARMUP);
+    if (sensors & ACQ_ICM42688) {
+        profiler_begin(PROFILER_OP_IMU);
+        if (icm42688_wakeup(acq_icm42688_ready) == 0)   m_acq_pending |= ACQ_ICM42688;
+    }
+    if (sensors & ACQ_TMP117) {
+        profiler_begin(PROFILER_OP_TEMP);
+        if (tmp117_wakeup(acq_tmp117_ready) == 0)       m_acq_pending |= ACQ_TMP117;
+    }
+    if (sensors & ACQ_MAX30102) {
+        profiler_begin(PROFILER_OP_PPG);
+        if (max30102_power_on(acq_max30102_ready) == 0) m_acq_pending |= ACQ_MAX30102;
     }
+    if (sensors & ACQ_ADS1292R) {
+        profiler_begin(PROFILER_OP_ECG);
+        if (ads1292r_power_on(acq_ads1292r_ready) == 0) m_acq_pending |= ACQ_ADS1292R;
+    }
+    m_warmup_pending = m_acq_pending;
     
-    // Check for no movement after fall
-    if (vitals->fall_detected && accel_magnitude < 0.5) {
-        vitals->no_movement = true;
+    if (m_acq_pending == 0) {
+        profiler_end(PROFILER_OP_WARMUP);
+        main_event_post(MAIN_EVT_ACQ_DONE);
     }
 }
 
 /**
- * @brief Analyze health status based on vital signs
- * @param vitals Pointer to vital signs structure
- * @return Health status
+ * @brief End the acquisitions in progress early
+ * @note ECG and PPG stop as on a timeout and report from what they have;
+ *       the readings finish the cycle and its sensors are sampled again by
+ *       the emergency cycle that follows
  */
-static health_status_t analyze_health(vital_signs_t *vitals) {
-    health_status_t status = HEALTH_NORMAL;
-    uint8_t warning_flags = 0;
-    uint8_t critical_flags = 0;
-    
-    // Check SpO2
-    if (vitals->spo2 < SPO2_MIN_CRITICAL) {
-        critical_flags++;
-        NRF_LOG_ERROR("CRITICAL: SpO2 too low: %d%%", vitals->spo2);
-    } else if (vitals->spo2 < SPO2_MIN_NORMAL) {
-        warning_flags++;
-        NRF_LOG_WARNING("WARNING: SpO2 below normal: %d%%", vitals->spo2);
+static void acquisition_cut_short(void) {
+    if (g_system_ctx.current_state != STATE_WAKING &&
+        g_system_ctx.current_state != STATE_MONITORING) {
+        return;
     }
     
-    // Check Heart Rate
-    if (vitals->heart_rate < HEART_RATE_CRITICAL_MIN || 
-        vitals->heart_rate > HEART_RATE_CRITICAL_MAX) {
-        critical_flags++;
-        NRF_LOG_ERROR("CRITICAL: Heart rate abnormal: %d BPM", vitals->heart_rate);
-    } else if (vitals->heart_rate < HEART_RATE_MIN || 
-               vitals->heart_rate > HEART_RATE_MAX) {
-        warning_flags++;
-        NRF_LOG_WARNING("WARNING: Heart rate outside normal range: %d BPM", vitals->heart_rate);
-    }
+    m_acq_cut = true;
+    ads1292r_abort();
+    max30102_abort();
+    m_rerun = true;
+}
+
+/**
+ * @brief Let each driver consume its pending interrupt work
+ */
+static void sensors_process(void) {
+    icm42688_process();
+    max30102_process();
+    ads1292r_process();
+    tmp117_process();
+}
+
+/**
+ * @brief Collect the vital signs once every acquisition has reported
+ * @param vitals Pointer to vital signs structure, holding the last readings
+ * @note All acquisitions run concurrently: the TMP117 conversion and the
+ *       PPG window overlap the ECG capture, so the awake time is set by the
+ *       longest sensor rather than the sum of all four. Acquisitions were
+ *       started by sensors_power_on() as each sensor became ready. Sensors
+ *       not sampled this cycle keep their previous reading, marked stale.
+ */
+static void measure_vitals(vital_signs_t *vitals) {
+    uint8_t sampled = m_acq_awake & ~m_acq_dropped;
     
-    // Check Temperature
-    if (vitals->temperature < TEMP_CRITICAL_MIN || 
-        vitals->temperature > TEMP_CRITICAL_MAX) {
-        critical_flags++;
-        NRF_LOG_ERROR("CRITICAL: Temperature abnormal: %d.%02d°C", 
-                     (int)vitals->temperature, 
-                     (int)(vitals->temperature * 100) % 100);
-    } else if (vitals->temperature < TEMP_MIN_NORMAL || 
-               vitals->temperature > TEMP_MAX_NORMAL) {
-        warning_flags++;
-        NRF_LOG_WARNING("WARNING: Temperature outside normal range");
-    }
+    // Timestamped at the start of the cycle
+    vitals->timestamp = m_cycle_start;
+    vitals->stale = 0;
     
-    // Check Blood Pressure
-    if (vitals->bp_systolic > BP_SYSTOLIC_MAX || 
-        vitals->bp_systolic < BP_SYSTOLIC_MIN) {
-        warning_flags++;
-        NRF_LOG_WARNING("WARNING: Systolic BP abnormal: %d mmHg", vitals->bp_systolic);
+    // SpO2 and Heart Rate (MAX30102)
+    if (sampled & ACQ_MAX30102) {
+        vitals->ppg_valid = (max30102_get_result(&vitals->spo2, &vitals->heart_rate) == 0);
+    } else {
+        vitals->stale |= VITAL_STALE_PPG;
     }
     
-    // Check for fall
-    if (vitals->fall_detected) {
-        if (vitals->no_movement) {
-            critical_flags++;
-            NRF_LOG_ERROR("EMERGENCY: Fall detected with no movement!");
-        } else {
-            warning_flags++;
-            NRF_LOG_WARNING("WARNING: Fall detected!");
+    // ECG-derived Blood Pressure (ADS1292R)
+    if (sampled & ACQ_ADS1292R) {
+        vitals->ecg_valid = (ads1292r_get_bp(&vitals->bp_systolic, &vitals->bp_diastolic) == 0);
+        
+        // Pulse transit time replaces the heart-rate estimate when the
+        // PPG window ran alongside the capture
+        if (vitals->ecg_valid && (sampled & ACQ_MAX30102)) {
+            ptt_get_bp(&vitals->bp_systolic, &vitals->bp_diastolic);
         }
+        
+        // RR intervals of the capture feed the HRV window
+        if (vitals->ecg_valid) {
+            uint16_t rr[QRS_MAX_RR];
+            uint8_t count = qrs_detector_get_rr(rr, QRS_MAX_RR);
+            for (uint8_t i = 0; i < count; i++) {
+                rr[i] = (uint16_t)((rr[i] * 1000UL) / QRS_SAMPLE_RATE_HZ);
+            }
+            hrv_add_capture(rr, count);
+        }
+    } else {
+        vitals->stale |= VITAL_STALE_ECG;
     }
     
-    // Determine overall status
-    if (critical_flags > 0 || vitals->fall_detected) {
-        status = HEALTH_EMERGENCY;
-    } else if (warning_flags >= 2) {
-        status = HEALTH_CRITICAL;
-    } else if (warning_flags > 0) {
-        status = HEALTH_WARNING;
+    // Temperature (TMP117); a failed conversion keeps the previous reading
+    if (!(sampled & ACQ_TMP117) || tmp117_get_result(&vitals->temp_raw) != 0) {
+        vitals->stale |= VITAL_STALE_TEMP;
     }
     
-    return status;
+    // Acceleration (ICM-42688); falls come from the always-on monitor
+    if (sampled & ACQ_ICM42688) {
+        icm42688_get_accel_raw(vitals->accel_raw);
+        vitals->accel_mag_sq = 0;
+        for (uint8_t i = 0; i < 3; i++) {
+            vitals->accel_mag_sq += (uint32_t)((int32_t)vitals->accel_raw[i] * vitals->accel_raw[i]);
+        }
+    } else {
+        vitals->stale |= VITAL_STALE_ACCEL;
+    }
+    icm42688_get_fall_status(&vitals->fall_detected, &vitals->no_movement);
 }
 
 /**
@@ -423,27 +587,30 @@ static health_status_t analyze_health(vital_signs_t *vitals) {
 static void handle_health_status(health_status_t status) {
     switch (status) {
         case HEALTH_NORMAL:
-            NRF_LOG_INFO("Health Status: NORMAL");
-            g_system_ctx.monitoring_interval = NORMAL_MONITORING_INTERVAL_MS;
+            TRACE_INFO("Health Status: NORMAL");
+            monitoring_interval_set(NORMAL_MONITORING_INTERVAL_MS);
             g_system_ctx.anomaly_count = 0;
             g_system_ctx.emergency_sent = false;
+            ecg_stream_stop();
+            queue_vitals(&g_system_ctx.vitals, status);
             break;
             
         case HEALTH_WARNING:
-            NRF_LOG_WARNING("Health Status: WARNING");
+            TRACE_WARNING("Health Status: WARNING");
             g_system_ctx.anomaly_count++;
             
             if (g_system_ctx.anomaly_count >= 2) {
                 // Switch to extended monitoring
-                g_system_ctx.monitoring_interval = EXTENDED_MONITORING_INTERVAL_MS;
+                monitoring_interval_set(EXTENDED_MONITORING_INTERVAL_MS);
                 g_system_ctx.current_state = STATE_EXTENDED_MONITORING;
-                NRF_LOG_INFO("Switching to extended monitoring mode");
+                TRACE_INFO("Switching to extended monitoring mode");
             }
+            queue_vitals(&g_system_ctx.vitals, status);
             break;
             
         case HEALTH_CRITICAL:
-            NRF_LOG_ERROR("Health Status: CRITICAL");
-            g_system_ctx.monitoring_interval = EXTENDED_MONITORING_INTERVAL_MS;
+            TRACE_ERROR("Health Status: CRITICAL");
+            monitoring_interval_set(EXTENDED_MONITORING_INTERVAL_MS);
             g_system_ctx.current_state = STATE_EXTENDED_MONITORING;
             
             // Send alert but not emergency yet
@@ -451,28 +618,221 @@ static void handle_health_status(health_status_t status) {
             break;
             
         case HEALTH_EMERGENCY:
-            NRF_LOG_ERROR("Health Status: EMERGENCY");
-            g_system_ctx.monitoring_interval = EMERGENCY_MONITORING_INTERVAL_MS;
+            TRACE_ERROR("Health Status: EMERGENCY");
+            monitoring_interval_set(EMERGENCY_MONITORING_INTERVAL_MS);
             g_system_ctx.current_state = STATE_EMERGENCY;
             
-            // Send emergency alert
+            // Medics get the raw waveform until the worker is back to normal
+            if (!ecg_stream_active() && ecg_stream_start(TRANSPORT_BLE_PACKET_BYTES) != 0) {
+                TRACE_ERROR("ECG stream not started");
+            }
+            
+            // Send emergency alert; follow-up readings go out from STATE_EMERGENCY
             if (!g_system_ctx.emergency_sent) {
-                transmit_data(&g_system_ctx.vitals, status);
+                emergency_alert(app_timer_cnt_get());
                 g_system_ctx.emergency_sent = true;
+            } else {
+                queue_vitals(&g_system_ctx.vitals, status);
             }
             break;
     }
 }
 
 /**
- * @brief Enter low-power sleep mode
- * @param duration_ms Sleep duration in milliseconds
+ * @brief Switch the wake tick to a new monitoring interval
+ * @param interval_ms Time between measurement cycles
+ * @note The timer is re-armed only when the interval changes, so the next
+ *       wake comes one interval after the escalation rather than whenever
+ *       the previous, longer period would have ended.
+ */
+static void monitoring_interval_set(uint32_t interval_ms) {
+    g_system_ctx.monitoring_interval = interval_ms;
+    if (interval_ms == m_timer_interval) {
+        return;
+    }
+    
+    app_timer_stop(m_monitoring_timer);
+    ret_code_t err_code = app_timer_start(m_monitoring_timer, APP_TIMER_TICKS(interval_ms), NULL);
+    APP_ERROR_CHECK(err_code);
+    m_timer_interval = interval_ms;
+    TRACE_INFO("Monitoring interval: %d ms", interval_ms);
+}
+
+/**
+ * @brief Release peripherals not needed until the next measurement cycle
+ * @note The ADS1292R releases SPIM1 in ads1292r_power_off(), and HFXO is
+ *       only held while a frame is on air. The ICM-42688 SPI stays up for
+ *       the fall monitor. TWIM0 stays enabled while sensor writes are
+ *       still queued and is released by a later idle_wait().
+ */
+static void peripherals_power_down(void) {
+    twi_bus_suspend();
+    m_peripherals_down = true;
+}
+
+/**
+ * @brief Idle until the next interrupt
+ * @note Peripherals are released once per sleep period; during a cycle the
+ *       core only waits for the sensors. The RTC-driven app_timer is armed by
+ *       monitoring_interval_set().
+ */
+static void idle_wait(void) {
+    if (g_system_ctx.current_state == STATE_SLEEP && !m_peripherals_down) {
+        TRACE_INFO("Entering sleep mode for %d ms...", g_system_ctx.monitoring_interval);
+        TRACE_FLUSH();
+        peripherals_power_down();
+    } else if (m_peripherals_down) {
+        // Sensor writes queued at the end of the cycle kept the bus up
+        twi_bus_suspend();
+    }
+    
+    // System ON idle; only the RTC and event sources stay clocked
+    uint32_t start = app_timer_cnt_get();
+    profiler_begin(PROFILER_OP_SLEEP);
+    nrf_pwr_mgmt_run();
+    profiler_end(PROFILER_OP_SLEEP);
+    m_sleep_ticks += app_timer_cnt_diff_compute(app_timer_cnt_get(), start);
+}
+
+/**
+ * @brief Log how much of the last cycle was spent asleep and start a new one
+ */
+static void sleep_report(void) {
+    uint32_t now = app_timer_cnt_get();
+    uint32_t cycle_ticks = app_timer_cnt_diff_compute(now, m_cycle_start);
+    
+    if (cycle_ticks > 0) {
+        TRACE_INFO("Sleep residency: %d%% (%d of %d ms)",
+                   (int)((uint64_t)m_sleep_ticks * 100 / cycle_ticks),
+                   (int)((uint64_t)m_sleep_ticks * 1000 / APP_TIMER_CLOCK_FREQ),
+                   (int)((uint64_t)cycle_ticks * 1000 / APP_TIMER_CLOCK_FREQ));
+    }
+    
+    m_cycle_start = now;
+    m_sleep_ticks = 0;
+    m_peripherals_down = false;
+}
+
+/**
+ * @brief Queue a state machine event; safe from interrupt context
+ */
+static void main_event_post(main_evt_t evt) {
+    // A full queue already holds a wake or completion the event would repeat
+    (void)app_sched_event_put(&evt, sizeof(evt), main_event_handler);
+}
+
+/**
+ * @brief Start a measurement cycle
+ */
+static void cycle_start(void) {
+#if POWER_BENCH_CYCLES > 0
+    // The benchmark firmware stops waking once its cycles are recorded
+    if (!power_bench_cycle(g_system_ctx.health_status, m_acq_awake)) {
+        app_timer_stop(m_monitoring_timer);
+        return;
+    }
+#endif
+    sleep_report();
+    uint8_t due = sensors_due();
+    TRACE_INFO("Waking up sensors 0x%x...", due);
+    g_system_ctx.current_state = STATE_WAKING;
+    sensors_power_on(due);
+}
+
+/**
+ * @brief Evaluate the readings of a completed cycle and go back to sleep
+ */
+static void cycle_finish(void) {
+    TRACE_INFO("Measuring vitals...");
+    measure_vitals(&g_system_ctx.vitals);
+#if POWER_BENCH_CYCLES > 0
+    power_bench_vitals(&g_system_ctx.vitals);
+#endif
+    emergency_prepare();
+    log_vitals(&g_system_ctx.vitals);
+    
+    // Analyze health; the trend decides, the reading alone is only logged
+    profiler_begin(PROFILER_OP_ANALYZE);
+    health_status_t reading_status = health_analyze(&g_system_ctx.vitals);
+    g_system_ctx.health_status = trend_update(&g_system_ctx.vitals);
+    profiler_end(PROFILER_OP_ANALYZE);
+    if (g_system_ctx.health_status != reading_status) {
+        TRACE_INFO("Trend status %d, reading alone %d", g_system_ctx.health_status, reading_status);
+    }
+    trend_log();
+    handle_health_status(g_system_ctx.health_status);
+    boot_cycle_done();
+    
+    // Power off the sensors woken for this cycle
+    sensors_power_off(m_acq_awake);
+    
+    // Return to sleep if not emergency
+    if (g_system_ctx.current_state == STATE_EMERGENCY) {
+        main_event_post(MAIN_EVT_EMERGENCY);
+    } else {
+        g_system_ctx.current_state = STATE_SLEEP;
+    }
+    
+    // A cycle cut short by a fall is followed by a complete one; dropped
+    // sensors are due regardless of their period
+    if (m_acq_cut) {
+        m_acq_cut = false;
+        m_acq_forced |= m_acq_dropped;
+        main_event_post(MAIN_EVT_WAKE);
+    }
+}
+
+/**
+ * @brief Send the readings taken since an emergency alert
  */
-static void enter_sleep_mode(uint32_t duration_ms) {
-    // Enter System ON idle mode
-    __WFE();
-    __SEV();
-    __WFE();
+static void emergency_upload(void) {
+    TRACE_WARNING("EMERGENCY STATE - Critical health issue detected!");
+    
+    // Readings taken since the alert go out now rather than waiting for a
+    // full batch
+    vitals_log_flush();
+    if (vitals_log_pending() > 0) {
+        upload_backlog(true);
+    }
+    if (m_log_down && telemetry_count() > 0) {
+        ram_batch_send(true);
+    }
+    
+    // Continue monitoring at high frequency; the timer is already armed
+    // with the emergency interval
+    g_system_ctx.current_state = STATE_SLEEP;
+}
+
+/**
+ * @brief State machine, runs from app_sched_execute() in the main loop
+ */
+static void main_event_handler(void *p_event_data, uint16_t event_size) {
+    main_evt_t evt = *(main_evt_t *)p_event_data;
+    
+    // Handlers start drivers whose first step may be a synchronous flag
+    m_rerun = true;
+    
+    switch (evt) {
+        case MAIN_EVT_WAKE:
+            // A cycle in progress already covers this tick
+            if (g_system_ctx.current_state == STATE_SLEEP) {
+                cycle_start();
+            }
+            break;
+            
+        case MAIN_EVT_ACQ_DONE:
+            if ((g_system_ctx.current_state == STATE_WAKING ||
+                 g_system_ctx.current_state == STATE_MONITORING) && m_acq_pending == 0) {
+                cycle_finish();
+            }
+            break;
+            
+        case MAIN_EVT_EMERGENCY:
+            if (g_system_ctx.current_state == STATE_EMERGENCY) {
+                emergency_upload();
+            }
+            break;
+    }
 }
 
 /**
@@ -480,47 +840,313 @@ static void enter_sleep_mode(uint32_t duration_ms) {
  * @param p_context Timer context (unused)
  */
 static void monitoring_timer_handler(void *p_context) {
-    // Wake up system for measurement
-    g_system_ctx.current_state = STATE_WAKING;
+    main_event_post(MAIN_EVT_WAKE);
+}
+
+/**
+ * @brief Fall monitor events, delivered from icm42688_process()
+ * @param evt Fall monitor event
+ * @param impact_mag_sq Peak impact magnitude squared (counts^2)
+ */
+static void fall_event_handler(icm42688_evt_t evt, uint32_t impact_mag_sq) {
+    switch (evt) {
+        case ICM42688_EVT_FALL:
+        case ICM42688_EVT_NO_MOVEMENT:
+            TRACE_ERROR("FALL %s", (evt == ICM42688_EVT_FALL) ? "DETECTED" : "- NO MOVEMENT");
+            
+            // Alert immediately with the last known vitals, then run a full
+            // measurement cycle in emergency mode; a cycle in progress is
+            // cut short rather than waited for
+            g_system_ctx.vitals.fall_detected = true;
+            g_system_ctx.vitals.no_movement = (evt == ICM42688_EVT_NO_MOVEMENT);
+            g_system_ctx.health_status = HEALTH_EMERGENCY;
+            emergency_alert(icm42688_event_ticks());
+            g_system_ctx.emergency_sent = true;
+            monitoring_interval_set(EMERGENCY_MONITORING_INTERVAL_MS);
+            acquisition_cut_short();
+            main_event_post(MAIN_EVT_WAKE);
+            break;
+            
+        case ICM42688_EVT_RECOVERED:
+            TRACE_INFO("Movement resumed after fall");
+            break;
+    }
+}
+
+/**
+ * @brief TMP117 limit crossed between cycles, delivered from tmp117_process()
+ * @param high High limit crossed (low limit otherwise)
+ * @param temp_raw Temperature behind the alert (1/128 C)
+ * @note The measurement cycle started here confirms the reading before any
+ *       alert goes out
+ */
+static void temp_alert_handler(bool high, int16_t temp_raw) {
+    TRACE_WARNING("Temperature %s limit crossed: %d (1/128 C)", high ? "high" : "low", temp_raw);
+    m_acq_forced |= ACQ_TMP117;
+    main_event_post(MAIN_EVT_WAKE);
+}
+
+/**
+ * @brief Alert frame left the TX queue, delivered from communication_process()
+ * @param success Frame was sent (false once retries are exhausted)
+ * @note The reading stays unacknowledged in the log and goes out again with
+ *       the backlog; the gateway drops it by sequence number. Readings sent
+ *       from RAM while the log is down are lost with the frame.
+ */
+static void transmit_done_handler(bool success, void *p_context) {
+    if (success) {
+        TRACE_INFO("Data transmission complete");
+    } else {
+        TRACE_ERROR("Data transmission failed");
+    }
+}
+
+/**
+ * @brief Backlog frame left the TX queue, delivered from communication_process()
+ * @param success Frame was sent (false once retries are exhausted)
+ * @param p_context Sequence number of the last reading in the frame
+ */
+static void upload_done_handler(bool success, void *p_context) {
+    m_upload_in_flight = false;
+    
+    if (!success) {
+        // Link is down; the readings stay in the log for the next attempt
+        TRACE_WARNING("Backlog upload failed, %d readings pending", vitals_log_pending());
+        return;
+    }
+    
+    vitals_log_ack((uint32_t)(uintptr_t)p_context);
+    
+    // Link is up; keep draining while full batches are waiting
+    if (vitals_log_pending() >= TELEMETRY_BATCH_RECORDS) {
+        upload_backlog(false);
+    }
+}
+
+/**
+ * @brief Send the oldest unacknowledged readings as one batched frame
+ * @param is_emergency Emergency flag for priority transmission
+ */
+static void upload_backlog(bool is_emergency) {
+    vital_signs_t backlog[TELEMETRY_BATCH_RECORDS];
+    uint8_t status[TELEMETRY_BATCH_RECORDS];
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    uint32_t first_seq = vitals_log_first_unacked();
+    uint8_t records = 0;
+    
+    // With the log down the batch holds readings waiting in RAM; those
+    // already in flash go out after the next reset
+    if (m_upload_in_flight || m_log_down) {
+        return;
+    }
+    
+    uint8_t count = vitals_log_read(&first_seq, backlog, status, TELEMETRY_BATCH_RECORDS);
+    while (records < count && telemetry_add(&backlog[records], status[records])) {
+        records++;
+    }
+    if (records == 0) {
+        return;
+    }
+    
+    // Duty cycles and HRV features since the previous frame ride along
+    profiler_stats_t stats;
+    profiler_snapshot(&stats);
+    telemetry_attach_stats(&stats);
+    hrv_features_t hrv;
+    if (hrv_snapshot(&hrv)) {
+        telemetry_attach_hrv(&hrv);
+    }
+    
+    profiler_begin(PROFILER_OP_ENCODE);
+    uint16_t frame_len = telemetry_encode(frame, sizeof(frame), (uint16_t)first_seq, &records);
+    if (frame_len == 0) {
+        profiler_end(PROFILER_OP_ENCODE);
+        TRACE_ERROR("Telemetry frame encoding failed");
+        return;
+    }
+    
+    // Readings that did not fit are still unacknowledged and go next time
+    uint32_t last_seq = first_seq + records - 1;
+    TRACE_INFO("Uploading readings %d..%d (%d bytes)...", first_seq, last_seq, frame_len);
+    int err = communication_send(frame, frame_len, is_emergency, upload_done_handler,
+                                 (void *)(uintptr_t)last_seq);
+    profiler_end(PROFILER_OP_ENCODE);
+    if (err != 0) {
+        TRACE_ERROR("Backlog frame not queued, TX queue full");
+        return;
+    }
+    m_upload_in_flight = true;
+    profiler_log();
 }
 
 /**
- * @brief Transmit vital data to gateway
+ * @brief Store a routine reading, uploading once a full batch is waiting
  * @param vitals Pointer to vital signs
  * @param status Health status
  */
+static void queue_vitals(vital_signs_t *vitals, health_status_t status) {
+    if (!reading_store(vitals, status, NULL)) {
+        ram_batch_add(vitals, status);
+        if (telemetry_full()) {
+            ram_batch_send(false);
+        }
+        return;
+    }
+    
+    if (vitals_log_pending() >= TELEMETRY_BATCH_RECORDS) {
+        upload_backlog(false);
+    }
+}
+
+/**
+ * @brief Append a reading to the flash log unless the log is down
+ * @param p_seq Receives the reading's sequence number; may be NULL
+ * @return false if the reading was not stored and must go out from RAM
+ * @note The first failed append takes the log down until the next reset,
+ *       so no sequence number is handed out twice
+ */
+static bool reading_store(vital_signs_t *vitals, health_status_t status, uint32_t *p_seq) {
+    if (m_log_down) {
+        return false;
+    }
+    if (vitals_log_append(vitals, status, p_seq) == 0) {
+        return true;
+    }
+    
+    TRACE_ERROR("Reading not stored, sending readings from RAM");
+    m_log_down = true;
+    m_ram_seq = vitals_log_next_seq();
+    return false;
+}
+
+/**
+ * @brief Batch a reading in RAM while the log is down
+ */
+static void ram_batch_add(vital_signs_t *vitals, health_status_t status) {
+    if (!telemetry_add(vitals, status)) {
+        // Batch full or spanning too long; send it and start a new one
+        ram_batch_send(false);
+        telemetry_add(vitals, status);
+    }
+}
+
+/**
+ * @brief Send the readings batched in RAM, numbered from m_ram_seq
+ * @param is_emergency Emergency flag for priority transmission
+ * @note Nothing is retried: without the log there is no copy to send again
+ */
+static void ram_batch_send(bool is_emergency) {
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    uint8_t records = 0;
+    
+    profiler_stats_t stats;
+    profiler_snapshot(&stats);
+    telemetry_attach_stats(&stats);
+    hrv_features_t hrv;
+    if (hrv_snapshot(&hrv)) {
+        telemetry_attach_hrv(&hrv);
+    }
+    
+    profiler_begin(PROFILER_OP_ENCODE);
+    uint16_t frame_len = telemetry_encode(frame, sizeof(frame), (uint16_t)m_ram_seq, &records);
+    if (frame_len == 0) {
+        profiler_end(PROFILER_OP_ENCODE);
+        TRACE_ERROR("Telemetry frame encoding failed");
+        return;
+    }
+    
+    // Readings that did not fit were dropped with the batch and get no number
+    TRACE_INFO("Sending readings %d..%d from RAM (%d bytes)...",
+               m_ram_seq, m_ram_seq + records - 1, frame_len);
+    m_ram_seq += records;
+    int err = communication_send(frame, frame_len, is_emergency, transmit_done_handler, NULL);
+    profiler_end(PROFILER_OP_ENCODE);
+    if (err != 0) {
+        TRACE_ERROR("RAM batch dropped, TX queue full");
+    }
+}
+
+/**
+ * @brief Transmit vital data to gateway immediately
+ * @param vitals Pointer to vital signs
+ * @param status Health status
+ * @note The reading is also stored, so it reaches the gateway with the
+ *       backlog even if this frame is lost. With the log down it goes out
+ *       at once together with the readings batched in RAM.
+ */
 static void transmit_data(vital_signs_t *vitals, health_status_t status) {
-    NRF_LOG_INFO("Transmitting data to gateway...");
-    g_system_ctx.current_state = STATE_TRANSMITTING;
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    uint32_t seq;
     
-    // Prepare data packet
-    uint8_t data_packet[64];
-    uint16_t packet_len = 0;
+    if (!reading_store(vitals, status, &seq)) {
+        ram_batch_add(vitals, status);
+        ram_batch_send(status == HEALTH_EMERGENCY);
+        return;
+    }
+    vitals_log_flush();
     
-    // Pack data (simplified protocol)
-    data_packet[packet_len++] = 0xAA; // Start marker
-    data_packet[packet_len++] = status; // Health status
-    data_packet[packet_len++] = vitals->spo2;
-    data_packet[packet_len++] = (vitals->heart_rate >> 8) & 0xFF;
-    data_packet[packet_len++] = vitals->heart_rate & 0xFF;
-    data_packet[packet_len++] = (vitals->bp_systolic >> 8) & 0xFF;
-    data_packet[packet_len++] = vitals->bp_systolic & 0xFF;
-    data_packet[packet_len++] = (vitals->bp_diastolic >> 8) & 0xFF;
-    data_packet[packet_len++] = vitals->bp_diastolic & 0xFF;
+    profiler_begin(PROFILER_OP_ENCODE);
+    telemetry_add(vitals, status);
+    hrv_features_t hrv;
+    if (hrv_snapshot(&hrv)) {
+        telemetry_attach_hrv(&hrv);
+    }
+    uint16_t frame_len = telemetry_encode(frame, sizeof(frame), (uint16_t)seq, NULL);
+    if (frame_len == 0) {
+        profiler_end(PROFILER_OP_ENCODE);
+        TRACE_ERROR("Telemetry frame encoding failed");
+        return;
+    }
     
-    // Temperature (scaled by 100)
-    uint16_t temp_scaled = (uint16_t)(vitals->temperature * 100);
-    data_packet[packet_len++] = (temp_scaled >> 8) & 0xFF;
-    data_packet[packet_len++] = temp_scaled & 0xFF;
+    TRACE_INFO("Queueing alert reading %d (%d bytes) for gateway...", seq, frame_len);
+    int err = communication_send(frame, frame_len, status == HEALTH_EMERGENCY,
+                                 transmit_done_handler, NULL);
+    profiler_end(PROFILER_OP_ENCODE);
+    if (err != 0) {
+        TRACE_ERROR("Alert frame dropped, TX queue full");
+    }
+}
+
+/**
+ * @brief Encode the emergency alert from the latest readings
+ * @note Done after every cycle, so the alert path does no encoding
+ */
+static void emergency_prepare(void) {
+    telemetry_alert_prepare(m_alert_frame, &g_system_ctx.vitals, HEALTH_EMERGENCY);
+}
+
+/**
+ * @brief Put the prepared emergency alert on air, then store the reading
+ * @param event_ticks RTC ticks of the event behind the alert
+ * @note The frame is queued before the log is touched: a flush or a page
+ *       erase would otherwise stand between the event and the uplink. The
+ *       alert carries the sequence number the reading is stored under; if
+ *       it cannot be stored, that number is taken from the RAM counter.
+ */
+static void emergency_alert(uint32_t event_ticks) {
+    uint32_t seq = m_log_down ? m_ram_seq + telemetry_count() : vitals_log_next_seq();
+    uint8_t flags = 0;
     
-    // Fall detection flags
-    data_packet[packet_len++] = (vitals->fall_detected << 1) | vitals->no_movement;
-    data_packet[packet_len++] = 0x55; // End marker
+    if (g_system_ctx.vitals.fall_detected) flags |= VITAL_FLAG_FALL;
+    if (g_system_ctx.vitals.no_movement)   flags |= VITAL_FLAG_NO_MOVEMENT;
+    telemetry_alert_finish(m_alert_frame, (uint16_t)seq, flags);
     
-    // Transmit via LoRa/BLE
-    communication_send_data(data_packet, packet_len, status == HEALTH_EMERGENCY);
+    TRACE_INFO("Queueing emergency alert, reading %d", seq);
+    if (communication_send_alert(m_alert_frame, TELEMETRY_ALERT_SIZE, event_ticks,
+                                 transmit_done_handler, NULL) != 0) {
+        TRACE_ERROR("Emergency alert not queued");
+    }
     
-    NRF_LOG_INFO("Data transmission complete");
+    if (!reading_store(&g_system_ctx.vitals, HEALTH_EMERGENCY, NULL)) {
+        // Readings batched in RAM keep the numbers ahead of the alert, which
+        // is the reading's only copy and has used its number up
+        if (telemetry_count() > 0) {
+            ram_batch_send(true);
+        }
+        m_ram_seq = seq + 1;
+        return;
+    }
+    vitals_log_flush();
 }
 
 /**
@@ -528,17 +1154,11 @@ static void transmit_data(vital_signs_t *vitals, health_status_t status) {
  * @param vitals Pointer to vital signs
  */
 static void log_vitals(vital_signs_t *vitals) {
-    NRF_LOG_INFO("========== VITAL SIGNS ==========");
-    NRF_LOG_INFO("SpO2: %d%%", vitals->spo2);
-    NRF_LOG_INFO("Heart Rate: %d BPM", vitals->heart_rate);
-    NRF_LOG_INFO("BP: %d/%d mmHg", vitals->bp_systolic, vitals->bp_diastolic);
-    NRF_LOG_INFO("Temperature: %d.%02d°C", 
-                 (int)vitals->temperature, 
-                 (int)(vitals->temperature * 100) % 100);
-    NRF_LOG_INFO("Accel: X=%d.%02d Y=%d.%02d Z=%d.%02d g",
-                 (int)vitals->accel_x, (int)(fabs(vitals->accel_x) * 100) % 100,
-                 (int)vitals->accel_y, (int)(fabs(vitals->accel_y) * 100) % 100,
-                 (int)vitals->accel_z, (int)(fabs(vitals->accel_z) * 100) % 100);
-    NRF_LOG_INFO("Fall Detected: %s", vitals->fall_detected ? "YES" : "NO");
-    NRF_LOG_INFO("================================");
+    // Two records in sensor units; binary traces are scaled on the host
+    TRACE_INFO("Vitals: SpO2 %d%% HR %d BPM BP %d/%d mmHg temp %d (1/128 C)",
+               vitals->spo2, vitals->heart_rate,
+               vitals->bp_systolic, vitals->bp_diastolic, vitals->temp_raw);
+    TRACE_INFO("Accel %d/%d/%d (1/2048 g) fall %d no movement %d",
+               vitals->accel_raw[0], vitals->accel_raw[1], vitals->accel_raw[2],
+               vitals->fall_detected, vitals->no_movement);
 }
\ No newline at end of file
@@ -4,84 +4,555 @@
  */
 
 #include "max30102_driver.h"
-#include "nrf_drv_twi.h"
+#include "twi_bus.h"
+#include "boot.h"
+#include "ptt.h"
+#include "nrf_drv_gpiote.h"
+#include "nrf_drv_ppi.h"
+#include "app_timer.h"
 #include "nrf_delay.h"
 #include "nrf_log.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_SENSORS
+#include "trace.h"
+#include <string.h>
+
+#define MAX30102_INT_PIN        28    // Active-low open-drain INT (adjust to your circuit)
 
 #define MAX30102_I2C_ADDR       0x57
 #define MAX30102_REG_INT_STATUS 0x00
 #define MAX30102_REG_INT_ENABLE 0x02
 #define MAX30102_REG_FIFO_WR    0x04
+#define MAX30102_REG_FIFO_OVF   0x05
 #define MAX30102_REG_FIFO_RD    0x06
 #define MAX30102_REG_FIFO_DATA  0x07
+#define MAX30102_REG_FIFO_CFG   0x08
 #define MAX30102_REG_MODE_CFG   0x09
 #define MAX30102_REG_SPO2_CFG   0x0A
 #define MAX30102_REG_LED1_PA    0x0C
 #define MAX30102_REG_LED2_PA    0x0D
+#define MAX30102_REG_PART_ID    0xFF
+
+#define MAX30102_INT_A_FULL     (1 << 7)
+#define MAX30102_FIFO_A_FULL    2     // Interrupt with 2 free slots (30 samples, 300 ms)
+#define MAX30102_SPO2_CFG       0x27  // ADC range 4096, SR 100Hz, PW 411us
+
+#define MAX30102_FIFO_DEPTH     32
+#define MAX30102_SAMPLE_BYTES   6     // 3 bytes RED + 3 bytes IR in SpO2 mode
+#define MAX30102_SAMPLE_MASK    0x03FFFF
+
+// SpO2/HR pipeline
+#define PPG_SAMPLE_RATE_HZ      100
+#define PPG_WINDOW_SAMPLES      400   // 4 s measurement window
+#define PPG_TIMEOUT_MS          4500
+#define PPG_DC_SHIFT            6     // DC tracker time constant ~0.64 s
+#define PPG_SMOOTH_LEN          4     // Moving-average length for beat detection
+#define PPG_REFRACTORY_SAMPLES  30    // 300 ms, limits HR to 200 BPM
+#define PPG_MIN_BEATS           3
+#define PPG_FINGER_DC_MIN       50000 // IR DC below this means no skin contact
+#define PPG_RATIO_Q             10    // Ratio-of-ratios in Q10
+#define PPG_SAMPLE_PERIOD_US    (1000000 / PPG_SAMPLE_RATE_HZ)
+#define PPG_SMOOTH_DELAY_US     ((PPG_SMOOTH_LEN - 1) * PPG_SAMPLE_PERIOD_US / 2)
 
-static const nrf_drv_twi_t m_twi = NRF_DRV_TWI_INSTANCE(0);
 static bool m_initialized = false;
 
+// Init sequence, advanced by max30102_init_step()
+typedef enum {
+    MAX30102_INIT_START,
+    MAX30102_INIT_CONFIGURE             // Reset in progress
+} max30102_init_state_t;
+
+static max30102_init_state_t m_init_state = MAX30102_INIT_START;
+
+static volatile bool m_fifo_pending = false;
+static nrf_ppi_channel_t m_ppi_int_capture;     // INT edge -> PTT capture during a window
+static ptt_clock_t m_clock;                     // Window sample index to PTT time
+static uint32_t m_last_capture;
+static volatile bool m_read_timed_out = false;
+APP_TIMER_DEF(m_read_timeout_timer);
+
+static uint8_t m_fifo_buf[MAX30102_FIFO_DEPTH * MAX30102_SAMPLE_BYTES];
+
+// FIFO drain runs as two queued TWI transactions: status and pointers,
+// then the sample burst sized from the pointers
+typedef enum {
+    MAX30102_DRAIN_IDLE,
+    MAX30102_DRAIN_PTRS,
+    MAX30102_DRAIN_DATA
+} max30102_drain_state_t;
+
+static max30102_drain_state_t m_drain_state = MAX30102_DRAIN_IDLE;
+static volatile bool m_drain_done = false;
+static volatile ret_code_t m_drain_result = NRF_SUCCESS;
+
+// Register addresses are sent by EasyDMA, so they live in RAM
+static uint8_t m_reg_int_status = MAX30102_REG_INT_STATUS;
+static uint8_t m_reg_fifo_wr = MAX30102_REG_FIFO_WR;
+static uint8_t m_reg_fifo_data = MAX30102_REG_FIFO_DATA;
+static uint8_t m_int_status;
+static uint8_t m_fifo_ptrs[3];  // FIFO_WR, OVF_COUNTER, FIFO_RD
+
+static nrf_twi_mngr_transfer_t m_ptrs_transfers[] = {
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, &m_reg_int_status, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(MAX30102_I2C_ADDR, &m_int_status, 1, 0),
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, &m_reg_fifo_wr, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(MAX30102_I2C_ADDR, m_fifo_ptrs, sizeof(m_fifo_ptrs), 0)
+};
+
+static nrf_twi_mngr_transfer_t m_data_transfers[] = {
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, &m_reg_fifo_data, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(MAX30102_I2C_ADDR, m_fifo_buf, 0, 0)  // Length set per drain
+};
+
+static void max30102_drain_callback(ret_code_t result, void *p_user_data);
+
+static const nrf_twi_mngr_transaction_t m_ptrs_transaction = {
+    .callback            = max30102_drain_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_ptrs_transfers,
+    .number_of_transfers = sizeof(m_ptrs_transfers) / sizeof(m_ptrs_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+static const nrf_twi_mngr_transaction_t m_data_transaction = {
+    .callback            = max30102_drain_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_data_transfers,
+    .number_of_transfers = sizeof(m_data_transfers) / sizeof(m_data_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+// Per-cycle writes are queued too. Their buffers never change, so a write
+// may be queued again before the previous one has gone out; the bus runs
+// them in order, ahead of any drain queued later.
+static volatile bool m_write_failed = false;
+static uint8_t m_mode_on_buf[2] = {MAX30102_REG_MODE_CFG, 0x03};    // SpO2 mode
+static uint8_t m_mode_off_buf[2] = {MAX30102_REG_MODE_CFG, 0x80};   // Shutdown mode
+static uint8_t m_fifo_reset_buf[4] = {MAX30102_REG_FIFO_WR, 0x00, 0x00, 0x00}; // WR, OVF, RD
+static uint8_t m_reset_status;
+
+static nrf_twi_mngr_transfer_t const m_mode_on_transfers[] = {
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, m_mode_on_buf, sizeof(m_mode_on_buf), 0)
+};
+
+static nrf_twi_mngr_transfer_t const m_mode_off_transfers[] = {
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, m_mode_off_buf, sizeof(m_mode_off_buf), 0)
+};
+
+// Reading INT_STATUS clears interrupts left from before the reset
+static nrf_twi_mngr_transfer_t const m_fifo_reset_transfers[] = {
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, m_fifo_reset_buf, sizeof(m_fifo_reset_buf), 0),
+    NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, &m_reg_int_status, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(MAX30102_I2C_ADDR, &m_reset_status, 1, 0)
+};
+
+static void max30102_write_callback(ret_code_t result, void *p_user_data);
+
+static const nrf_twi_mngr_transaction_t m_mode_on_transaction = {
+    .callback            = max30102_write_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_mode_on_transfers,
+    .number_of_transfers = sizeof(m_mode_on_transfers) / sizeof(m_mode_on_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+static const nrf_twi_mngr_transaction_t m_mode_off_transaction = {
+    .callback            = max30102_write_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_mode_off_transfers,
+    .number_of_transfers = sizeof(m_mode_off_transfers) / sizeof(m_mode_off_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+static const nrf_twi_mngr_transaction_t m_fifo_reset_transaction = {
+    .callback            = max30102_write_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_fifo_reset_transfers,
+    .number_of_transfers = sizeof(m_fifo_reset_transfers) / sizeof(m_fifo_reset_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+// Per-window PPG processing state
+typedef struct {
+    int32_t  red_dc_q8;             // DC estimates, Q8
+    int32_t  ir_dc_q8;
+    int32_t  smooth[PPG_SMOOTH_LEN];
+    int32_t  smooth_sum;
+    int32_t  prev_ir_ac;
+    int32_t  red_max, red_min;      // AC extremes within current beat
+    int32_t  ir_max, ir_min;
+    int32_t  foot_max;              // Smoothed IR peak before the upstroke
+    uint16_t foot_sample;
+    uint32_t ratio_sum_q;           // Sum of per-beat ratio-of-ratios
+    uint16_t ratio_count;
+    uint16_t sample_count;
+    uint16_t last_beat;
+    uint16_t first_beat;
+    uint16_t beat_count;
+} ppg_state_t;
+
+static ppg_state_t m_ppg;
+
+// Non-blocking measurement state
+static max30102_ready_handler_t m_ready_handler = NULL;
+static bool m_ready_pending = false;
+static max30102_done_handler_t m_done_handler = NULL;
+static bool m_read_active = false;
+static int m_result = -1;
+static uint8_t m_spo2 = 0;
+static uint16_t m_heart_rate = 0;
+
 /**
- * @brief Write register
+ * @brief Write register (blocking, init only)
  */
 static ret_code_t write_register(uint8_t reg, uint8_t value) {
     uint8_t data[2] = {reg, value};
-    return nrf_drv_twi_tx(&m_twi, MAX30102_I2C_ADDR, data, 2, false);
+    nrf_twi_mngr_transfer_t const transfers[] = {
+        NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, data, sizeof(data), 0)
+    };
+    return twi_bus_perform(transfers, 1);
 }
 
 /**
- * @brief Read register
+ * @brief Burst read starting at reg (blocking)
  */
-static ret_code_t read_register(uint8_t reg, uint8_t *value) {
-    ret_code_t err_code;
-    err_code = nrf_drv_twi_tx(&m_twi, MAX30102_I2C_ADDR, &reg, 1, true);
-    if (err_code != NRF_SUCCESS) return err_code;
-    return nrf_drv_twi_rx(&m_twi, MAX30102_I2C_ADDR, value, 1);
+static ret_code_t read_registers(uint8_t reg, uint8_t *buffer, uint8_t length) {
+    nrf_twi_mngr_transfer_t const transfers[] = {
+        NRF_TWI_MNGR_WRITE(MAX30102_I2C_ADDR, &reg, 1, NRF_TWI_MNGR_NO_STOP),
+        NRF_TWI_MNGR_READ(MAX30102_I2C_ADDR, buffer, length, 0)
+    };
+    return twi_bus_perform(transfers, 2);
 }
 
 /**
- * @brief Initialize MAX30102
+ * @brief Drain transaction finished, runs in TWIM interrupt context
  */
-int max30102_init(void) {
-    ret_code_t err_code;
-    
-    // Initialize TWI
-    const nrf_drv_twi_config_t twi_config = {
-       .scl                = 27,  // Adjust to your pin
-       .sda                = 26,  // Adjust to your pin
-       .frequency          = NRF_DRV_TWI_FREQ_400K,
-       .interrupt_priority = APP_IRQ_PRIORITY_HIGH,
-       .clear_bus_init     = false
-    };
-    
-    err_code = nrf_drv_twi_init(&m_twi, &twi_config, NULL, NULL);
-    if (err_code != NRF_SUCCESS) {
+static void max30102_drain_callback(ret_code_t result, void *p_user_data) {
+    m_drain_result = result;
+    m_drain_done = true;
+}
+
+/**
+ * @brief Queued mode or FIFO reset write finished, runs in TWIM interrupt context
+ */
+static void max30102_write_callback(ret_code_t result, void *p_user_data) {
+    if (result != NRF_SUCCESS) {
+        m_write_failed = true;
+    }
+}
+
+/**
+ * @brief INT pin handler, FIFO almost full
+ */
+static void max30102_int_handler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action) {
+    m_fifo_pending = true;
+}
+
+/**
+ * @brief Measurement window watchdog
+ */
+static void max30102_timeout_handler(void *p_context) {
+    m_read_timed_out = true;
+}
+
+/**
+ * @brief Queue the FIFO pointer reset and clear pending interrupts
+ */
+static ret_code_t max30102_fifo_reset(void) {
+    return twi_bus_schedule(&m_fifo_reset_transaction);
+}
+
+/**
+ * @brief Switch INT between PORT sense and a GPIOTE IN event
+ * @note Only an IN event can drive PPI, but it keeps HFCLK running, so it
+ *       is used for the measurement window alone. The pin is released
+ *       first, so a failure leaves it unconfigured until the next call.
+ */
+static ret_code_t max30102_int_sense(bool hi_accuracy) {
+    nrf_drv_gpiote_in_config_t int_config = GPIOTE_CONFIG_IN_SENSE_HITOLO(hi_accuracy);
+    int_config.pull = NRF_GPIO_PIN_PULLUP;
+    nrf_drv_gpiote_in_uninit(MAX30102_INT_PIN);
+    return nrf_drv_gpiote_in_init(MAX30102_INT_PIN, &int_config, max30102_int_handler);
+}
+
+/**
+ * @brief Reset pipeline state for a new measurement window
+ */
+static void ppg_reset(void) {
+    memset(&m_ppg, 0, sizeof(m_ppg));
+}
+
+/**
+ * @brief Close the current beat and accumulate its ratio-of-ratios
+ */
+static void ppg_end_beat(void) {
+    int32_t red_ac = m_ppg.red_max - m_ppg.red_min;
+    int32_t ir_ac = m_ppg.ir_max - m_ppg.ir_min;
+    int32_t red_dc = m_ppg.red_dc_q8 >> 8;
+    int32_t ir_dc = m_ppg.ir_dc_q8 >> 8;
+
+    if (m_ppg.beat_count == 0) {
+        m_ppg.first_beat = m_ppg.sample_count;
+    } else if (red_ac > 0 && ir_ac > 0 && red_dc > 0) {
+        // R = (AC_red / DC_red) / (AC_ir / DC_ir); DC is 18-bit so scale
+        // each term down before multiplying to stay within 32 bits
+        uint32_t num = (uint32_t)red_ac * (uint32_t)(ir_dc >> 6);
+        uint32_t den = (uint32_t)ir_ac * (uint32_t)(red_dc >> 6);
+        if (den > 0) {
+            m_ppg.ratio_sum_q += (uint32_t)(((uint64_t)num << PPG_RATIO_Q) / den);
+            m_ppg.ratio_count++;
+        }
+    }
+
+    // The first foot may fall in the DC settling time
+    if (m_ppg.beat_count > 0 && m_clock.anchored) {
+        ptt_event(PTT_SOURCE_PPG, ptt_clock_time(&m_clock, m_ppg.foot_sample) - PPG_SMOOTH_DELAY_US);
+    }
+
+    m_ppg.beat_count++;
+    m_ppg.last_beat = m_ppg.sample_count;
+    m_ppg.red_max = m_ppg.red_min = 0;
+    m_ppg.ir_max = m_ppg.ir_min = 0;
+    m_ppg.foot_max = 0;
+}
+
+/**
+ * @brief Feed one RED/IR sample pair through DC removal and beat detection
+ */
+static void ppg_process_sample(int32_t red, int32_t ir) {
+    if (m_ppg.sample_count == 0) {
+        m_ppg.red_dc_q8 = red << 8;
+        m_ppg.ir_dc_q8 = ir << 8;
+    }
+
+    // DC removal with a single-pole tracker
+    m_ppg.red_dc_q8 += ((red << 8) - m_ppg.red_dc_q8) >> PPG_DC_SHIFT;
+    m_ppg.ir_dc_q8 += ((ir << 8) - m_ppg.ir_dc_q8) >> PPG_DC_SHIFT;
+    int32_t red_ac = red - (m_ppg.red_dc_q8 >> 8);
+    int32_t ir_ac = ir - (m_ppg.ir_dc_q8 >> 8);
+
+    // Smooth IR for beat detection. Absorption rises with each pulse, so
+    // the IR signal is inverted: a beat starts on a downward zero crossing.
+    uint8_t idx = m_ppg.sample_count % PPG_SMOOTH_LEN;
+    m_ppg.smooth_sum += ir_ac - m_ppg.smooth[idx];
+    m_ppg.smooth[idx] = ir_ac;
+    int32_t ir_smooth = m_ppg.smooth_sum / PPG_SMOOTH_LEN;
+
+    if (red_ac > m_ppg.red_max) m_ppg.red_max = red_ac;
+    if (red_ac < m_ppg.red_min) m_ppg.red_min = red_ac;
+    if (ir_ac > m_ppg.ir_max) m_ppg.ir_max = ir_ac;
+    if (ir_ac < m_ppg.ir_min) m_ppg.ir_min = ir_ac;
+
+    // Pulse foot: least absorption, right before the systolic upstroke
+    if (ir_smooth > m_ppg.foot_max) {
+        m_ppg.foot_max = ir_smooth;
+        m_ppg.foot_sample = m_ppg.sample_count;
+    }
+
+    // Skip the DC tracker settling time before looking for beats
+    if (m_ppg.sample_count > PPG_SAMPLE_RATE_HZ / 2 &&
+        m_ppg.prev_ir_ac >= 0 && ir_smooth < 0 &&
+        (m_ppg.beat_count == 0 ||
+         (m_ppg.sample_count - m_ppg.last_beat) >= PPG_REFRACTORY_SAMPLES)) {
+        ppg_end_beat();
+    }
+
+    m_ppg.prev_ir_ac = ir_smooth;
+    m_ppg.sample_count++;
+}
+
+/**
+ * @brief Queue the status/pointer read that starts a FIFO drain
+ */
+static void max30102_drain_start(void) {
+    // Reading INT_STATUS releases the INT pin
+    if (twi_bus_schedule(&m_ptrs_transaction) == NRF_SUCCESS) {
+        m_drain_state = MAX30102_DRAIN_PTRS;
+    }
+}
+
+/**
+ * @brief Advance the FIFO drain after a transaction completes
+ */
+static void max30102_drain_continue(void) {
+    if (m_drain_result != NRF_SUCCESS) {
+        TRACE_WARNING("MAX30102 FIFO read failed: %d", m_drain_result);
+        m_drain_state = MAX30102_DRAIN_IDLE;
+        return;
+    }
+
+    if (m_drain_state == MAX30102_DRAIN_PTRS) {
+        uint8_t count = (m_fifo_ptrs[0] - m_fifo_ptrs[2]) & (MAX30102_FIFO_DEPTH - 1);
+        if (m_fifo_ptrs[1] > 0) {
+            count = MAX30102_FIFO_DEPTH;
+            TRACE_WARNING("MAX30102 FIFO overflow: %d samples lost", m_fifo_ptrs[1]);
+        }
+
+        // A fresh INT capture belongs to the almost-full sample, the 30th
+        // unread one. After an overflow the sample indices are unknown.
+        uint32_t capture = ptt_capture_get(PTT_SOURCE_PPG);
+        if (capture != m_last_capture && m_fifo_ptrs[1] == 0) {
+            ptt_clock_anchor(&m_clock, m_ppg.sample_count + MAX30102_FIFO_DEPTH - MAX30102_FIFO_A_FULL - 1,
+                             capture);
+        }
+        m_last_capture = capture;
+
+        m_drain_state = MAX30102_DRAIN_IDLE;
+        if (count == 0) {
+            return;
+        }
+
+        // The whole FIFO in one burst
+        m_data_transfers[1].length = count * MAX30102_SAMPLE_BYTES;
+        if (twi_bus_schedule(&m_data_transaction) == NRF_SUCCESS) {
+            m_drain_state = MAX30102_DRAIN_DATA;
+        }
+        return;
+    }
+
+    uint8_t count = m_data_transfers[1].length / MAX30102_SAMPLE_BYTES;
+    for (uint8_t i = 0; i < count && m_ppg.sample_count < PPG_WINDOW_SAMPLES; i++) {
+        uint8_t *p = &m_fifo_buf[i * MAX30102_SAMPLE_BYTES];
+        int32_t red = ((p[0] << 16) | (p[1] << 8) | p[2]) & MAX30102_SAMPLE_MASK;
+        int32_t ir  = ((p[3] << 16) | (p[4] << 8) | p[5]) & MAX30102_SAMPLE_MASK;
+        ppg_process_sample(red, ir);
+    }
+    m_drain_state = MAX30102_DRAIN_IDLE;
+}
+
+/**
+ * @brief Derive SpO2 and heart rate from the processed window
+ * @return 0 on success, -1 if no reliable pulse was found
+ */
+static int ppg_compute(uint8_t *spo2, uint16_t *heart_rate) {
+    if ((m_ppg.ir_dc_q8 >> 8) < PPG_FINGER_DC_MIN) {
+        TRACE_WARNING("MAX30102: no skin contact");
+        return -1;
+    }
+    if (m_ppg.beat_count < PPG_MIN_BEATS || m_ppg.ratio_count == 0) {
+        TRACE_WARNING("MAX30102: only %d pulses detected", m_ppg.beat_count);
         return -1;
     }
-    nrf_drv_twi_enable(&m_twi);
+
+    // Beat rate over the span between first and last detected pulse
+    uint32_t span = m_ppg.last_beat - m_ppg.first_beat;
+    *heart_rate = (uint16_t)((60 * PPG_SAMPLE_RATE_HZ * (m_ppg.beat_count - 1) + span / 2) / span);
+
+    // Empirical calibration: SpO2 = 110 - 25 * R
+    uint32_t ratio_q = m_ppg.ratio_sum_q / m_ppg.ratio_count;
+    int32_t value = 110 - (int32_t)((25 * ratio_q) >> PPG_RATIO_Q);
+    if (value > 100) value = 100;
+    if (value < 0) value = 0;
+    *spo2 = (uint8_t)value;
+
+    return 0;
+}
+
+/**
+ * @brief Advance the init sequence by one step
+ * @return ms to wait before the next step, 0 once initialized, -1 on failure
+ * @note After a warm reset the sensor keeps its configuration. If it
+ *       answers with the part ID it had before, the reset (100 ms) is
+ *       skipped and the FIFO is flushed instead.
+ */
+int32_t max30102_init_step(void) {
+    ret_code_t err_code;
+    uint8_t part_id = 0;
     
-    // Reset sensor
-    write_register(MAX30102_REG_MODE_CFG, 0x40);
-    nrf_delay_ms(100);
+    if (m_init_state == MAX30102_INIT_START) {
+        // Shared with the TMP117
+        if (twi_bus_init() != 0) {
+            return -1;
+        }
+        
+        if (!boot_warm() || read_registers(MAX30102_REG_PART_ID, &part_id, 1) != NRF_SUCCESS ||
+            !boot_sensor_known(BOOT_SENSOR_MAX30102, part_id)) {
+            boot_sensor_forget(BOOT_SENSOR_MAX30102);
+            
+            // Reset sensor
+            write_register(MAX30102_REG_MODE_CFG, 0x40);
+            m_init_state = MAX30102_INIT_CONFIGURE;
+            return 100;
+        }
+        NRF_LOG_INFO("MAX30102 configured before reset, reset skipped");
+        max30102_fifo_reset();
+    }
+    m_init_state = MAX30102_INIT_START;
     
     // Configure SpO2 mode
     write_register(MAX30102_REG_MODE_CFG, 0x03); // SpO2 mode
-    write_register(MAX30102_REG_SPO2_CFG, 0x27); // ADC range 4096, SR 100Hz, PW 411us
+    write_register(MAX30102_REG_SPO2_CFG, MAX30102_SPO2_CFG);
     write_register(MAX30102_REG_LED1_PA, 0x24);  // Red LED current
     write_register(MAX30102_REG_LED2_PA, 0x24);  // IR LED current
     
+    // FIFO: no sample averaging, no rollover, almost-full interrupt
+    write_register(MAX30102_REG_FIFO_CFG, MAX30102_FIFO_A_FULL);
+    write_register(MAX30102_REG_INT_ENABLE, MAX30102_INT_A_FULL);
+    
+    // INT pin wakes the CPU; low-accuracy PORT sense keeps idle current down
+    if (!nrf_drv_gpiote_is_init()) {
+        err_code = nrf_drv_gpiote_init();
+        if (err_code != NRF_SUCCESS) return -1;
+    }
+    nrf_drv_gpiote_in_config_t int_config = GPIOTE_CONFIG_IN_SENSE_HITOLO(false);
+    int_config.pull = NRF_GPIO_PIN_PULLUP;
+    err_code = nrf_drv_gpiote_in_init(MAX30102_INT_PIN, &int_config, max30102_int_handler);
+    if (err_code != NRF_SUCCESS) return -1;
+    
+    err_code = nrf_drv_ppi_init();
+    if (err_code != NRF_SUCCESS && err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED) return -1;
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_int_capture);
+    if (err_code != NRF_SUCCESS) return -1;
+    
+    err_code = app_timer_create(&m_read_timeout_timer, APP_TIMER_MODE_SINGLE_SHOT,
+                                max30102_timeout_handler);
+    if (err_code != NRF_SUCCESS) return -1;
+    
+    // Trusted across a reset once the configuration reads back
+    uint8_t spo2_cfg = 0;
+    if (read_registers(MAX30102_REG_PART_ID, &part_id, 1) == NRF_SUCCESS &&
+        read_registers(MAX30102_REG_SPO2_CFG, &spo2_cfg, 1) == NRF_SUCCESS &&
+        spo2_cfg == MAX30102_SPO2_CFG) {
+        boot_sensor_store(BOOT_SENSOR_MAX30102, part_id);
+    } else {
+        boot_sensor_forget(BOOT_SENSOR_MAX30102);
+    }
+    
     m_initialized = true;
     return 0;
 }
 
 /**
- * @brief Power on sensor
+ * @brief Initialize MAX30102 (blocking)
  */
-void max30102_power_on(void) {
-    if (m_initialized) {
-        write_register(MAX30102_REG_MODE_CFG, 0x03); // SpO2 mode
+int max30102_init(void) {
+    int32_t wait;
+    while ((wait = max30102_init_step()) > 0) {
+        nrf_delay_ms(wait);
     }
+    return (int)wait;
+}
+
+/**
+ * @brief Power on sensor (non-blocking)
+ * @param handler Called from max30102_process() once the sensor is ready
+ * @return 0 if the sensor was powered on
+ * @note Shutdown exit takes effect at the next sample period, and the PPG
+ *       pipeline rides out the LED/DC settling itself, so the sensor is
+ *       reported ready straight away.
+ */
+int max30102_power_on(max30102_ready_handler_t handler) {
+    if (!m_initialized) {
+        return -1;
+    }
+    
+    // Anything read from the sensor is queued behind the mode change
+    if (twi_bus_schedule(&m_mode_on_transaction) != NRF_SUCCESS) {
+        return -1;
+    }
+    
+    m_ready_handler = handler;
+    m_ready_pending = true;
+    return 0;
 }
 
 /**
@@ -89,32 +560,154 @@ void max30102_power_on(void) {
  */
 void max30102_power_off(void) {
     if (m_initialized) {
-        write_register(MAX30102_REG_MODE_CFG, 0x80); // Shutdown mode
+        m_ready_pending = false;
+        if (twi_bus_schedule(&m_mode_off_transaction) != NRF_SUCCESS) {
+            TRACE_ERROR("MAX30102 shutdown not queued");
+        }
     }
 }
 
 /**
- * @brief Read SpO2 and Heart Rate (Simulated for demonstration)
+ * @brief Start a non-blocking 4 s PPG window
+ * @param handler Called from max30102_process() once the result is ready
+ * @return 0 if the window was started
+ * @note The CPU sleeps between FIFO almost-full interrupts (every 300 ms)
  */
-void max30102_read_data(uint8_t *spo2, uint16_t *heart_rate) {
-    // In real implementation, read FIFO and process PPG signals
-    // For simulation, generate realistic values with some variation
+int max30102_start_read(max30102_done_handler_t handler) {
+    if (!m_initialized || m_read_active) {
+        return -1;
+    }
+    
+    // Timestamp INT edges for the pulse transit time. Failing either step
+    // leaves INT on PORT sense as it was, so it still wakes the CPU.
+    if (max30102_int_sense(true) != NRF_SUCCESS) {
+        TRACE_ERROR("MAX30102 INT event unavailable");
+        max30102_int_sense(false);
+        return -1;
+    }
+    if (max30102_fifo_reset() != NRF_SUCCESS) {
+        max30102_int_sense(false);
+        return -1;
+    }
+    ppg_reset();
+    
+    m_drain_state = MAX30102_DRAIN_IDLE;
+    m_drain_done = false;
+    m_result = -1;
+    m_done_handler = handler;
+    m_fifo_pending = false;
+    m_read_timed_out = false;
+    
+    nrf_drv_ppi_channel_assign(m_ppi_int_capture, nrf_drv_gpiote_in_event_addr_get(MAX30102_INT_PIN),
+                               ptt_capture_task_addr(PTT_SOURCE_PPG));
+    nrf_drv_ppi_channel_enable(m_ppi_int_capture);
+    ptt_clock_reset(&m_clock, PPG_SAMPLE_PERIOD_US);
+    ptt_acquire(PTT_SOURCE_PPG);
+    m_last_capture = ptt_capture_get(PTT_SOURCE_PPG);
+    
+    nrf_drv_gpiote_in_event_enable(MAX30102_INT_PIN, true);
+    app_timer_start(m_read_timeout_timer, APP_TIMER_TICKS(PPG_TIMEOUT_MS), NULL);
+    m_read_active = true;
+    
+    return 0;
+}
+
+/**
+ * @brief Cut a running PPG window short
+ * @note Ends as on a timeout: the next max30102_process() closes the window
+ *       once any drain in flight is done and reports what it has
+ */
+void max30102_abort(void) {
+    if (m_read_active) {
+        app_timer_stop(m_read_timeout_timer);
+        m_read_timed_out = true;
+    }
+}
+
+/**
+ * @brief Report readiness and drain the FIFO if the sensor signalled; call
+ *        from the main loop
+ */
+void max30102_process(void) {
+    if (m_write_failed) {
+        m_write_failed = false;
+        TRACE_WARNING("MAX30102 register write failed");
+    }
     
-    static uint8_t simulation_counter = 0;
-    simulation_counter++;
+    if (m_ready_pending) {
+        m_ready_pending = false;
+        if (m_ready_handler) {
+            m_ready_handler();
+        }
+    }
+    
+    if (!m_read_active) {
+        return;
+    }
     
-    // Simulate normal values with slight variations
-    *spo2 = 95 + (simulation_counter % 5); // 95-99%
-    *heart_rate = 70 + (simulation_counter % 20); // 70-89 BPM
+    if (m_drain_done) {
+        m_drain_done = false;
+        max30102_drain_continue();
+    }
+    
+    // INT is level-low until the status is read; also catch an edge
+    // that arrived before the event was enabled
+    if (m_drain_state == MAX30102_DRAIN_IDLE &&
+        (m_fifo_pending || !nrf_drv_gpiote_in_is_set(MAX30102_INT_PIN))) {
+        m_fifo_pending = false;
+        max30102_drain_start();
+    }
+    
+    // Buffers stay owned by the bus until an in-flight drain completes
+    if (m_drain_state != MAX30102_DRAIN_IDLE ||
+        (m_ppg.sample_count < PPG_WINDOW_SAMPLES && !m_read_timed_out)) {
+        return;
+    }
+    
+    app_timer_stop(m_read_timeout_timer);
+    nrf_drv_gpiote_in_event_disable(MAX30102_INT_PIN);
+    nrf_drv_ppi_channel_disable(m_ppi_int_capture);
+    max30102_int_sense(false);
+    ptt_release(PTT_SOURCE_PPG);
+    m_read_active = false;
+    
+    if (m_read_timed_out) {
+        TRACE_WARNING("MAX30102 read timed out after %d samples", m_ppg.sample_count);
+    }
     
-    // Occasionally simulate anomalies for testing
-    if (simulation_counter % 50 == 0) {
-        *spo2 = 88; // Low SpO2
-        NRF_LOG_WARNING("Simulating low SpO2 condition");
+    m_result = ppg_compute(&m_spo2, &m_heart_rate);
+    if (m_done_handler) {
+        m_done_handler();
+    }
+}
+
+/**
+ * @brief SpO2 and heart rate from the last completed window
+ * @return 0 if valid, -1 if no reliable reading
+ */
+int max30102_get_result(uint8_t *spo2, uint16_t *heart_rate) {
+    *spo2 = (m_result == 0) ? m_spo2 : 0;
+    *heart_rate = (m_result == 0) ? m_heart_rate : 0;
+    return m_result;
+}
+
+/**
+ * @brief Read SpO2 and Heart Rate from a 4 s PPG window (blocking)
+ * @return 0 on success, -1 if no reliable reading
+ */
+int max30102_read_data(uint8_t *spo2, uint16_t *heart_rate) {
+    if (max30102_start_read(NULL) != 0) {
+        *spo2 = 0;
+        *heart_rate = 0;
+        return -1;
     }
     
-    if (simulation_counter % 73 == 0) {
-        *heart_rate = 125; // High heart rate
-        NRF_LOG_WARNING("Simulating high heart rate");
+    while (m_read_active) {
+        max30102_process();
+        if (m_read_active) {
+            __WFE();
+        }
     }
+    
+    return max30102_get_result(spo2, heart_rate);
 }
\ No newline at end of file
@@ -3,9 +3,17 @@
 
 #include <stdint.h>
 
+typedef void (*max30102_ready_handler_t)(void);
+typedef void (*max30102_done_handler_t)(void);
+
 int max30102_init(void);
-void max30102_power_on(void);
+int32_t max30102_init_step(void);
+int max30102_power_on(max30102_ready_handler_t handler);
 void max30102_power_off(void);
-void max30102_read_data(uint8_t *spo2, uint16_t *heart_rate);
+int max30102_start_read(max30102_done_handler_t handler);
+void max30102_abort(void);
+void max30102_process(void);
+int max30102_get_result(uint8_t *spo2, uint16_t *heart_rate);
+int max30102_read_data(uint8_t *spo2, uint16_t *heart_rate);
 
 #endif
\ No newline at end of file
@@ -10,7 +10,6 @@ import numpy as np
 import time
 import random
 from datetime import datetime
-from collections import deque
 from enum import Enum
 
 # Enable interactive mode
@@ -30,16 +29,55 @@ class HealthStatus(Enum):
     CRITICAL = 3
     EMERGENCY = 4
 
+class RingBuffer:
+    """Fixed-capacity history in a preallocated array
+
+    Every value is stored twice, at i and i + capacity, so the newest n
+    values are always one contiguous slice and plotting never copies.
+    """
+
+    def __init__(self, capacity):
+        self.capacity = capacity
+        self.data = np.zeros(2 * capacity)
+        self.head = 0
+        self.count = 0
+
+    def append(self, value):
+        self.data[self.head] = value
+        self.data[self.head + self.capacity] = value
+        self.head = (self.head + 1) % self.capacity
+        self.count = min(self.count + 1, self.capacity)
+
+    def latest(self, n):
+        """View of the newest n values, oldest first"""
+        n = min(n, self.count)
+        end = self.head + self.capacity
+        return self.data[end - n:end]
+
+    def __len__(self):
+        return self.count
+
 class MinerDashboard:
-    def __init__(self, max_data_points=100):
+    """Dashboard for one miner
+
+    Axes, grids, bands and the sensor bars are drawn once and cached as
+    per-panel backgrounds. Each update restores the background of the
+    panels that changed, draws their animated artists and blits only those
+    panels, so the refresh cost does not grow with the history length.
+    """
+
+    def __init__(self, max_data_points=100, window=50, max_fps=20):
         self.max_points = max_data_points
+        self.window = min(window, max_data_points)
+        self.min_frame_interval = 1.0 / max_fps if max_fps else 0.0
         
         # Data buffers for real-time plotting
-        self.time_data = deque(maxlen=max_data_points)
-        self.heart_rate_data = deque(maxlen=max_data_points)
-        self.spo2_data = deque(maxlen=max_data_points)
-        self.temperature_data = deque(maxlen=max_data_points)
-        self.battery_data = deque(maxlen=max_data_points)
+        self.heart_rate_data = RingBuffer(max_data_points)
+        self.spo2_data = RingBuffer(max_data_points)
+        self.temperature_data = RingBuffer(max_data_points)
+        self.battery_data = RingBuffer(max_data_points)
+        self.power_mode_data = RingBuffer(max_data_points)
+        self.x_axis = np.arange(self.window)
         
         # System parameters
         self.battery_level = 100.0  # Start at 100%
@@ -57,6 +95,13 @@ class MinerDashboard:
             'nRF52840': {'power_mw': 25.0, 'efficiency': 88, 'heat_mw': 4.5}
         }
         
+        # Blitting state
+        self.backgrounds = {}       # Axes -> cached background without animated artists
+        self.dirty = set()          # Axes whose animated artists changed since the last frame
+        self.last_frame = 0.0
+        self.sensors_drawn = None   # Sensor values the bars were drawn with
+        self.status_drawn = None    # (text, color) on screen
+        
         self.setup_dashboard()
     
     def setup_dashboard(self):
@@ -76,7 +121,7 @@ class MinerDashboard:
         self.ax_hr.set_ylabel('BPM')
         self.ax_hr.set_ylim(40, 160)
         self.ax_hr.grid(True, alpha=0.3)
-        self.line_hr, = self.ax_hr.plot([], [], 'r-', linewidth=2, label='Heart Rate')
+        self.line_hr, = self.ax_hr.plot([], [], 'r-', linewidth=2, label='Heart Rate', animated=True)
         self.ax_hr.axhspan(45, 120, alpha=0.2, color='green', label='Normal Range')
         self.ax_hr.legend(loc='upper right', fontsize=8)
         
@@ -86,7 +131,7 @@ class MinerDashboard:
         self.ax_spo2.set_ylabel('%')
         self.ax_spo2.set_ylim(80, 100)
         self.ax_spo2.grid(True, alpha=0.3)
-        self.line_spo2, = self.ax_spo2.plot([], [], 'c-', linewidth=2, label='SpO2')
+        self.line_spo2, = self.ax_spo2.plot([], [], 'c-', linewidth=2, label='SpO2', animated=True)
         self.ax_spo2.axhspan(92, 100, alpha=0.2, color='green', label='Normal Range')
         self.ax_spo2.legend(loc='upper right', fontsize=8)
         
@@ -96,7 +141,7 @@ class MinerDashboard:
         self.ax_temp.set_ylabel('°C')
         self.ax_temp.set_ylim(34, 41)
         self.ax_temp.grid(True, alpha=0.3)
-        self.line_temp, = self.ax_temp.plot([], [], 'orange', linewidth=2, label='Temperature')
+        self.line_temp, = self.ax_temp.plot([], [], 'orange', linewidth=2, label='Temperature', animated=True)
         self.ax_temp.axhspan(35.5, 38.5, alpha=0.2, color='green', label='Normal Range')
         self.ax_temp.legend(loc='upper right', fontsize=8)
         
@@ -106,7 +151,7 @@ class MinerDashboard:
         self.ax_battery.set_ylabel('%')
         self.ax_battery.set_ylim(0, 100)
         self.ax_battery.grid(True, alpha=0.3)
-        self.line_battery, = self.ax_battery.plot([], [], 'lime', linewidth=3, label='Battery')
+        self.line_battery, = self.ax_battery.plot([], [], 'lime', linewidth=3, label='Battery', animated=True)
         self.ax_battery.axhspan(0, 20, alpha=0.3, color='red', label='Critical')
         self.ax_battery.axhspan(20, 50, alpha=0.3, color='yellow', label='Low')
         self.ax_battery.legend(loc='upper right', fontsize=8)
@@ -136,25 +181,68 @@ class MinerDashboard:
         self.ax_power_mode.set_ylabel('Mode')
         self.ax_power_mode.set_ylim(-0.5, 1.5)
         self.ax_power_mode.grid(True, alpha=0.3)
-        self.power_mode_data = deque(maxlen=self.max_points)
-        self.line_power_mode, = self.ax_power_mode.plot([], [], 'm-', linewidth=2, marker='o', markersize=4)
+        self.line_power_mode, = self.ax_power_mode.plot([], [], 'm-', linewidth=2, marker='o', markersize=4,
+                                                        animated=True)
         self.ax_power_mode.set_yticks([0, 1])
         self.ax_power_mode.set_yticklabels(['SLEEP', 'ACTIVE'])
         
+        # Fixed x range: the newest sample is always at the right edge, so
+        # tick labels never change and the cached backgrounds stay valid
+        for ax in (self.ax_hr, self.ax_spo2, self.ax_temp, self.ax_battery, self.ax_power_mode):
+            ax.set_xlim(0, self.window)
+        
         # System Status Panel (bottom full width)
         self.ax_status = self.fig.add_subplot(gs[3, :])
         self.ax_status.axis('off')
         self.status_text = self.ax_status.text(0.5, 0.5, '', 
                                                ha='center', va='center',
                                                fontsize=12, fontweight='bold',
-                                               bbox=dict(boxstyle='round', facecolor='black', alpha=0.8))
+                                               bbox=dict(boxstyle='round', facecolor='black', alpha=0.8),
+                                               animated=True)
+        
+        # Animated artists per panel; only these are redrawn between full draws
+        self.panels = {
+            self.ax_hr: [self.line_hr],
+            self.ax_spo2: [self.line_spo2],
+            self.ax_temp: [self.line_temp],
+            self.ax_battery: [self.line_battery],
+            self.ax_power_mode: [self.line_power_mode],
+            self.ax_status: [self.status_text],
+        }
         
+        self.update_sensor_bars()
         plt.tight_layout()
+        
+        self.fig.canvas.mpl_connect('draw_event', self.on_draw)
+        plt.show(block=False)
+        self.fig.canvas.draw()
+        self.fig.canvas.flush_events()
+    
+    def on_draw(self, event):
+        """Full redraw (first show, resize, bar change): recapture backgrounds"""
+        if event is not None and event.canvas is not self.fig.canvas:
+            return
+        canvas = self.fig.canvas
+        self.backgrounds = {ax: canvas.copy_from_bbox(ax.bbox) for ax in self.panels}
+        
+        # The full draw skipped the animated artists; put them back on top
+        for ax, artists in self.panels.items():
+            for artist in artists:
+                ax.draw_artist(artist)
+        self.dirty.clear()
     
     def update_sensor_bars(self):
         """Update sensor power, efficiency, and heat bars"""
         sensor_names = list(self.sensors.keys())
         
+        # The bars are part of the static background; rebuild them only
+        # when a sensor figure changed
+        drawn = tuple((s, v['power_mw'], v['efficiency'], v['heat_mw']) for s, v in self.sensors.items())
+        if drawn == self.sensors_drawn:
+            return
+        first = self.sensors_drawn is None
+        self.sensors_drawn = drawn
+        
         # Power consumption bars
         self.ax_power.clear()
         self.ax_power.set_title('⚡ SENSOR POWER CONSUMPTION', fontweight='bold', color='yellow')
@@ -205,6 +293,10 @@ class MinerDashboard:
             self.ax_heat.text(bar.get_x() + bar.get_width()/2., height,
                             f'{heat:.2f}mW',
                             ha='center', va='bottom', fontsize=8)
+        
+        # New background: full redraw, on_draw recaptures it
+        if not first:
+            self.fig.canvas.draw_idle()
     
     def update_status_panel(self):
         """Update system status information"""
@@ -221,14 +313,16 @@ class MinerDashboard:
         ⚙️ Total Power: {sum(s['power_mw'] for s in self.sensors.values()):.1f}mW | 🔥 Total Heat: {sum(s['heat_mw'] for s in self.sensors.values()):.2f}mW
         """
         
-        self.status_text.set_text(status_text)
-        self.status_text.set_color(status_colors[self.health_status])
+        status = (status_text, status_colors[self.health_status])
+        if status == self.status_drawn:
+            return
+        self.status_drawn = status
+        self.status_text.set_text(status[0])
+        self.status_text.set_color(status[1])
+        self.dirty.add(self.ax_status)
     
     def add_measurement(self, heart_rate, spo2, temperature, power_active=False):
         """Add new measurement data"""
-        current_time = len(self.time_data)
-        
-        self.time_data.append(current_time)
         self.heart_rate_data.append(heart_rate)
         self.spo2_data.append(spo2)
         self.temperature_data.append(temperature)
@@ -255,28 +349,15 @@ class MinerDashboard:
         self.update_plots()
     
     def update_plots(self):
-        """Update all real-time plots"""
-        time_array = list(self.time_data)
-        
-        # Update heart rate
-        self.line_hr.set_data(time_array, list(self.heart_rate_data))
-        self.ax_hr.set_xlim(max(0, len(time_array) - 50), max(50, len(time_array)))
-        
-        # Update SpO2
-        self.line_spo2.set_data(time_array, list(self.spo2_data))
-        self.ax_spo2.set_xlim(max(0, len(time_array) - 50), max(50, len(time_array)))
-        
-        # Update temperature
-        self.line_temp.set_data(time_array, list(self.temperature_data))
-        self.ax_temp.set_xlim(max(0, len(time_array) - 50), max(50, len(time_array)))
-        
-        # Update battery
-        self.line_battery.set_data(time_array, list(self.battery_data))
-        self.ax_battery.set_xlim(max(0, len(time_array) - 50), max(50, len(time_array)))
-        
-        # Update power mode
-        self.line_power_mode.set_data(time_array, list(self.power_mode_data))
-        self.ax_power_mode.set_xlim(max(0, len(time_array) - 50), max(50, len(time_array)))
+        """Point the lines at the newest window of each buffer and refresh"""
+        for line, data in ((self.line_hr, self.heart_rate_data),
+                           (self.line_spo2, self.spo2_data),
+                           (self.line_temp, self.temperature_data),
+                           (self.line_battery, self.battery_data),
+                           (self.line_power_mode, self.power_mode_data)):
+            values = data.latest(self.window)
+            line.set_data(self.x_axis[:len(values)], values)
+            self.dirty.add(line.axes)
         
         # Update sensor bars
         self.update_sensor_bars()
@@ -285,7 +366,34 @@ class MinerDashboard:
         self.update_status_panel()
         
         # Refresh display
-        plt.pause(0.01)
+        self.render()
+    
+    def render(self, force=False):
+        """Blit the changed panels, at most once per min_frame_interval
+
+        Skipped frames keep their panels dirty; the line data is already
+        current, so the next frame or a full redraw shows it.
+        """
+        if not self.dirty:
+            return
+        now = time.monotonic()
+        if not force and now - self.last_frame < self.min_frame_interval:
+            return
+        self.last_frame = now
+        
+        canvas = self.fig.canvas
+        if not getattr(canvas, 'supports_blit', False) or not self.backgrounds:
+            canvas.draw_idle()
+            canvas.flush_events()
+            return
+        
+        for ax in self.dirty:
+            canvas.restore_region(self.backgrounds[ax])
+            for artist in self.panels[ax]:
+                ax.draw_artist(artist)
+            canvas.blit(ax.bbox)
+        self.dirty.clear()
+        canvas.flush_events()
     
     def set_health_status(self, status):
         """Set current health status"""
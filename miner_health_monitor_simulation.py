@@ -1,14 +1,42 @@
 """
 Miner Health Monitoring System - Simulation
 Demonstrates the complete workflow without hardware
+
+Usage:
+    python miner_health_monitor_simulation.py
+    python miner_health_monitor_simulation.py --fleet --miners 2000 --days 30
+    python miner_health_monitor_simulation.py --fleet --set NORMAL_INTERVAL=60 --energy report.json
+    python miner_health_monitor_simulation.py --fleet --sweep SPO2_MIN_NORMAL=90,91,92
+
+Without arguments one monitor runs through a few minutes with console output.
+--fleet runs the firmware's state machine vectorized over every shift of
+every miner for battery and alert volume: readings are confirmed through the
+trend engine (trend.c) and sampled at the per-status periods of main.c;
+--legacy judges every reading on its own with every sensor sampled each
+cycle, as the firmware did before both. --energy takes the per-status cycle
+charge from a host/power_report.py JSON report of the release under test.
+The fleet run needs numpy, the demo does not.
 """
 
+import argparse
+import json
 import time
 import random
 import math
 from datetime import datetime
 from enum import Enum
 
+np = None                               # numpy, loaded by the fleet model only
+
+
+def load_numpy():
+    """Import numpy on first use, so the single monitor demo runs without it"""
+    global np
+    if np is None:
+        import numpy
+        np = numpy
+    return np
+
 class SystemState(Enum):
     SLEEP = 1
     WAKING = 2
@@ -268,6 +296,515 @@ class MinerHealthMonitor:
         print(f"📊 Total Monitoring Cycles: {cycle_count}")
         print("="*60 + "\n")
 
+class FleetEnergyModel:
+    """Charge of a monitoring cycle by health status, sleep current in between
+
+    The defaults are placeholders of the order the benchmark firmware
+    measures (make bench); load the report of the release under test with
+    from_report() before drawing conclusions about battery life.
+    """
+    SLEEP_MA = 0.015                        # System ON idle, fall monitor running
+    AWAKE_MA = 4.0                          # Sensors sampling, CPU mostly in WFE
+    AWAKE_MS = (3000, 9000, 9000, 9000)     # NORMAL skips most ECG captures
+    TX_MA = 45                              # LoRa at +14 dBm (TRANSPORT_LORA_TX_MA)
+    TX_MS = 370                             # Alert frame at SF10
+
+    def __init__(self, sleep_ma=None, awake_uah=None, awake_ms=None, tx_uah=None):
+        load_numpy()
+        self.sleep_ma = self.SLEEP_MA if sleep_ma is None else sleep_ma
+        self.awake_ms = np.array(self.AWAKE_MS if awake_ms is None else awake_ms, dtype=float)
+        if awake_uah is None:
+            awake_uah = self.AWAKE_MA * self.awake_ms / 3600.0
+        self.awake_uah = np.array(awake_uah, dtype=float)
+        self.tx_uah = self.TX_MA * self.TX_MS / 3600.0 if tx_uah is None else tx_uah
+
+    @classmethod
+    def from_report(cls, path, sleep_ma=None):
+        """Per-status cycle charge from a host/power_report.py JSON report
+
+        The report's cycles include their sleep; it is taken out at the sleep
+        current so the simulated intervals can differ from the benchmark's.
+        Frames on air are part of the measured cycles, so no TX charge is
+        added on top. Statuses the benchmark never reached cost as much as
+        the dearest one it did.
+        """
+        with open(path) as f:
+            report = json.load(f)
+        sleep_ma = cls.SLEEP_MA if sleep_ma is None else sleep_ma
+
+        awake_ms = list(cls.AWAKE_MS)
+        awake_uah = [None] * len(HealthStatus)
+        for i, status in enumerate(HealthStatus):
+            entry = report.get('by_status', {}).get(status.name.lower())
+            if entry is None or 'charge_uah_per_cycle' not in entry:
+                continue
+            awake_ms[i] = entry['awake_ms_per_cycle']
+            sleep_uah = sleep_ma * (entry['cycle_ms'] - entry['awake_ms_per_cycle']) / 3600.0
+            awake_uah[i] = max(0.0, entry['charge_uah_per_cycle'] - sleep_uah)
+
+        known = [u for u in awake_uah if u is not None]
+        if not known:
+            raise ValueError('%s has no charge per cycle, report it with --capture' % path)
+        awake_uah = [max(known) if u is None else u for u in awake_uah]
+        return cls(sleep_ma, awake_uah, awake_ms, tx_uah=0.0)
+
+
+class FleetTrend:
+    """trend.c for one vital over all lanes, in floating point
+
+    EWMA of the value (1/4), of its change per minute (1/2) and of its
+    squared deviation (1/8), a quality score that drops on 4 sigma outliers,
+    and the same confirmation rules: out of band on TREND_PERSIST_READINGS
+    readings in a row (one more on poor quality), a prior slope already
+    heading out fast on good quality, a critical reading on good quality
+    while the mean is in the warning band and the slope still heading out,
+    or the mean itself out of band. Levels are 0 normal, 1 warning and 2
+    critical; an unconfirmed critical reading counts as a warning.
+    """
+    MEAN_WEIGHT = 0.25
+    SLOPE_WEIGHT = 0.5
+    VAR_WEIGHT = 0.125
+    QUALITY_WEIGHT = 0.25
+    OUTLIER_SIGMA_SQ = 16.0
+    QUALITY_OUTLIER = 64.0
+    QUALITY_GOOD = 160.0
+    PERSIST_READINGS = 2
+    STALE_S = 360.0                     # TREND_STALE_TICKS: slope restarts after longer gaps
+
+    def __init__(self, lanes, critical_low, warning_low, warning_high, critical_high, noise, fast_slope):
+        self.band = (critical_low, warning_low, warning_high, critical_high)
+        self.noise_sq = noise * noise
+        self.fast = fast_slope
+        self.mean = np.zeros(lanes)
+        self.slope = np.zeros(lanes)
+        self.var = np.full(lanes, self.noise_sq)
+        self.quality = np.full(lanes, 255.0)
+        self.last = np.zeros(lanes)
+        self.last_t = np.zeros(lanes)
+        self.persist_warning = np.zeros(lanes, dtype=np.int64)
+        self.persist_critical = np.zeros(lanes, dtype=np.int64)
+        self.level = np.zeros(lanes, dtype=np.int64)
+        self.primed = np.zeros(lanes, dtype=bool)
+
+    STATE = ('mean', 'slope', 'var', 'quality', 'last', 'last_t', 'persist_warning',
+             'persist_critical', 'level', 'primed')
+
+    def keep(self, mask):
+        """Drop the lanes whose shift ended"""
+        for name in self.STATE:
+            setattr(self, name, getattr(self, name)[mask])
+
+    def band_level(self, value):
+        critical_low, warning_low, warning_high, critical_high = self.band
+        return np.where((value < critical_low) | (value > critical_high), 2,
+                        np.where((value < warning_low) | (value > warning_high), 1, 0))
+
+    def heading_out(self, value, slope, fast):
+        _, warning_low, warning_high, _ = self.band
+        return (((value < warning_low) & (slope <= -fast)) |
+                ((value >= warning_low) & (value > warning_high) & (slope >= fast)))
+
+    def update(self, fresh, value, t):
+        """Fold the readings of the lanes in `fresh` in; the others keep their level
+
+        @return Confirmed level per lane
+        """
+        primed = self.primed
+        prior_slope = np.where(primed, self.slope, 0.0)
+        var = np.maximum(self.var, self.noise_sq)
+        dev_sq = (value - self.mean) ** 2
+        outlier = primed & (dev_sq > self.OUTLIER_SIGMA_SQ * var)
+        dev_sq = np.minimum(dev_sq, self.OUTLIER_SIGMA_SQ * var)
+
+        dt_min = np.maximum(t - self.last_t, 1e-9) / 60.0
+        rate = (value - self.last) / dt_min
+        slope = np.where(t - self.last_t > self.STALE_S, 0.0,
+                         self.slope + self.SLOPE_WEIGHT * (rate - self.slope))
+        quality = self.quality + self.QUALITY_WEIGHT * (
+            np.where(outlier, self.QUALITY_OUTLIER, 255.0) - self.quality)
+
+        mean = np.where(primed, self.mean + self.MEAN_WEIGHT * (value - self.mean), value)
+        var = np.where(primed, self.var + self.VAR_WEIGHT * (dev_sq - self.var), self.noise_sq)
+        slope = np.where(primed, slope, 0.0)
+        quality = np.where(primed, quality, self.quality)
+
+        now = self.band_level(value)
+        persist_warning = np.where(now >= 1, self.persist_warning + 1, 0)
+        persist_critical = np.where(now == 2, self.persist_critical + 1, 0)
+        needed = self.PERSIST_READINGS + (quality < self.QUALITY_GOOD)
+
+        level = self.band_level(mean)
+        level = np.where(persist_critical >= needed, 2,
+                         np.where((persist_warning >= needed) & (level < 1), 1, level))
+        good = quality >= self.QUALITY_GOOD
+        up = now > level
+        by_slope = up & good & self.heading_out(value, prior_slope, self.fast)
+        by_mean = up & (now == 2) & (level == 1) & good & self.heading_out(value, slope, 1e-9)
+        level = np.where(by_slope | by_mean, now, np.where(up & (now == 2) & (level < 1), 1, level))
+
+        for name, new in (('mean', mean), ('slope', slope), ('var', var), ('quality', quality),
+                          ('persist_warning', persist_warning), ('persist_critical', persist_critical),
+                          ('level', level)):
+            setattr(self, name, np.where(fresh, new, getattr(self, name)))
+        self.last = np.where(fresh, value, self.last)
+        self.last_t = np.where(fresh, t, self.last_t)
+        self.primed = primed | fresh
+        return self.level
+
+
+class FleetSimulation:
+    """Firmware state machine over a whole fleet, vectorized
+
+    Every shift of every miner is one numpy lane. A shift starts freshly
+    charged in NORMAL and steps cycle by cycle, all lanes at once, so a month
+    of a 2,000-miner fleet takes seconds rather than real time. Readings go
+    through FleetTrend per vital and the status is composed from the
+    confirmed levels as in trend_update(); the temperature is only sampled
+    at the TMP117 period of the previous status, as sensors_due() in main.c
+    does, and a skipped reading keeps the earlier one without feeding the
+    trend. With legacy=True every sensor is read each cycle and judged on
+    its own by analyze_health(), as before the trend engine.
+
+    Thresholds and intervals default to the MinerHealthMonitor constants;
+    override them per run to see what a change does to battery life and
+    alert volume. Blood pressure is not modelled; the ECG captures it needs
+    are part of the per-status charge of FleetEnergyModel.
+    """
+
+    # Miner baselines (mean, SD across the fleet) and reading noise
+    HR_BASE = (76.0, 7.0)
+    HR_NOISE = 5.0
+    SPO2_BASE = (97.0, 0.8)
+    SPO2_NOISE = 1.0
+    TEMP_BASE = (36.7, 0.25)
+    TEMP_NOISE = 0.15
+
+    # Episodes that push one vital out of range for a while: starts per
+    # shift hour, mean length (minutes), mean and SD of the deviation
+    EPISODES = (
+        ('exertion', 0.20, 10.0, 45.0, 10.0),       # heart rate +BPM
+        ('desaturation', 0.05, 8.0, 7.0, 2.0),      # SpO2 -%
+        ('heat', 0.02, 40.0, 1.8, 0.5),             # temperature +C
+    )
+    EPISODE_HR, EPISODE_SPO2, EPISODE_TEMP = 1, 2, 3
+    FALLS_PER_HOUR = 0.002
+
+    # TMP117 row of m_acq_period_ms in main.c (seconds, 0 = every cycle),
+    # indexed by the status of the previous cycle
+    TEMP_PERIOD_S = (300.0, 60.0, 0.0, 0.0)
+
+    # Reading noise (1 sigma) and confirming slope per minute of m_bands in trend.c
+    TREND_SPO2 = (1.0, 2.0)
+    TREND_HR = (3.0, 10.0)
+    TREND_TEMP = (0.1, 0.25)
+
+    # Firmware names accepted for the MinerHealthMonitor intervals (seconds)
+    ALIASES = {
+        'NORMAL_MONITORING_INTERVAL_MS': 'NORMAL_INTERVAL',
+        'EXTENDED_MONITORING_INTERVAL_MS': 'EXTENDED_INTERVAL',
+        'EMERGENCY_MONITORING_INTERVAL_MS': 'EMERGENCY_INTERVAL',
+    }
+
+    def __init__(self, miners=2000, days=30, shift_hours=12.0, battery_mah=1000.0,
+                 energy=None, seed=1, legacy=False, **overrides):
+        load_numpy()
+        self.legacy = legacy
+        self.miners = miners
+        self.days = days
+        self.shift_hours = shift_hours
+        self.battery_mah = battery_mah
+        self.energy = energy or FleetEnergyModel()
+        self.seed = seed
+
+        self.params = {name: value for name, value in vars(MinerHealthMonitor).items()
+                       if name.isupper()}
+        for name, value in overrides.items():
+            if name in self.ALIASES:
+                name, value = self.ALIASES[name], value / 1000.0
+            if name not in self.params:
+                raise ValueError('unknown MinerHealthMonitor constant %s' % name)
+            self.params[name] = value
+
+    def analyze_health(self, spo2, heart_rate, temperature, fall):
+        """analyze_health() over all lanes, status index 0 (NORMAL) to 3"""
+        p = self.params
+        spo2_critical = spo2 < p['SPO2_MIN_CRITICAL']
+        hr_critical = ((heart_rate < p['HEART_RATE_CRITICAL_MIN']) |
+                       (heart_rate > p['HEART_RATE_CRITICAL_MAX']))
+        temp_critical = ((temperature < p['TEMP_CRITICAL_MIN']) |
+                         (temperature > p['TEMP_CRITICAL_MAX']))
+
+        warnings = ((~spo2_critical & (spo2 < p['SPO2_MIN_NORMAL'])).astype(np.int8) +
+                    (~hr_critical & ((heart_rate < p['HEART_RATE_MIN']) |
+                                     (heart_rate > p['HEART_RATE_MAX']))) +
+                    (~temp_critical & ((temperature < p['TEMP_MIN_NORMAL']) |
+                                       (temperature > p['TEMP_MAX_NORMAL']))))
+        critical = spo2_critical | hr_critical | temp_critical | fall
+
+        return np.where(critical, 3, np.where(warnings >= 2, 2, np.where(warnings > 0, 1, 0)))
+
+    def run(self):
+        """Simulate every shift; returns per-shift arrays and fleet totals"""
+        p = self.params
+        energy = self.energy
+        rng = np.random.default_rng(self.seed)
+        shift_s = self.shift_hours * 3600.0
+        lanes = self.miners * self.days
+        started = time.perf_counter()
+
+        # Baselines belong to the miner, each of their shifts is a lane
+        miner = np.repeat(np.arange(self.miners), self.days)
+        hr_base = rng.normal(self.HR_BASE[0], self.HR_BASE[1], self.miners)[miner]
+        spo2_base = rng.normal(self.SPO2_BASE[0], self.SPO2_BASE[1], self.miners)[miner]
+        temp_base = rng.normal(self.TEMP_BASE[0], self.TEMP_BASE[1], self.miners)[miner]
+
+        ep_rate = np.array([e[1] for e in self.EPISODES])
+        ep_len_s = np.array([e[2] * 60.0 for e in self.EPISODES])
+        ep_mean = np.array([e[3] for e in self.EPISODES])
+        ep_sd = np.array([e[4] for e in self.EPISODES])
+        ep_total = ep_rate.sum()
+
+        # Per-shift results
+        charge_uah = np.zeros(lanes)
+        cycles = np.zeros(lanes, dtype=np.int64)
+        routine_tx = np.zeros(lanes, dtype=np.int64)
+        alerts = np.zeros(lanes, dtype=np.int64)
+        falls = np.zeros(lanes, dtype=np.int64)
+        depleted_s = np.full(lanes, np.nan)
+        status_cycles = np.zeros(len(HealthStatus), dtype=np.int64)
+        capacity_uah = self.battery_mah * 1000.0
+
+        # State of the lanes still in their shift
+        lane = np.arange(lanes)
+        t = np.zeros(lanes)
+        interval = np.full(lanes, float(p['NORMAL_INTERVAL']))
+        anomaly = np.zeros(lanes, dtype=np.int64)
+        sent = np.zeros(lanes, dtype=bool)
+        ep_kind = np.zeros(lanes, dtype=np.int8)
+        ep_end = np.zeros(lanes)
+        ep_mag = np.zeros(lanes)
+        prev_status = np.zeros(lanes, dtype=np.int64)
+        temp_at = np.full(lanes, -np.inf)           # Last TMP117 sample
+        temp_held = np.zeros(lanes)
+        temp_period = np.array(self.TEMP_PERIOD_S)
+        trends = (
+            FleetTrend(lanes, p['SPO2_MIN_CRITICAL'], p['SPO2_MIN_NORMAL'], np.inf, np.inf, *self.TREND_SPO2),
+            FleetTrend(lanes, p['HEART_RATE_CRITICAL_MIN'], p['HEART_RATE_MIN'], p['HEART_RATE_MAX'],
+                       p['HEART_RATE_CRITICAL_MAX'], *self.TREND_HR),
+            FleetTrend(lanes, p['TEMP_CRITICAL_MIN'], p['TEMP_MIN_NORMAL'], p['TEMP_MAX_NORMAL'],
+                       p['TEMP_CRITICAL_MAX'], *self.TREND_TEMP),
+        )
+
+        while lane.size:
+            # Shifts that end during this sleep
+            t_next = t + interval
+            ending = t_next > shift_s
+            if ending.any():
+                charge_uah[lane[ending]] += energy.sleep_ma * (shift_s - t[ending]) / 3.6
+                keep = ~ending
+                (lane, t, t_next, interval, anomaly, sent, ep_kind, ep_end, ep_mag,
+                 prev_status, temp_at, temp_held) = (
+                    a[keep] for a in (lane, t, t_next, interval, anomaly, sent, ep_kind, ep_end, ep_mag,
+                                      prev_status, temp_at, temp_held))
+                for trend in trends:
+                    trend.keep(keep)
+                if not lane.size:
+                    break
+            dt = interval
+            t = t_next
+            n = lane.size
+
+            # Episodes and falls starting during the sleep just ended
+            idle = ep_end <= t
+            start = idle & (rng.random(n) < -np.expm1(-ep_total * dt / 3600.0))
+            if start.any():
+                kinds = rng.choice(len(self.EPISODES), int(start.sum()), p=ep_rate / ep_total)
+                onset = t[start] - dt[start] * rng.random(kinds.size)
+                ep_kind[start] = kinds + 1
+                ep_end[start] = onset + rng.exponential(ep_len_s[kinds])
+                ep_mag[start] = np.maximum(0.0, rng.normal(ep_mean[kinds], ep_sd[kinds]))
+            on = ep_end > t
+            fall = rng.random(n) < -np.expm1(-self.FALLS_PER_HOUR * dt / 3600.0)
+
+            # simulate_sensor_readings()
+            noise = rng.standard_normal((3, n))
+            heart_rate = np.rint(hr_base[lane] + self.HR_NOISE * noise[0] +
+                                 np.where(on & (ep_kind == self.EPISODE_HR), ep_mag, 0.0))
+            spo2 = np.clip(np.rint(spo2_base[lane] + self.SPO2_NOISE * noise[1] -
+                                   np.where(on & (ep_kind == self.EPISODE_SPO2), ep_mag, 0.0)), 0, 100)
+            temperature = np.round(temp_base[lane] + self.TEMP_NOISE * noise[2] +
+                                   np.where(on & (ep_kind == self.EPISODE_TEMP), ep_mag, 0.0), 2)
+
+            if self.legacy:
+                status = self.analyze_health(spo2, heart_rate, temperature, fall)
+            else:
+                # sensors_due(): the period of the previous status, met by a
+                # tick within half an interval of it
+                period = temp_period[prev_status]
+                temp_due = (period == 0) | (t - temp_at + dt / 2 >= period)
+                temp_at = np.where(temp_due, t, temp_at)
+                temp_held = np.where(temp_due, temperature, temp_held)
+
+                every = np.ones(n, dtype=bool)
+                levels = (trends[0].update(every, spo2, t), trends[1].update(every, heart_rate, t),
+                          trends[2].update(temp_due, temp_held, t))
+                warnings = sum((level == 1).astype(np.int8) for level in levels)
+                critical = fall | (levels[0] == 2) | (levels[1] == 2) | (levels[2] == 2)
+                status = np.where(critical, 3, np.where(warnings >= 2, 2, np.where(warnings > 0, 1, 0)))
+                prev_status = status
+
+            # handle_health_status()
+            normal, warning, critical, emergency = (status == i for i in range(len(HealthStatus)))
+            anomaly = np.where(normal, 0, anomaly + warning)
+            interval = np.where(normal, float(p['NORMAL_INTERVAL']), interval)
+            interval = np.where((warning & (anomaly >= 2)) | critical, float(p['EXTENDED_INTERVAL']), interval)
+            interval = np.where(emergency, float(p['EMERGENCY_INTERVAL']), interval)
+            alert = emergency & ~sent
+            sent = (sent | emergency) & ~normal
+
+            # Charge of the cycle: the sleep before it, the measurement and
+            # any frame it sends
+            awake_s = energy.awake_ms[status] / 1000.0
+            cycle_uah = (energy.awake_uah[status] +
+                         energy.sleep_ma * np.maximum(dt - awake_s, 0.0) / 3.6 +
+                         energy.tx_uah * (critical | alert))
+            charge_uah[lane] += cycle_uah
+            flat = np.isnan(depleted_s[lane]) & (charge_uah[lane] > capacity_uah)
+            depleted_s[lane[flat]] = t[flat]
+
+            cycles[lane] += 1
+            routine_tx[lane] += critical
+            alerts[lane] += alert
+            falls[lane] += fall
+            status_cycles += np.bincount(status, minlength=len(HealthStatus))
+
+        return {
+            'charge_mah': charge_uah / 1000.0,
+            'cycles': cycles,
+            'routine_tx': routine_tx,
+            'alerts': alerts,
+            'falls': falls,
+            'depleted_hours': depleted_s / 3600.0,
+            'status_cycles': status_cycles,
+            'elapsed_s': time.perf_counter() - started,
+        }
+
+    def summarize(self, result):
+        """Fleet figures of a run() result"""
+        charge = result['charge_mah']
+        mean_ma = charge / self.shift_hours
+        depleted = ~np.isnan(result['depleted_hours'])
+        status_share = result['status_cycles'] / max(1, result['status_cycles'].sum())
+        return {
+            'shifts': charge.size,
+            'cycles_per_shift': result['cycles'].mean(),
+            'shift_mah_mean': charge.mean(),
+            'shift_mah_p95': np.percentile(charge, 95),
+            'mean_ma': mean_ma.mean(),
+            'runtime_hours_median': np.median(self.battery_mah / mean_ma),
+            'runtime_hours_p5': np.percentile(self.battery_mah / mean_ma, 5),
+            'depleted_shifts': int(depleted.sum()),
+            'depleted_pct': 100.0 * depleted.mean(),
+            'alerts_per_day': result['alerts'].sum() / self.days,
+            'routine_tx_per_day': result['routine_tx'].sum() / self.days,
+            'alerts_per_shift_p95': np.percentile(result['alerts'], 95),
+            'shifts_with_alert_pct': 100.0 * (result['alerts'] > 0).mean(),
+            'falls': int(result['falls'].sum()),
+            'status_share': {s.name: float(status_share[i]) for i, s in enumerate(HealthStatus)},
+            'elapsed_s': result['elapsed_s'],
+        }
+
+
+def print_fleet_summary(sim, summary):
+    print("\n" + "="*60)
+    print("🏭 FLEET SIMULATION: %d miners, %d days, %g h shifts" % (sim.miners, sim.days, sim.shift_hours))
+    print("="*60)
+    print("📐 Rules: %s" % ("every reading on its own, every sensor each cycle (legacy)" if sim.legacy else
+                           "trend engine, per-status sampling periods"))
+    print("⏱️  Intervals: %g / %g / %g s (normal / extended / emergency)"
+          % (sim.params['NORMAL_INTERVAL'], sim.params['EXTENDED_INTERVAL'], sim.params['EMERGENCY_INTERVAL']))
+    print("🔄 Cycles per shift: %.0f" % summary['cycles_per_shift'])
+    print("📊 Cycles by status: " + ", ".join("%s %.2f%%" % (name, 100.0 * share)
+                                          for name, share in summary['status_share'].items()))
+    print("🔋 Charge per shift: %.1f mAh mean, %.1f mAh p95 (%.3f mA mean)"
+          % (summary['shift_mah_mean'], summary['shift_mah_p95'], summary['mean_ma']))
+    print("🔋 Runtime on %g mAh: %.0f h median, %.0f h for the worst 5%% of shifts"
+          % (sim.battery_mah, summary['runtime_hours_median'], summary['runtime_hours_p5']))
+    print("🪫 Shifts that run flat: %d (%.2f%%)" % (summary['depleted_shifts'], summary['depleted_pct']))
+    print("🚨 Emergency alerts: %.1f per day fleet-wide, %.2f%% of shifts, p95 %.0f per shift"
+          % (summary['alerts_per_day'], summary['shifts_with_alert_pct'], summary['alerts_per_shift_p95']))
+    print("📡 Critical transmissions: %.1f per day fleet-wide" % summary['routine_tx_per_day'])
+    print("🚨 Falls: %d" % summary['falls'])
+    print("⏱️  Simulated in %.1f s" % summary['elapsed_s'])
+    print("="*60 + "\n")
+
+
+def parse_assignment(text):
+    name, _, value = text.partition('=')
+    if not value:
+        raise argparse.ArgumentTypeError('expected NAME=VALUE, got %r' % text)
+    return name.strip(), [float(v) for v in value.split(',')]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Miner health monitor simulation')
+    parser.add_argument('--minutes', type=float, default=5, help='length of the single monitor demo')
+    parser.add_argument('--fleet', action='store_true', help='vectorized fleet run instead of the demo')
+    parser.add_argument('--miners', type=int, default=2000)
+    parser.add_argument('--days', type=int, default=30)
+    parser.add_argument('--shift-hours', type=float, default=12.0)
+    parser.add_argument('--battery-mah', type=float, default=1000.0)
+    parser.add_argument('--energy', help='host/power_report.py JSON report for the charge per cycle')
+    parser.add_argument('--sleep-ma', type=float, help='sleep current between cycles (mA)')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--legacy', action='store_true',
+                        help='judge every reading on its own and sample every sensor each cycle, '
+                             'as the firmware before the trend engine')
+    parser.add_argument('--set', type=parse_assignment, action='append', default=[], metavar='NAME=VALUE',
+                        help='override a MinerHealthMonitor threshold or interval')
+    parser.add_argument('--sweep', type=parse_assignment, metavar='NAME=V1,V2,...',
+                        help='one fleet run per value of a threshold or interval')
+    args = parser.parse_args()
+
+    if not args.fleet:
+        monitor = MinerHealthMonitor()
+        monitor.run(duration_minutes=args.minutes)
+        return 0
+
+    try:
+        load_numpy()
+    except ImportError:
+        parser.error('--fleet needs numpy')
+    if args.energy:
+        energy = FleetEnergyModel.from_report(args.energy, args.sleep_ma)
+    else:
+        energy = FleetEnergyModel(sleep_ma=args.sleep_ma)
+    overrides = {name: values[-1] for name, values in args.set}
+
+    def fleet(**extra):
+        try:
+            return FleetSimulation(args.miners, args.days, args.shift_hours, args.battery_mah,
+                                   energy, args.seed, args.legacy, **dict(overrides, **extra))
+        except ValueError as e:
+            parser.error(str(e))
+
+    if args.sweep is None:
+        sim = fleet()
+        print_fleet_summary(sim, sim.summarize(sim.run()))
+        return 0
+
+    name, values = args.sweep
+    width = max(12, len(name))
+    print("%-*s %9s %10s %9s %12s %12s %8s" % (width, name, 'mean mA', 'runtime h', 'flat %',
+                                                'alerts/day', 'critical/day', 'time s'))
+    for value in values:
+        sim = fleet(**{name: value})
+        s = sim.summarize(sim.run())
+        print("%-*g %9.3f %10.0f %9.2f %12.1f %12.1f %8.1f" % (
+            width, value, s['mean_ma'], s['runtime_hours_median'], s['depleted_pct'],
+            s['alerts_per_day'], s['routine_tx_per_day'], s['elapsed_s']))
+    return 0
+
+
 if __name__ == "__main__":
-    monitor = MinerHealthMonitor()
-    monitor.run(duration_minutes=5)  # Run 5-minute simulation
\ No newline at end of file
+    raise SystemExit(main())
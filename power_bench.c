@@ -0,0 +1,164 @@
+/**
+ * @file power_bench.c
+ * @brief Fixed-workload power benchmark firmware (make bench)
+ * @description The benchmark build runs the normal firmware for
+ *              POWER_BENCH_CYCLES monitoring cycles with the readings
+ *              replaced by a fixed script. Health status, sampling periods,
+ *              flash writes and uplinks then follow the same sequence on
+ *              every run, so two releases can be compared cycle for cycle.
+ *              The sensors are still powered and read as usual; only their
+ *              results are overridden.
+ *
+ *              Every wake tick ends the previous cycle. A binary
+ *              power_bench_record_t with its per-phase profiler times goes
+ *              out on RTT up channel POWER_BENCH_RTT_CHANNEL, and
+ *              POWER_BENCH_MARKER_PIN toggles so a Power Profiler capture
+ *              can be cut at the same boundaries. host/power_report.py
+ *              pairs the two into the release report.
+ *
+ *              All calls come from thread context.
+ */
+
+#include "power_bench.h"
+#include "tmp117_driver.h"
+#include "app_timer.h"
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "SEGGER_RTT.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_POWER_BENCH
+#include "trace.h"
+#include <string.h>
+
+#define POWER_BENCH_RTT_RECORDS     8       // Records buffered while the host is slow
+
+// Scripted reading, one per cycle
+typedef struct {
+    uint8_t  spo2;
+    uint8_t  heart_rate;
+    uint8_t  bp_systolic;
+    uint8_t  bp_diastolic;
+    int16_t  temp_cdeg;             // 1/100 C
+} power_bench_reading_t;
+
+// One shift pattern, repeated: mostly normal readings, a heart-rate run
+// that escalates to extended monitoring, one critical SpO2 dip and the
+// recovery after it
+static const power_bench_reading_t m_script[] = {
+    { 97, 72,  118, 76, 3680 },
+    { 97, 74,  120, 78, 3682 },
+    { 96, 76,  119, 77, 3685 },
+    { 97, 75,  121, 78, 3684 },
+    { 98, 73,  118, 76, 3681 },
+    { 97, 78,  122, 79, 3688 },
+    { 96, 84,  124, 80, 3692 },
+    { 96, 125, 132, 84, 3705 },
+    { 95, 128, 134, 85, 3712 },
+    { 95, 131, 136, 86, 3718 },
+    { 94, 118, 130, 83, 3710 },
+    { 84, 112, 128, 82, 3706 },
+    { 90, 98,  124, 80, 3698 },
+    { 95, 86,  121, 78, 3690 },
+    { 97, 78,  119, 77, 3684 },
+    { 97, 74,  118, 76, 3680 },
+};
+
+#define POWER_BENCH_SCRIPT_LEN      (sizeof(m_script) / sizeof(m_script[0]))
+
+static uint8_t m_rtt_buffer[POWER_BENCH_RTT_RECORDS * sizeof(power_bench_record_t)];
+static profiler_total_t m_last_totals[PROFILER_PHASES];
+static uint32_t m_last_ticks;
+static uint16_t m_cycle;
+static bool m_started = false;
+
+/**
+ * @brief Set up the RTT channel and the marker pin
+ * @note Call after profiler_init()
+ */
+void power_bench_init(void) {
+    SEGGER_RTT_ConfigUpBuffer(POWER_BENCH_RTT_CHANNEL, "bench", m_rtt_buffer,
+                              sizeof(m_rtt_buffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+    nrf_gpio_cfg_output(POWER_BENCH_MARKER_PIN);
+    nrf_gpio_pin_clear(POWER_BENCH_MARKER_PIN);
+
+    m_cycle = 0;
+    m_started = false;
+    TRACE_INFO("Power benchmark: %d cycles, marker on P0.%d", POWER_BENCH_CYCLES, POWER_BENCH_MARKER_PIN);
+}
+
+/**
+ * @brief Close the previous cycle at a wake tick
+ * @param status Health status the previous cycle ended with
+ * @param sensors Sensors woken in the previous cycle
+ * @return true while cycles remain to be recorded
+ * @note A record is dropped whole rather than stalling the cycle when the
+ *       RTT buffer is full; the host reports the gap in cycle numbers
+ */
+bool power_bench_cycle(uint8_t status, uint8_t sensors) {
+    uint32_t now = app_timer_cnt_get();
+    profiler_total_t totals[PROFILER_PHASES];
+
+    if (m_cycle >= POWER_BENCH_CYCLES) {
+        return false;
+    }
+
+    nrf_gpio_pin_toggle(POWER_BENCH_MARKER_PIN);
+    profiler_totals(totals);
+
+    if (!m_started) {
+        m_started = true;
+    } else {
+        power_bench_record_t record;
+
+        record.magic = POWER_BENCH_MAGIC;
+        record.cycle = m_cycle;
+        record.status = status;
+        record.sensors = sensors;
+        record.op_count = PROFILER_OP_COUNT;
+        record.phase_count = PROFILER_PHASES;
+        record.flags = (m_cycle + 1 >= POWER_BENCH_CYCLES) ? POWER_BENCH_FLAG_LAST : 0;
+        record.reserved = 0;
+        record.core_hz = SystemCoreClock;
+        record.wall_ticks = app_timer_cnt_diff_compute(now, m_last_ticks);
+        for (uint8_t i = 0; i < PROFILER_PHASES; i++) {
+            record.phases[i].ticks = totals[i].ticks - m_last_totals[i].ticks;
+            record.phases[i].cycles = totals[i].cycles - m_last_totals[i].cycles;
+        }
+
+        if (SEGGER_RTT_Write(POWER_BENCH_RTT_CHANNEL, &record, sizeof(record)) != sizeof(record)) {
+            TRACE_WARNING("Benchmark record %d dropped, RTT buffer full", m_cycle);
+        }
+        m_cycle++;
+    }
+
+    memcpy(m_last_totals, totals, sizeof(m_last_totals));
+    m_last_ticks = now;
+
+    if (m_cycle >= POWER_BENCH_CYCLES) {
+        TRACE_INFO("Power benchmark done after %d cycles", m_cycle);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Replace the readings of the current cycle with the script
+ * @note Staleness is left as measured: it follows from the sampling
+ *       periods, which the scripted readings already make deterministic
+ */
+void power_bench_vitals(vital_signs_t *vitals) {
+    power_bench_reading_t const *reading = &m_script[m_cycle % POWER_BENCH_SCRIPT_LEN];
+
+    vitals->spo2 = reading->spo2;
+    vitals->heart_rate = reading->heart_rate;
+    vitals->bp_systolic = reading->bp_systolic;
+    vitals->bp_diastolic = reading->bp_diastolic;
+    vitals->temp_raw = TMP117_RAW_FROM_CDEG(reading->temp_cdeg);
+    vitals->accel_raw[0] = 0;
+    vitals->accel_raw[1] = 0;
+    vitals->accel_raw[2] = 2048;            // 1 g, upright and still
+    vitals->accel_mag_sq = 2048UL * 2048UL;
+    vitals->fall_detected = false;
+    vitals->no_movement = false;
+    vitals->ppg_valid = true;
+    vitals->ecg_valid = true;
+}
@@ -0,0 +1,39 @@
+#ifndef POWER_BENCH_H
+#define POWER_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vitals.h"
+#include "profiler.h"
+
+// Monitoring cycles recorded by the benchmark firmware, 0 builds the normal
+// firmware. Set through `make bench BENCH_CYCLES=<n>`.
+#ifndef POWER_BENCH_CYCLES
+#define POWER_BENCH_CYCLES          0
+#endif
+
+#define POWER_BENCH_MARKER_PIN      31          // Power Profiler digital input 0 (adjust to your wiring)
+#define POWER_BENCH_RTT_CHANNEL     1           // Up channel the records go out on
+#define POWER_BENCH_MAGIC           0x31425750  // "PWB1"
+#define POWER_BENCH_FLAG_LAST       (1 << 0)
+
+// One monitoring cycle, wake tick to wake tick (172 bytes on RTT)
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t cycle;                         // From 0
+    uint8_t  status;                        // Health status the cycle ended with
+    uint8_t  sensors;                       // Sensors woken, bit per sensor in main.c order
+    uint8_t  op_count;                      // PROFILER_OP_COUNT
+    uint8_t  phase_count;                   // PROFILER_PHASES
+    uint8_t  flags;                         // POWER_BENCH_FLAG_*
+    uint8_t  reserved;
+    uint32_t core_hz;                       // DWT cycles per second
+    uint32_t wall_ticks;                    // Cycle length (RTC ticks)
+    profiler_total_t phases[PROFILER_PHASES];   // Spent per phase in the cycle
+} power_bench_record_t;
+
+void power_bench_init(void);
+bool power_bench_cycle(uint8_t status, uint8_t sensors);
+void power_bench_vitals(vital_signs_t *vitals);
+
+#endif
\ No newline at end of file
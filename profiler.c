@@ -0,0 +1,226 @@
+/**
+ * @file profiler.c
+ * @brief Per-phase timing of the measurement cycle
+ * @description Every operation and system state is timed twice: in RTC
+ *              ticks (wall time, keeps counting through sleep) and in DWT
+ *              cycles (CPU running, stops in WFE). Each phase keeps a log2
+ *              histogram of its durations in RAM; profiler_snapshot()
+ *              turns the time spent per phase into duty cycles for the
+ *              telemetry stats record.
+ *
+ *              All calls come from thread context.
+ */
+
+#include "profiler.h"
+#include "app_timer.h"
+#include "nrf.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_PROFILER
+#include "trace.h"
+#include <string.h>
+
+#define PROFILER_TICK_MASK      0x00FFFFFF      // app_timer counter is 24-bit
+
+typedef struct {
+    uint32_t start_ticks;
+    uint32_t start_cycles;
+    bool     active;
+    uint32_t count;
+    uint32_t total_ticks;
+    uint64_t total_cycles;
+    uint32_t max_ticks;
+    uint32_t period_ticks;              // Since the last snapshot
+    uint16_t hist[PROFILER_HIST_BUCKETS];
+} profiler_phase_t;
+
+static const char * const m_op_names[PROFILER_OP_COUNT] = {
+    "sleep", "warmup", "ecg", "ppg", "temp", "imu",
+    "analyze", "encode", "flash", "radio", "log"
+};
+
+static profiler_phase_t m_phases[PROFILER_PHASES];
+static uint8_t m_state = PROFILER_MAX_STATES;   // None yet
+
+// Period accounting, advanced on every call
+static uint32_t m_last_ticks;
+static uint32_t m_last_cycles;
+static uint32_t m_period_ticks;
+static uint64_t m_period_cycles;
+
+static void profiler_advance(uint32_t now_ticks, uint32_t now_cycles) {
+    m_period_ticks += (now_ticks - m_last_ticks) & PROFILER_TICK_MASK;
+    m_period_cycles += now_cycles - m_last_cycles;
+    m_last_ticks = now_ticks;
+    m_last_cycles = now_cycles;
+}
+
+static void profiler_phase_begin(profiler_phase_t *phase) {
+    phase->start_ticks = app_timer_cnt_get();
+    phase->start_cycles = DWT->CYCCNT;
+    phase->active = true;
+    profiler_advance(phase->start_ticks, phase->start_cycles);
+}
+
+static void profiler_phase_end(profiler_phase_t *phase) {
+    uint32_t now_ticks = app_timer_cnt_get();
+    uint32_t now_cycles = DWT->CYCCNT;
+
+    if (!phase->active) {
+        return;
+    }
+    phase->active = false;
+    profiler_advance(now_ticks, now_cycles);
+
+    uint32_t ticks = (now_ticks - phase->start_ticks) & PROFILER_TICK_MASK;
+    uint8_t bucket = 0;
+    while (bucket < PROFILER_HIST_BUCKETS - 1 && (ticks >> bucket) != 0) {
+        bucket++;
+    }
+
+    phase->count++;
+    phase->total_ticks += ticks;
+    phase->total_cycles += now_cycles - phase->start_cycles;
+    phase->period_ticks += ticks;
+    if (ticks > phase->max_ticks) {
+        phase->max_ticks = ticks;
+    }
+    if (phase->hist[bucket] < UINT16_MAX) {
+        phase->hist[bucket]++;
+    }
+}
+
+static uint32_t profiler_ticks_to_us(uint64_t ticks) {
+    return (uint32_t)(ticks * 1000000 / APP_TIMER_CLOCK_FREQ);
+}
+
+static uint16_t profiler_duty(uint64_t ticks, uint32_t period_ticks) {
+    if (period_ticks == 0) {
+        return 0;
+    }
+    uint64_t duty = ticks * PROFILER_DUTY_ONE / period_ticks;
+    return (duty > PROFILER_DUTY_ONE) ? PROFILER_DUTY_ONE : (uint16_t)duty;
+}
+
+/**
+ * @brief Start the DWT cycle counter and clear all statistics
+ * @note Call after app_timer_init()
+ */
+void profiler_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(m_phases, 0, sizeof(m_phases));
+    m_state = PROFILER_MAX_STATES;
+    m_last_ticks = app_timer_cnt_get();
+    m_last_cycles = DWT->CYCCNT;
+    m_period_ticks = 0;
+    m_period_cycles = 0;
+}
+
+/**
+ * @brief Record a system state transition
+ */
+void profiler_state(uint8_t state) {
+    if (state >= PROFILER_MAX_STATES || state == m_state) {
+        return;
+    }
+    if (m_state < PROFILER_MAX_STATES) {
+        profiler_phase_end(&m_phases[PROFILER_OP_COUNT + m_state]);
+    }
+    m_state = state;
+    profiler_phase_begin(&m_phases[PROFILER_OP_COUNT + state]);
+}
+
+/**
+ * @brief Mark the start of an operation
+ */
+void profiler_begin(profiler_op_t op) {
+    if (op < PROFILER_OP_COUNT) {
+        profiler_phase_begin(&m_phases[op]);
+    }
+}
+
+/**
+ * @brief Mark the end of an operation; ignored if it was not started
+ */
+void profiler_end(profiler_op_t op) {
+    if (op < PROFILER_OP_COUNT) {
+        profiler_phase_end(&m_phases[op]);
+    }
+}
+
+/**
+ * @brief Duty cycles since the previous snapshot
+ * @note Operations still running are counted in the snapshot they end in
+ */
+void profiler_snapshot(profiler_stats_t *stats) {
+    profiler_advance(app_timer_cnt_get(), DWT->CYCCNT);
+
+    // CPU cycles expressed in RTC ticks at the core clock
+    uint64_t cpu_ticks = m_period_cycles * APP_TIMER_CLOCK_FREQ / SystemCoreClock;
+
+    stats->period_ms = profiler_ticks_to_us(m_period_ticks) / 1000;
+    stats->cpu_duty = profiler_duty(cpu_ticks, m_period_ticks);
+    for (uint8_t op = 0; op < PROFILER_OP_COUNT; op++) {
+        stats->op_duty[op] = profiler_duty(m_phases[op].period_ticks, m_period_ticks);
+        m_phases[op].period_ticks = 0;
+    }
+
+    m_period_ticks = 0;
+    m_period_cycles = 0;
+}
+
+/**
+ * @brief Time spent in every phase so far
+ * @param totals PROFILER_PHASES entries
+ * @note Phases still running are counted up to now, so a read taken in the
+ *       middle of a phase splits it between the two intervals
+ */
+void profiler_totals(profiler_total_t *totals) {
+    uint32_t now_ticks = app_timer_cnt_get();
+    uint32_t now_cycles = DWT->CYCCNT;
+
+    for (uint8_t i = 0; i < PROFILER_PHASES; i++) {
+        profiler_phase_t const *phase = &m_phases[i];
+        totals[i].ticks = phase->total_ticks;
+        totals[i].cycles = (uint32_t)phase->total_cycles;
+        if (phase->active) {
+            totals[i].ticks += (now_ticks - phase->start_ticks) & PROFILER_TICK_MASK;
+            totals[i].cycles += now_cycles - phase->start_cycles;
+        }
+    }
+}
+
+/**
+ * @brief Log per-phase counts, timing and histograms
+ */
+void profiler_log(void) {
+    TRACE_INFO("---------- PROFILE ----------");
+    for (uint8_t i = 0; i < PROFILER_PHASES; i++) {
+        profiler_phase_t const *phase = &m_phases[i];
+        if (phase->count == 0) {
+            continue;
+        }
+
+        uint32_t mean_us = profiler_ticks_to_us(phase->total_ticks / phase->count);
+        uint32_t cpu_us = (uint32_t)(phase->total_cycles / phase->count / (SystemCoreClock / 1000000));
+        if (i < PROFILER_OP_COUNT) {
+            TRACE_INFO("%s: n=%d mean=%d us cpu=%d us max=%d us", m_op_names[i],
+                       phase->count, mean_us, cpu_us, profiler_ticks_to_us(phase->max_ticks));
+        } else {
+            TRACE_INFO("state %d: n=%d mean=%d us cpu=%d us max=%d us", i - PROFILER_OP_COUNT,
+                       phase->count, mean_us, cpu_us, profiler_ticks_to_us(phase->max_ticks));
+        }
+
+        for (uint8_t b = 0; b < PROFILER_HIST_BUCKETS; b++) {
+            if (phase->hist[b] == 0) {
+                continue;
+            }
+            if (b < PROFILER_HIST_BUCKETS - 1) {
+                TRACE_DEBUG("  < %d us: %d", profiler_ticks_to_us(1ULL << b), phase->hist[b]);
+            } else {
+                TRACE_DEBUG("  >= %d us: %d", profiler_ticks_to_us(1ULL << (b - 1)), phase->hist[b]);
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PROFILER_MAX_STATES     8       // System states tracked by profiler_state()
+#define PROFILER_HIST_BUCKETS   24      // log2 of RTC ticks, last bucket ~256 s
+#define PROFILER_DUTY_ONE       65535   // Duty cycle full scale (100%)
+#define PROFILER_PHASES         (PROFILER_OP_COUNT + PROFILER_MAX_STATES)
+
+// Profiled operations
+typedef enum {
+    PROFILER_OP_SLEEP,          // CPU asleep in idle_wait()
+    PROFILER_OP_WARMUP,         // Power-on until every sensor is ready
+    PROFILER_OP_ECG,            // ADS1292R power-on to capture done
+    PROFILER_OP_PPG,            // MAX30102 power-on to PPG window done
+    PROFILER_OP_TEMP,           // TMP117 wake-up to conversion read
+    PROFILER_OP_IMU,            // ICM-42688 wake-up to snapshot read
+    PROFILER_OP_ANALYZE,        // Health analysis
+    PROFILER_OP_ENCODE,         // Telemetry framing and queueing
+    PROFILER_OP_FLASH,          // Vitals log erase/program
+    PROFILER_OP_RADIO,          // Frame on air
+    PROFILER_OP_LOG,            // NRF_LOG processing
+    PROFILER_OP_COUNT
+} profiler_op_t;
+
+// Duty cycles since the previous snapshot (telemetry stats record, 28 bytes)
+typedef struct __attribute__((packed)) {
+    uint32_t period_ms;                     // Time covered by this record
+    uint16_t cpu_duty;                      // CPU running (DWT), 1/65535 of period
+    uint16_t op_duty[PROFILER_OP_COUNT];    // Per operation, 1/65535 of period
+} profiler_stats_t;
+
+// Running totals of one phase, operations first and states after; both
+// wrap, so intervals are taken as differences of two reads
+typedef struct __attribute__((packed)) {
+    uint32_t ticks;                         // RTC ticks
+    uint32_t cycles;                        // DWT cycles
+} profiler_total_t;
+
+void profiler_init(void);
+void profiler_state(uint8_t state);
+void profiler_begin(profiler_op_t op);
+void profiler_end(profiler_op_t op);
+void profiler_snapshot(profiler_stats_t *stats);
+void profiler_totals(profiler_total_t *totals);
+void profiler_log(void);
+
+#endif
\ No newline at end of file
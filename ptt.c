@@ -0,0 +1,279 @@
+/**
+ * @file ptt.c
+ * @brief Pulse transit time from hardware-timestamped ECG and PPG edges
+ * @description TIMER2 runs at 1 MHz while either sensor is acquiring. PPI
+ *              routes the ADS1292R DRDY and MAX30102 INT edges into its
+ *              capture registers, so each edge is timestamped without the
+ *              CPU. The drivers read a capture once per DMA block or FIFO
+ *              drain and anchor their sample index to it; the anchors also
+ *              measure each sensor's actual sample period, so oscillator
+ *              tolerance does not leak into the result.
+ *
+ *              The ADS1292R reports R peaks and the MAX30102 pulse feet on
+ *              that time base. PTT is the median delay from an R peak to the
+ *              next pulse foot, and blood pressure follows from a linear
+ *              model around a per-user reference reading: pressure rises as
+ *              the arteries stiffen and the pulse arrives sooner.
+ */
+
+#include "ptt.h"
+#include "nrf_drv_timer.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_PTT
+#include "trace.h"
+#include <string.h>
+
+#define PTT_CLOCK_TOLERANCE_SHIFT   4       // Anchors within 1/16 of the nominal period
+#define PTT_CLOCK_REANCHOR          2       // Rejected anchors in a row before starting over
+
+// Population defaults until ptt_calibrate() is given a cuff reading
+#define PTT_DEFAULT_SYSTOLIC        120     // mmHg
+#define PTT_DEFAULT_DIASTOLIC       80
+#define PTT_DEFAULT_PTT_US          260000
+
+// Pressure change per ms of PTT shortening (mmHg, Q8)
+#define PTT_SYSTOLIC_SLOPE_Q8       154     // 0.6 mmHg/ms
+#define PTT_DIASTOLIC_SLOPE_Q8      90      // 0.35 mmHg/ms
+
+#define PTT_SYSTOLIC_MIN            60
+#define PTT_SYSTOLIC_MAX            220
+#define PTT_DIASTOLIC_MIN           30
+#define PTT_DIASTOLIC_MAX           140
+#define PTT_PULSE_PRESSURE_MIN      20
+
+static const nrf_drv_timer_t m_timer = NRF_DRV_TIMER_INSTANCE(2);
+static bool m_initialized = false;
+static uint8_t m_users = 0;                 // One bit per ptt_source_t
+
+// Events of the current cycle, oldest overwritten first
+static uint32_t m_events[PTT_SOURCE_COUNT][PTT_MAX_EVENTS];
+static uint8_t m_event_count[PTT_SOURCE_COUNT];
+
+// Per-user calibration
+static uint16_t m_ref_systolic = PTT_DEFAULT_SYSTOLIC;
+static uint16_t m_ref_diastolic = PTT_DEFAULT_DIASTOLIC;
+static uint32_t m_ref_ptt_us = PTT_DEFAULT_PTT_US;
+
+/**
+ * @brief Compare events only; the CPU never services the timer
+ */
+static void ptt_timer_handler(nrf_timer_event_t event_type, void *p_context) {
+}
+
+/**
+ * @brief Set up the capture timer; safe to call from every driver
+ * @return 0 on success
+ */
+int ptt_init(void) {
+    if (m_initialized) {
+        return 0;
+    }
+    
+    nrf_drv_timer_config_t timer_config = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_config.frequency = NRF_TIMER_FREQ_1MHz;
+    timer_config.mode = NRF_TIMER_MODE_TIMER;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+    if (nrf_drv_timer_init(&m_timer, &timer_config, ptt_timer_handler) != NRF_SUCCESS) {
+        TRACE_ERROR("PTT timer init failed");
+        return -1;
+    }
+    
+    ptt_restart();
+    m_initialized = true;
+    return 0;
+}
+
+/**
+ * @brief Start the time base for a source
+ * @note The first user clears the timer and with it the events on the old
+ *       time base, so only edges from overlapping acquisitions pair up
+ */
+void ptt_acquire(ptt_source_t source) {
+    if (!m_initialized || source >= PTT_SOURCE_COUNT) {
+        return;
+    }
+    if (m_users == 0) {
+        nrf_drv_timer_clear(&m_timer);
+        nrf_drv_timer_enable(&m_timer);
+        ptt_restart();
+    }
+    m_users |= (uint8_t)(1 << source);
+}
+
+/**
+ * @brief Release the time base; it stops with its last user
+ * @note Events and captures stay readable until the next acquisition
+ */
+void ptt_release(ptt_source_t source) {
+    if (!m_initialized || source >= PTT_SOURCE_COUNT || !(m_users & (1 << source))) {
+        return;
+    }
+    m_users &= (uint8_t)~(1 << source);
+    if (m_users == 0) {
+        nrf_drv_timer_disable(&m_timer);
+    }
+}
+
+/**
+ * @brief CAPTURE task for a source's PPI channel
+ */
+uint32_t ptt_capture_task_addr(ptt_source_t source) {
+    return nrf_drv_timer_capture_task_address_get(&m_timer, source);
+}
+
+/**
+ * @brief Time of the source's last edge (us)
+ */
+uint32_t ptt_capture_get(ptt_source_t source) {
+    return nrf_drv_timer_capture_get(&m_timer, (nrf_timer_cc_channel_t)source);
+}
+
+/**
+ * @brief Forget the anchors of a sensor clock
+ */
+void ptt_clock_reset(ptt_clock_t *clock, uint32_t nominal_period_us) {
+    memset(clock, 0, sizeof(*clock));
+    clock->nominal_q8 = nominal_period_us << 8;
+    clock->period_q8 = clock->nominal_q8;
+}
+
+/**
+ * @brief Tie a sample index to the capture of its edge
+ * @note An anchor that disagrees with the nominal period belongs to a
+ *       missed or stale edge and is dropped, unless it keeps happening.
+ */
+void ptt_clock_anchor(ptt_clock_t *clock, uint32_t index, uint32_t time_us) {
+    if (clock->anchored && index != clock->anchor_index) {
+        uint32_t samples = index - clock->anchor_index;
+        uint32_t period_q8 = (uint32_t)(((uint64_t)(time_us - clock->anchor_us) << 8) / samples);
+        uint32_t tolerance = clock->nominal_q8 >> PTT_CLOCK_TOLERANCE_SHIFT;
+        
+        if (period_q8 + tolerance >= clock->nominal_q8 && period_q8 <= clock->nominal_q8 + tolerance) {
+            clock->period_q8 = period_q8;
+            clock->rejects = 0;
+        } else if (++clock->rejects < PTT_CLOCK_REANCHOR) {
+            return;
+        } else {
+            clock->period_q8 = clock->nominal_q8;
+            clock->rejects = 0;
+        }
+    }
+    clock->anchor_us = time_us;
+    clock->anchor_index = index;
+    clock->anchored = true;
+}
+
+/**
+ * @brief Time of a sample (us), extrapolated from the nearest anchor
+ */
+uint32_t ptt_clock_time(ptt_clock_t const *clock, uint32_t index) {
+    int64_t offset = (int64_t)(int32_t)(index - clock->anchor_index) * clock->period_q8;
+    return clock->anchor_us + (uint32_t)(int32_t)(offset / 256);
+}
+
+/**
+ * @brief Drop the events of the previous cycle
+ */
+void ptt_restart(void) {
+    memset(m_event_count, 0, sizeof(m_event_count));
+}
+
+/**
+ * @brief Record an R peak (ECG) or pulse foot (PPG)
+ */
+void ptt_event(ptt_source_t source, uint32_t time_us) {
+    if (source >= PTT_SOURCE_COUNT) {
+        return;
+    }
+    m_events[source][m_event_count[source] % PTT_MAX_EVENTS] = time_us;
+    if (m_event_count[source] < UINT8_MAX) {
+        m_event_count[source]++;
+    }
+}
+
+/**
+ * @brief Median delay from R peak to the following pulse foot
+ * @param ptt_us Pulse transit time (us)
+ * @return 0 if at least PTT_MIN_PAIRS beats paired up, -1 otherwise
+ */
+int ptt_measure(uint32_t *ptt_us) {
+    uint8_t r_count = (m_event_count[PTT_SOURCE_ECG] < PTT_MAX_EVENTS) ? m_event_count[PTT_SOURCE_ECG] : PTT_MAX_EVENTS;
+    uint8_t f_count = (m_event_count[PTT_SOURCE_PPG] < PTT_MAX_EVENTS) ? m_event_count[PTT_SOURCE_PPG] : PTT_MAX_EVENTS;
+    uint32_t delays[PTT_MAX_EVENTS];
+    uint8_t pairs = 0;
+    
+    for (uint8_t f = 0; f < f_count; f++) {
+        // The latest R peak before the foot is the beat it belongs to
+        uint32_t best = UINT32_MAX;
+        for (uint8_t r = 0; r < r_count; r++) {
+            int32_t delay = (int32_t)(m_events[PTT_SOURCE_PPG][f] - m_events[PTT_SOURCE_ECG][r]);
+            if (delay >= 0 && (uint32_t)delay < best) {
+                best = (uint32_t)delay;
+            }
+        }
+        if (best < PTT_MIN_US || best > PTT_MAX_US) {
+            continue;
+        }
+        
+        // Insertion sort, a handful of beats
+        uint8_t i = pairs++;
+        while (i > 0 && delays[i - 1] > best) {
+            delays[i] = delays[i - 1];
+            i--;
+        }
+        delays[i] = best;
+    }
+    
+    if (pairs < PTT_MIN_PAIRS) {
+        TRACE_DEBUG("PTT: %d of %d pulse feet paired", pairs, f_count);
+        return -1;
+    }
+    *ptt_us = (pairs & 1) ? delays[pairs / 2] : (delays[pairs / 2 - 1] + delays[pairs / 2]) / 2;
+    return 0;
+}
+
+static int32_t ptt_clamp(int32_t value, int32_t min, int32_t max) {
+    return (value < min) ? min : (value > max) ? max : value;
+}
+
+/**
+ * @brief Blood pressure from the PTT of the current cycle
+ * @return 0 if a PTT was measured, -1 otherwise
+ */
+int ptt_get_bp(uint16_t *systolic, uint16_t *diastolic) {
+    uint32_t ptt_us;
+    if (ptt_measure(&ptt_us) != 0) {
+        return -1;
+    }
+    
+    // Shorter transit than at the reference means higher pressure
+    int32_t shortening_us = (int32_t)m_ref_ptt_us - (int32_t)ptt_us;
+    int32_t sys = m_ref_systolic + (shortening_us * PTT_SYSTOLIC_SLOPE_Q8) / (1000 << 8);
+    int32_t dia = m_ref_diastolic + (shortening_us * PTT_DIASTOLIC_SLOPE_Q8) / (1000 << 8);
+    
+    sys = ptt_clamp(sys, PTT_SYSTOLIC_MIN, PTT_SYSTOLIC_MAX);
+    dia = ptt_clamp(dia, PTT_DIASTOLIC_MIN, PTT_DIASTOLIC_MAX);
+    if (dia > sys - PTT_PULSE_PRESSURE_MIN) {
+        dia = sys - PTT_PULSE_PRESSURE_MIN;
+    }
+    
+    *systolic = (uint16_t)sys;
+    *diastolic = (uint16_t)dia;
+    TRACE_INFO("PTT %d us: BP %d/%d mmHg", ptt_us, sys, dia);
+    return 0;
+}
+
+/**
+ * @brief Take a cuff reading as the user's reference for the current PTT
+ * @return 0 if the cycle had a PTT to calibrate against
+ */
+int ptt_calibrate(uint16_t systolic, uint16_t diastolic) {
+    uint32_t ptt_us;
+    if (ptt_measure(&ptt_us) != 0) {
+        return -1;
+    }
+    m_ref_systolic = systolic;
+    m_ref_diastolic = diastolic;
+    m_ref_ptt_us = ptt_us;
+    TRACE_INFO("PTT calibrated: %d/%d mmHg at %d us", systolic, diastolic, ptt_us);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef PTT_H
+#define PTT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PTT_MAX_EVENTS          8       // R peaks and pulse feet kept per cycle
+#define PTT_MIN_PAIRS           2       // Beats needed for a PTT
+#define PTT_MIN_US              80000   // R peak to pulse foot, shorter is no pair
+#define PTT_MAX_US              450000
+
+// Event sources, one TIMER capture channel each
+typedef enum {
+    PTT_SOURCE_ECG,             // ADS1292R DRDY, R peaks
+    PTT_SOURCE_PPG,             // MAX30102 INT, pulse feet
+    PTT_SOURCE_COUNT
+} ptt_source_t;
+
+// Sample index to time mapping of one sensor, anchored on captured edges
+typedef struct {
+    uint32_t anchor_us;         // Capture time of the anchor sample
+    uint32_t anchor_index;      // Its sample index
+    uint32_t period_q8;         // Measured sample period (us, Q8)
+    uint32_t nominal_q8;        // Data sheet sample period (us, Q8)
+    uint8_t  rejects;           // Anchors dropped in a row
+    bool     anchored;
+} ptt_clock_t;
+
+int ptt_init(void);
+void ptt_acquire(ptt_source_t source);
+void ptt_release(ptt_source_t source);
+uint32_t ptt_capture_task_addr(ptt_source_t source);
+uint32_t ptt_capture_get(ptt_source_t source);
+
+void ptt_clock_reset(ptt_clock_t *clock, uint32_t nominal_period_us);
+void ptt_clock_anchor(ptt_clock_t *clock, uint32_t index, uint32_t time_us);
+uint32_t ptt_clock_time(ptt_clock_t const *clock, uint32_t index);
+
+void ptt_restart(void);
+void ptt_event(ptt_source_t source, uint32_t time_us);
+int ptt_measure(uint32_t *ptt_us);
+int ptt_get_bp(uint16_t *systolic, uint16_t *diastolic);
+int ptt_calibrate(uint16_t systolic, uint16_t diastolic);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,287 @@
+/**
+ * @file qrs_detector.c
+ * @brief Streaming Pan-Tompkins QRS detector
+ * @description Integer-only, O(1) per sample. Filter lengths are scaled from
+ *              the original 200 Hz design to the ADS1292R's 500 SPS.
+ */
+
+#include "qrs_detector.h"
+#include <string.h>
+
+// Filter stage lengths (samples at 500 SPS)
+#define QRS_LP_DELAY            15      // Low-pass zero spacing, notch at 33 Hz
+#define QRS_HP_WINDOW           64      // High-pass moving average, ~3.5 Hz cutoff
+#define QRS_DERIV_SPACING       2
+#define QRS_MWI_WINDOW          64      // ~128 ms integration window
+#define QRS_INPUT_SHIFT         4       // Keep LP intermediate in 32 bits for 24-bit input
+#define QRS_LP_GAIN_SHIFT       7       // LP DC gain is 15^2 = 225
+#define QRS_DERIV_CLAMP         4095    // Square stays below 2^24, MWI sum below 2^30
+
+// Ring buffer sizes (powers of two)
+#define QRS_LP_RING             32
+#define QRS_HP_RING             QRS_HP_WINDOW
+#define QRS_DERIV_RING          16
+#define QRS_MWI_RING            QRS_MWI_WINDOW
+
+// Detection timing
+#define QRS_SETTLE_SAMPLES      200     // Filter transients after restart
+#define QRS_LEARN_SAMPLES       500     // Threshold learning on first use
+#define QRS_REFRACTORY_SAMPLES  100     // 200 ms
+#define QRS_DETECTION_DELAY     70      // MWI peak to R-peak, filter group delays
+
+// Filter state
+static int32_t  m_lp_x[QRS_LP_RING];
+static int32_t  m_lp_y1;
+static int32_t  m_lp_y2;
+static int32_t  m_hp_x[QRS_HP_RING];
+static int32_t  m_hp_sum;
+static int32_t  m_deriv_x[QRS_DERIV_RING];
+static uint32_t m_mwi_x[QRS_MWI_RING];
+static uint32_t m_mwi_sum;
+static uint32_t m_n;
+
+// Peak tracking
+static uint32_t m_peak_value;
+static uint32_t m_peak_n;
+static uint32_t m_candidate_value;      // Largest noise peak since last beat (search-back)
+static uint32_t m_candidate_n;
+
+// Adaptive thresholds, kept across restarts once learned
+static bool     m_learned = false;
+static uint32_t m_learn_max;
+static uint32_t m_spki;
+static uint32_t m_npki;
+static uint32_t m_threshold1;
+
+// Beats seen since restart
+static uint8_t  m_beat_count;
+static uint32_t m_last_beat_n;
+static uint16_t m_rr[QRS_MAX_RR];
+static uint8_t  m_rr_count;
+static uint32_t m_rr_sum;
+
+/**
+ * @brief Recompute THRESHOLD I from signal and noise peak levels
+ */
+static void qrs_update_threshold(void) {
+    m_threshold1 = m_npki + ((m_spki - m_npki) >> 2);
+}
+
+/**
+ * @brief Record a detected beat at MWI peak position peak_n
+ */
+static void qrs_accept_beat(uint32_t peak_n, qrs_beat_t *beat) {
+    uint16_t rr = 0;
+
+    if (m_beat_count > 0) {
+        uint32_t interval = peak_n - m_last_beat_n;
+        rr = (interval > UINT16_MAX) ? UINT16_MAX : (uint16_t)interval;
+
+        if (m_rr_count < QRS_MAX_RR) {
+            m_rr[m_rr_count++] = rr;
+            m_rr_sum += rr;
+        }
+    }
+
+    if (m_beat_count < UINT8_MAX) {
+        m_beat_count++;
+    }
+    m_last_beat_n = peak_n;
+    m_candidate_value = 0;
+
+    beat->r_peak_sample = (peak_n > QRS_DETECTION_DELAY) ? peak_n - QRS_DETECTION_DELAY : 0;
+    beat->rr_interval = rr;
+}
+
+/**
+ * @brief Classify a completed MWI peak as signal or noise
+ */
+static bool qrs_classify_peak(uint32_t value, uint32_t peak_n, qrs_beat_t *beat) {
+    if (peak_n < QRS_SETTLE_SAMPLES) {
+        return false;
+    }
+
+    if (!m_learned) {
+        if (value > m_learn_max) {
+            m_learn_max = value;
+        }
+        if (peak_n >= QRS_SETTLE_SAMPLES + QRS_LEARN_SAMPLES && m_learn_max > 0) {
+            m_spki = m_learn_max >> 1;
+            m_npki = m_learn_max >> 3;
+            qrs_update_threshold();
+            m_learned = true;
+        }
+        return false;
+    }
+
+    if (m_beat_count > 0 && (peak_n - m_last_beat_n) < QRS_REFRACTORY_SAMPLES) {
+        return false;
+    }
+
+    if (value > m_threshold1) {
+        m_spki = (value + 7 * m_spki) >> 3;
+        qrs_update_threshold();
+        qrs_accept_beat(peak_n, beat);
+        return true;
+    }
+
+    m_npki = (value + 7 * m_npki) >> 3;
+    qrs_update_threshold();
+
+    if (value > m_candidate_value) {
+        m_candidate_value = value;
+        m_candidate_n = peak_n;
+    }
+    return false;
+}
+
+/**
+ * @brief Search back for a missed beat once RR exceeds 166% of average
+ */
+static bool qrs_search_back(qrs_beat_t *beat) {
+    if (m_rr_count == 0 || m_candidate_value == 0) {
+        return false;
+    }
+
+    uint32_t rr_avg = m_rr_sum / m_rr_count;
+    if ((m_n - m_last_beat_n) * 3 < rr_avg * 5) {
+        return false;
+    }
+
+    if (m_candidate_value > (m_threshold1 >> 1)) {
+        m_spki = (m_candidate_value + 3 * m_spki) >> 2;
+        qrs_update_threshold();
+        qrs_accept_beat(m_candidate_n, beat);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Initialize detector, discarding learned thresholds
+ */
+void qrs_detector_init(void) {
+    m_learned = false;
+    m_spki = 0;
+    m_npki = 0;
+    m_threshold1 = 0;
+    qrs_detector_restart();
+}
+
+/**
+ * @brief Restart filters and beat history for a new capture window
+ */
+void qrs_detector_restart(void) {
+    memset(m_lp_x, 0, sizeof(m_lp_x));
+    memset(m_hp_x, 0, sizeof(m_hp_x));
+    memset(m_deriv_x, 0, sizeof(m_deriv_x));
+    memset(m_mwi_x, 0, sizeof(m_mwi_x));
+    m_lp_y1 = 0;
+    m_lp_y2 = 0;
+    m_hp_sum = 0;
+    m_mwi_sum = 0;
+    m_n = 0;
+
+    m_peak_value = 0;
+    m_peak_n = 0;
+    m_candidate_value = 0;
+    m_candidate_n = 0;
+    m_learn_max = 0;
+
+    m_beat_count = 0;
+    m_last_beat_n = 0;
+    m_rr_count = 0;
+    m_rr_sum = 0;
+}
+
+/**
+ * @brief Feed one ECG sample
+ * @param sample Raw 24-bit ECG sample
+ * @param beat Filled in when a beat is detected
+ * @return true if a beat was detected on this sample
+ */
+bool qrs_detector_process(int32_t sample, qrs_beat_t *beat) {
+    uint32_t n = m_n;
+    int32_t x = sample >> QRS_INPUT_SHIFT;
+
+    // Low-pass: y[n] = 2y[n-1] - y[n-2] + x[n] - 2x[n-15] + x[n-30]
+    int32_t lp_x15 = m_lp_x[(n - QRS_LP_DELAY) & (QRS_LP_RING - 1)];
+    int32_t lp_x30 = m_lp_x[(n - 2 * QRS_LP_DELAY) & (QRS_LP_RING - 1)];
+    m_lp_x[n & (QRS_LP_RING - 1)] = x;
+    int32_t lp_y = 2 * m_lp_y1 - m_lp_y2 + x - 2 * lp_x15 + lp_x30;
+    m_lp_y2 = m_lp_y1;
+    m_lp_y1 = lp_y;
+    int32_t lp = lp_y >> QRS_LP_GAIN_SHIFT;
+
+    // High-pass: delayed input minus moving average
+    uint32_t hp_idx = n & (QRS_HP_RING - 1);
+    m_hp_sum += lp - m_hp_x[hp_idx];
+    m_hp_x[hp_idx] = lp;
+    int32_t hp = m_hp_x[(n - QRS_HP_WINDOW / 2) & (QRS_HP_RING - 1)] - (m_hp_sum >> 6);
+
+    // Five-point derivative
+    m_deriv_x[n & (QRS_DERIV_RING - 1)] = hp;
+    int32_t d = (2 * hp
+                 + m_deriv_x[(n - 1 * QRS_DERIV_SPACING) & (QRS_DERIV_RING - 1)]
+                 - m_deriv_x[(n - 3 * QRS_DERIV_SPACING) & (QRS_DERIV_RING - 1)]
+                 - 2 * m_deriv_x[(n - 4 * QRS_DERIV_SPACING) & (QRS_DERIV_RING - 1)]) >> 3;
+
+    // Squaring, saturated so the integrator cannot overflow
+    if (d < 0) d = -d;
+    if (d > QRS_DERIV_CLAMP) d = QRS_DERIV_CLAMP;
+    uint32_t sq = (uint32_t)(d * d);
+
+    // Moving-window integration
+    uint32_t mwi_idx = n & (QRS_MWI_RING - 1);
+    m_mwi_sum += sq - m_mwi_x[mwi_idx];
+    m_mwi_x[mwi_idx] = sq;
+    uint32_t mwi = m_mwi_sum >> 6;
+
+    m_n++;
+
+    // Peak is complete once the integrator falls to half its maximum
+    bool detected = false;
+    if (mwi > m_peak_value) {
+        m_peak_value = mwi;
+        m_peak_n = n;
+    } else if (m_peak_value > 0 && mwi < (m_peak_value >> 1)) {
+        detected = qrs_classify_peak(m_peak_value, m_peak_n, beat);
+        m_peak_value = 0;
+    }
+
+    if (!detected && m_learned) {
+        detected = qrs_search_back(beat);
+    }
+
+    return detected;
+}
+
+/**
+ * @brief Number of beats detected since restart
+ */
+uint8_t qrs_detector_beat_count(void) {
+    return m_beat_count;
+}
+
+/**
+ * @brief Copy RR intervals (in samples) detected since restart
+ * @return Number of intervals copied
+ */
+uint8_t qrs_detector_get_rr(uint16_t *rr_intervals, uint8_t max_count) {
+    uint8_t count = (m_rr_count < max_count) ? m_rr_count : max_count;
+    memcpy(rr_intervals, m_rr, count * sizeof(uint16_t));
+    return count;
+}
+
+/**
+ * @brief Heart rate from mean RR interval
+ * @return BPM, or 0 if no RR interval has been measured
+ */
+uint16_t qrs_detector_heart_rate(void) {
+    if (m_rr_count == 0) {
+        return 0;
+    }
+
+    uint32_t rr_avg = m_rr_sum / m_rr_count;
+    return (uint16_t)((60 * QRS_SAMPLE_RATE_HZ + rr_avg / 2) / rr_avg);
+}
\ No newline at end of file
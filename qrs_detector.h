@@ -0,0 +1,22 @@
+#ifndef QRS_DETECTOR_H
+#define QRS_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define QRS_SAMPLE_RATE_HZ  500
+#define QRS_MAX_RR          8
+
+typedef struct {
+    uint32_t r_peak_sample;     // R-peak position, samples since qrs_detector_restart()
+    uint16_t rr_interval;       // Samples since previous R-peak (0 for first beat)
+} qrs_beat_t;
+
+void qrs_detector_init(void);
+void qrs_detector_restart(void);
+bool qrs_detector_process(int32_t sample, qrs_beat_t *beat);
+uint8_t qrs_detector_beat_count(void);
+uint8_t qrs_detector_get_rr(uint16_t *rr_intervals, uint8_t max_count);
+uint16_t qrs_detector_heart_rate(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,359 @@
+/**
+ * @file telemetry.c
+ * @brief Batched, delta-encoded telemetry frames
+ * @description Readings accumulate in a batch and go out as one frame:
+ *
+ *   Offset Size  Field
+ *   0      1     Sync (0xA5)
+ *   1      1     Version
+ *   2      4     Device ID (FICR DEVICEID[0], little-endian)
+ *   6      2     Sequence number of record 0 (little-endian); the
+ *                others follow consecutively
+ *   8      1     Record count N
+ *   9      1     Health status of record 0, bit 6 set if an HRV
+ *                record is present, bit 7 if a stats record is
+ *   10     17    Record 0 (vital_record_t, little-endian)
+ *   27     ...   Bitstream, LSB first, present when N > 1:
+ *                  9 x 5-bit field widths, then per record 1..N-1:
+ *                  2-bit status, 8-bit flags, then each field delta
+ *                  against record 0 in its width (zigzag for signed)
+ *   ...    6     HRV record (hrv_features_t), if flagged
+ *   ...    28    Stats record (profiler_stats_t), if flagged
+ *   end    2     CRC16-CCITT over all preceding bytes (little-endian)
+ *
+ *   Field order: timestamp (125 ms units), temperature, accel X/Y/Z,
+ *   SpO2, heart rate, systolic, diastolic. The high nibble of the record
+ *   flags holds the VITAL_STALE_* bits: those fields repeat an earlier
+ *   reading and must not be counted again.
+ *
+ *   Alerts are single-record frames kept encoded outside the batch, so an
+ *   event only patches the sequence number, the flags and the CRC.
+ */
+
+#include "telemetry.h"
+#include "crc16.h"
+#include "app_timer.h"
+#include "nrf.h"
+#include <string.h>
+
+#define TELEMETRY_FIELDS            9
+#define TELEMETRY_WIDTH_BITS        5
+#define TELEMETRY_STATUS_BITS       2
+#define TELEMETRY_FLAGS_BITS        8
+#define TELEMETRY_TS_MASK           0x00FFFFFF  // app_timer counter is 24-bit
+#define TELEMETRY_TS_SHIFT          12          // RTC ticks -> 125 ms units
+#define TELEMETRY_MAX_SPAN_TICKS    (400UL * APP_TIMER_CLOCK_FREQ)  // Stay clear of the counter wrap
+
+// The gateway decodes timestamps in 125 ms units; a prescaler change has to
+// change the shift with it
+_Static_assert((1UL << TELEMETRY_TS_SHIFT) * 8 == APP_TIMER_CLOCK_FREQ,
+               "TELEMETRY_TS_SHIFT must give 125 ms units at APP_TIMER_CLOCK_FREQ");
+
+static vital_record_t m_batch[TELEMETRY_BATCH_RECORDS];
+static uint8_t m_batch_status[TELEMETRY_BATCH_RECORDS];
+static uint8_t m_batch_count = 0;
+static uint32_t m_device_id = 0;
+static profiler_stats_t m_stats;
+static bool m_stats_attached = false;
+static hrv_features_t m_hrv;
+static bool m_hrv_attached = false;
+
+// Bit writer over the frame buffer
+typedef struct {
+    uint8_t  *p_buf;
+    uint16_t size;
+    uint32_t bit_pos;
+    bool     overflow;
+} bit_writer_t;
+
+/**
+ * @brief Append the low `bits` bits of value, LSB first
+ */
+static void bits_put(bit_writer_t *w, uint32_t value, uint8_t bits) {
+    for (uint8_t i = 0; i < bits; i++) {
+        uint32_t byte = w->bit_pos >> 3;
+        if (byte >= w->size) {
+            w->overflow = true;
+            return;
+        }
+        if ((w->bit_pos & 7) == 0) {
+            w->p_buf[byte] = 0;
+        }
+        if (value & (1UL << i)) {
+            w->p_buf[byte] |= (uint8_t)(1 << (w->bit_pos & 7));
+        }
+        w->bit_pos++;
+    }
+}
+
+/**
+ * @brief Map a signed delta onto an unsigned code (0, -1, 1, -2, ...)
+ */
+static uint32_t zigzag(int32_t delta) {
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+/**
+ * @brief Number of bits needed to hold value
+ */
+static uint8_t bit_width(uint32_t value) {
+    uint8_t width = 0;
+    while (value) {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+/**
+ * @brief Timestamp offset from record 0 in 125 ms units
+ */
+static uint32_t telemetry_ts_delta(uint32_t timestamp) {
+    return ((timestamp - m_batch[0].timestamp) & TELEMETRY_TS_MASK) >> TELEMETRY_TS_SHIFT;
+}
+
+/**
+ * @brief Field codes of record k relative to record 0
+ */
+static void telemetry_field_codes(uint8_t k, uint32_t codes[TELEMETRY_FIELDS]) {
+    vital_record_t const *r0 = &m_batch[0];
+    vital_record_t const *r = &m_batch[k];
+
+    codes[0] = telemetry_ts_delta(r->timestamp);
+    codes[1] = zigzag((int32_t)r->temp_raw - r0->temp_raw);
+    codes[2] = zigzag((int32_t)r->accel_raw[0] - r0->accel_raw[0]);
+    codes[3] = zigzag((int32_t)r->accel_raw[1] - r0->accel_raw[1]);
+    codes[4] = zigzag((int32_t)r->accel_raw[2] - r0->accel_raw[2]);
+    codes[5] = zigzag((int32_t)r->spo2 - r0->spo2);
+    codes[6] = zigzag((int32_t)r->heart_rate - r0->heart_rate);
+    codes[7] = zigzag((int32_t)r->bp_systolic - r0->bp_systolic);
+    codes[8] = zigzag((int32_t)r->bp_diastolic - r0->bp_diastolic);
+}
+
+/**
+ * @brief Initialize the batch and read the device ID
+ */
+void telemetry_init(void) {
+    m_batch_count = 0;
+    m_stats_attached = false;
+    m_hrv_attached = false;
+    m_device_id = NRF_FICR->DEVICEID[0];
+}
+
+/**
+ * @brief Add a reading to the current batch
+ * @param status Health status at the time of the reading
+ * @return false if the batch is full or the reading is too far from the
+ *         first record; encode the batch and add again
+ */
+bool telemetry_add(vital_signs_t const *vitals, uint8_t status) {
+    if (m_batch_count >= TELEMETRY_BATCH_RECORDS) {
+        return false;
+    }
+    if (m_batch_count > 0 &&
+        ((vitals->timestamp - m_batch[0].timestamp) & TELEMETRY_TS_MASK) > TELEMETRY_MAX_SPAN_TICKS) {
+        return false;
+    }
+
+    vitals_pack(vitals, &m_batch[m_batch_count]);
+    m_batch_status[m_batch_count] = status;
+    m_batch_count++;
+    return true;
+}
+
+/**
+ * @brief Number of readings waiting in the batch
+ */
+uint8_t telemetry_count(void) {
+    return m_batch_count;
+}
+
+/**
+ * @brief Batch has reached its configured size
+ */
+bool telemetry_full(void) {
+    return m_batch_count >= TELEMETRY_BATCH_RECORDS;
+}
+
+/**
+ * @brief Send a stats record with the next frame
+ */
+void telemetry_attach_stats(profiler_stats_t const *stats) {
+    m_stats = *stats;
+    m_stats_attached = true;
+}
+
+/**
+ * @brief Send an HRV record with the next frame
+ */
+void telemetry_attach_hrv(hrv_features_t const *features) {
+    m_hrv = *features;
+    m_hrv_attached = true;
+}
+
+/**
+ * @brief Narrowest width per field that fits records 1..count-1
+ * @return Bitstream length in bits, 0 for a single record
+ */
+static uint32_t telemetry_widths(uint8_t count, uint8_t widths[TELEMETRY_FIELDS]) {
+    uint32_t codes[TELEMETRY_FIELDS];
+
+    memset(widths, 0, TELEMETRY_FIELDS);
+    if (count < 2) {
+        return 0;
+    }
+    for (uint8_t k = 1; k < count; k++) {
+        telemetry_field_codes(k, codes);
+        for (uint8_t f = 0; f < TELEMETRY_FIELDS; f++) {
+            uint8_t width = bit_width(codes[f]);
+            if (width > widths[f]) {
+                widths[f] = width;
+            }
+        }
+    }
+
+    uint32_t bits = TELEMETRY_FIELDS * TELEMETRY_WIDTH_BITS;
+    for (uint8_t f = 0; f < TELEMETRY_FIELDS; f++) {
+        bits += (uint32_t)(count - 1) * widths[f];
+    }
+    return bits + (uint32_t)(count - 1) * (TELEMETRY_STATUS_BITS + TELEMETRY_FLAGS_BITS);
+}
+
+/**
+ * @brief Encode the batch into a frame and start a new batch
+ * @param frame Output buffer, TELEMETRY_MAX_FRAME_SIZE bytes is always enough
+ * @param sequence Sequence number of the first record
+ * @param p_records Set to the records in the frame, may be NULL
+ * @return Frame length, or 0 if the batch is empty or the buffer cannot
+ *         hold a single record
+ * @note The batch is emptied either way. When the buffer is too small for
+ *       all of it, the frame carries the longest prefix that fits and the
+ *       records after it are dropped; callers resend them from the vitals
+ *       log. HRV and stats records that do not fit stay attached for the
+ *       next frame.
+ */
+uint16_t telemetry_encode(uint8_t *frame, uint16_t size, uint16_t sequence, uint8_t *p_records) {
+    uint32_t codes[TELEMETRY_FIELDS];
+    uint8_t widths[TELEMETRY_FIELDS];
+    uint16_t pos = 0;
+    uint8_t count = m_batch_count;
+
+    if (p_records) {
+        *p_records = 0;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (size < TELEMETRY_ALERT_SIZE) {
+        m_batch_count = 0;
+        return 0;
+    }
+
+    uint16_t room = size - TELEMETRY_ALERT_SIZE;
+    uint32_t bits = telemetry_widths(count, widths);
+    while (count > 1 && ((bits + 7) >> 3) > room) {
+        bits = telemetry_widths(--count, widths);
+    }
+    room -= (uint16_t)((bits + 7) >> 3);
+
+    bool hrv = m_hrv_attached && sizeof(hrv_features_t) <= room;
+    if (hrv) {
+        room -= sizeof(hrv_features_t);
+    }
+    bool stats = m_stats_attached && sizeof(profiler_stats_t) <= room;
+
+    frame[pos++] = TELEMETRY_SYNC;
+    frame[pos++] = TELEMETRY_VERSION;
+    frame[pos++] = m_device_id & 0xFF;
+    frame[pos++] = (m_device_id >> 8) & 0xFF;
+    frame[pos++] = (m_device_id >> 16) & 0xFF;
+    frame[pos++] = (m_device_id >> 24) & 0xFF;
+    frame[pos++] = sequence & 0xFF;
+    frame[pos++] = (sequence >> 8) & 0xFF;
+    frame[pos++] = count;
+    frame[pos++] = m_batch_status[0] | (hrv ? TELEMETRY_STATUS_HRV : 0) |
+                   (stats ? TELEMETRY_STATUS_STATS : 0);
+    memcpy(&frame[pos], &m_batch[0], sizeof(vital_record_t));
+    pos += sizeof(vital_record_t);
+
+    if (count > 1) {
+        bit_writer_t w = {
+            .p_buf    = &frame[pos],
+            .size     = size - pos - 2,
+            .bit_pos  = 0,
+            .overflow = false
+        };
+
+        for (uint8_t f = 0; f < TELEMETRY_FIELDS; f++) {
+            bits_put(&w, widths[f], TELEMETRY_WIDTH_BITS);
+        }
+
+        for (uint8_t k = 1; k < count; k++) {
+            telemetry_field_codes(k, codes);
+            bits_put(&w, m_batch_status[k], TELEMETRY_STATUS_BITS);
+            bits_put(&w, m_batch[k].flags, TELEMETRY_FLAGS_BITS);
+            for (uint8_t f = 0; f < TELEMETRY_FIELDS; f++) {
+                bits_put(&w, codes[f], widths[f]);
+            }
+        }
+        pos += (w.bit_pos + 7) >> 3;
+    }
+
+    if (hrv) {
+        memcpy(&frame[pos], &m_hrv, sizeof(hrv_features_t));
+        pos += sizeof(hrv_features_t);
+        m_hrv_attached = false;
+    }
+
+    if (stats) {
+        memcpy(&frame[pos], &m_stats, sizeof(profiler_stats_t));
+        pos += sizeof(profiler_stats_t);
+        m_stats_attached = false;
+    }
+
+    uint16_t crc = crc16_compute(frame, pos, NULL);
+    frame[pos++] = crc & 0xFF;
+    frame[pos++] = (crc >> 8) & 0xFF;
+
+    m_batch_count = 0;
+    if (p_records) {
+        *p_records = count;
+    }
+    return pos;
+}
+
+/**
+ * @brief Encode a single-record alert frame, independent of the batch
+ * @param frame TELEMETRY_ALERT_SIZE bytes, kept by the caller until the event
+ * @param status Health status the alert reports
+ */
+void telemetry_alert_prepare(uint8_t *frame, vital_signs_t const *vitals, uint8_t status) {
+    frame[0] = TELEMETRY_SYNC;
+    frame[1] = TELEMETRY_VERSION;
+    frame[2] = m_device_id & 0xFF;
+    frame[3] = (m_device_id >> 8) & 0xFF;
+    frame[4] = (m_device_id >> 16) & 0xFF;
+    frame[5] = (m_device_id >> 24) & 0xFF;
+    frame[8] = 1;
+    frame[9] = status;
+    vitals_pack(vitals, (vital_record_t *)&frame[TELEMETRY_HEADER_SIZE]);
+    telemetry_alert_finish(frame, 0, 0);
+}
+
+/**
+ * @brief Stamp a prepared alert frame for sending
+ * @param sequence Sequence number the reading is stored under
+ * @param flags VITAL_FLAG_* bits to set on top of the prepared reading
+ */
+void telemetry_alert_finish(uint8_t *frame, uint16_t sequence, uint8_t flags) {
+    vital_record_t *record = (vital_record_t *)&frame[TELEMETRY_HEADER_SIZE];
+    uint16_t pos = TELEMETRY_HEADER_SIZE + sizeof(vital_record_t);
+
+    frame[6] = sequence & 0xFF;
+    frame[7] = (sequence >> 8) & 0xFF;
+    record->flags |= flags;
+
+    uint16_t crc = crc16_compute(frame, pos, NULL);
+    frame[pos++] = crc & 0xFF;
+    frame[pos] = (crc >> 8) & 0xFF;
+}
@@ -0,0 +1,29 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vitals.h"
+#include "profiler.h"
+#include "hrv.h"
+
+#define TELEMETRY_SYNC              0xA5
+#define TELEMETRY_VERSION           3
+#define TELEMETRY_BATCH_RECORDS     8       // 8 x 35 s = one frame every ~5 min
+#define TELEMETRY_HEADER_SIZE       10
+#define TELEMETRY_MAX_FRAME_SIZE    192     // Worst case for a full batch with HRV and stats
+#define TELEMETRY_STATUS_HRV        0x40    // Header status flag: HRV record present
+#define TELEMETRY_STATUS_STATS      0x80    // Header status flag: stats record present
+#define TELEMETRY_ALERT_SIZE        (TELEMETRY_HEADER_SIZE + sizeof(vital_record_t) + 2)
+
+void telemetry_init(void);
+bool telemetry_add(vital_signs_t const *vitals, uint8_t status);
+uint8_t telemetry_count(void);
+bool telemetry_full(void);
+void telemetry_attach_stats(profiler_stats_t const *stats);
+void telemetry_attach_hrv(hrv_features_t const *features);
+uint16_t telemetry_encode(uint8_t *frame, uint16_t size, uint16_t sequence, uint8_t *p_records);
+void telemetry_alert_prepare(uint8_t *frame, vital_signs_t const *vitals, uint8_t status);
+void telemetry_alert_finish(uint8_t *frame, uint16_t sequence, uint8_t flags);
+
+#endif
\ No newline at end of file
@@ -2,15 +2,25 @@
  * @file tmp117_driver.c
  * @brief TMP117 High-Accuracy Temperature Sensor Driver
  * @description ±0.1°C accurate digital temperature sensor with I2C interface
+ *
+ *              Readings are averaged one-shot conversions completed by the
+ *              ALERT pin in data-ready mode. Between measurement cycles the
+ *              sensor either shuts down or, with alert limits armed, keeps
+ *              converting on a long cycle with ALERT in alert mode so an
+ *              out-of-range temperature wakes the system.
  */
 
 #include "tmp117_driver.h"
-#include "nrf_drv_twi.h"
-#include "nrf_delay.h"
+#include "twi_bus.h"
+#include "app_timer.h"
+#include "nrf_drv_gpiote.h"
 #include "nrf_log.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_SENSORS
+#include "trace.h"
 
 // TMP117 I2C Address (default)
 #define TMP117_I2C_ADDR         0x48
+#define TMP117_ALERT_PIN        29    // Active-low open-drain ALERT (adjust to your circuit)
 
 // TMP117 Register Addresses
 #define TMP117_REG_TEMP         0x00  // Temperature result
@@ -33,14 +43,109 @@
 #define TMP117_CFG_MOD_CC       (0 << 10)  // Continuous conversion
 #define TMP117_CFG_MOD_SD       (1 << 10)  // Shutdown
 #define TMP117_CFG_MOD_OS       (3 << 10)  // One-shot
+#define TMP117_CFG_CONV_POS     7          // Standby cycle in CC mode
+#define TMP117_CFG_AVG_POS      5
+#define TMP117_CFG_TNA          (1 << 4)   // Therm mode (0 = alert mode)
+#define TMP117_CFG_POL          (1 << 3)   // ALERT active high (0 = active low)
+#define TMP117_CFG_DR_ALERT     (1 << 2)   // ALERT reflects Data_Ready
 
 #define TMP117_RESOLUTION       0.0078125  // °C per LSB
 
-static const nrf_drv_twi_t m_twi = NRF_DRV_TWI_INSTANCE(0);
 static bool m_initialized = false;
+static tmp117_avg_t m_avg = TMP117_AVG_8;
+static tmp117_cycle_t m_monitor_cycle = TMP117_CYCLE_16S;
+
+// One-shot conversion time per AVG setting; the ALERT pin normally ends the
+// wait, the timer only catches a missed edge
+static const uint16_t m_conversion_ms[] = {16, 125, 500, 1000};
+
+// Alert limits, monitored between measurement cycles when armed
+static tmp117_alert_handler_t m_alert_handler = NULL;
+static bool m_monitor_armed = false;
+static bool m_monitoring = false;       // Sensor in long-cycle CC mode
+static bool m_alert_read = false;       // Alert result read in flight
+
+// Non-blocking one-shot conversion state
+APP_TIMER_DEF(m_conversion_timer);
+static tmp117_ready_handler_t m_ready_handler = NULL;
+static bool m_ready_pending = false;
+static tmp117_done_handler_t m_done_handler = NULL;
+static volatile bool m_conversion_due = false;
+static volatile bool m_alert_pending = false;
+static bool m_read_active = false;
+static int m_result = -1;
+static int16_t m_temp_raw = TMP117_RAW_FROM_CDEG(3650);
+
+// Queued bus transactions: the one-shot trigger, then CFGR and TEMP in one go
+static volatile bool m_bus_done = false;
+static volatile ret_code_t m_bus_result = NRF_SUCCESS;
+static bool m_result_pending = false;   // Result read in flight
+
+static uint8_t m_trigger_buf[3] = {TMP117_REG_CFGR, 0, 0};
+static uint8_t m_reg_cfgr = TMP117_REG_CFGR;
+static uint8_t m_reg_temp = TMP117_REG_TEMP;
+static uint8_t m_flags_buf[2];
+static uint8_t m_cfgr_buf[2];
+static uint8_t m_temp_buf[2];
+
+// Flags left over from alert monitoring are cleared before the trigger, so
+// ALERT only falls once the one-shot result is ready
+static nrf_twi_mngr_transfer_t const m_trigger_transfers[] = {
+    NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, &m_reg_cfgr, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(TMP117_I2C_ADDR, m_flags_buf, sizeof(m_flags_buf), 0),
+    NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, m_trigger_buf, sizeof(m_trigger_buf), 0)
+};
+
+// Reading CFGR first clears Data_Ready and the alert flags
+static nrf_twi_mngr_transfer_t const m_result_transfers[] = {
+    NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, &m_reg_cfgr, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(TMP117_I2C_ADDR, m_cfgr_buf, sizeof(m_cfgr_buf), 0),
+    NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, &m_reg_temp, 1, NRF_TWI_MNGR_NO_STOP),
+    NRF_TWI_MNGR_READ(TMP117_I2C_ADDR, m_temp_buf, sizeof(m_temp_buf), 0)
+};
+
+static void tmp117_bus_callback(ret_code_t result, void *p_user_data);
+
+static const nrf_twi_mngr_transaction_t m_trigger_transaction = {
+    .callback            = tmp117_bus_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_trigger_transfers,
+    .number_of_transfers = sizeof(m_trigger_transfers) / sizeof(m_trigger_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+static const nrf_twi_mngr_transaction_t m_result_transaction = {
+    .callback            = tmp117_bus_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_result_transfers,
+    .number_of_transfers = sizeof(m_result_transfers) / sizeof(m_result_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
+
+// CFGR write of tmp117_sleep(), queued as well; alert monitoring starts
+// from tmp117_process() once it has gone out
+static volatile bool m_sleep_done = false;
+static volatile ret_code_t m_sleep_result = NRF_SUCCESS;
+static bool m_sleep_pending = false;    // Sleep write in flight
+static bool m_sleep_monitor = false;    // Sleep write starts alert monitoring
+static uint8_t m_sleep_buf[3] = {TMP117_REG_CFGR, 0, 0};
+
+static nrf_twi_mngr_transfer_t const m_sleep_transfers[] = {
+    NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, m_sleep_buf, sizeof(m_sleep_buf), 0)
+};
+
+static void tmp117_sleep_callback(ret_code_t result, void *p_user_data);
+
+static const nrf_twi_mngr_transaction_t m_sleep_transaction = {
+    .callback            = tmp117_sleep_callback,
+    .p_user_data         = NULL,
+    .p_transfers         = m_sleep_transfers,
+    .number_of_transfers = sizeof(m_sleep_transfers) / sizeof(m_sleep_transfers[0]),
+    .p_required_twi_cfg  = NULL
+};
 
 /**
- * @brief Write register (16-bit)
+ * @brief Write register (16-bit, blocking, init only)
  */
 static ret_code_t tmp117_write_register(uint8_t reg, uint16_t value) {
     uint8_t data[3];
@@ -48,26 +153,78 @@ static ret_code_t tmp117_write_register(uint8_t reg, uint16_t value) {
     data[1] = (value >> 8) & 0xFF;  // MSB
     data[2] = value & 0xFF;         // LSB
     
-    return nrf_drv_twi_tx(&m_twi, TMP117_I2C_ADDR, data, 3, false);
+    nrf_twi_mngr_transfer_t const transfers[] = {
+        NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, data, sizeof(data), 0)
+    };
+    return twi_bus_perform(transfers, 1);
 }
 
 /**
- * @brief Read register (16-bit)
+ * @brief Read register (16-bit, blocking)
  */
 static ret_code_t tmp117_read_register(uint8_t reg, uint16_t *value) {
     ret_code_t err_code;
     uint8_t data[2];
     
-    err_code = nrf_drv_twi_tx(&m_twi, TMP117_I2C_ADDR, &reg, 1, true);
-    if (err_code != NRF_SUCCESS) return err_code;
-    
-    err_code = nrf_drv_twi_rx(&m_twi, TMP117_I2C_ADDR, data, 2);
+    nrf_twi_mngr_transfer_t const transfers[] = {
+        NRF_TWI_MNGR_WRITE(TMP117_I2C_ADDR, &reg, 1, NRF_TWI_MNGR_NO_STOP),
+        NRF_TWI_MNGR_READ(TMP117_I2C_ADDR, data, sizeof(data), 0)
+    };
+    err_code = twi_bus_perform(transfers, 2);
     if (err_code != NRF_SUCCESS) return err_code;
     
     *value = (data[0] << 8) | data[1];
     return NRF_SUCCESS;
 }
 
+/**
+ * @brief Queued transaction finished, runs in TWIM interrupt context
+ */
+static void tmp117_bus_callback(ret_code_t result, void *p_user_data) {
+    m_bus_result = result;
+    m_bus_done = true;
+}
+
+/**
+ * @brief Sleep write finished, runs in TWIM interrupt context
+ */
+static void tmp117_sleep_callback(ret_code_t result, void *p_user_data) {
+    m_sleep_result = result;
+    m_sleep_done = true;
+}
+
+/**
+ * @brief Conversion timeout elapsed
+ */
+static void tmp117_conversion_timer_handler(void *p_context) {
+    m_conversion_due = true;
+}
+
+/**
+ * @brief ALERT pin handler: result ready during a read, limit crossed
+ *        while monitoring
+ */
+static void tmp117_alert_pin_handler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action) {
+    m_alert_pending = true;
+}
+
+/**
+ * @brief CFGR value for the one-shot trigger
+ */
+static uint16_t tmp117_oneshot_config(void) {
+    return TMP117_CFG_MOD_OS | ((uint16_t)m_avg << TMP117_CFG_AVG_POS) | TMP117_CFG_DR_ALERT;
+}
+
+/**
+ * @brief CFGR value for alert monitoring between cycles
+ * @note With 8x averaging and a 16 s cycle the sensor is active for 125 ms
+ *       per cycle, a few uA on average
+ */
+static uint16_t tmp117_monitor_config(void) {
+    return TMP117_CFG_MOD_CC | ((uint16_t)m_monitor_cycle << TMP117_CFG_CONV_POS) |
+           ((uint16_t)m_avg << TMP117_CFG_AVG_POS);
+}
+
 /**
  * @brief Initialize TMP117
  */
@@ -75,22 +232,10 @@ int tmp117_init(void) {
     ret_code_t err_code;
     uint16_t device_id;
     
-    // TWI/I2C is already initialized by MAX30102, skip if initialized
-    if (!m_initialized) {
-        const nrf_drv_twi_config_t twi_config = {
-           .scl                = 27,
-           .sda                = 26,
-           .frequency          = NRF_DRV_TWI_FREQ_400K,
-           .interrupt_priority = APP_IRQ_PRIORITY_HIGH,
-           .clear_bus_init     = false
-        };
-        
-        err_code = nrf_drv_twi_init(&m_twi, &twi_config, NULL, NULL);
-        if (err_code != NRF_SUCCESS && err_code != NRF_ERROR_INVALID_STATE) {
-            NRF_LOG_ERROR("TMP117 TWI init failed: %d", err_code);
-            return -1;
-        }
-        nrf_drv_twi_enable(&m_twi);
+    // Shared with the MAX30102
+    if (twi_bus_init() != 0) {
+        NRF_LOG_ERROR("TMP117 TWI init failed");
+        return -1;
     }
     
     // Read device ID to verify communication
@@ -107,16 +252,33 @@ int tmp117_init(void) {
         NRF_LOG_WARNING("Unexpected TMP117 device ID");
     }
     
-    // Configure for continuous conversion, 1Hz (low power)
-    // AVG[1:0] = 00 (no averaging)
-    // CONV[2:0] = 000 (15.5ms conversion)
-    err_code = tmp117_write_register(TMP117_REG_CFGR, TMP117_CFG_MOD_CC);
+    // Shut down until the first reading; conversions are one-shot
+    err_code = tmp117_write_register(TMP117_REG_CFGR,
+                                     TMP117_CFG_MOD_SD | ((uint16_t)m_avg << TMP117_CFG_AVG_POS));
     if (err_code != NRF_SUCCESS) {
         NRF_LOG_ERROR("TMP117 configuration failed");
         return -1;
     }
     
-    nrf_delay_ms(50); // Wait for first conversion
+    // ALERT is open-drain, active low
+    if (!nrf_drv_gpiote_is_init()) {
+        err_code = nrf_drv_gpiote_init();
+        if (err_code != NRF_SUCCESS) return -1;
+    }
+    nrf_drv_gpiote_in_config_t alert_config = GPIOTE_CONFIG_IN_SENSE_HITOLO(false);
+    alert_config.pull = NRF_GPIO_PIN_PULLUP;
+    err_code = nrf_drv_gpiote_in_init(TMP117_ALERT_PIN, &alert_config, tmp117_alert_pin_handler);
+    if (err_code != NRF_SUCCESS) {
+        NRF_LOG_ERROR("TMP117 ALERT pin init failed");
+        return -1;
+    }
+    
+    err_code = app_timer_create(&m_conversion_timer, APP_TIMER_MODE_SINGLE_SHOT,
+                                tmp117_conversion_timer_handler);
+    if (err_code != NRF_SUCCESS) {
+        NRF_LOG_ERROR("TMP117 timer create failed");
+        return -1;
+    }
     
     m_initialized = true;
     NRF_LOG_INFO("TMP117 initialized successfully");
@@ -125,82 +287,331 @@ int tmp117_init(void) {
 }
 
 /**
- * @brief Wake up TMP117 from shutdown mode
+ * @brief Set averaging and the alert monitoring cycle
+ * @param avg Conversions averaged per reading; also sets the one-shot time
+ * @param monitor_cycle Conversion period while alert limits are monitored
+ * @return 0 on success, -1 if a reading is in progress or a value is invalid
+ * @note Takes effect from the next reading or tmp117_sleep()
  */
-void tmp117_wakeup(void) {
-    if (m_initialized) {
-        tmp117_write_register(TMP117_REG_CFGR, TMP117_CFG_MOD_CC);
-        nrf_delay_ms(20); // Wait for conversion
+int tmp117_configure(tmp117_avg_t avg, tmp117_cycle_t monitor_cycle) {
+    if (m_read_active || avg > TMP117_AVG_64 ||
+        monitor_cycle < TMP117_CYCLE_1S || monitor_cycle > TMP117_CYCLE_16S) {
+        return -1;
     }
+    
+    m_avg = avg;
+    m_monitor_cycle = monitor_cycle;
+    return 0;
 }
 
 /**
- * @brief Put TMP117 into shutdown mode (low power)
+ * @brief Wake up TMP117 from shutdown mode (non-blocking)
+ * @param handler Called from tmp117_process() once the sensor is ready
+ * @return 0 if the sensor is available
  */
-void tmp117_sleep(void) {
-    if (m_initialized) {
-        tmp117_write_register(TMP117_REG_CFGR, TMP117_CFG_MOD_SD);
+int tmp117_wakeup(tmp117_ready_handler_t handler) {
+    if (!m_initialized) {
+        return -1;
     }
+    
+    // Readings are one-shot conversions started from shutdown or monitoring,
+    // so there is nothing to warm up; readiness is reported once a pending
+    // alert read has released the bus buffers
+    m_ready_handler = handler;
+    m_ready_pending = true;
+    return 0;
 }
 
 /**
- * @brief Read temperature from TMP117
- * @return Temperature in degrees Celsius
+ * @brief Put TMP117 into shutdown mode, or alert monitoring if limits are armed
+ * @note The CFGR write is queued; with limits armed, monitoring starts from
+ *       tmp117_process() once the write has gone out
  */
-float tmp117_read_temperature(void) {
+void tmp117_sleep(void) {
     if (!m_initialized) {
-        return 36.5; // Default body temperature
+        return;
     }
     
-    uint16_t raw_temp;
-    ret_code_t err_code;
+    m_ready_pending = false;
+    if (m_sleep_pending) {
+        // The previous sleep write still owns the buffer
+        TRACE_WARNING("TMP117 sleep write still queued");
+        return;
+    }
     
-    // Check if data is ready
-    uint16_t config;
-    err_code = tmp117_read_register(TMP117_REG_CFGR, &config);
-    if (err_code != NRF_SUCCESS) {
-        NRF_LOG_ERROR("Failed to read config register");
-        return 36.5;
+    // ALERT stays off until the sensor is known to be in alert mode
+    uint16_t config = m_monitor_armed ? tmp117_monitor_config() :
+                      (TMP117_CFG_MOD_SD | ((uint16_t)m_avg << TMP117_CFG_AVG_POS));
+    nrf_drv_gpiote_in_event_disable(TMP117_ALERT_PIN);
+    m_monitoring = false;
+    
+    m_sleep_buf[1] = (config >> 8) & 0xFF;
+    m_sleep_buf[2] = config & 0xFF;
+    m_sleep_monitor = m_monitor_armed;
+    m_sleep_done = false;
+    if (twi_bus_schedule(&m_sleep_transaction) != NRF_SUCCESS) {
+        TRACE_ERROR("TMP117 sleep write not queued");
+        return;
+    }
+    m_sleep_pending = true;
+}
+
+/**
+ * @brief Sleep write went out: start alert monitoring if it was requested
+ * @note A read started in the meantime has taken the sensor over again
+ */
+static void tmp117_sleep_process(void) {
+    if (!m_sleep_pending || !m_sleep_done) {
+        return;
+    }
+    m_sleep_pending = false;
+    
+    if (m_sleep_result != NRF_SUCCESS) {
+        if (m_sleep_monitor) {
+            TRACE_ERROR("TMP117 alert monitoring not started");
+        } else {
+            TRACE_ERROR("TMP117 shutdown failed");
+        }
+        return;
+    }
+    if (!m_sleep_monitor || m_read_active) {
+        return;
     }
+    m_alert_pending = false;
+    nrf_drv_gpiote_in_event_enable(TMP117_ALERT_PIN, true);
+    m_monitoring = true;
+}
+
+/**
+ * @brief Start a non-blocking one-shot conversion
+ * @param handler Called from tmp117_process() once the result is ready
+ * @return 0 if the conversion was started
+ */
+int tmp117_start_read(tmp117_done_handler_t handler) {
+    if (!m_initialized || m_read_active || m_alert_read) {
+        return -1;
+    }
+    
+    // A failed trigger must not hand out the previous conversion
+    m_result = -1;
+    
+    uint16_t config = tmp117_oneshot_config();
+    m_trigger_buf[1] = (config >> 8) & 0xFF;
+    m_trigger_buf[2] = config & 0xFF;
+    m_alert_pending = false;
+    nrf_drv_gpiote_in_event_enable(TMP117_ALERT_PIN, true);
     
-    // Wait for data ready bit
-    uint8_t timeout = 100;
-    while (!(config & TMP117_CFG_DATA_READY) && timeout--) {
-        nrf_delay_ms(1);
-        tmp117_read_register(TMP117_REG_CFGR, &config);
+    // Queued behind any MAX30102 burst; ALERT falls once the result is ready
+    if (twi_bus_schedule(&m_trigger_transaction) != NRF_SUCCESS) {
+        TRACE_ERROR("Failed to start TMP117 conversion");
+        nrf_drv_gpiote_in_event_disable(TMP117_ALERT_PIN);
+        return -1;
     }
     
-    // Read temperature register
-    err_code = tmp117_read_register(TMP117_REG_TEMP, &raw_temp);
-    if (err_code != NRF_SUCCESS) {
-        NRF_LOG_ERROR("Failed to read temperature");
-        return 36.5;
+    // Timeout with 25% margin for the oscillator tolerance and bus queueing
+    uint16_t timeout_ms = m_conversion_ms[m_avg] + m_conversion_ms[m_avg] / 4 + 5;
+    
+    m_done_handler = handler;
+    m_bus_done = false;
+    m_result_pending = false;
+    m_conversion_due = false;
+    m_monitoring = false;
+    m_read_active = true;
+    app_timer_start(m_conversion_timer, APP_TIMER_TICKS(timeout_ms), NULL);
+    
+    return 0;
+}
+
+/**
+ * @brief End the read and report completion
+ */
+static void tmp117_finish_read(void) {
+    app_timer_stop(m_conversion_timer);
+    nrf_drv_gpiote_in_event_disable(TMP117_ALERT_PIN);
+    m_read_active = false;
+    if (m_done_handler) {
+        m_done_handler();
+    }
+}
+
+/**
+ * @brief Alert monitoring: fetch the temperature and flags behind an ALERT edge
+ */
+static void tmp117_alert_process(void) {
+    if (m_alert_read) {
+        if (!m_bus_done) {
+            return;
+        }
+        m_bus_done = false;
+        m_alert_read = false;
+        
+        if (m_bus_result != NRF_SUCCESS) {
+            TRACE_ERROR("Failed to read TMP117 alert");
+            return;
+        }
+        
+        uint16_t config = (m_cfgr_buf[0] << 8) | m_cfgr_buf[1];
+        m_temp_raw = (int16_t)((m_temp_buf[0] << 8) | m_temp_buf[1]);
+        m_result = 0;
+        if ((config & (TMP117_CFG_HIGH_ALERT | TMP117_CFG_LOW_ALERT)) && m_alert_handler) {
+            m_alert_handler((config & TMP117_CFG_HIGH_ALERT) != 0, m_temp_raw);
+        }
+        return;
     }
     
-    // Convert to temperature (two's complement)
-    int16_t temp_raw = (int16_t)raw_temp;
-    float temperature = temp_raw * TMP117_RESOLUTION;
+    // Alert mode latches ALERT low until CFGR is read; also catch a level
+    // that was already asserted when monitoring started
+    if (m_monitoring && (m_alert_pending || !nrf_drv_gpiote_in_is_set(TMP117_ALERT_PIN))) {
+        m_alert_pending = false;
+        m_bus_done = false;
+        if (twi_bus_schedule(&m_result_transaction) == NRF_SUCCESS) {
+            m_alert_read = true;
+        }
+    }
+}
+
+/**
+ * @brief Report readiness, collect the conversion result once ALERT signals
+ *        it and service alert monitoring; call from the main loop
+ */
+void tmp117_process(void) {
+    tmp117_sleep_process();
+    
+    if (!m_read_active) {
+        tmp117_alert_process();
+    }
     
-    NRF_LOG_INFO("TMP117 Temperature: %d.%02d°C", 
-                 (int)temperature, 
-                 (int)(temperature * 100) % 100);
+    if (m_ready_pending && !m_alert_read) {
+        m_ready_pending = false;
+        if (m_ready_handler) {
+            m_ready_handler();
+        }
+    }
+    
+    if (!m_read_active) {
+        return;
+    }
     
-    return temperature;
+    if (m_bus_done) {
+        m_bus_done = false;
+        
+        if (m_bus_result != NRF_SUCCESS) {
+            // Trigger or result read failed, give up on this conversion
+            TRACE_ERROR("Failed to read temperature");
+            tmp117_finish_read();
+            return;
+        }
+        
+        if (m_result_pending) {
+            m_result_pending = false;
+            uint16_t config = (m_cfgr_buf[0] << 8) | m_cfgr_buf[1];
+            
+            if (!(config & TMP117_CFG_DATA_READY)) {
+                if (!m_conversion_due) {
+                    return;     // Early edge, keep waiting for the result
+                }
+                TRACE_WARNING("TMP117 conversion timed out");
+                tmp117_finish_read();
+                return;
+            }
+            
+            // Two's complement, kept in raw LSB
+            m_temp_raw = (int16_t)((m_temp_buf[0] << 8) | m_temp_buf[1]);
+            m_result = 0;
+            
+            int32_t cdeg = TMP117_CDEG_FROM_RAW(m_temp_raw);
+            TRACE_INFO("TMP117 Temperature: %d.%02d°C", 
+                       (int)(cdeg / 100), 
+                       (int)(cdeg % 100));
+            tmp117_finish_read();
+            return;
+        }
+    }
+    
+    if ((m_alert_pending || m_conversion_due) && !m_result_pending) {
+        m_alert_pending = false;
+        if (twi_bus_schedule(&m_result_transaction) == NRF_SUCCESS) {
+            m_result_pending = true;
+        } else {
+            TRACE_ERROR("Failed to read temperature");
+            tmp117_finish_read();
+        }
+    }
+}
+
+/**
+ * @brief Temperature from the last completed conversion
+ * @return Temperature in degrees Celsius (36.5 if no valid reading)
+ */
+float tmp117_get_temperature(void) {
+    return (m_result == 0) ? m_temp_raw * TMP117_RESOLUTION : 36.5;
+}
+
+/**
+ * @brief Temperature from the last completed conversion, in TMP117 LSB
+ * @return Raw temperature (1/128 degC), 36.5 degC if no valid reading
+ */
+int16_t tmp117_get_temperature_raw(void) {
+    return (m_result == 0) ? m_temp_raw : TMP117_RAW_FROM_CDEG(3650);
+}
+
+/**
+ * @brief Temperature from the last completed conversion, in TMP117 LSB
+ * @param temp_raw Receives the temperature (1/128 degC) if valid
+ * @return 0 if valid, -1 if the last conversion failed or never started
+ */
+int tmp117_get_result(int16_t *temp_raw) {
+    if (m_result == 0) {
+        *temp_raw = m_temp_raw;
+    }
+    return m_result;
 }
 
 /**
- * @brief Set temperature alert thresholds
+ * @brief Read temperature from TMP117 (blocking)
+ * @return Temperature in degrees Celsius
  */
-void tmp117_set_alert_limits(float high_limit, float low_limit) {
-    if (!m_initialized) return;
+float tmp117_read_temperature(void) {
+    if (tmp117_start_read(NULL) != 0) {
+        return 36.5; // Default body temperature
+    }
     
-    int16_t high_raw = (int16_t)(high_limit / TMP117_RESOLUTION);
-    int16_t low_raw = (int16_t)(low_limit / TMP117_RESOLUTION);
+    while (m_read_active) {
+        tmp117_process();
+        if (m_read_active) {
+            __WFE();
+        }
+    }
     
-    tmp117_write_register(TMP117_REG_THI_LIMIT, (uint16_t)high_raw);
-    tmp117_write_register(TMP117_REG_TLO_LIMIT, (uint16_t)low_raw);
+    return tmp117_get_temperature();
+}
+
+/**
+ * @brief Arm temperature alert limits for monitoring between cycles
+ * @param high_raw High limit in TMP117 LSB (1/128 degC)
+ * @param low_raw Low limit in TMP117 LSB
+ * @param handler Called from tmp117_process() when a limit is crossed
+ * @return 0 if the limits were written
+ * @note Blocking, called once at init. Monitoring starts with the next
+ *       tmp117_sleep().
+ */
+int tmp117_set_alert_limits(int16_t high_raw, int16_t low_raw, tmp117_alert_handler_t handler) {
+    if (!m_initialized || low_raw >= high_raw) {
+        return -1;
+    }
     
+    if (tmp117_write_register(TMP117_REG_THI_LIMIT, (uint16_t)high_raw) != NRF_SUCCESS ||
+        tmp117_write_register(TMP117_REG_TLO_LIMIT, (uint16_t)low_raw) != NRF_SUCCESS) {
+        return -1;
+    }
+    
+    m_alert_handler = handler;
+    m_monitor_armed = true;
+    
+    int32_t low_cdeg = TMP117_CDEG_FROM_RAW(low_raw);
+    int32_t high_cdeg = TMP117_CDEG_FROM_RAW(high_raw);
     NRF_LOG_INFO("Temperature alert limits set: Low=%d.%02d°C, High=%d.%02d°C",
-                 (int)low_limit, (int)(low_limit * 100) % 100,
-                 (int)high_limit, (int)(high_limit * 100) % 100);
+                 (int)(low_cdeg / 100), (int)(low_cdeg % 100),
+                 (int)(high_cdeg / 100), (int)(high_cdeg % 100));
+    return 0;
 }
\ No newline at end of file
@@ -2,11 +2,43 @@
 #define TMP117_DRIVER_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// Raw temperature is in TMP117 LSB (1/128 degC); cdeg is hundredths of degC
+#define TMP117_LSB_PER_DEGC         128
+#define TMP117_RAW_FROM_CDEG(cdeg)  ((int16_t)(((cdeg) * TMP117_LSB_PER_DEGC) / 100))
+#define TMP117_CDEG_FROM_RAW(raw)   (((int32_t)(raw) * 100) / TMP117_LSB_PER_DEGC)
+
+// Conversions averaged per reading (CFGR AVG)
+typedef enum {
+    TMP117_AVG_1,                   // 15.5 ms
+    TMP117_AVG_8,                   // 125 ms
+    TMP117_AVG_32,                  // 500 ms
+    TMP117_AVG_64                   // 1 s
+} tmp117_avg_t;
+
+// Alert monitoring cycle between measurement cycles (CFGR CONV)
+typedef enum {
+    TMP117_CYCLE_1S = 4,
+    TMP117_CYCLE_4S,
+    TMP117_CYCLE_8S,
+    TMP117_CYCLE_16S
+} tmp117_cycle_t;
+
+typedef void (*tmp117_ready_handler_t)(void);
+typedef void (*tmp117_done_handler_t)(void);
+typedef void (*tmp117_alert_handler_t)(bool high, int16_t temp_raw);
 
 int tmp117_init(void);
-void tmp117_wakeup(void);
+int tmp117_configure(tmp117_avg_t avg, tmp117_cycle_t monitor_cycle);
+int tmp117_wakeup(tmp117_ready_handler_t handler);
 void tmp117_sleep(void);
+int tmp117_start_read(tmp117_done_handler_t handler);
+void tmp117_process(void);
+float tmp117_get_temperature(void);
+int16_t tmp117_get_temperature_raw(void);
+int tmp117_get_result(int16_t *temp_raw);
 float tmp117_read_temperature(void);
-void tmp117_set_alert_limits(float high_limit, float low_limit);
+int tmp117_set_alert_limits(int16_t high_raw, int16_t low_raw, tmp117_alert_handler_t handler);
 
 #endif
\ No newline at end of file
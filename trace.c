@@ -0,0 +1,35 @@
+/**
+ * @file trace.c
+ * @brief Binary trace ring for TRACE_MODE_BINARY
+ * @description Records are claimed with a single increment, so interrupt
+ *              handlers may trace too. The ring overwrites its oldest
+ *              records; read it with a debugger (symbol m_trace_ring) and
+ *              decode with trace_decode.py.
+ */
+
+#include "trace.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include <string.h>
+
+static trace_ring_t m_trace_ring = {
+    .magic = TRACE_RING_MAGIC,
+    .head  = 0
+};
+
+/**
+ * @brief Store one record; args beyond nargs are zeroed
+ */
+void trace_write(char const *fmt, uint32_t const *args, uint8_t nargs) {
+    uint32_t idx;
+
+    CRITICAL_REGION_ENTER();
+    idx = m_trace_ring.head++;
+    CRITICAL_REGION_EXIT();
+
+    trace_record_t *record = &m_trace_ring.records[idx % TRACE_RING_RECORDS];
+    record->timestamp = app_timer_cnt_get();
+    record->id = (uint32_t)(uintptr_t)fmt;
+    memset(record->args, 0, sizeof(record->args));
+    memcpy(record->args, args, nargs * sizeof(uint32_t));
+}
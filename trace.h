@@ -0,0 +1,168 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "nrf_log.h"
+
+/*
+ * Trace front end. Modules log through TRACE_ERROR/WARNING/INFO/DEBUG
+ * after defining TRACE_MODULE_LEVEL, for example
+ *
+ *     #define TRACE_MODULE_LEVEL  TRACE_LEVEL_MAIN
+ *     #include "trace.h"
+ *
+ * Anything above the module level is compiled out, format string included.
+ *
+ * TRACE_MODE_TEXT forwards to NRF_LOG. TRACE_MODE_BINARY stores fixed-size
+ * records (timestamp, format id, raw args) in a RAM ring and formats
+ * nothing on the target. The format id is the address of the string in the
+ * .trace_fmt section; trace_decode.py resolves it from the ELF. Keep that
+ * section out of flash in the linker script:
+ *
+ *     .trace_fmt 0xF0000000 (INFO) : { KEEP(*(.trace_fmt)) }
+ *
+ * Only integer and string-pointer arguments are supported, at most
+ * TRACE_MAX_ARGS of them, as with NRF_LOG.
+ */
+
+#define TRACE_MODE_TEXT         0
+#define TRACE_MODE_BINARY       1
+
+#define TRACE_LEVEL_OFF         0
+#define TRACE_LEVEL_ERROR       1
+#define TRACE_LEVEL_WARNING     2
+#define TRACE_LEVEL_INFO        3
+#define TRACE_LEVEL_DEBUG       4
+
+#define TRACE_MAX_ARGS          6
+#define TRACE_RING_RECORDS      128     // 4 KB of RAM
+#define TRACE_RING_MAGIC        0x54524331  // "TRC1"
+
+#ifndef TRACE_MODE
+#define TRACE_MODE              TRACE_MODE_TEXT
+#endif
+
+#ifndef TRACE_DEFAULT_LEVEL
+#define TRACE_DEFAULT_LEVEL     TRACE_LEVEL_INFO
+#endif
+
+// Per-module levels, override with -DTRACE_LEVEL_<MODULE>=<level>
+#ifndef TRACE_LEVEL_MAIN
+#define TRACE_LEVEL_MAIN        TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_COMM
+#define TRACE_LEVEL_COMM        TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_PROFILER
+#define TRACE_LEVEL_PROFILER    TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_STREAM
+#define TRACE_LEVEL_STREAM      TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_HEALTH
+#define TRACE_LEVEL_HEALTH      TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_TREND
+#define TRACE_LEVEL_TREND       TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_BOOT
+#define TRACE_LEVEL_BOOT        TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_PTT
+#define TRACE_LEVEL_PTT         TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_HRV
+#define TRACE_LEVEL_HRV         TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_TRANSPORT
+#define TRACE_LEVEL_TRANSPORT   TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_POWER_BENCH
+#define TRACE_LEVEL_POWER_BENCH TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_ECG
+#define TRACE_LEVEL_ECG         TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_SENSORS
+#define TRACE_LEVEL_SENSORS     TRACE_DEFAULT_LEVEL
+#endif
+#ifndef TRACE_LEVEL_VITALS_LOG
+#define TRACE_LEVEL_VITALS_LOG  TRACE_DEFAULT_LEVEL
+#endif
+
+#ifndef TRACE_MODULE_LEVEL
+#define TRACE_MODULE_LEVEL      TRACE_DEFAULT_LEVEL
+#endif
+
+typedef struct {
+    uint32_t timestamp;                 // RTC ticks
+    uint32_t id;                        // Format string address in .trace_fmt
+    uint32_t args[TRACE_MAX_ARGS];
+} trace_record_t;
+
+typedef struct {
+    uint32_t       magic;
+    uint32_t       head;                // Total records written
+    trace_record_t records[TRACE_RING_RECORDS];
+} trace_ring_t;
+
+void trace_write(char const *fmt, uint32_t const *args, uint8_t nargs);
+
+#define TRACE_STR_(x)           #x
+#define TRACE_STR(x)            TRACE_STR_(x)
+#define TRACE_CAT_(a, b)        a##b
+#define TRACE_CAT(a, b)         TRACE_CAT_(a, b)
+
+#define TRACE_NARGS(...)        TRACE_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define TRACE_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+
+#define TRACE_ARG(a)            (uint32_t)(uintptr_t)(a)
+#define TRACE_ARGS_0()
+#define TRACE_ARGS_1(a)                     , TRACE_ARG(a)
+#define TRACE_ARGS_2(a, b)                  , TRACE_ARG(a), TRACE_ARG(b)
+#define TRACE_ARGS_3(a, b, c)               TRACE_ARGS_2(a, b), TRACE_ARG(c)
+#define TRACE_ARGS_4(a, b, c, d)            TRACE_ARGS_3(a, b, c), TRACE_ARG(d)
+#define TRACE_ARGS_5(a, b, c, d, e)         TRACE_ARGS_4(a, b, c, d), TRACE_ARG(e)
+#define TRACE_ARGS_6(a, b, c, d, e, f)      TRACE_ARGS_5(a, b, c, d, e), TRACE_ARG(f)
+
+#if TRACE_MODE == TRACE_MODE_BINARY
+
+// The level is stored as the first character of the format string
+#define TRACE_EMIT(level, fmt, ...)                                                 \
+    do {                                                                            \
+        if ((level) <= TRACE_MODULE_LEVEL) {                                        \
+            static const char trace_fmt[] __attribute__((section(".trace_fmt"))) =  \
+                TRACE_STR(level) fmt;                                               \
+            uint32_t const trace_args[] = {                                         \
+                0 TRACE_CAT(TRACE_ARGS_, TRACE_NARGS(__VA_ARGS__))(__VA_ARGS__)     \
+            };                                                                      \
+            trace_write(trace_fmt, &trace_args[1], TRACE_NARGS(__VA_ARGS__));       \
+        }                                                                           \
+    } while (0)
+
+#define TRACE_ERROR(...)        TRACE_EMIT(TRACE_LEVEL_ERROR, __VA_ARGS__)
+#define TRACE_WARNING(...)      TRACE_EMIT(TRACE_LEVEL_WARNING, __VA_ARGS__)
+#define TRACE_INFO(...)         TRACE_EMIT(TRACE_LEVEL_INFO, __VA_ARGS__)
+#define TRACE_DEBUG(...)        TRACE_EMIT(TRACE_LEVEL_DEBUG, __VA_ARGS__)
+#define TRACE_HEXDUMP_INFO(p_data, len)     do { } while (0)
+#define TRACE_FLUSH()           do { } while (0)
+
+#else
+
+#define TRACE_TEXT(level, log_macro, ...)                                           \
+    do {                                                                            \
+        if ((level) <= TRACE_MODULE_LEVEL) {                                        \
+            log_macro(__VA_ARGS__);                                                 \
+        }                                                                           \
+    } while (0)
+
+#define TRACE_ERROR(...)        TRACE_TEXT(TRACE_LEVEL_ERROR, NRF_LOG_ERROR, __VA_ARGS__)
+#define TRACE_WARNING(...)      TRACE_TEXT(TRACE_LEVEL_WARNING, NRF_LOG_WARNING, __VA_ARGS__)
+#define TRACE_INFO(...)         TRACE_TEXT(TRACE_LEVEL_INFO, NRF_LOG_INFO, __VA_ARGS__)
+#define TRACE_DEBUG(...)        TRACE_TEXT(TRACE_LEVEL_DEBUG, NRF_LOG_DEBUG, __VA_ARGS__)
+#define TRACE_HEXDUMP_INFO(p_data, len)     TRACE_TEXT(TRACE_LEVEL_INFO, NRF_LOG_HEXDUMP_INFO, p_data, len)
+#define TRACE_FLUSH()           NRF_LOG_FLUSH()
+
+#endif
+
+#endif
\ No newline at end of file
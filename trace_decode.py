@@ -0,0 +1,184 @@
+"""
+Miner Health Monitoring System - Binary trace decoder
+Formats a TRACE_MODE_BINARY ring dump using the format strings in the ELF
+
+Usage:
+    python trace_decode.py firmware.elf ring.bin
+    python trace_decode.py firmware.elf ram.bin --ram-base 0x20000000
+
+The dump is either the m_trace_ring object alone or a RAM image starting at
+--ram-base, in which case the ring is located through the ELF symbol table.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+TRACE_RING_MAGIC = 0x54524331
+TRACE_MAX_ARGS = 6
+RECORD_SIZE = 8 + 4 * TRACE_MAX_ARGS
+RTC_FREQ_HZ = 32768
+LEVEL_NAMES = {'1': 'E', '2': 'W', '3': 'I', '4': 'D'}
+
+SHF_ALLOC = 0x2
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+
+FORMAT_SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+
+class Elf:
+    """Minimal ELF reader: sections, symbols and strings at addresses"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+
+        self.is64 = self.data[4] == 2
+        self.endian = '<' if self.data[5] == 1 else '>'
+        if self.is64:
+            shoff, = struct.unpack_from(self.endian + 'Q', self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + 'HHH', self.data, 0x3A)
+        else:
+            shoff, = struct.unpack_from(self.endian + 'I', self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + 'HHH', self.data, 0x2E)
+
+        self.sections = []
+        for i in range(shnum):
+            base = shoff + i * shentsize
+            if self.is64:
+                name, stype, flags, addr, offset, size, link = struct.unpack_from(
+                    self.endian + 'IIQQQQI', self.data, base)
+            else:
+                name, stype, flags, addr, offset, size, link = struct.unpack_from(
+                    self.endian + 'IIIIIII', self.data, base)
+            self.sections.append({'name_off': name, 'type': stype, 'flags': flags,
+                                  'addr': addr, 'offset': offset, 'size': size, 'link': link})
+
+        shstr = self.sections[shstrndx]
+        for s in self.sections:
+            s['name'] = self._cstring(shstr['offset'] + s['name_off'])
+
+    def _cstring(self, offset):
+        end = self.data.index(b'\0', offset)
+        return self.data[offset:end].decode('utf-8', 'replace')
+
+    def section(self, name):
+        for s in self.sections:
+            if s['name'] == name:
+                return s
+        return None
+
+    def symbol(self, name):
+        """Address and size of a symbol, local symbols included"""
+        for s in self.sections:
+            if s['type'] != SHT_SYMTAB:
+                continue
+            strtab = self.sections[s['link']]
+            entsize = 24 if self.is64 else 16
+            for off in range(s['offset'], s['offset'] + s['size'], entsize):
+                if self.is64:
+                    st_name, _, _, _, value, size = struct.unpack_from(self.endian + 'IBBHQQ', self.data, off)
+                else:
+                    st_name, value, size = struct.unpack_from(self.endian + 'III', self.data, off)
+                if self._cstring(strtab['offset'] + st_name) == name:
+                    return value, size
+        return None
+
+    def string_at(self, addr, trace_only=False):
+        """C string at a target address, or None if it is not in the image"""
+        for s in self.sections:
+            if s['type'] == SHT_NOBITS or s['size'] == 0:
+                continue
+            if trace_only and s['name'] != '.trace_fmt':
+                continue
+            if not trace_only and not (s['flags'] & SHF_ALLOC):
+                continue
+            if s['addr'] <= addr < s['addr'] + s['size']:
+                return self._cstring(s['offset'] + addr - s['addr'])
+        return None
+
+
+def format_message(elf, fmt, args):
+    """printf-style formatting of raw 32-bit arguments"""
+    args = list(args)
+    out = []
+    pos = 0
+    for m in FORMAT_SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, precision, _, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+
+        value = args.pop(0) if args else 0
+        spec = '%' + flags + width + ('.' + precision if precision else '')
+        if conv in 'di':
+            value = value - (1 << 32) if value & 0x80000000 else value
+            out.append((spec + 'd') % value)
+        elif conv == 's':
+            text = elf.string_at(value)
+            out.append((spec + 's') % (text if text is not None else '<0x%08x>' % value))
+        elif conv == 'p':
+            out.append('0x%08x' % value)
+        elif conv == 'c':
+            out.append((spec + 'c') % chr(value & 0xFF))
+        else:
+            out.append((spec + conv) % value)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def load_ring(elf, dump, ram_base):
+    if ram_base is None and len(dump) >= 8 and struct.unpack_from('<I', dump, 0)[0] == TRACE_RING_MAGIC:
+        return dump
+
+    sym = elf.symbol('m_trace_ring')
+    if sym is None:
+        raise ValueError('m_trace_ring not found in ELF and dump does not start with the ring')
+    offset = sym[0] - (ram_base if ram_base is not None else 0x20000000)
+    return dump[offset:offset + sym[1]]
+
+
+def decode(elf, ring):
+    magic, head = struct.unpack_from('<II', ring, 0)
+    if magic != TRACE_RING_MAGIC:
+        raise ValueError('bad ring magic 0x%08x' % magic)
+
+    capacity = (len(ring) - 8) // RECORD_SIZE
+    first = max(0, head - capacity)
+    for n in range(first, head):
+        off = 8 + (n % capacity) * RECORD_SIZE
+        fields = struct.unpack_from('<II%dI' % TRACE_MAX_ARGS, ring, off)
+        timestamp, fmt_id, args = fields[0], fields[1], fields[2:]
+
+        fmt = elf.string_at(fmt_id, trace_only=True)
+        if not fmt:
+            yield timestamp, '?', 'unknown format id 0x%08x %s' % (fmt_id, list(args))
+            continue
+        yield timestamp, LEVEL_NAMES.get(fmt[0], '?'), format_message(elf, fmt[1:], args)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a binary trace ring dump')
+    parser.add_argument('elf', help='firmware ELF the dump was taken from')
+    parser.add_argument('dump', help='ring or RAM dump')
+    parser.add_argument('--ram-base', type=lambda v: int(v, 0), default=None,
+                        help='address of the first byte of a RAM dump')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    with open(args.dump, 'rb') as f:
+        ring = load_ring(elf, f.read(), args.ram_base)
+
+    for timestamp, level, message in decode(elf, ring):
+        print('[%10.3f] %s %s' % (timestamp / RTC_FREQ_HZ, level, message))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
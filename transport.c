@@ -0,0 +1,310 @@
+/**
+ * @file transport.c
+ * @brief Link selection between BLE and LoRa
+ * @description Every attempt on a link is reported back with its outcome,
+ *              the time to the ACK and, when the ACK carried them, RSSI and
+ *              SNR. A link is failing after two misses in a row, when less
+ *              than half of its last eight attempts were ACKed, or when BLE
+ *              RSSI sits below the sensitivity margin; one ACK makes it
+ *              healthy again.
+ *
+ *              Routine frames take the healthy link with the lowest expected
+ *              charge per delivered frame: airtime times TX current, divided
+ *              by the recent success rate. With every link failing they
+ *              take the one with the most recent ACKs. A failing link cheaper than that
+ *              choice gets every TRANSPORT_PROBE_EVERY-th frame so it can
+ *              recover. Emergency frames go out on every link at once and
+ *              communication.c stops the others at the first ACK.
+ *
+ *              LoRa adapts its spreading factor like LoRaWAN ADR: after a
+ *              few ACKs with SNR to spare above the demodulation floor of
+ *              the current SF it steps down 1 SF per 3 dB of margin, and
+ *              after two misses in a row it steps up one. The data rate
+ *              follows the SF (DR = 12 - SF at 125 kHz).
+ */
+
+#include "transport.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_TRANSPORT
+#include "trace.h"
+#include <string.h>
+
+#define TRANSPORT_HISTORY_BITS      8
+#define TRANSPORT_BLE_RSSI_FLOOR    (-90)   // 1M PHY sensitivity -95 dBm plus margin
+#define TRANSPORT_BLE_PACKET_US     (21 * 8 + 150 + 80 + 150)  // Headers, IFS, empty ACK, IFS
+#define TRANSPORT_BLE_ACK_GUARD_MS  100     // Two connection intervals
+#define TRANSPORT_LORA_ACK_GUARD_MS 2000    // Gateway RX window and the mesh hop back
+#define TRANSPORT_LORA_PREAMBLE     8
+#define TRANSPORT_ADR_MIN_ACKS      4       // ACKs with SNR before stepping the SF down
+#define TRANSPORT_ADR_MAX_MISSES    2       // Misses in a row before stepping it up
+#define TRANSPORT_ADR_STEP_DB       3
+
+static char const * const m_link_names[TRANSPORT_LINK_COUNT] = { "BLE", "LoRa" };
+
+// Demodulation floor at 125 kHz, SF7 to SF12 (half dB)
+static const int8_t m_lora_snr_floor_x2[] = { -15, -20, -25, -30, -35, -40 };
+
+static transport_link_stats_t m_links[TRANSPORT_LINK_COUNT];
+static uint8_t m_lora_sf;
+static uint8_t m_lora_acks;             // ACKs with SNR since the last SF change
+static uint8_t m_lora_misses;           // Misses in a row since the last SF change
+
+static uint8_t transport_popcount(uint8_t bits) {
+    uint8_t count = 0;
+    while (bits) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Smooth by 1/4, or take the first value as it is
+ */
+static int32_t transport_smooth(int32_t average, int32_t value, bool first) {
+    return first ? value : average + (value - average) / 4;
+}
+
+/**
+ * @brief LoRa time on air: explicit header, CRC, CR 4/5, 125 kHz
+ */
+static uint32_t transport_lora_airtime_us(uint8_t sf, uint16_t length) {
+    uint32_t symbol_us = (1u << sf) * 8;            // 2^SF / 125 kHz
+    uint8_t de = (sf >= 11) ? 1 : 0;                // Low data rate optimisation
+    int32_t bits = 8 * (int32_t)length - 4 * sf + 28 + 16;
+    uint32_t per_block = 4 * (sf - 2 * de);
+    uint32_t symbols = 8;
+
+    if (bits > 0) {
+        symbols += ((uint32_t)bits + per_block - 1) / per_block * 5;
+    }
+    // Preamble plus 4.25 sync symbols
+    return (4 * (symbols + TRANSPORT_LORA_PREAMBLE) + 17) * symbol_us / 4;
+}
+
+/**
+ * @brief Charge to put a frame on air once (us * mA)
+ */
+static uint64_t transport_cost(transport_link_t link, uint16_t length) {
+    uint32_t current_ma = (link == TRANSPORT_LINK_BLE) ? TRANSPORT_BLE_TX_MA : TRANSPORT_LORA_TX_MA;
+    return (uint64_t)transport_airtime_us(link, length) * current_ma;
+}
+
+/**
+ * @brief Cost scaled by the recent success rate, one extra success and
+ *        attempt assumed so an untried link is not free
+ */
+static uint64_t transport_expected_cost(transport_link_t link, uint16_t length) {
+    transport_link_stats_t const *l = &m_links[link];
+    uint8_t acked = transport_popcount(l->history & ((1u << l->attempts) - 1));
+    return transport_cost(link, length) * (l->attempts + 1) / (acked + 1);
+}
+
+static void transport_lora_set_sf(uint8_t sf, char const *reason) {
+    TRACE_INFO("LoRa SF%d -> SF%d (DR%d), %s", m_lora_sf, sf, TRANSPORT_LORA_SF_MAX - sf, reason);
+    m_lora_sf = sf;
+    m_lora_acks = 0;
+    m_lora_misses = 0;
+}
+
+/**
+ * @brief ADR step after a LoRa attempt
+ */
+static void transport_lora_adapt(bool acked, bool has_snr) {
+    transport_link_stats_t const *l = &m_links[TRANSPORT_LINK_LORA];
+
+    if (!acked) {
+        m_lora_acks = 0;
+        if (++m_lora_misses >= TRANSPORT_ADR_MAX_MISSES && m_lora_sf < TRANSPORT_LORA_SF_MAX) {
+            transport_lora_set_sf(m_lora_sf + 1, "ACKs missed");
+        }
+        return;
+    }
+
+    m_lora_misses = 0;
+    if (!has_snr || ++m_lora_acks < TRANSPORT_ADR_MIN_ACKS) {
+        return;
+    }
+
+    int32_t margin_x2 = 2 * l->snr_db - m_lora_snr_floor_x2[m_lora_sf - TRANSPORT_LORA_SF_MIN] -
+                        2 * TRANSPORT_LORA_MARGIN_DB;
+    int32_t steps = margin_x2 / (2 * TRANSPORT_ADR_STEP_DB);
+    if (steps > m_lora_sf - TRANSPORT_LORA_SF_MIN) {
+        steps = m_lora_sf - TRANSPORT_LORA_SF_MIN;
+    }
+    if (steps > 0) {
+        transport_lora_set_sf(m_lora_sf - steps, "SNR margin");
+    }
+}
+
+/**
+ * @brief Forget all link history
+ */
+void transport_init(void) {
+    memset(m_links, 0, sizeof(m_links));
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        m_links[i].rssi_dbm = TRANSPORT_SIGNAL_UNKNOWN;
+        m_links[i].snr_db = TRANSPORT_SIGNAL_UNKNOWN;
+    }
+    m_lora_sf = TRANSPORT_LORA_SF_START;
+    m_lora_acks = 0;
+    m_lora_misses = 0;
+}
+
+/**
+ * @brief Link is usable for routine traffic; untried links are
+ */
+bool transport_healthy(transport_link_t link) {
+    transport_link_stats_t const *l = &m_links[link];
+
+    if (l->attempts == 0) {
+        return true;
+    }
+    if (link == TRANSPORT_LINK_BLE && l->rssi_dbm != TRANSPORT_SIGNAL_UNKNOWN &&
+        l->rssi_dbm < TRANSPORT_BLE_RSSI_FLOOR) {
+        return false;
+    }
+    if (l->history & 1) {
+        return true;
+    }
+    if (l->attempts >= 2 && (l->history & 0x3) == 0) {
+        return false;
+    }
+    uint8_t acked = transport_popcount(l->history & ((1u << l->attempts) - 1));
+    return 2 * acked >= l->attempts;
+}
+
+/**
+ * @brief Links to put a frame on
+ * @param length Frame length in bytes
+ * @param is_emergency Fan out on every link
+ * @return Mask of TRANSPORT_LINK_MASK() bits, never empty
+ */
+uint8_t transport_select(uint16_t length, bool is_emergency) {
+    if (is_emergency) {
+        return TRANSPORT_ALL_LINKS;
+    }
+
+    // Cheapest healthy link
+    transport_link_t best = TRANSPORT_LINK_COUNT;
+    uint64_t best_cost = UINT64_MAX;
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        if (!transport_healthy((transport_link_t)i)) {
+            continue;
+        }
+        uint64_t cost = transport_expected_cost((transport_link_t)i, length);
+        if (cost < best_cost) {
+            best = (transport_link_t)i;
+            best_cost = cost;
+        }
+    }
+
+    // None healthy: the one that got most through lately, the cheaper on a tie
+    if (best == TRANSPORT_LINK_COUNT) {
+        uint8_t best_acked = 0;
+        best = TRANSPORT_LINK_BLE;
+        for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+            uint8_t acked = transport_popcount(m_links[i].history);
+            if (acked > best_acked) {
+                best = (transport_link_t)i;
+                best_acked = acked;
+            }
+        }
+    }
+
+    // Give a cheaper failing link a frame now and then to find out it is back
+    for (uint8_t i = 0; i < TRANSPORT_LINK_COUNT; i++) {
+        transport_link_stats_t *l = &m_links[i];
+        if (i == best || transport_healthy((transport_link_t)i) ||
+            transport_cost((transport_link_t)i, length) >= transport_cost(best, length)) {
+            continue;
+        }
+        if (++l->skipped >= TRANSPORT_PROBE_EVERY) {
+            l->skipped = 0;
+            TRACE_DEBUG("Probing %s", m_link_names[i]);
+            return TRANSPORT_LINK_MASK(i);
+        }
+    }
+
+    return TRANSPORT_LINK_MASK(best);
+}
+
+/**
+ * @brief Outcome of one attempt on a link; cancelled attempts are not reported
+ * @param latency_ms Send to ACK, ignored if not ACKed
+ * @param rssi_dbm RSSI of the ACK or TRANSPORT_SIGNAL_UNKNOWN
+ * @param snr_db SNR of the ACK or TRANSPORT_SIGNAL_UNKNOWN
+ */
+void transport_report(transport_link_t link, bool acked, uint32_t latency_ms,
+                      int8_t rssi_dbm, int8_t snr_db) {
+    if (link >= TRANSPORT_LINK_COUNT) {
+        return;
+    }
+    transport_link_stats_t *l = &m_links[link];
+    bool was_healthy = transport_healthy(link);
+
+    l->history = (uint8_t)((l->history << 1) | (acked ? 1 : 0));
+    if (l->attempts < TRANSPORT_HISTORY_BITS) {
+        l->attempts++;
+    }
+
+    if (acked) {
+        if (latency_ms > UINT16_MAX) {
+            latency_ms = UINT16_MAX;
+        }
+        l->ack_latency_ms = (uint16_t)transport_smooth(l->ack_latency_ms, latency_ms, l->ack_latency_ms == 0);
+        if (rssi_dbm != TRANSPORT_SIGNAL_UNKNOWN) {
+            l->rssi_dbm = (int8_t)transport_smooth(l->rssi_dbm, rssi_dbm,
+                                                   l->rssi_dbm == TRANSPORT_SIGNAL_UNKNOWN);
+        }
+        if (snr_db != TRANSPORT_SIGNAL_UNKNOWN) {
+            l->snr_db = (int8_t)transport_smooth(l->snr_db, snr_db, l->snr_db == TRANSPORT_SIGNAL_UNKNOWN);
+        }
+        l->skipped = 0;
+    }
+
+    if (link == TRANSPORT_LINK_LORA) {
+        transport_lora_adapt(acked, snr_db != TRANSPORT_SIGNAL_UNKNOWN);
+    }
+
+    if (was_healthy != transport_healthy(link)) {
+        TRACE_WARNING("%s link %s", m_link_names[link], was_healthy ? "failing" : "recovered");
+    }
+}
+
+/**
+ * @brief Time on air of a frame on a link at its current settings
+ */
+uint32_t transport_airtime_us(transport_link_t link, uint16_t length) {
+    if (link == TRANSPORT_LINK_LORA) {
+        return transport_lora_airtime_us(m_lora_sf, length);
+    }
+    uint32_t packets = (length + TRANSPORT_BLE_PACKET_BYTES - 1) / TRANSPORT_BLE_PACKET_BYTES;
+    return 8 * (uint32_t)length + packets * TRANSPORT_BLE_PACKET_US;
+}
+
+/**
+ * @brief How long to wait for the ACK of a frame before counting a miss
+ * @note Airtime plus a guard for the link, and never less than twice the
+ *       smoothed ACK latency
+ */
+uint32_t transport_ack_timeout_ms(transport_link_t link, uint16_t length) {
+    uint32_t guard_ms = (link == TRANSPORT_LINK_LORA) ? TRANSPORT_LORA_ACK_GUARD_MS
+                                                      : TRANSPORT_BLE_ACK_GUARD_MS;
+    uint32_t timeout_ms = (transport_airtime_us(link, length) + 999) / 1000 + guard_ms;
+    uint32_t latency_ms = 2 * (uint32_t)m_links[link].ack_latency_ms;
+
+    return (latency_ms > timeout_ms) ? latency_ms : timeout_ms;
+}
+
+/**
+ * @brief Spreading factor the LoRa back-end transmits with
+ */
+uint8_t transport_lora_sf(void) {
+    return m_lora_sf;
+}
+
+void transport_get_stats(transport_link_t link, transport_link_stats_t *stats) {
+    if (link < TRANSPORT_LINK_COUNT) {
+        *stats = m_links[link];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRANSPORT_SIGNAL_UNKNOWN    INT8_MIN    // RSSI or SNR the ACK did not carry
+#define TRANSPORT_PROBE_EVERY       8           // Routine frames between probes of a cheaper failing link
+#define TRANSPORT_LORA_SF_MIN       7           // DR5 at 125 kHz
+#define TRANSPORT_LORA_SF_MAX       12          // DR0
+#define TRANSPORT_LORA_SF_START     10          // Until SNR reports say otherwise
+#define TRANSPORT_LORA_MARGIN_DB    10          // SNR kept above the demodulation floor
+
+#define TRANSPORT_BLE_PACKET_BYTES  244         // ATT payload per LL packet with DLE
+
+// TX current per link, for the energy of a frame (mA)
+#define TRANSPORT_BLE_TX_MA         5           // nRF52840 at 0 dBm, DC/DC on
+#define TRANSPORT_LORA_TX_MA        45          // SX1262 at +14 dBm
+
+typedef enum {
+    TRANSPORT_LINK_BLE,         // Relay or handheld nearby, cheap and short range
+    TRANSPORT_LINK_LORA,        // Mesh to the surface, long airtime
+    TRANSPORT_LINK_COUNT
+} transport_link_t;
+
+#define TRANSPORT_LINK_MASK(link)   (1u << (link))
+#define TRANSPORT_ALL_LINKS         ((1u << TRANSPORT_LINK_COUNT) - 1)
+
+// What the selection knows about one link
+typedef struct {
+    uint16_t ack_latency_ms;    // Smoothed send to ACK, 0 before the first ACK
+    int8_t   rssi_dbm;          // Smoothed over ACKs, TRANSPORT_SIGNAL_UNKNOWN before
+    int8_t   snr_db;            // Smoothed over ACKs, LoRa only
+    uint8_t  history;           // Bit per attempt, newest in bit 0, 1 = ACKed
+    uint8_t  attempts;          // Valid bits in history
+    uint8_t  skipped;           // Routine frames sent elsewhere while failing
+} transport_link_stats_t;
+
+void transport_init(void);
+uint8_t transport_select(uint16_t length, bool is_emergency);
+void transport_report(transport_link_t link, bool acked, uint32_t latency_ms,
+                      int8_t rssi_dbm, int8_t snr_db);
+bool transport_healthy(transport_link_t link);
+uint32_t transport_airtime_us(transport_link_t link, uint16_t length);
+uint32_t transport_ack_timeout_ms(transport_link_t link, uint16_t length);
+uint8_t transport_lora_sf(void);
+void transport_get_stats(transport_link_t link, transport_link_stats_t *stats);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,275 @@
+/**
+ * @file trend.c
+ * @brief Rolling trend per vital, so a single noisy reading cannot escalate
+ * @description Every valid reading updates, in O(1) and fixed memory, an
+ *              EWMA of the value, of its change per minute and of its
+ *              squared deviation, and a signal-quality score that drops on
+ *              invalid readings and on outliers beyond 4 sigma. A reading
+ *              outside its normal band only counts once it is confirmed:
+ *
+ *              - persistent: out of band on TREND_PERSIST_READINGS readings
+ *                in a row, one more while the quality score is poor
+ *              - fast-rising: the slope before the reading was already
+ *                heading out of the band faster than the vital's limit and
+ *                the quality is good
+ *              - critical while the EWMA is already in the warning band,
+ *                the slope still heading out and the quality good
+ *              - the EWMA itself has left the band
+ *
+ *              An unconfirmed critical reading counts as a warning. Falls
+ *              come from the IMU monitor and are not trended. The status is
+ *              composed from the confirmed levels as in health_analyze().
+ *
+ *              Integer arithmetic only; timestamps are app_timer ticks at
+ *              APP_TIMER_CLOCK_FREQ, which follows the RTC prescaler in
+ *              sdk_config.h.
+ */
+
+#include "trend.h"
+#include "app_timer.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_TREND
+#include "trace.h"
+#include <string.h>
+
+#define TREND_MEAN_SHIFT        2       // EWMA weight 1/4
+#define TREND_SLOPE_SHIFT       1       // 1/2, a change shows after one reading
+#define TREND_VAR_SHIFT         3       // 1/8
+#define TREND_QUALITY_SHIFT     2
+#define TREND_OUTLIER_SIGMA_SQ  16      // 4 sigma
+#define TREND_QUALITY_OUTLIER   64      // Score of an outlier; valid readings score 255
+#define TREND_PERSIST_READINGS  2
+#define TREND_TICKS_PER_MIN     (60LL * APP_TIMER_CLOCK_FREQ)
+#define TREND_TICK_MASK         0x00FFFFFF  // app_timer counter is 24-bit
+#define TREND_STALE_TICKS       (6UL * 60 * APP_TIMER_CLOCK_FREQ)  // Covers the 5 min temperature period in main.c
+#define TREND_SLOPE_LIMIT       (1L << 23)
+
+#define TREND_NO_LOW            INT16_MIN
+#define TREND_NO_HIGH           INT16_MAX
+
+// Normal band of a vital in sensor units, thresholds as in health_analyze()
+typedef struct {
+    char const *name;
+    int16_t critical_low;       // Below: critical
+    int16_t warning_low;        // Below: warning
+    int16_t warning_high;       // Above: warning
+    int16_t critical_high;      // Above: critical
+    int16_t noise;              // Reading-to-reading noise, 1 sigma
+    int16_t fast_slope;         // Change per minute that confirms a deviation at once
+} trend_band_t;
+
+static const trend_band_t m_bands[TREND_VITAL_COUNT] = {
+    [TREND_SPO2]        = { "SpO2", SPO2_MIN_CRITICAL, SPO2_MIN_NORMAL,
+                            TREND_NO_HIGH, TREND_NO_HIGH, 1, 2 },
+    [TREND_HEART_RATE]  = { "HR", HEART_RATE_CRITICAL_MIN, HEART_RATE_MIN,
+                            HEART_RATE_MAX, HEART_RATE_CRITICAL_MAX, 3, 10 },
+    [TREND_TEMPERATURE] = { "temp", TEMP_CRITICAL_MIN, TEMP_MIN_NORMAL,
+                            TEMP_MAX_NORMAL, TEMP_CRITICAL_MAX,
+                            TMP117_RAW_FROM_CDEG(10), TMP117_RAW_FROM_CDEG(25) },
+    [TREND_SYSTOLIC]    = { "systolic", TREND_NO_LOW, BP_SYSTOLIC_MIN,
+                            BP_SYSTOLIC_MAX, TREND_NO_HIGH, 4, 10 },
+};
+
+static trend_stats_t m_stats[TREND_VITAL_COUNT];
+static uint8_t m_primed = 0;            // One bit per vital with a first reading
+
+static trend_level_t trend_band_level(trend_band_t const *band, int32_t value) {
+    if (value < band->critical_low || value > band->critical_high) {
+        return TREND_LEVEL_CRITICAL;
+    }
+    if (value < band->warning_low || value > band->warning_high) {
+        return TREND_LEVEL_WARNING;
+    }
+    return TREND_LEVEL_NORMAL;
+}
+
+static int32_t trend_mean(trend_stats_t const *s) {
+    return (s->mean + (1 << (TREND_FRAC_BITS - 1))) >> TREND_FRAC_BITS;
+}
+
+/**
+ * @brief Slope points out of the band on the side the value left it
+ * @param fast Least change per minute that counts, << TREND_FRAC_BITS
+ */
+static bool trend_heading_out(trend_band_t const *band, int32_t value, int32_t slope, int32_t fast) {
+    if (value < band->warning_low) {
+        return slope <= -fast;
+    }
+    if (value > band->warning_high) {
+        return slope >= fast;
+    }
+    return false;
+}
+
+static uint8_t trend_sat_inc(uint8_t count) {
+    return (count < UINT8_MAX) ? count + 1 : count;
+}
+
+/**
+ * @brief Fold one reading into the statistics of a vital
+ * @return Confirmed level
+ */
+static trend_level_t trend_vital_update(trend_vital_t vital, int32_t value, uint32_t timestamp, bool valid) {
+    trend_stats_t *s = &m_stats[vital];
+    trend_band_t const *band = &m_bands[vital];
+    bool primed = (m_primed & (1 << vital)) != 0;
+
+    if (!valid) {
+        // Nothing to judge; a deviation holds as long as the mean shows it
+        s->quality -= s->quality >> TREND_QUALITY_SHIFT;
+        s->level = primed ? trend_band_level(band, trend_mean(s)) : TREND_LEVEL_NORMAL;
+        return (trend_level_t)s->level;
+    }
+
+    int32_t prior_slope = s->slope;
+
+    if (!primed) {
+        s->mean = value * (1 << TREND_FRAC_BITS);
+        s->slope = 0;
+        s->var = (uint32_t)band->noise * band->noise;
+        prior_slope = 0;
+        m_primed |= (uint8_t)(1 << vital);
+    } else {
+        uint32_t floor = (uint32_t)band->noise * band->noise;
+        uint32_t var = (s->var > floor) ? s->var : floor;
+        int32_t dev = value - trend_mean(s);
+        uint64_t dev_sq = (uint64_t)((int64_t)dev * dev);
+        bool outlier = dev_sq > (uint64_t)TREND_OUTLIER_SIGMA_SQ * var;
+
+        // Outliers are clipped to 4 sigma so one cannot mask the next
+        if (outlier) {
+            dev_sq = (uint64_t)TREND_OUTLIER_SIGMA_SQ * var;
+        }
+        s->var = (uint32_t)((int64_t)s->var + (((int64_t)dev_sq - (int64_t)s->var) >> TREND_VAR_SHIFT));
+        s->mean += ((value * (1 << TREND_FRAC_BITS)) - s->mean) >> TREND_MEAN_SHIFT;
+
+        int32_t score = outlier ? TREND_QUALITY_OUTLIER : UINT8_MAX;
+        s->quality = (uint8_t)(s->quality + ((score - (int32_t)s->quality) >> TREND_QUALITY_SHIFT));
+
+        uint32_t dt = (timestamp - s->last_time) & TREND_TICK_MASK;
+        if (dt > TREND_STALE_TICKS) {
+            s->slope = 0;
+        } else if (dt > 0) {
+            int64_t rate = ((int64_t)(value - s->last) * TREND_TICKS_PER_MIN * (1 << TREND_FRAC_BITS)) / dt;
+            if (rate > TREND_SLOPE_LIMIT) {
+                rate = TREND_SLOPE_LIMIT;
+            } else if (rate < -TREND_SLOPE_LIMIT) {
+                rate = -TREND_SLOPE_LIMIT;
+            }
+            s->slope += (int32_t)((rate - s->slope) >> TREND_SLOPE_SHIFT);
+        }
+    }
+    s->last = value;
+    s->last_time = timestamp;
+
+    trend_level_t now = trend_band_level(band, value);
+    s->persist_warning = (now >= TREND_LEVEL_WARNING) ? trend_sat_inc(s->persist_warning) : 0;
+    s->persist_critical = (now == TREND_LEVEL_CRITICAL) ? trend_sat_inc(s->persist_critical) : 0;
+    uint8_t needed = TREND_PERSIST_READINGS + ((s->quality < TREND_QUALITY_GOOD) ? 1 : 0);
+
+    trend_level_t level = trend_band_level(band, trend_mean(s));
+    if (s->persist_critical >= needed) {
+        level = TREND_LEVEL_CRITICAL;
+    } else if (s->persist_warning >= needed && level < TREND_LEVEL_WARNING) {
+        level = TREND_LEVEL_WARNING;
+    }
+
+    int32_t fast = (int32_t)band->fast_slope << TREND_FRAC_BITS;
+    if (now > level) {
+        if (s->quality >= TREND_QUALITY_GOOD && trend_heading_out(band, value, prior_slope, fast)) {
+            level = now;
+            TRACE_INFO("%s %d confirmed by slope %d/min", band->name, value, prior_slope >> TREND_FRAC_BITS);
+        } else if (now == TREND_LEVEL_CRITICAL && level == TREND_LEVEL_WARNING &&
+                   s->quality >= TREND_QUALITY_GOOD && trend_heading_out(band, value, s->slope, 1)) {
+            // The mean has already drifted out of the normal band: a critical
+            // reading that keeps falling is the deterioration itself, waiting
+            // for TREND_PERSIST_READINGS would only delay the alert
+            level = now;
+            TRACE_INFO("%s %d confirmed by mean %d", band->name, value, trend_mean(s));
+        } else {
+            if (now == TREND_LEVEL_CRITICAL && level < TREND_LEVEL_WARNING) {
+                level = TREND_LEVEL_WARNING;
+            }
+            TRACE_INFO("%s %d not confirmed yet (%d of %d readings, quality %d)", band->name, value,
+                       s->persist_warning, needed, s->quality);
+        }
+    }
+
+    s->level = level;
+    return level;
+}
+
+/**
+ * @brief Clear all statistics; the first reading of each vital primes it
+ */
+void trend_init(void) {
+    memset(m_stats, 0, sizeof(m_stats));
+    for (uint8_t i = 0; i < TREND_VITAL_COUNT; i++) {
+        m_stats[i].quality = UINT8_MAX;
+    }
+    m_primed = 0;
+}
+
+/**
+ * @brief Update the trends with a new set of readings
+ * @param vitals Readings of the cycle, timestamped in RTC ticks
+ * @return Health status from the confirmed deviations
+ */
+health_status_t trend_update(vital_signs_t const *vitals) {
+    trend_level_t levels[TREND_VITAL_COUNT];
+    uint8_t warning_flags = 0;
+    uint8_t critical_flags = 0;
+
+    // A stale reading was already counted; its vital keeps its level
+    for (uint8_t i = 0; i < TREND_VITAL_COUNT; i++) {
+        levels[i] = (trend_level_t)m_stats[i].level;
+    }
+    if (!(vitals->stale & VITAL_STALE_PPG)) {
+        levels[TREND_SPO2] = trend_vital_update(TREND_SPO2, vitals->spo2,
+                                                vitals->timestamp, vitals->ppg_valid);
+        levels[TREND_HEART_RATE] = trend_vital_update(TREND_HEART_RATE, vitals->heart_rate,
+                                                      vitals->timestamp, vitals->ppg_valid);
+    }
+    if (!(vitals->stale & VITAL_STALE_TEMP)) {
+        levels[TREND_TEMPERATURE] = trend_vital_update(TREND_TEMPERATURE, vitals->temp_raw,
+                                                       vitals->timestamp, true);
+    }
+    if (!(vitals->stale & VITAL_STALE_ECG)) {
+        levels[TREND_SYSTOLIC] = trend_vital_update(TREND_SYSTOLIC, vitals->bp_systolic,
+                                                    vitals->timestamp, vitals->ecg_valid);
+    }
+
+    for (uint8_t i = 0; i < TREND_VITAL_COUNT; i++) {
+        if (levels[i] == TREND_LEVEL_CRITICAL) {
+            critical_flags++;
+        } else if (levels[i] == TREND_LEVEL_WARNING) {
+            warning_flags++;
+        }
+    }
+
+    // Falls are events from the IMU monitor, not trends
+    if (critical_flags > 0 || vitals->fall_detected) {
+        return HEALTH_EMERGENCY;
+    }
+    if (warning_flags >= 2) {
+        return HEALTH_CRITICAL;
+    }
+    return (warning_flags > 0) ? HEALTH_WARNING : HEALTH_NORMAL;
+}
+
+/**
+ * @brief Running statistics of one vital, NULL for an unknown vital
+ */
+trend_stats_t const *trend_stats(trend_vital_t vital) {
+    return (vital < TREND_VITAL_COUNT) ? &m_stats[vital] : NULL;
+}
+
+/**
+ * @brief Log the trend of every vital
+ */
+void trend_log(void) {
+    for (uint8_t i = 0; i < TREND_VITAL_COUNT; i++) {
+        trend_stats_t const *s = &m_stats[i];
+        TRACE_DEBUG("%s: mean %d slope %d/min var %d quality %d level %d", m_bands[i].name,
+                    trend_mean(s), s->slope >> TREND_FRAC_BITS, s->var, s->quality, s->level);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef TREND_H
+#define TREND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vitals.h"
+#include "health.h"
+
+#define TREND_FRAC_BITS         8       // Fixed-point fraction of mean and slope
+#define TREND_QUALITY_GOOD      160     // Below this a deviation needs one more reading
+
+// Vitals followed by the trend engine
+typedef enum {
+    TREND_SPO2,
+    TREND_HEART_RATE,
+    TREND_TEMPERATURE,
+    TREND_SYSTOLIC,
+    TREND_VITAL_COUNT
+} trend_vital_t;
+
+// Deviation levels, ordered by severity
+typedef enum {
+    TREND_LEVEL_NORMAL,
+    TREND_LEVEL_WARNING,
+    TREND_LEVEL_CRITICAL
+} trend_level_t;
+
+// Running statistics of one vital (24 bytes)
+typedef struct {
+    int32_t  mean;              // EWMA, sensor units << TREND_FRAC_BITS
+    int32_t  slope;             // EWMA of the change per minute << TREND_FRAC_BITS
+    uint32_t var;               // EWMA of the squared deviation from the mean
+    int32_t  last;              // Previous valid reading
+    uint32_t last_time;         // Its timestamp (RTC ticks)
+    uint8_t  quality;           // Signal quality score, 255 = clean
+    uint8_t  persist_warning;   // Consecutive readings at warning or worse
+    uint8_t  persist_critical;  // Consecutive readings at critical
+    uint8_t  level;             // Confirmed level (trend_level_t)
+} trend_stats_t;
+
+void trend_init(void);
+health_status_t trend_update(vital_signs_t const *vitals);
+trend_stats_t const *trend_stats(trend_vital_t vital);
+void trend_log(void);
+
+#endif
\ No newline at end of file
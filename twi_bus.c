@@ -0,0 +1,100 @@
+/**
+ * @file twi_bus.c
+ * @brief Shared TWI bus for the MAX30102 and TMP117
+ * @description Single owner of TWIM0. Drivers queue transactions that run
+ *              back-to-back from the TWIM interrupt, so a FIFO burst from
+ *              one sensor never blocks the other driver's code.
+ */
+
+#include "twi_bus.h"
+#include "nrf_log.h"
+
+#define TWI_BUS_SCL_PIN         27    // Adjust to your pin
+#define TWI_BUS_SDA_PIN         26    // Adjust to your pin
+#define TWI_BUS_QUEUE_SIZE      8     // Transactions waiting behind the active one
+
+NRF_TWI_MNGR_DEF(m_twi_mngr, TWI_BUS_QUEUE_SIZE, 0);
+static bool m_initialized = false;
+static bool m_suspended = false;
+
+/**
+ * @brief Sleep while a blocking transaction is in progress
+ */
+static void twi_bus_idle(void) {
+    __WFE();
+}
+
+/**
+ * @brief Initialize the bus; safe to call from every driver
+ */
+int twi_bus_init(void) {
+    if (m_initialized) {
+        return 0;
+    }
+    
+    const nrf_drv_twi_config_t twi_config = {
+       .scl                = TWI_BUS_SCL_PIN,
+       .sda                = TWI_BUS_SDA_PIN,
+       .frequency          = NRF_DRV_TWI_FREQ_400K,
+       .interrupt_priority = APP_IRQ_PRIORITY_HIGH,
+       .clear_bus_init     = false
+    };
+    
+    ret_code_t err_code = nrf_twi_mngr_init(&m_twi_mngr, &twi_config);
+    if (err_code != NRF_SUCCESS) {
+        NRF_LOG_ERROR("TWI bus init failed: %d", err_code);
+        return -1;
+    }
+    
+    m_initialized = true;
+    return 0;
+}
+
+/**
+ * @brief Re-enable TWIM0 after twi_bus_suspend()
+ */
+static void twi_bus_resume(void) {
+    if (m_suspended) {
+        nrf_drv_twi_enable(&m_twi_mngr.twi);
+        m_suspended = false;
+    }
+}
+
+/**
+ * @brief Disable TWIM0 until the next transfer, if nothing is queued
+ */
+void twi_bus_suspend(void) {
+    if (m_initialized && !m_suspended && nrf_twi_mngr_is_idle(&m_twi_mngr)) {
+        nrf_drv_twi_disable(&m_twi_mngr.twi);
+        m_suspended = true;
+    }
+}
+
+/**
+ * @brief Queue a transaction without waiting for it
+ * @note The transaction and all buffers it references must stay valid until
+ *       its callback runs (TWIM interrupt context). Write buffers must be in
+ *       RAM for EasyDMA.
+ */
+ret_code_t twi_bus_schedule(nrf_twi_mngr_transaction_t const *p_transaction) {
+    if (!m_initialized) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    
+    twi_bus_resume();
+    return nrf_twi_mngr_schedule(&m_twi_mngr, p_transaction);
+}
+
+/**
+ * @brief Run transfers and sleep until they complete (thread context only)
+ * @note Queued behind any scheduled transactions, so it never interleaves
+ *       with another driver's burst.
+ */
+ret_code_t twi_bus_perform(nrf_twi_mngr_transfer_t const *p_transfers, uint8_t count) {
+    if (!m_initialized) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    
+    twi_bus_resume();
+    return nrf_twi_mngr_perform(&m_twi_mngr, NULL, p_transfers, count, twi_bus_idle);
+}
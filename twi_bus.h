@@ -0,0 +1,12 @@
+#ifndef TWI_BUS_H
+#define TWI_BUS_H
+
+#include <stdint.h>
+#include "nrf_twi_mngr.h"
+
+int twi_bus_init(void);
+ret_code_t twi_bus_schedule(nrf_twi_mngr_transaction_t const *p_transaction);
+ret_code_t twi_bus_perform(nrf_twi_mngr_transfer_t const *p_transfers, uint8_t count);
+void twi_bus_suspend(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+/**
+ * @file vitals.c
+ * @brief Conversion between working vitals and the packed record
+ */
+
+#include "vitals.h"
+#include <string.h>
+
+/**
+ * @brief Saturate a 16-bit value into a byte
+ */
+static uint8_t vitals_sat_u8(uint16_t value) {
+    return (value > UINT8_MAX) ? UINT8_MAX : (uint8_t)value;
+}
+
+/**
+ * @brief Pack vitals into a compact record
+ */
+void vitals_pack(vital_signs_t const *vitals, vital_record_t *record) {
+    record->timestamp = vitals->timestamp;
+    record->temp_raw = vitals->temp_raw;
+    record->accel_raw[0] = vitals->accel_raw[0];
+    record->accel_raw[1] = vitals->accel_raw[1];
+    record->accel_raw[2] = vitals->accel_raw[2];
+    record->spo2 = vitals->spo2;
+    record->heart_rate = vitals_sat_u8(vitals->heart_rate);
+    record->bp_systolic = vitals_sat_u8(vitals->bp_systolic);
+    record->bp_diastolic = vitals_sat_u8(vitals->bp_diastolic);
+    record->flags = (vitals->fall_detected ? VITAL_FLAG_FALL : 0) |
+                    (vitals->no_movement ? VITAL_FLAG_NO_MOVEMENT : 0) |
+                    (vitals->ppg_valid ? VITAL_FLAG_PPG_VALID : 0) |
+                    (vitals->ecg_valid ? VITAL_FLAG_ECG_VALID : 0) |
+                    ((vitals->stale << VITAL_FLAG_STALE_SHIFT) & VITAL_FLAG_STALE_MASK);
+}
+
+/**
+ * @brief Expand a packed record back into working vitals
+ */
+void vitals_unpack(vital_record_t const *record, vital_signs_t *vitals) {
+    memset(vitals, 0, sizeof(vital_signs_t));
+    vitals->timestamp = record->timestamp;
+    vitals->temp_raw = record->temp_raw;
+    for (uint8_t i = 0; i < 3; i++) {
+        vitals->accel_raw[i] = record->accel_raw[i];
+        vitals->accel_mag_sq += (uint32_t)((int32_t)record->accel_raw[i] * record->accel_raw[i]);
+    }
+    vitals->spo2 = record->spo2;
+    vitals->heart_rate = record->heart_rate;
+    vitals->bp_systolic = record->bp_systolic;
+    vitals->bp_diastolic = record->bp_diastolic;
+    vitals->fall_detected = (record->flags & VITAL_FLAG_FALL) != 0;
+    vitals->no_movement = (record->flags & VITAL_FLAG_NO_MOVEMENT) != 0;
+    vitals->ppg_valid = (record->flags & VITAL_FLAG_PPG_VALID) != 0;
+    vitals->ecg_valid = (record->flags & VITAL_FLAG_ECG_VALID) != 0;
+    vitals->stale = (record->flags & VITAL_FLAG_STALE_MASK) >> VITAL_FLAG_STALE_SHIFT;
+}
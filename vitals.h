@@ -0,0 +1,53 @@
+#ifndef VITALS_H
+#define VITALS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Vital signs in raw sensor units, so health decisions stay integer-only
+typedef struct {
+    uint8_t  spo2;              // Blood oxygen saturation (%)
+    uint16_t heart_rate;        // Beats per minute
+    uint16_t bp_systolic;       // Blood pressure systolic (mmHg)
+    uint16_t bp_diastolic;      // Blood pressure diastolic (mmHg)
+    int16_t  temp_raw;          // Body temperature (TMP117 LSB, 1/128 degC)
+    int16_t  accel_raw[3];      // Acceleration X/Y/Z (ICM-42688 counts, 2048/g)
+    uint32_t accel_mag_sq;      // Acceleration magnitude squared (counts^2)
+    bool     fall_detected;     // Fall detection flag
+    bool     no_movement;       // No movement detected flag
+    bool     ppg_valid;         // SpO2/HR are valid (pulse detected)
+    bool     ecg_valid;         // ECG-derived BP is valid (QRS detected)
+    uint8_t  stale;             // VITAL_STALE_* readings carried from an earlier cycle
+    uint32_t timestamp;         // Measurement timestamp
+} vital_signs_t;
+
+// Sensors not sampled this cycle, their fields hold the previous reading
+#define VITAL_STALE_PPG         (1 << 0)
+#define VITAL_STALE_ECG         (1 << 1)
+#define VITAL_STALE_TEMP        (1 << 2)
+#define VITAL_STALE_ACCEL       (1 << 3)
+
+// Packed record flags
+#define VITAL_FLAG_FALL         (1 << 0)
+#define VITAL_FLAG_NO_MOVEMENT  (1 << 1)
+#define VITAL_FLAG_PPG_VALID    (1 << 2)
+#define VITAL_FLAG_ECG_VALID    (1 << 3)
+#define VITAL_FLAG_STALE_SHIFT  4           // VITAL_STALE_* bits in the high nibble
+#define VITAL_FLAG_STALE_MASK   (0x0F << VITAL_FLAG_STALE_SHIFT)
+
+// Compact record for buffering and transmission (17 bytes)
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;
+    int16_t  temp_raw;
+    int16_t  accel_raw[3];
+    uint8_t  spo2;
+    uint8_t  heart_rate;        // Saturated at 255 BPM
+    uint8_t  bp_systolic;       // Saturated at 255 mmHg
+    uint8_t  bp_diastolic;
+    uint8_t  flags;             // VITAL_FLAG_*
+} vital_record_t;
+
+void vitals_pack(vital_signs_t const *vitals, vital_record_t *record);
+void vitals_unpack(vital_record_t const *record, vital_signs_t *vitals);
+
+#endif
\ No newline at end of file
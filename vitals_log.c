@@ -0,0 +1,367 @@
+/**
+ * @file vitals_log.c
+ * @brief Store-and-forward ring log of readings in internal flash
+ * @description Append-only log over VITALS_LOG_PAGES flash pages. Every
+ *              reading gets a sequence number; uploads are confirmed with
+ *              ACK entries in the same log, so after a reset only readings
+ *              newer than the last ACK are sent again.
+ *
+ *              Entries are staged in RAM and written one chunk at a time.
+ *              A page is erased right before its first chunk, so each page
+ *              sees one erase per trip around the ring. Once the ring is
+ *              full the oldest page is dropped, acknowledged or not.
+ *
+ *              Each 32-byte entry holds a write counter (its position in the
+ *              ring), a sequence number, a packed record, its kind and a
+ *              CRC16. Torn or erased entries fail the CRC and are skipped.
+ */
+
+#include "vitals_log.h"
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_nvmc.h"
+#include "crc16.h"
+#include "profiler.h"
+#define TRACE_MODULE_LEVEL  TRACE_LEVEL_VITALS_LOG
+#include "trace.h"
+#include <stddef.h>
+#include <string.h>
+
+#define VITALS_LOG_PAGE_ENTRIES     (VITALS_LOG_PAGE_SIZE / sizeof(vitals_log_entry_t))
+#define VITALS_LOG_ENTRIES          (VITALS_LOG_PAGES * VITALS_LOG_PAGE_ENTRIES)
+#define VITALS_LOG_END_ADDR         (VITALS_LOG_START_ADDR + VITALS_LOG_PAGES * VITALS_LOG_PAGE_SIZE)
+
+#define VITALS_LOG_KIND_READING     0x01
+#define VITALS_LOG_KIND_ACK         0x02    // seq is the first unacknowledged reading
+
+typedef struct __attribute__((packed)) {
+    uint32_t       id;          // Write counter, slot is id % VITALS_LOG_ENTRIES
+    uint32_t       seq;
+    vital_record_t record;
+    uint8_t        status;
+    uint8_t        kind;
+    uint8_t        reserved[3];
+    uint16_t       crc;         // CRC16 over all preceding bytes
+} vitals_log_entry_t;
+
+static void vitals_log_evt_handler(nrf_fstorage_evt_t *p_evt);
+
+NRF_FSTORAGE_DEF(nrf_fstorage_t m_fstorage) = {
+    .evt_handler = vitals_log_evt_handler,
+    .start_addr  = VITALS_LOG_START_ADDR,
+    .end_addr    = VITALS_LOG_END_ADDR,
+};
+
+static bool m_initialized = false;
+
+// Staged entries, ids m_flash_next .. m_next_id - 1
+static vitals_log_entry_t m_stage[VITALS_LOG_CHUNK_ENTRIES];
+static uint8_t m_stage_count = 0;
+
+// Chunk being programmed; fstorage needs the source until it completes
+static vitals_log_entry_t m_write_buf[VITALS_LOG_CHUNK_ENTRIES];
+static uint32_t m_write_id;
+static uint8_t m_write_count = 0;
+static volatile uint8_t m_ops_pending = 0;
+
+static uint32_t m_flash_next = 0;       // Next id to be programmed
+static uint32_t m_next_id = 0;          // Next id to be staged
+static uint32_t m_next_seq = 0;         // Sequence number of the next reading
+static uint32_t m_first_unacked = 0;
+
+// Readings with seq >= m_hint_seq all lie at or after m_hint_id
+static uint32_t m_hint_id = 0;
+static uint32_t m_hint_seq = 0;
+
+static void vitals_log_evt_handler(nrf_fstorage_evt_t *p_evt) {
+    if (p_evt->result != NRF_SUCCESS) {
+        TRACE_ERROR("Vitals log flash operation failed: %d", p_evt->result);
+    }
+    if (p_evt->id == NRF_FSTORAGE_EVT_WRITE_RESULT) {
+        m_write_count = 0;
+    }
+    m_ops_pending--;
+}
+
+static uint32_t vitals_log_addr(uint32_t id) {
+    return VITALS_LOG_START_ADDR + (id % VITALS_LOG_ENTRIES) * sizeof(vitals_log_entry_t);
+}
+
+static uint16_t vitals_log_crc(vitals_log_entry_t const *entry) {
+    return crc16_compute((uint8_t const *)entry, offsetof(vitals_log_entry_t, crc), NULL);
+}
+
+/**
+ * @brief Oldest id still held in flash
+ * @note The page being filled has lost its previous contents, the other
+ *       pages hold one full trip around the ring.
+ */
+static uint32_t vitals_log_oldest_id(void) {
+    uint32_t page_start = m_flash_next - (m_flash_next % VITALS_LOG_PAGE_ENTRIES);
+    uint32_t span = (VITALS_LOG_PAGES - 1) * VITALS_LOG_PAGE_ENTRIES;
+    return (page_start > span) ? page_start - span : 0;
+}
+
+/**
+ * @brief Fetch an entry from the stage, the chunk in flight or flash
+ * @return true if the entry is valid
+ */
+static bool vitals_log_get(uint32_t id, vitals_log_entry_t *entry) {
+    if (id >= m_flash_next) {
+        *entry = m_stage[id - m_flash_next];
+        return true;
+    }
+    if (m_write_count > 0 && id >= m_write_id) {
+        *entry = m_write_buf[id - m_write_id];
+        return true;
+    }
+    if (nrf_fstorage_read(&m_fstorage, vitals_log_addr(id), entry, sizeof(*entry)) != NRF_SUCCESS) {
+        return false;
+    }
+    return entry->id == id && entry->crc == vitals_log_crc(entry);
+}
+
+/**
+ * @brief Program the staged entries, erasing the page on its first chunk
+ */
+static int vitals_log_write_stage(void) {
+    if (m_stage_count == 0) {
+        return 0;
+    }
+    if (m_ops_pending > 0) {
+        return -1;
+    }
+
+    uint32_t addr = vitals_log_addr(m_flash_next);
+    ret_code_t err_code;
+
+    profiler_begin(PROFILER_OP_FLASH);
+    if ((m_flash_next % VITALS_LOG_PAGE_ENTRIES) == 0) {
+        m_ops_pending++;
+        err_code = nrf_fstorage_erase(&m_fstorage, addr, 1, NULL);
+        if (err_code != NRF_SUCCESS) {
+            m_ops_pending--;
+            profiler_end(PROFILER_OP_FLASH);
+            TRACE_ERROR("Vitals log page erase failed: %d", err_code);
+            return -1;
+        }
+    }
+
+    memcpy(m_write_buf, m_stage, m_stage_count * sizeof(vitals_log_entry_t));
+    m_write_id = m_flash_next;
+    m_write_count = m_stage_count;
+
+    m_ops_pending++;
+    err_code = nrf_fstorage_write(&m_fstorage, addr, m_write_buf,
+                                  m_write_count * sizeof(vitals_log_entry_t), NULL);
+    profiler_end(PROFILER_OP_FLASH);
+    if (err_code != NRF_SUCCESS) {
+        m_ops_pending--;
+        m_write_count = 0;
+        TRACE_ERROR("Vitals log write failed: %d", err_code);
+        return -1;
+    }
+
+    m_flash_next += m_stage_count;
+    m_stage_count = 0;
+    return 0;
+}
+
+/**
+ * @brief Stage one entry, programming the chunk once it is complete
+ */
+static int vitals_log_put(vitals_log_entry_t *entry) {
+    if (m_stage_count > 0 && (m_next_id % VITALS_LOG_CHUNK_ENTRIES) == 0) {
+        // Stage ends on a chunk boundary but the previous chunk was still
+        // in flight; a chunk never spans two pages
+        if (vitals_log_write_stage() != 0) {
+            return -1;
+        }
+    }
+
+    entry->id = m_next_id;
+    memset(entry->reserved, 0xFF, sizeof(entry->reserved));
+    entry->crc = vitals_log_crc(entry);
+    m_stage[m_stage_count++] = *entry;
+    m_next_id++;
+
+    if ((m_next_id % VITALS_LOG_CHUNK_ENTRIES) == 0) {
+        vitals_log_write_stage();
+    }
+    return 0;
+}
+
+/**
+ * @brief Initialize flash access and recover the log position
+ */
+int vitals_log_init(void) {
+    vitals_log_entry_t entry;
+    bool found = false;
+    uint32_t last_id = 0;
+
+    ret_code_t err_code = nrf_fstorage_init(&m_fstorage, &nrf_fstorage_nvmc, NULL);
+    if (err_code != NRF_SUCCESS) {
+        TRACE_ERROR("Vitals log fstorage init failed: %d", err_code);
+        return -1;
+    }
+
+    m_next_seq = 0;
+    m_first_unacked = 0;
+
+    for (uint32_t slot = 0; slot < VITALS_LOG_ENTRIES; slot++) {
+        uint32_t addr = VITALS_LOG_START_ADDR + slot * sizeof(vitals_log_entry_t);
+        if (nrf_fstorage_read(&m_fstorage, addr, &entry, sizeof(entry)) != NRF_SUCCESS ||
+            (entry.id % VITALS_LOG_ENTRIES) != slot ||
+            entry.crc != vitals_log_crc(&entry)) {
+            continue;
+        }
+
+        if (!found || entry.id > last_id) {
+            last_id = entry.id;
+            found = true;
+        }
+        if (entry.kind == VITALS_LOG_KIND_READING && entry.seq >= m_next_seq) {
+            m_next_seq = entry.seq + 1;
+        } else if (entry.kind == VITALS_LOG_KIND_ACK && entry.seq > m_first_unacked) {
+            m_first_unacked = entry.seq;
+        }
+    }
+
+    // Resume on a fresh chunk so a torn write is never programmed twice
+    m_next_id = 0;
+    if (found) {
+        m_next_id = last_id + VITALS_LOG_CHUNK_ENTRIES - (last_id % VITALS_LOG_CHUNK_ENTRIES);
+    }
+    m_flash_next = m_next_id;
+    m_stage_count = 0;
+    m_hint_id = vitals_log_oldest_id();
+    m_hint_seq = 0;
+
+    TRACE_INFO("Vitals log: %d readings, %d not uploaded",
+               m_next_seq, m_next_seq - m_first_unacked);
+    m_initialized = true;
+    return 0;
+}
+
+/**
+ * @brief Append a reading
+ * @param p_seq Receives the reading's sequence number; may be NULL
+ * @return 0 on success, -1 if the log is unavailable
+ */
+int vitals_log_append(vital_signs_t const *vitals, uint8_t status, uint32_t *p_seq) {
+    vitals_log_entry_t entry;
+
+    if (!m_initialized) {
+        return -1;
+    }
+
+    entry.seq = m_next_seq;
+    vitals_pack(vitals, &entry.record);
+    entry.status = status;
+    entry.kind = VITALS_LOG_KIND_READING;
+
+    if (vitals_log_put(&entry) != 0) {
+        TRACE_ERROR("Vitals log full, reading not stored");
+        return -1;
+    }
+
+    if (p_seq) {
+        *p_seq = m_next_seq;
+    }
+    m_next_seq++;
+    return 0;
+}
+
+/**
+ * @brief Readings not yet acknowledged by the gateway
+ */
+uint32_t vitals_log_pending(void) {
+    return m_next_seq - m_first_unacked;
+}
+
+/**
+ * @brief Sequence number the next appended reading gets
+ */
+uint32_t vitals_log_next_seq(void) {
+    return m_next_seq;
+}
+
+/**
+ * @brief Sequence number of the oldest unacknowledged reading
+ */
+uint32_t vitals_log_first_unacked(void) {
+    return m_first_unacked;
+}
+
+/**
+ * @brief Read consecutive readings, including those still staged in RAM
+ * @param p_seq First sequence number wanted; updated to the first one
+ *              returned, which is later if older readings were overwritten
+ * @return Number of readings copied
+ */
+uint8_t vitals_log_read(uint32_t *p_seq, vital_signs_t *vitals, uint8_t *status, uint8_t max_count) {
+    vitals_log_entry_t entry;
+    uint32_t oldest = vitals_log_oldest_id();
+    uint32_t id = oldest;
+    uint32_t expected = *p_seq;
+    uint8_t count = 0;
+
+    if (!m_initialized) {
+        return 0;
+    }
+
+    if (*p_seq >= m_hint_seq && m_hint_id >= oldest) {
+        id = m_hint_id;
+    }
+
+    for (; id < m_next_id && count < max_count; id++) {
+        if (!vitals_log_get(id, &entry) ||
+            entry.kind != VITALS_LOG_KIND_READING ||
+            entry.seq < expected) {
+            continue;
+        }
+        if (count == 0) {
+            *p_seq = entry.seq;
+        } else if (entry.seq != expected) {
+            break;
+        }
+
+        vitals_unpack(&entry.record, &vitals[count]);
+        status[count] = entry.status;
+        count++;
+        expected = entry.seq + 1;
+
+        m_hint_id = id + 1;
+        m_hint_seq = expected;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Mark all readings up to last_seq as uploaded
+ */
+void vitals_log_ack(uint32_t last_seq) {
+    vitals_log_entry_t entry;
+
+    if (!m_initialized || last_seq < m_first_unacked) {
+        return;
+    }
+
+    m_first_unacked = last_seq + 1;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.seq = m_first_unacked;
+    entry.kind = VITALS_LOG_KIND_ACK;
+    if (vitals_log_put(&entry) != 0) {
+        TRACE_WARNING("Vitals log ACK not stored");
+    }
+}
+
+/**
+ * @brief Program staged entries now instead of waiting for a full chunk
+ */
+void vitals_log_flush(void) {
+    if (m_initialized) {
+        vitals_log_write_stage();
+    }
+}
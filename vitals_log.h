@@ -0,0 +1,23 @@
+#ifndef VITALS_LOG_H
+#define VITALS_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vitals.h"
+
+// Flash region reserved for the log (must stay outside the application image)
+#define VITALS_LOG_START_ADDR       0x000E0000
+#define VITALS_LOG_PAGES            16
+#define VITALS_LOG_PAGE_SIZE        4096
+#define VITALS_LOG_CHUNK_ENTRIES    8       // Entries per flash write (256 bytes)
+
+int vitals_log_init(void);
+int vitals_log_append(vital_signs_t const *vitals, uint8_t status, uint32_t *p_seq);
+uint32_t vitals_log_pending(void);
+uint32_t vitals_log_next_seq(void);
+uint32_t vitals_log_first_unacked(void);
+uint8_t vitals_log_read(uint32_t *p_seq, vital_signs_t *vitals, uint8_t *status, uint8_t max_count);
+void vitals_log_ack(uint32_t last_seq);
+void vitals_log_flush(void);
+
+#endif
\ No newline at end of file